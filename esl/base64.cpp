@@ -1,12 +1,284 @@
 #include "base64.hpp"
-//#include <immintrin.h>
+#include "intrin.hpp"
+
+#include <algorithm>
+#include <cstring>
 
 namespace esl {
 
+#ifdef ESL_ARCH_X86_ANY
+
+namespace {
+
+// Vectorized encoding, see http://0x80.pl/notesen/2016-01-12-sse-base64-encoding.html
+// Kernels return the input size consumed (multiple of 3), the remainder is left to the scalar loop
+
+// shift to add to a 6-bit index to get the character of std_prefix alphabets, selected by
+// 0..25 => 13, 26..51 => 0, 52..61 => 1..10, 62 => 11, 63 => 12
+ESL_ATTR_TARGET("ssse3")
+inline __m128i base64_encode_shift_lut_(const base64_option& option) noexcept {
+	const char s62 = static_cast<char>(option.encode(62) - 62);
+	const char s63 = static_cast<char>(option.encode(63) - 63);
+	const char sd = '0' - 52;
+	return _mm_setr_epi8('a' - 26, sd, sd, sd, sd, sd, sd, sd, sd, sd, sd, s62, s63, 'A', 0, 0);
+}
+
+ESL_ATTR_TARGET("ssse3")
+inline __m128i base64_encode_split_ssse3_(__m128i in) noexcept {
+	// [aaaaaabb][bbbbcccc][ccdddddd] -> [00aaaaaa][00bbbbbb][00cccccc][00dddddd] in each 32-bit lane
+	in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+	const __m128i t0 = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+	const __m128i t1 = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+	return _mm_or_si128(t0, t1);
+}
+
+ESL_ATTR_TARGET("ssse3")
+inline __m128i base64_encode_translate_ssse3_(__m128i indices, __m128i shift_lut) noexcept {
+	__m128i sel = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+	const __m128i upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+	sel = _mm_or_si128(sel, _mm_and_si128(upper, _mm_set1_epi8(13)));
+	return _mm_add_epi8(indices, _mm_shuffle_epi8(shift_lut, sel));
+}
+
+// 12 bytes => 16 chars
+ESL_ATTR_TARGET("ssse3")
+std::size_t base64_encode_ssse3_(const unsigned char* in, std::size_t size, char* out, const base64_option& option) noexcept {
+	const __m128i shift_lut = base64_encode_shift_lut_(option);
+	const unsigned char* const in_base = in;
+	for (; size >= 16; size -= 12) {
+		const __m128i indices = base64_encode_split_ssse3_(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in)));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out), base64_encode_translate_ssse3_(indices, shift_lut));
+		in += 12;
+		out += 16;
+	}
+	return in - in_base;
+}
+
+// 24 bytes => 32 chars
+ESL_ATTR_TARGET("avx2")
+std::size_t base64_encode_avx2_(const unsigned char* in, std::size_t size, char* out, const base64_option& option) noexcept {
+	const __m256i shift_lut = _mm256_broadcastsi128_si256(base64_encode_shift_lut_(option));
+	const __m256i split_shuffle = _mm256_broadcastsi128_si256(_mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+	const unsigned char* const in_base = in;
+	for (; size >= 28; size -= 24) {
+		const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+		const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 12));
+		__m256i v = _mm256_shuffle_epi8(_mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1), split_shuffle);
+		const __m256i t0 = _mm256_mulhi_epu16(_mm256_and_si256(v, _mm256_set1_epi32(0x0fc0fc00)), _mm256_set1_epi32(0x04000040));
+		const __m256i t1 = _mm256_mullo_epi16(_mm256_and_si256(v, _mm256_set1_epi32(0x003f03f0)), _mm256_set1_epi32(0x01000010));
+		const __m256i indices = _mm256_or_si256(t0, t1);
+		__m256i sel = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+		const __m256i upper = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+		sel = _mm256_or_si256(sel, _mm256_and_si256(upper, _mm256_set1_epi8(13)));
+		v = _mm256_add_epi8(indices, _mm256_shuffle_epi8(shift_lut, sel));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out), v);
+		in += 24;
+		out += 32;
+	}
+	return in - in_base;
+}
+
+// 48 bytes => 64 chars, any alphabet
+// See http://0x80.pl/notesen/2016-04-03-avx512-base64.html
+ESL_ATTR_TARGET("avx512f,avx512bw,avx512vbmi")
+std::size_t base64_encode_avx512vbmi_(const unsigned char* in, std::size_t size, char* out, const base64_option& option) noexcept {
+	const __m512i lookup = _mm512_loadu_si512(option.alphabet());
+	// bytes [1, 0, 2, 1] of each 3-byte group in each 32-bit lane
+	const __m512i split_shuffle = _mm512_setr_epi32(0x01020001, 0x04050304, 0x07080607, 0x0a0b090a, 0x0d0e0c0d, 0x10110f10, 0x13141213, 0x16171516,
+			0x191a1819, 0x1c1d1b1c, 0x1f201e1f, 0x22232122, 0x25262425, 0x28292728, 0x2b2c2a2b, 0x2e2f2d2e);
+	// bit offsets of a, b, c, d in the lanes above
+	const __m512i shifts = _mm512_set1_epi64(0x3036242a1016040a);
+	const unsigned char* const in_base = in;
+	for (; size >= 64; size -= 48) {
+		const __m512i v = _mm512_permutexvar_epi8(split_shuffle, _mm512_loadu_si512(in));
+		const __m512i indices = _mm512_multishift_epi64_epi8(shifts, v);
+		_mm512_storeu_si512(out, _mm512_permutexvar_epi8(indices, lookup));
+		in += 48;
+		out += 64;
+	}
+	return in - in_base;
+}
+
+std::size_t base64_encode_simd_(const unsigned char* in, std::size_t size, char* out, const base64_option& option) noexcept {
+	const auto& features = current_cpu_features();
+	std::size_t n = 0;
+	if (features.avx512vbmi) {
+		n += base64_encode_avx512vbmi_(in, size, out, option);
+	}
+	if (option.std_prefix()) {
+		if (features.avx2) {
+			n += base64_encode_avx2_(in + n, size - n, out + n / 3 * 4, option);
+		}
+		if (features.ssse3) {
+			n += base64_encode_ssse3_(in + n, size - n, out + n / 3 * 4, option);
+		}
+	}
+	return n;
+}
+
+// Vectorized decoding of std_prefix alphabets, see http://0x80.pl/notesen/2016-01-17-sse-base64-decoding.html
+// Kernels only consume blocks of valid alphabet characters (no padding), and return the input size consumed.
+// A block with anything else is left to the scalar loop, so results and error positions stay the same
+
+// Per high nibble delta from character to value: '0'-'9' +4, 'A'-'Z' -65, 'a'-'z' -71,
+// characters 62 and 63 are blended in separately as they may share a high nibble with the ranges
+constexpr signed char base64_decode_roll_lut_[16] = {0, 0, 0, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0};
+
+// 16 chars => 12 bytes
+ESL_ATTR_TARGET("sse4.1")
+std::size_t base64_decode_sse41_(const char* in, std::size_t size, unsigned char* out, const base64_option& option) noexcept {
+	const __m128i lut_lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(option.nibble_lut()));
+	const __m128i lut_hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(option.nibble_lut() + 16));
+	const __m128i lut_roll = _mm_loadu_si128(reinterpret_cast<const __m128i*>(base64_decode_roll_lut_));
+	const __m128i c62 = _mm_set1_epi8(option.encode(62));
+	const __m128i c63 = _mm_set1_epi8(option.encode(63));
+	const __m128i roll62 = _mm_set1_epi8(static_cast<char>(62 - option.encode(62)));
+	const __m128i roll63 = _mm_set1_epi8(static_cast<char>(63 - option.encode(63)));
+	const __m128i nibble_mask = _mm_set1_epi8(0x0F);
+	const char* const in_base = in;
+	// 16 bytes stored, within the exact decoded size: 24 characters decode to at least 16 bytes even if padded
+	for (; size >= 24; size -= 16) {
+		const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+		const __m128i hi_nibbles = _mm_and_si128(_mm_srli_epi32(v, 4), nibble_mask);
+		const __m128i lo_nibbles = _mm_and_si128(v, nibble_mask);
+		const __m128i invalid = _mm_and_si128(_mm_shuffle_epi8(lut_lo, lo_nibbles), _mm_shuffle_epi8(lut_hi, hi_nibbles));
+		if (!_mm_testz_si128(invalid, invalid)) {
+			break;
+		}
+		__m128i roll = _mm_shuffle_epi8(lut_roll, hi_nibbles);
+		roll = _mm_blendv_epi8(roll, roll62, _mm_cmpeq_epi8(v, c62));
+		roll = _mm_blendv_epi8(roll, roll63, _mm_cmpeq_epi8(v, c63));
+		const __m128i values = _mm_add_epi8(v, roll);
+		// [00aaaaaa][00bbbbbb][00cccccc][00dddddd] -> [aaaaaabb][bbbbcccc][ccdddddd] in each 32-bit lane
+		const __m128i ab_cd = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+		const __m128i abcd = _mm_madd_epi16(ab_cd, _mm_set1_epi32(0x00011000));
+		const __m128i packed = _mm_shuffle_epi8(abcd, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out), packed);
+		in += 16;
+		out += 12;
+	}
+	return in - in_base;
+}
+
+// 32 chars => 24 bytes
+ESL_ATTR_TARGET("avx2")
+std::size_t base64_decode_avx2_(const char* in, std::size_t size, unsigned char* out, const base64_option& option) noexcept {
+	const __m256i lut_lo = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(option.nibble_lut())));
+	const __m256i lut_hi = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(option.nibble_lut() + 16)));
+	const __m256i lut_roll = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(base64_decode_roll_lut_)));
+	const __m256i c62 = _mm256_set1_epi8(option.encode(62));
+	const __m256i c63 = _mm256_set1_epi8(option.encode(63));
+	const __m256i roll62 = _mm256_set1_epi8(static_cast<char>(62 - option.encode(62)));
+	const __m256i roll63 = _mm256_set1_epi8(static_cast<char>(63 - option.encode(63)));
+	const __m256i nibble_mask = _mm256_set1_epi8(0x0F);
+	const __m256i pack_shuffle = _mm256_broadcastsi128_si256(_mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+	const char* const in_base = in;
+	// 32 bytes stored, within the exact decoded size: 48 characters decode to at least 34 bytes even if padded
+	for (; size >= 48; size -= 32) {
+		const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in));
+		const __m256i hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(v, 4), nibble_mask);
+		const __m256i lo_nibbles = _mm256_and_si256(v, nibble_mask);
+		const __m256i invalid = _mm256_and_si256(_mm256_shuffle_epi8(lut_lo, lo_nibbles), _mm256_shuffle_epi8(lut_hi, hi_nibbles));
+		if (!_mm256_testz_si256(invalid, invalid)) {
+			break;
+		}
+		__m256i roll = _mm256_shuffle_epi8(lut_roll, hi_nibbles);
+		roll = _mm256_blendv_epi8(roll, roll62, _mm256_cmpeq_epi8(v, c62));
+		roll = _mm256_blendv_epi8(roll, roll63, _mm256_cmpeq_epi8(v, c63));
+		const __m256i values = _mm256_add_epi8(v, roll);
+		const __m256i ab_cd = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+		const __m256i abcd = _mm256_madd_epi16(ab_cd, _mm256_set1_epi32(0x00011000));
+		const __m256i packed = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(abcd, pack_shuffle), _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out), packed);
+		in += 32;
+		out += 24;
+	}
+	return in - in_base;
+}
+
+// Whitespace compaction by 8-byte halves: shuffle indices of the non-whitespace bytes for each 8-bit whitespace mask
+struct base64_compact_lut_t_ {
+	unsigned char shuffle[256][8];
+	unsigned char count[256];
+};
+
+constexpr base64_compact_lut_t_ base64_make_compact_lut_() noexcept {
+	base64_compact_lut_t_ lut{};
+	for (unsigned int mask = 0; mask < 256; ++mask) {
+		unsigned char k = 0;
+		for (unsigned char i = 0; i < 8; ++i) {
+			if (!(mask & (1U << i))) {
+				lut.shuffle[mask][k++] = i;
+			}
+		}
+		lut.count[mask] = k;
+		while (k < 8) {
+			lut.shuffle[mask][k++] = 0x80;
+		}
+	}
+	return lut;
+}
+
+constexpr base64_compact_lut_t_ base64_compact_lut_ = base64_make_compact_lut_();
+
+// 16 bytes per step, blocks without whitespace are copied as is
+// return: input size consumed
+ESL_ATTR_TARGET("ssse3")
+std::size_t base64_strip_whitespace_ssse3_(const char* in, std::size_t size, char*& out) noexcept {
+	const char* const in_base = in;
+	for (; size >= 16; size -= 16) {
+		const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+		const __m128i ctrl = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('\t' - 1)), _mm_cmpgt_epi8(_mm_set1_epi8('\r' + 1), v));
+		const __m128i ws = _mm_or_si128(ctrl, _mm_cmpeq_epi8(v, _mm_set1_epi8(' ')));
+		const auto mask = static_cast<unsigned int>(_mm_movemask_epi8(ws));
+		// Stores stay within the input size consumed so far
+		if (mask == 0) {
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out), v);
+			out += 16;
+		} else {
+			const unsigned int lo = mask & 0xFF;
+			const unsigned int hi = mask >> 8;
+			const __m128i lo_shuffle = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(base64_compact_lut_.shuffle[lo]));
+			const __m128i hi_shuffle = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(base64_compact_lut_.shuffle[hi]));
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_shuffle_epi8(v, lo_shuffle));
+			out += base64_compact_lut_.count[lo];
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_shuffle_epi8(_mm_srli_si128(v, 8), hi_shuffle));
+			out += base64_compact_lut_.count[hi];
+		}
+		in += 16;
+	}
+	return in - in_base;
+}
+
+std::size_t base64_decode_simd_(const char* in, std::size_t size, unsigned char* out, const base64_option& option) noexcept {
+	if (!option.std_prefix()) {
+		return 0;
+	}
+	const auto& features = current_cpu_features();
+	std::size_t n = 0;
+	if (features.avx2) {
+		n += base64_decode_avx2_(in, size, out, option);
+	}
+	if (features.sse41) {
+		n += base64_decode_sse41_(in + n, size - n, out + n / 4 * 3, option);
+	}
+	return n;
+}
+
+} // namespace
+
+#endif // ESL_ARCH_X86_ANY
+
 std::size_t base64_encode(const void* in, std::size_t size, char* out,
 		const base64_option& option) noexcept {
 	const unsigned char* in_b = static_cast<const unsigned char*>(in);
 	char* const out_base = out;
+#ifdef ESL_ARCH_X86_ANY
+	const std::size_t n = base64_encode_simd_(in_b, size, out, option);
+	in_b += n;
+	size -= n;
+	out += n / 3 * 4;
+#endif
 	while (size > 2) {
 		// [aaaaaabb][bbbbcccc][ccdddddd] -> [00aaaaaa][00bbbbbb][00cccccc][00dddddd]
 		*out++ = option.encode(in_b[0] >> 2);
@@ -35,16 +307,45 @@ std::size_t base64_encode(const void* in, std::size_t size, char* out,
 	return out - out_base;
 }
 
+namespace {
+
+constexpr bool base64_is_whitespace_(char c) noexcept {
+	return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// out: at least `size' size
+// return: output size
+std::size_t base64_strip_whitespace_(const char* in, std::size_t size, char* out) noexcept {
+	char* const out_base = out;
+#ifdef ESL_ARCH_X86_ANY
+	if (current_cpu_features().ssse3) {
+		const auto n = base64_strip_whitespace_ssse3_(in, size, out);
+		in += n;
+		size -= n;
+	}
+#endif
+	for (const char* const in_end = in + size; in != in_end; ++in) {
+		*out = *in;
+		out += !base64_is_whitespace_(*in);
+	}
+	return out - out_base;
+}
+
 #define ESL_BASE64_DECODE_ERROR_BREAK_() --in; break
 #define ESL_BASE64_DECODE_CHECK_AB_(x) if (x > 0x3F) { ESL_BASE64_DECODE_ERROR_BREAK_(); }
 #define ESL_BASE64_DECODE_CHECK_AB_B_(x) if (x & 0xF) { ++in; break; }
 #define ESL_BASE64_DECODE_CHECK_ABC_C_(x) if (x & 3) { ++in; break; }
-std::pair<std::size_t, std::size_t> base64_try_decode(const char* in, std::size_t size, void* out,
+std::pair<std::size_t, std::size_t> base64_try_decode_(const char* in, std::size_t size, void* out,
 		const base64_option& option) noexcept {
 	unsigned char* const out_b_base = static_cast<unsigned char*>(out);
 	unsigned char* out_b = out_b_base;
 	const char* const in_base = in;
 	const char* const in_end = in + size;
+#ifdef ESL_ARCH_X86_ANY
+	const std::size_t n = base64_decode_simd_(in, size, out_b, option);
+	in += n;
+	out_b += n / 4 * 3;
+#endif
 	while (in < in_end) {
 		// [00aaaaaa][00bbbbbb][00cccccc][00dddddd] -> [aaaaaabb][bbbbcccc][ccdddddd]
 		const auto a = option.decode(*in++);
@@ -98,5 +399,71 @@ std::pair<std::size_t, std::size_t> base64_try_decode(const char* in, std::size_
 #undef ESL_BASE64_DECODE_CHECK_AB_B_
 #undef ESL_BASE64_DECODE_CHECK_ABC_C_
 
+} // namespace
+
+std::pair<std::size_t, std::size_t> base64_try_decode(const char* in, std::size_t size, void* out,
+		const base64_option& option) noexcept {
+	if (option.skip_whitespace()) {
+		base64_pending_ pending{};
+		return base64_try_decode_ws_(in, size, 0, out, option, pending, true);
+	}
+	return base64_try_decode_(in, size, out, option);
+}
+
+// Compact a window of input after the pending characters, then decode the complete groups as usual
+std::pair<std::size_t, std::size_t> base64_try_decode_ws_(const char* in, std::size_t size, std::size_t base, void* out,
+		const base64_option& option, base64_pending_& pending, bool final) noexcept {
+	constexpr std::size_t window = 1024;
+	char buf[4 + window];
+	unsigned char* const out_base = static_cast<unsigned char*>(out);
+	unsigned char* out_b = out_base;
+	std::size_t pos = 0;
+	do {
+		const std::size_t w = std::min(window, size - pos);
+		const bool last = final && pos + w == size;
+		std::memcpy(buf, pending.chars, pending.size);
+		const std::size_t n = base64_strip_whitespace_(in + pos, w, buf + pending.size);
+		const std::size_t m = pending.size + n;
+		const std::size_t q = last ? m : (m & ~static_cast<std::size_t>(3));
+		const auto r = base64_try_decode_(buf, q, out_b, option);
+		out_b += r.first;
+		if (r.second != q) {
+			// Map the compacted position back to the input
+			std::size_t e = r.second;
+			if (e < pending.size) {
+				return {out_b - out_base, pending.positions[e]};
+			}
+			e -= pending.size;
+			if (e >= n) {
+				return {out_b - out_base, base + pos + w + (e - n)};
+			}
+			std::size_t i = pos;
+			for (;; ++i) {
+				if (!base64_is_whitespace_(in[i]) && e-- == 0) {
+					break;
+				}
+			}
+			return {out_b - out_base, base + i};
+		}
+		// Carry the incomplete group, from this window and (if it has too few) the previous pending
+		const std::size_t k = m - q;
+		std::size_t positions[4];
+		std::size_t j = k;
+		for (std::size_t i = pos + w; j != 0 && i != pos;) {
+			if (!base64_is_whitespace_(in[--i])) {
+				positions[--j] = base + i;
+			}
+		}
+		for (std::size_t i = pending.size; j != 0;) {
+			positions[--j] = pending.positions[--i];
+		}
+		std::memmove(pending.chars, buf + q, k);
+		std::memcpy(pending.positions, positions, k * sizeof(std::size_t));
+		pending.size = k;
+		pos += w;
+	} while (pos < size);
+	return {out_b - out_base, base + size};
+}
+
 } // namespace esl
 
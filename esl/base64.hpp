@@ -2,24 +2,84 @@
 #define ESL_BASE64_HPP
 
 #include "array.hpp"
+#include "executor.hpp"
+#include "span.hpp"
 #include "utility.hpp"
 
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
 namespace esl {
 
 // base64_alphabet_(std|urlsafe)
 inline constexpr const char* base64_alphabet_std = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 inline constexpr const char* base64_alphabet_urlsafe = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
 
+// Whether alphabet[0, 62) is "A-Za-z0-9", i.e. only the last two characters differ from base64_alphabet_std
+inline constexpr bool base64_is_std_prefix_(const char* alphabet) noexcept {
+    for (std::size_t i = 0; i < 62; ++i) {
+        if (alphabet[i] != base64_alphabet_std[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Nibble tables for vectorized decoding, [0, 16) indexed by the low nibble and [16, 32) by the high nibble:
+// c is in the alphabet iff (lut[c & 0xF] & lut[16 + (c >> 4)]) == 0
+// High nibbles with the same set of valid low nibbles share a bit, std_prefix alphabets need no more than 8
+inline constexpr std::array<unsigned char, 32> base64_make_nibble_lut_(const char* alphabet) noexcept {
+    std::uint16_t rows[16]{};
+    for (std::size_t i = 0; i < 64; ++i) {
+        const auto c = static_cast<unsigned char>(alphabet[i]);
+        rows[c >> 4] |= static_cast<std::uint16_t>(1U << (c & 0xF));
+    }
+    std::array<unsigned char, 32> lut{};
+    std::uint16_t classes[8]{};
+    std::size_t nclasses = 0;
+    for (std::size_t h = 0; h < 16; ++h) {
+        std::size_t k = 0;
+        while (k < nclasses && classes[k] != rows[h]) {
+            ++k;
+        }
+        if (k == 8) {
+            // Too many classes, reject everything
+            for (auto& b : lut) {
+                b = 0xFF;
+            }
+            return lut;
+        }
+        if (k == nclasses) {
+            classes[nclasses++] = rows[h];
+        }
+        lut[16 + h] = static_cast<unsigned char>(1U << k);
+        for (std::size_t l = 0; l < 16; ++l) {
+            if (!(rows[h] & (1U << l))) {
+                lut[l] |= static_cast<unsigned char>(1U << k);
+            }
+        }
+    }
+    return lut;
+}
+
 class base64_option {
 private:
     std::array<char, 64> alphabet_;
     char pad_;
     std::array<unsigned char, 256> alphabet_invert_;
+    bool std_prefix_;
+    std::array<unsigned char, 32> nibble_lut_;
+    bool skip_whitespace_;
 
 public:
-    constexpr base64_option(const char* alphabet, char pad = '=') noexcept
-        : alphabet_(make_sized_array<64>(alphabet)), pad_(pad), alphabet_invert_(invert_integer_array<unsigned char, 256, 64>(alphabet, {{pad, 64}})) {}
-    constexpr base64_option(const char* alphabet, bool padding) noexcept : base64_option(alphabet, padding ? '=' : '\0') {}
+    // skip_whitespace: Ignore " \t\n\v\f\r" anywhere when decoding, e.g. line-wrapped MIME or PEM
+    constexpr base64_option(const char* alphabet, char pad = '=', bool skip_whitespace = false) noexcept
+        : alphabet_(make_sized_array<64>(alphabet)), pad_(pad), alphabet_invert_(invert_integer_array<unsigned char, 256, 64>(alphabet, {{pad, 64}})),
+          std_prefix_(base64_is_std_prefix_(alphabet)), nibble_lut_(base64_make_nibble_lut_(alphabet)), skip_whitespace_(skip_whitespace) {}
+    constexpr base64_option(const char* alphabet, bool padding, bool skip_whitespace = false) noexcept
+        : base64_option(alphabet, padding ? '=' : '\0', skip_whitespace) {}
 
     // b [0, 64)
     constexpr char encode(unsigned char b) const noexcept {
@@ -38,12 +98,32 @@ public:
     constexpr unsigned char decode(char c) const noexcept {
         return alphabet_invert_[static_cast<unsigned char>(c)];
     }
+
+    // 64 characters, not null-terminated
+    constexpr const char* alphabet() const noexcept {
+        return alphabet_.data();
+    }
+
+    // Vectorized kernels other than AVX-512 VBMI compute "A-Za-z0-9" arithmetically
+    constexpr bool std_prefix() const noexcept {
+        return std_prefix_;
+    }
+
+    // See base64_make_nibble_lut_
+    constexpr const unsigned char* nibble_lut() const noexcept {
+        return nibble_lut_.data();
+    }
+
+    constexpr bool skip_whitespace() const noexcept {
+        return skip_whitespace_;
+    }
 };
 
 inline constexpr base64_option base64_std{base64_alphabet_std};
 inline constexpr base64_option base64_std_npad{base64_alphabet_std, false};
 inline constexpr base64_option base64_urlsafe{base64_alphabet_urlsafe};
 inline constexpr base64_option base64_urlsafe_npad{base64_alphabet_std, false};
+inline constexpr base64_option base64_mime{base64_alphabet_std, '=', true};
 
 // base64_encode_size
 // return: Exact encode size
@@ -105,6 +185,21 @@ public:
 // return: output size and input decoded size
 std::pair<std::size_t, std::size_t> base64_try_decode(const char* in, std::size_t size, void* out, const base64_option& option = base64_std) noexcept;
 
+// Significant characters (up to 3) of an incomplete group carried by base64_try_decode_ws_, and their absolute positions
+struct base64_pending_ {
+    char chars[4];
+    std::size_t positions[4];
+    std::size_t size;
+};
+
+// base64_try_decode_ws_
+// Decode with whitespace skipped, shared by base64_try_decode and base64_decoder
+// base: Absolute position of `in'
+// final: Decode the trailing incomplete group instead of leaving it in `pending'
+// return: output size and absolute position decoded to (`base + size' if succeeded)
+std::pair<std::size_t, std::size_t> base64_try_decode_ws_(const char* in, std::size_t size, std::size_t base, void* out, const base64_option& option,
+                                                          base64_pending_& pending, bool final) noexcept;
+
 // return string
 inline std::pair<std::string, std::size_t> base64_try_decode(const char* in, std::size_t size, const base64_option& option = base64_std) {
     std::string s;
@@ -129,17 +224,258 @@ inline std::string base64_decode(const char* in, std::size_t size, const base64_
     s.resize(base64_decode(in, size, s.data(), option));
     return s;
 }
+
+// Smallest input slice worth a job of its own in the parallel overloads
+inline constexpr std::size_t base64_parallel_min_slice = 256 * 1024;
+
+// base64_parallel_slice_size_
+// return: Slice size, a multiple of `group', for splitting `size' over the executor
+template <class Executor>
+inline std::size_t base64_parallel_slice_size_(const Executor& executor, std::size_t size, std::size_t group) {
+    const std::size_t n = std::max<std::size_t>(1, std::min<std::size_t>(executor.concurrency(), size / base64_parallel_min_slice));
+    return std::max<std::size_t>(group, ((size + n - 1) / n + group - 1) / group * group);
+}
+
+// base64_encode
+// Parallel, `in' is split on 3 bytes boundaries and each slice is written to its own offset of `out'
+// out: at least `base64_encode_size' size
+// return: encode size
+// Exceptions: Whatever the executor throws
+template <class Executor>
+inline std::size_t base64_encode(const void* in, std::size_t size, char* out, const base64_option& option, Executor&& executor) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(in);
+    const auto slice = base64_parallel_slice_size_(executor, size, 3);
+    if (slice >= size) {
+        return base64_encode(in, size, out, option);
+    }
+    executor.bulk((size + slice - 1) / slice, [=, &option](std::size_t i) {
+        const auto begin = i * slice;
+        base64_encode(bytes + begin, std::min(slice, size - begin), out + begin / 3 * 4, option);
+    });
+    return base64_encode_size(size, option.padding());
+}
+
+// base64_try_decode
+// Parallel, `in' is split on 4 characters boundaries and each slice is written to its own offset of `out',
+// the result is the same as the sequential one: the lowest failing position is reported.
+// Falls back to sequential decoding if whitespace is skipped.
+// out: at least `base64_decode_max_size' size, slices are written at their offsets before gaps left by padding are closed
+// return: output size and input decoded size
+// Exceptions: Whatever the executor throws
+template <class Executor>
+inline std::pair<std::size_t, std::size_t> base64_try_decode(const char* in, std::size_t size, void* out, const base64_option& option,
+                                                             Executor&& executor) {
+    unsigned char* out_b = static_cast<unsigned char*>(out);
+    const auto slice = base64_parallel_slice_size_(executor, size, 4);
+    if (slice >= size || option.skip_whitespace()) {
+        return base64_try_decode(in, size, out, option);
+    }
+    const std::size_t n = (size + slice - 1) / slice;
+    std::vector<std::pair<std::size_t, std::size_t>> results(n);
+    executor.bulk(n, [=, &option, &results](std::size_t i) {
+        const auto begin = i * slice;
+        results[i] = base64_try_decode(in + begin, std::min(slice, size - begin), out_b + begin / 4 * 3, option);
+    });
+    // Slices end on group boundaries, a slice may only come up short of output on a padded group, close the gap then
+    std::size_t out_size = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        const auto begin = i * slice;
+        const auto r = results[i];
+        if (out_size != begin / 4 * 3) {
+            std::memmove(out_b + out_size, out_b + begin / 4 * 3, r.first);
+        }
+        out_size += r.first;
+        if (r.second != std::min(slice, size - begin)) {
+            return {out_size, begin + r.second};
+        }
+    }
+    return {out_size, size};
+}
+
+// base64_decode
+// Parallel, see the parallel base64_try_decode
+// Exceptions: base64_decode_error, whatever the executor throws
+template <class Executor>
+inline std::size_t base64_decode(const char* in, std::size_t size, char* out, const base64_option& option, Executor&& executor) {
+    auto r = base64_try_decode(in, size, out, option, std::forward<Executor>(executor));
+    if (r.second != size) {
+        throw base64_decode_error(r.second);
+    }
+    return r.first;
+}
+
+// base64_encoder
+// Incremental encoding of a stream split at arbitrary points, 0-2 bytes are carried between updates
+class base64_encoder {
+private:
+    const base64_option* option_;
+    unsigned char pending_[3];
+    std::size_t pending_size_;
+
+public:
+    explicit base64_encoder(const base64_option& option = base64_std) noexcept : option_(&option), pending_(), pending_size_(0) {}
+
+    // return: Max output size of update
+    std::size_t update_size(std::size_t size) const noexcept {
+        return (pending_size_ + size) / 3 * 4;
+    }
+
+    // return: Max output size of finish
+    static constexpr std::size_t finish_size() noexcept {
+        return 4;
+    }
+
+    // out: at least `update_size(size)' size
+    // return: encode size
+    std::size_t update(const void* in, std::size_t size, char* out) noexcept;
+
+    template <class T, std::size_t N>
+    std::size_t update(span<T, N> in, char* out) noexcept {
+        static_assert(std::is_trivially_copyable_v<T>, "span element type should be trivially copyable");
+        return this->update(in.data(), in.size() * sizeof(T), out);
+    }
+
+    // Encode the pending bytes with padding if required, and reset for a new stream
+    // out: at least `finish_size()' size
+    // return: encode size
+    std::size_t finish(char* out) noexcept {
+        const auto n = base64_encode(pending_, pending_size_, out, *option_);
+        pending_size_ = 0;
+        return n;
+    }
+};
+
+inline std::size_t base64_encoder::update(const void* in, std::size_t size, char* out) noexcept {
+    const unsigned char* in_b = static_cast<const unsigned char*>(in);
+    char* const out_base = out;
+    if (pending_size_ != 0) {
+        const auto n = std::min(size, 3 - pending_size_);
+        std::memcpy(pending_ + pending_size_, in_b, n);
+        in_b += n;
+        size -= n;
+        if ((pending_size_ += n) < 3) {
+            return 0;
+        }
+        out += base64_encode(pending_, 3, out, *option_);
+    }
+    const auto whole = size - size % 3;
+    out += base64_encode(in_b, whole, out, *option_);
+    pending_size_ = size - whole;
+    std::memcpy(pending_, in_b + whole, pending_size_);
+    return out - out_base;
+}
+
+// base64_decoder
+// Incremental decoding of a stream split at arbitrary points, 0-3 characters are carried between updates
+// Exceptions: esl::base64_decode_error with the absolute stream position, the decoder should be reset after that
+class base64_decoder {
+private:
+    const base64_option* option_;
+    base64_pending_ pending_;
+    std::size_t position_;
+
+public:
+    explicit base64_decoder(const base64_option& option = base64_std) noexcept : option_(&option), pending_(), position_(0) {}
+
+    // return: Max output size of update
+    std::size_t update_size(std::size_t size) const noexcept {
+        return (pending_.size + size) / 4 * 3;
+    }
+
+    // return: Max output size of finish
+    static constexpr std::size_t finish_size() noexcept {
+        return 2;
+    }
+
+    // return: Input size decoded or pending so far
+    std::size_t position() const noexcept {
+        return position_;
+    }
+
+    // out: at least `update_size(size)' size
+    // return: decode size
+    std::size_t update(const char* in, std::size_t size, void* out);
+
+    std::size_t update(span<const char> in, void* out) {
+        return this->update(in.data(), in.size(), out);
+    }
+
+    // Decode the pending characters as the end of stream, and reset for a new stream
+    // out: at least `finish_size()' size
+    // return: decode size
+    std::size_t finish(void* out) {
+        std::pair<std::size_t, std::size_t> r;
+        if (option_->skip_whitespace()) {
+            r = base64_try_decode_ws_(nullptr, 0, position_, out, *option_, pending_, true);
+        } else {
+            r = base64_try_decode(pending_.chars, pending_.size, out, *option_);
+            r.second += position_ - pending_.size;
+        }
+        if (r.second != position_) {
+            throw base64_decode_error(r.second);
+        }
+        this->reset();
+        return r.first;
+    }
+
+    void reset() noexcept {
+        pending_.size = 0;
+        position_ = 0;
+    }
+};
+
+inline std::size_t base64_decoder::update(const char* in, std::size_t size, void* out) {
+    std::size_t base = position_;
+    position_ += size;
+    if (option_->skip_whitespace()) {
+        const auto r = base64_try_decode_ws_(in, size, base, out, *option_, pending_, false);
+        if (r.second != position_) {
+            throw base64_decode_error(r.second);
+        }
+        return r.first;
+    }
+    unsigned char* out_b = static_cast<unsigned char*>(out);
+    unsigned char* const out_base = out_b;
+    if (pending_.size != 0) {
+        const auto n = std::min(size, 4 - pending_.size);
+        std::memcpy(pending_.chars + pending_.size, in, n);
+        in += n;
+        size -= n;
+        if ((pending_.size += n) < 4) {
+            return 0;
+        }
+        const auto r = base64_try_decode(pending_.chars, 4, out_b, *option_);
+        if (r.second != 4) {
+            throw base64_decode_error(base + n - 4 + r.second);
+        }
+        out_b += r.first;
+        base += n;
+        pending_.size = 0;
+    }
+    const auto whole = size & ~static_cast<std::size_t>(3);
+    const auto r = base64_try_decode(in, whole, out_b, *option_);
+    if (r.second != whole) {
+        throw base64_decode_error(base + r.second);
+    }
+    out_b += r.first;
+    pending_.size = size - whole;
+    std::memcpy(pending_.chars, in + whole, pending_.size);
+    return out_b - out_base;
+}
+
 // ostream
 template <class CharT, class Traits>
 inline std::basic_ostream<CharT, Traits>& base64_decode(std::basic_ostream<CharT, Traits>& os, const char* in, std::size_t size,
                                                         const base64_option& option = base64_std) {
     constexpr std::size_t chunk_size = 4 * 128;
     char buf[base64_decode_max_size(chunk_size)];
+    base64_decoder decoder(option);
     const char* const in_end = in + size;
     for (; in < in_end; in += chunk_size) {
         const auto n = std::min(static_cast<std::size_t>(in_end - in), chunk_size);
-        os.write(buf, base64_decode(in, n, buf, option));
+        os.write(buf, decoder.update(in, n, buf));
     }
+    os.write(buf, decoder.finish(buf));
     return os;
 }
 
@@ -0,0 +1,553 @@
+#ifndef ESL_CBOR_HPP
+#define ESL_CBOR_HPP
+
+#include "codec_detail.hpp"
+#include "intrin.hpp"
+#include "json.hpp"
+#include "type_traits.hpp"
+#include "yaml.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace esl {
+
+// See RFC 8949 (CBOR) and RFC 8746 (typed arrays)
+namespace cbor {
+
+// decode_error
+// position: byte offset of the data item
+using decode_error = details::codec_decode_error;
+
+// encode_option
+// typed_arrays: arrays of numbers only as RFC 8746 typed arrays, little-endian float64 (or sint64 for integers),
+//               smaller and faster to decode, but not understood by every decoder
+struct encode_option {
+    bool typed_arrays = false;
+};
+
+// half_from_double_
+// return: whether d is exactly a half-precision float, NaNs are
+inline bool half_from_double_(double d, std::uint16_t& h) noexcept {
+    if (std::isnan(d)) {
+        h = 0x7E00;
+        return true;
+    }
+    const float f = static_cast<float>(d);
+    if (static_cast<double>(f) != d) {
+        return false;
+    }
+    std::uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    const auto sign = static_cast<std::uint16_t>((bits >> 16) & 0x8000);
+    const int exp = static_cast<int>((bits >> 23) & 0xFF) - 127;
+    const std::uint32_t mant = bits & 0x7FFFFF;
+    if ((bits & 0x7FFFFFFF) == 0 || exp == 128) {
+        h = static_cast<std::uint16_t>(sign | (exp == 128 ? 0x7C00 : 0));
+        return true;
+    }
+    if (exp > 15 || exp < -24) {
+        return false;
+    }
+    if (exp >= -14) {
+        h = static_cast<std::uint16_t>(sign | ((exp + 15) << 10) | (mant >> 13));
+        return (mant & 0x1FFF) == 0;
+    }
+    // Subnormal: multiples of 2^-24
+    const std::uint32_t full = 0x800000 | mant;
+    const auto shift = static_cast<unsigned>(-(exp + 1));
+    h = static_cast<std::uint16_t>(sign | (full >> shift));
+    return (full & ((std::uint32_t(1) << shift) - 1)) == 0;
+}
+
+// half_to_double_
+inline double half_to_double_(std::uint16_t h) noexcept {
+    const int exp = (h >> 10) & 0x1F;
+    const int mant = h & 0x3FF;
+    double d;
+    if (exp == 0) {
+        d = std::ldexp(mant, -24);
+    } else if (exp != 31) {
+        d = std::ldexp(mant + 1024, exp - 25);
+    } else {
+        d = mant == 0 ? std::numeric_limits<double>::infinity() : std::numeric_limits<double>::quiet_NaN();
+    }
+    return (h & 0x8000) != 0 ? -d : d;
+}
+
+// encoder_
+// Preferred serialization: shortest heads, floats in the shortest exact width
+template <class Sink>
+class encoder_ {
+private:
+    Sink& sink_;
+    const encode_option& option_;
+
+    void head(unsigned major, std::uint64_t arg) {
+        unsigned char buf[9];
+        const auto m = static_cast<unsigned char>(major << 5);
+        if (arg < 24) {
+            sink_.put(static_cast<unsigned char>(m | arg));
+        } else if (arg <= 0xFF) {
+            buf[0] = m | 24;
+            buf[1] = static_cast<unsigned char>(arg);
+            sink_.write(buf, 2);
+        } else if (arg <= 0xFFFF) {
+            buf[0] = m | 25;
+            store16be(static_cast<std::uint16_t>(arg), buf + 1);
+            sink_.write(buf, 3);
+        } else if (arg <= 0xFFFFFFFF) {
+            buf[0] = m | 26;
+            store32be(static_cast<std::uint32_t>(arg), buf + 1);
+            sink_.write(buf, 5);
+        } else {
+            buf[0] = m | 27;
+            store64be(arg, buf + 1);
+            sink_.write(buf, 9);
+        }
+    }
+
+    void integer(std::int64_t i) {
+        // -1 - i is ~i
+        this->head(i >= 0 ? 0 : 1, static_cast<std::uint64_t>(i >= 0 ? i : ~i));
+    }
+
+    void floating(double d) {
+        unsigned char buf[9];
+        std::uint16_t h;
+        const float f = static_cast<float>(d);
+        if (half_from_double_(d, h)) {
+            buf[0] = 0xF9;
+            store16be(h, buf + 1);
+            sink_.write(buf, 3);
+        } else if (static_cast<double>(f) == d) {
+            std::uint32_t bits;
+            std::memcpy(&bits, &f, sizeof(bits));
+            buf[0] = 0xFA;
+            store32be(bits, buf + 1);
+            sink_.write(buf, 5);
+        } else {
+            std::uint64_t bits;
+            std::memcpy(&bits, &d, sizeof(bits));
+            buf[0] = 0xFB;
+            store64be(bits, buf + 1);
+            sink_.write(buf, 9);
+        }
+    }
+
+    void string(std::string_view s) {
+        this->head(3, s.size());
+        sink_.write(s.data(), s.size());
+    }
+
+    // Tag and byte string head of a typed array, then the elements little-endian
+    template <class T, class Array>
+    bool typed_array(const Array& a, std::uint64_t tag) {
+        for (const auto& e : a) {
+            if (!std::holds_alternative<T>(e)) {
+                return false;
+            }
+        }
+        this->head(6, tag);
+        this->head(2, a.size() * 8);
+        for (const auto& e : a) {
+            std::uint64_t bits;
+            std::memcpy(&bits, &std::get<T>(e), sizeof(bits));
+            unsigned char buf[8];
+            store64le(bits, buf);
+            sink_.write(buf, 8);
+        }
+        return true;
+    }
+
+public:
+    encoder_(Sink& sink, const encode_option& option) noexcept : sink_(sink), option_(option) {}
+
+    template <class Value>
+    void value(const Value& v) {
+        esl::visit([this](const auto& x) { this->alternative(x); }, v);
+    }
+
+    template <class T>
+    void alternative(const T& x) {
+        if constexpr (std::is_same_v<T, std::monostate>) {
+            sink_.put(0xF6);
+        } else if constexpr (std::is_same_v<T, bool>) {
+            sink_.put(x ? 0xF5 : 0xF4);
+        } else if constexpr (std::is_same_v<T, std::int64_t>) {
+            this->integer(x);
+        } else if constexpr (std::is_same_v<T, std::uint64_t>) {
+            this->head(0, x);
+        } else if constexpr (std::is_same_v<T, double>) {
+            this->floating(x);
+        } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+            this->string(x);
+        } else if constexpr (has_member_type_mapped_type_v<T>) {
+            this->head(5, x.size());
+            for (const auto& [k, e] : x) {
+                this->string(k);
+                this->value(e);
+            }
+        } else {
+            if (option_.typed_arrays && !x.empty()) {
+                if (this->typed_array<double>(x, 86)) {
+                    return;
+                }
+                if (this->typed_array<std::int64_t>(x, 79)) {
+                    return;
+                }
+            }
+            this->head(4, x.size());
+            for (const auto& e : x) {
+                this->value(e);
+            }
+        }
+    }
+};
+
+// encoded_size
+// Value: json::value, json::pmr::value, json::value_view or yaml::node
+template <class Value>
+inline std::size_t encoded_size(const Value& v, const encode_option& option = {}) {
+    details::codec_size_sink sink;
+    encoder_<details::codec_size_sink>(sink, option).value(v);
+    return sink.size;
+}
+
+// encode
+// Integers are encoded as integers, doubles as floats in the shortest exact width
+// out: encoded_size(v, option) bytes
+// return: output size
+template <class Value>
+inline std::size_t encode(const Value& v, void* out, const encode_option& option = {}) {
+    details::codec_pointer_sink sink{static_cast<unsigned char*>(out)};
+    encoder_<details::codec_pointer_sink>(sink, option).value(v);
+    return static_cast<std::size_t>(sink.p - static_cast<unsigned char*>(out));
+}
+// return bytes
+template <class Value>
+inline std::vector<unsigned char> encode(const Value& v, const encode_option& option = {}) {
+    std::vector<unsigned char> out(encoded_size(v, option));
+    encode(v, out.data(), option);
+    return out;
+}
+
+// decoder_
+template <class Handler>
+class decoder_ : public details::codec_input {
+private:
+    Handler& handler_;
+    std::size_t depth_ = 0;
+    std::string scratch_;
+
+    std::uint64_t argument(unsigned info, const unsigned char* at) {
+        if (info < 24) {
+            return info;
+        }
+        if (info > 27) {
+            this->fail("invalid additional information", at);
+        }
+        const std::size_t n = std::size_t(1) << (info - 24);
+        this->need(n, at);
+        const unsigned char* p = p_;
+        p_ += n;
+        switch (n) {
+        case 1:
+            return *p;
+        case 2:
+            return load16be(p);
+        case 4:
+            return load32be(p);
+        default:
+            return load64be(p);
+        }
+    }
+
+    void unsigned_integer(std::uint64_t u) {
+        if (u <= static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max())) {
+            handler_.integer(static_cast<std::int64_t>(u));
+        } else {
+            json::unsigned_integer_event_(handler_, u);
+        }
+    }
+
+    void enter(const unsigned char* at) {
+        if (++depth_ > json::max_depth) {
+            this->fail("too deeply nested", at);
+        }
+    }
+
+    // Definite strings are viewed in the input, indefinite ones are joined in scratch_
+    std::string_view string(unsigned major, unsigned info, const unsigned char* at) {
+        if (info != 31) {
+            const std::uint64_t n = this->argument(info, at);
+            this->need(n, at);
+            const auto s = reinterpret_cast<const char*>(p_);
+            p_ += n;
+            return std::string_view(s, static_cast<std::size_t>(n));
+        }
+        scratch_.clear();
+        for (;;) {
+            const unsigned char* chunk = p_;
+            this->need(1, chunk);
+            const unsigned ib = *p_++;
+            if (ib == 0xFF) {
+                break;
+            }
+            if ((ib >> 5) != major || (ib & 31) == 31) {
+                this->fail("invalid string chunk", chunk);
+            }
+            const std::uint64_t n = this->argument(ib & 31, chunk);
+            this->need(n, chunk);
+            scratch_.append(reinterpret_cast<const char*>(p_), static_cast<std::size_t>(n));
+            p_ += n;
+        }
+        return scratch_;
+    }
+
+    // Count definite items, or up to the break
+    template <class F>
+    std::size_t items(unsigned info, const unsigned char* at, F item) {
+        if (info == 31) {
+            std::size_t n = 0;
+            for (;;) {
+                this->need(1, at);
+                if (*p_ == 0xFF) {
+                    ++p_;
+                    return n;
+                }
+                item();
+                ++n;
+            }
+        }
+        const std::uint64_t n = this->argument(info, at);
+        // Every item takes a byte at least
+        this->need(n, at);
+        for (std::uint64_t i = 0; i != n; ++i) {
+            item();
+        }
+        return static_cast<std::size_t>(n);
+    }
+
+    template <class Load>
+    void typed_elements(const unsigned char* p, std::size_t count, std::size_t size, Load load) {
+        for (std::size_t i = 0; i != count; ++i, p += size) {
+            load(p);
+        }
+    }
+
+    // RFC 8746 tags 64-87: 0b010_f_s_e_ll, float, signed, little-endian, log2 of the size (of 2 bytes for floats)
+    void typed_array(std::uint64_t tag, const unsigned char* at) {
+        const bool f = (tag & 16) != 0;
+        const bool s = (tag & 8) != 0;
+        const bool le = (tag & 4) != 0;
+        const unsigned ll = tag & 3;
+        if (tag == 76 || (f && ll == 3)) {
+            this->fail("unsupported typed array", at);
+        }
+        this->need(1, at);
+        const unsigned ib = *p_++;
+        if ((ib >> 5) != 2 || (ib & 31) == 31) {
+            this->fail("invalid typed array", at);
+        }
+        const std::uint64_t bytes = this->argument(ib & 31, at);
+        this->need(bytes, at);
+        const std::size_t size = f ? std::size_t(2) << ll : std::size_t(1) << ll;
+        if (bytes % size != 0) {
+            this->fail("invalid typed array", at);
+        }
+        const unsigned char* p = p_;
+        p_ += bytes;
+        const auto count = static_cast<std::size_t>(bytes / size);
+        const auto u16 = [le](const unsigned char* b) { return le ? load16le(b) : load16be(b); };
+        const auto u32 = [le](const unsigned char* b) { return le ? load32le(b) : load32be(b); };
+        const auto u64 = [le](const unsigned char* b) { return le ? load64le(b) : load64be(b); };
+        handler_.begin_array();
+        if (f) {
+            switch (ll) {
+            case 0:
+                this->typed_elements(p, count, 2, [&](const unsigned char* b) { handler_.number(half_to_double_(u16(b))); });
+                break;
+            case 1:
+                this->typed_elements(p, count, 4, [&](const unsigned char* b) {
+                    const std::uint32_t bits = u32(b);
+                    float x;
+                    std::memcpy(&x, &bits, sizeof(x));
+                    handler_.number(x);
+                });
+                break;
+            default:
+                this->typed_elements(p, count, 8, [&](const unsigned char* b) {
+                    const std::uint64_t bits = u64(b);
+                    double x;
+                    std::memcpy(&x, &bits, sizeof(x));
+                    handler_.number(x);
+                });
+                break;
+            }
+        } else if (s) {
+            switch (ll) {
+            case 0:
+                this->typed_elements(p, count, 1, [&](const unsigned char* b) { handler_.integer(static_cast<std::int8_t>(*b)); });
+                break;
+            case 1:
+                this->typed_elements(p, count, 2, [&](const unsigned char* b) { handler_.integer(static_cast<std::int16_t>(u16(b))); });
+                break;
+            case 2:
+                this->typed_elements(p, count, 4, [&](const unsigned char* b) { handler_.integer(static_cast<std::int32_t>(u32(b))); });
+                break;
+            default:
+                this->typed_elements(p, count, 8, [&](const unsigned char* b) { handler_.integer(static_cast<std::int64_t>(u64(b))); });
+                break;
+            }
+        } else {
+            switch (ll) {
+            case 0:
+                this->typed_elements(p, count, 1, [&](const unsigned char* b) { handler_.integer(*b); });
+                break;
+            case 1:
+                this->typed_elements(p, count, 2, [&](const unsigned char* b) { handler_.integer(u16(b)); });
+                break;
+            case 2:
+                this->typed_elements(p, count, 4, [&](const unsigned char* b) { handler_.integer(u32(b)); });
+                break;
+            default:
+                this->typed_elements(p, count, 8, [&](const unsigned char* b) { this->unsigned_integer(u64(b)); });
+                break;
+            }
+        }
+        handler_.end_array(count);
+    }
+
+public:
+    decoder_(const unsigned char* first, const unsigned char* last, Handler& handler) noexcept
+        : codec_input(first, last), handler_(handler) {}
+
+    void item() {
+        const unsigned char* at = p_;
+        this->need(1, at);
+        const unsigned ib = *p_++;
+        const unsigned major = ib >> 5;
+        const unsigned info = ib & 31;
+        switch (major) {
+        case 0:
+            this->unsigned_integer(this->argument(info, at));
+            break;
+        case 1: {
+            const std::uint64_t u = this->argument(info, at);
+            if (u <= static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max())) {
+                handler_.integer(-1 - static_cast<std::int64_t>(u));
+            } else {
+                handler_.number(-1.0 - static_cast<double>(u));
+            }
+            break;
+        }
+        case 2:
+        case 3:
+            handler_.string(this->string(major, info, at));
+            break;
+        case 4: {
+            this->enter(at);
+            handler_.begin_array();
+            handler_.end_array(this->items(info, at, [this] { this->item(); }));
+            --depth_;
+            break;
+        }
+        case 5: {
+            this->enter(at);
+            handler_.begin_object();
+            handler_.end_object(this->items(info, at, [this] {
+                const unsigned char* key = p_;
+                this->need(1, key);
+                const unsigned kb = *p_++;
+                if ((kb >> 5) != 2 && (kb >> 5) != 3) {
+                    this->fail("unsupported key", key);
+                }
+                handler_.key(this->string(kb >> 5, kb & 31, key));
+                this->item();
+            }));
+            --depth_;
+            break;
+        }
+        case 6: {
+            // Other tags are dropped, their content kept
+            const std::uint64_t tag = this->argument(info, at);
+            if (tag >= 64 && tag <= 87) {
+                this->typed_array(tag, at);
+            } else {
+                this->enter(at);
+                this->item();
+                --depth_;
+            }
+            break;
+        }
+        default:
+            switch (info) {
+            case 20:
+                handler_.boolean(false);
+                break;
+            case 21:
+                handler_.boolean(true);
+                break;
+            case 22:
+            case 23:
+                handler_.null();
+                break;
+            case 25:
+                handler_.number(half_to_double_(static_cast<std::uint16_t>(this->argument(info, at))));
+                break;
+            case 26: {
+                const auto bits = static_cast<std::uint32_t>(this->argument(info, at));
+                float x;
+                std::memcpy(&x, &bits, sizeof(x));
+                handler_.number(x);
+                break;
+            }
+            case 27: {
+                const std::uint64_t bits = this->argument(info, at);
+                double x;
+                std::memcpy(&x, &bits, sizeof(x));
+                handler_.number(x);
+                break;
+            }
+            case 31:
+                this->fail("unexpected break", at);
+            default:
+                this->fail("unsupported simple value", at);
+            }
+            break;
+        }
+    }
+};
+
+// decode
+// Events of the data item at `data' for a handler of json::reader (see structural_parser_), with integer(std::int64_t) too;
+// byte strings are delivered as strings, tags other than typed arrays are dropped, undefined is null,
+// unsigned integers above the int64 range are unsigned_integer(std::uint64_t) if the handler has it, else numbers
+// NOTE: Definite strings and keys are views of the input
+// return: size of the data item
+// Exceptions: esl::cbor::decode_error, and exceptions thrown by the handler
+template <class Handler>
+inline std::size_t decode(const void* data, std::size_t size, Handler& handler) {
+    return details::codec_decode<decoder_>(data, size, handler);
+}
+
+// decode
+// Value: json::value or yaml::node, from a whole input holding one data item
+// Exceptions: esl::cbor::decode_error
+template <class Value>
+inline Value decode(const void* data, std::size_t size) {
+    return details::codec_decode<decoder_, Value>(data, size);
+}
+
+} // namespace cbor
+
+} // namespace esl
+
+#endif // ESL_CBOR_HPP
@@ -0,0 +1,466 @@
+#ifndef ESL_CHARCONV_HPP
+#define ESL_CHARCONV_HPP
+
+#include "intrin.hpp"
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <system_error>
+#include <type_traits>
+
+// ESL_USE_STD_FLOAT_TO_CHARS
+// Defined if the standard library formats float and double with std::to_chars (__cpp_lib_to_chars), unless
+// ESL_NO_STD_FLOAT_TO_CHARS is defined; to_chars_float_ gives the same output without it
+#if defined(__cpp_lib_to_chars) && !defined(ESL_NO_STD_FLOAT_TO_CHARS)
+#    define ESL_USE_STD_FLOAT_TO_CHARS
+#endif
+
+namespace esl {
+
+// pow5_128_
+// See charconv.cpp
+extern const std::uint64_t pow5_128_[651 * 2];
+
+// is_digit_
+inline constexpr bool is_digit_(char c) noexcept {
+    return static_cast<unsigned char>(c - '0') < 10;
+}
+
+// is_eight_digits_
+// SWAR: every byte of the little-endian word is an ASCII digit
+inline constexpr bool is_eight_digits_(std::uint64_t v) noexcept {
+    return ((v & 0xF0F0F0F0F0F0F0F0U) | (((v + 0x0606060606060606U) & 0xF0F0F0F0F0F0F0F0U) >> 4)) == 0x3333333333333333U;
+}
+
+// eight_digits_value_
+// SWAR: the value of the 8 ASCII digits of a little-endian word, as pairs, then quads, then the whole
+inline constexpr std::uint32_t eight_digits_value_(std::uint64_t v) noexcept {
+    v -= 0x3030303030303030U;
+    v = v * 10 + (v >> 8);
+    v = (((v & 0x000000FF000000FFU) * 0x000F424000000064U) + (((v >> 16) & 0x000000FF000000FFU) * 0x0000271000000001U)) >> 32;
+    return static_cast<std::uint32_t>(v);
+}
+
+// scan_digits_
+// Accumulate the digits at p into `value', 8 at a time while they last, wrapping on overflow
+// return: past the digits
+inline const char* scan_digits_(const char* p, const char* last, std::uint64_t& value) noexcept {
+    while (last - p >= 8) {
+        const std::uint64_t v = load64le(reinterpret_cast<const unsigned char*>(p));
+        if (!is_eight_digits_(v)) {
+            break;
+        }
+        value = value * 100000000 + eight_digits_value_(v);
+        p += 8;
+    }
+    for (; p != last && is_digit_(*p); ++p) {
+        value = value * 10 + static_cast<unsigned char>(*p - '0');
+    }
+    return p;
+}
+
+// decimal_
+// A decimal number as mantissa * 10^exponent
+struct decimal_ {
+    std::uint64_t mantissa = 0; // the first 19 significant digits
+    std::int64_t exponent = 0;
+    const char* last = nullptr; // past the number, nullptr if there is none
+    bool negative = false;
+    bool integral = true;   // neither a fraction nor an exponent
+    bool truncated = false; // more than 19 significant digits
+};
+
+// decimal_max_digits_
+// Significant digits a 64-bit mantissa always holds
+inline constexpr std::size_t decimal_max_digits_ = 19;
+
+// scan_decimal_
+// [-]digits[.digits][(e|E)[+|-]digits]
+// Json: the JSON grammar, digits are required before and after '.' and after 'e' and leading zeros are invalid;
+//       otherwise that of std::from_chars (general format), a '.' needs digits on one side and an exponent without digits
+//       is not part of the number
+template <bool Json>
+inline decimal_ scan_decimal_(const char* first, const char* last) noexcept {
+    decimal_ d;
+    const char* p = first;
+    if (p != last && *p == '-') {
+        d.negative = true;
+        ++p;
+    }
+    const char* const int_first = p;
+    p = scan_digits_(p, last, d.mantissa);
+    const char* const int_last = p;
+    auto digits = static_cast<std::size_t>(int_last - int_first);
+    if constexpr (Json) {
+        if (digits == 0 || (*int_first == '0' && digits > 1)) {
+            return d;
+        }
+    }
+    const char* frac_first = p;
+    const char* frac_last = p;
+    if (p != last && *p == '.') {
+        frac_first = ++p;
+        p = scan_digits_(p, last, d.mantissa);
+        frac_last = p;
+        d.exponent = frac_first - frac_last;
+        d.integral = false;
+        digits += static_cast<std::size_t>(frac_last - frac_first);
+        if constexpr (Json) {
+            if (frac_first == frac_last) {
+                return d;
+            }
+        }
+    }
+    if (digits == 0) {
+        return d;
+    }
+    std::int64_t e = 0;
+    if (p != last && (*p == 'e' || *p == 'E')) {
+        const char* q = p + 1;
+        const bool negative_exponent = q != last && *q == '-';
+        if (q != last && (*q == '+' || *q == '-')) {
+            ++q;
+        }
+        if (q != last && is_digit_(*q)) {
+            for (; q != last && is_digit_(*q); ++q) {
+                e = e < 0x10000000 ? e * 10 + (*q - '0') : e;
+            }
+            e = negative_exponent ? -e : e;
+            d.exponent += e;
+            d.integral = false;
+            p = q;
+        } else if constexpr (Json) {
+            return d;
+        }
+    }
+    d.last = p;
+    if (digits > decimal_max_digits_) {
+        // Leading zeros are not significant
+        for (const char* z = int_first; z != frac_last && (*z == '0' || *z == '.'); ++z) {
+            digits -= *z == '0' ? 1 : 0;
+        }
+        if (digits > decimal_max_digits_) {
+            // Again without overflow, up to 19 digits
+            constexpr std::uint64_t min_19_digits = 1000000000000000000U;
+            d.truncated = true;
+            d.mantissa = 0;
+            const char* q = int_first;
+            for (; d.mantissa < min_19_digits && q != int_last; ++q) {
+                d.mantissa = d.mantissa * 10 + static_cast<unsigned char>(*q - '0');
+            }
+            if (d.mantissa >= min_19_digits) {
+                d.exponent = (int_last - q) + e;
+            } else {
+                for (q = frac_first; d.mantissa < min_19_digits && q != frac_last; ++q) {
+                    d.mantissa = d.mantissa * 10 + static_cast<unsigned char>(*q - '0');
+                }
+                d.exponent = (frac_first - q) + e;
+            }
+        }
+    }
+    return d;
+}
+
+// binary_format_
+template <class T>
+struct binary_format_;
+template <>
+struct binary_format_<double> {
+    using bits_type = std::uint64_t;
+    static constexpr int mantissa_bits = 52;
+    static constexpr int min_exponent = -1023;
+    static constexpr int infinite_power = 0x7FF;
+    static constexpr int min_round_to_even = -4;
+    static constexpr int max_round_to_even = 23;
+    static constexpr int smallest_power_of_ten = -342;
+    static constexpr int largest_power_of_ten = 308;
+    static constexpr int max_fast_exponent = 22;
+    static constexpr double fast_powers[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                             1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+};
+template <>
+struct binary_format_<float> {
+    using bits_type = std::uint32_t;
+    static constexpr int mantissa_bits = 23;
+    static constexpr int min_exponent = -127;
+    static constexpr int infinite_power = 0xFF;
+    static constexpr int min_round_to_even = -17;
+    static constexpr int max_round_to_even = 10;
+    static constexpr int smallest_power_of_ten = -65;
+    static constexpr int largest_power_of_ten = 38;
+    static constexpr int max_fast_exponent = 10;
+    static constexpr float fast_powers[] = {1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+};
+
+// eisel_lemire_
+// Eisel-Lemire (Lemire: Number Parsing at a Gigabyte per Second): w * 10^q rounded to nearest even from a 128-bit
+// truncated product with 5^q, exact for every w without the fallback of the paper (Mushtak, Lemire: Fast Number Parsing
+// Without Fallback)
+// out: mantissa and biased exponent of T
+template <class T>
+inline void eisel_lemire_(std::int64_t q, std::uint64_t w, std::uint64_t& mantissa, int& power2) noexcept {
+    using format = binary_format_<T>;
+    if (w == 0 || q < format::smallest_power_of_ten) {
+        mantissa = 0;
+        power2 = 0;
+        return;
+    }
+    if (q > format::largest_power_of_ten) {
+        mantissa = 0;
+        power2 = format::infinite_power;
+        return;
+    }
+    const int lz = static_cast<int>(clz(w));
+    w <<= lz;
+    const auto index = static_cast<std::size_t>(2 * (q - binary_format_<double>::smallest_power_of_ten));
+    std::uint64_t lo;
+    std::uint64_t hi = mul128(w, pow5_128_[index], lo);
+    // Bits below the mantissa and the rounding bits all set, the low half of 5^q may carry into them
+    constexpr std::uint64_t precision_mask = ~std::uint64_t(0) >> (format::mantissa_bits + 3);
+    if ((hi & precision_mask) == precision_mask) {
+        std::uint64_t lo2;
+        const std::uint64_t hi2 = mul128(w, pow5_128_[index + 1], lo2);
+        lo += hi2;
+        hi += hi2 > lo ? 1 : 0;
+    }
+    const int upperbit = static_cast<int>(hi >> 63);
+    const int shift = upperbit + 64 - format::mantissa_bits - 3;
+    mantissa = hi >> shift;
+    // floor(q * log2(10)) + 63
+    power2 = static_cast<int>((((152170 + 65536) * q) >> 16) + 63) + upperbit - lz - format::min_exponent;
+    if (power2 <= 0) {
+        // Subnormal
+        if (-power2 + 1 >= 64) {
+            mantissa = 0;
+            power2 = 0;
+            return;
+        }
+        mantissa >>= -power2 + 1;
+        mantissa += mantissa & 1;
+        mantissa >>= 1;
+        power2 = mantissa < (std::uint64_t(1) << format::mantissa_bits) ? 0 : 1;
+        return;
+    }
+    // Exactly halfway, only possible for small q: round to even
+    if (lo <= 1 && q >= format::min_round_to_even && q <= format::max_round_to_even && (mantissa & 3) == 1 && (mantissa << shift) == hi) {
+        mantissa &= ~std::uint64_t(1);
+    }
+    mantissa += mantissa & 1;
+    mantissa >>= 1;
+    if (mantissa >= (std::uint64_t(2) << format::mantissa_bits)) {
+        mantissa = std::uint64_t(1) << format::mantissa_bits;
+        ++power2;
+    }
+    mantissa &= ~(std::uint64_t(1) << format::mantissa_bits);
+    if (power2 >= format::infinite_power) {
+        mantissa = 0;
+        power2 = format::infinite_power;
+    }
+}
+
+// compare_halfway_
+// See charconv.cpp
+// All the significant digits of the number d scanned from `first', against the halfway point above the binary
+// m * 2^power2, (2m + 1) * 2^(power2 - 1), exactly: with big integers, of the first 768 digits and whether any later
+// one is nonzero
+// return: negative, zero or positive as the number is below, at or above the halfway point
+int compare_halfway_(const decimal_& d, const char* first, std::uint64_t m, int power2) noexcept;
+
+// decimal_to_float_
+// Clinger's fast path when the mantissa and the power of ten are both exact in T, Eisel-Lemire otherwise, and
+// compare_halfway_ if the digits after the 19th may change the rounding
+// first: where d was scanned from
+template <class T>
+inline T decimal_to_float_(const decimal_& d, const char* first) noexcept {
+    using format = binary_format_<T>;
+    if (!d.truncated && d.exponent >= -format::max_fast_exponent && d.exponent <= format::max_fast_exponent &&
+        d.mantissa <= (std::uint64_t(1) << (format::mantissa_bits + 1))) {
+        T value = static_cast<T>(d.mantissa);
+        value = d.exponent < 0 ? value / format::fast_powers[-d.exponent] : value * format::fast_powers[d.exponent];
+        return d.negative ? -value : value;
+    }
+    std::uint64_t mantissa;
+    int power2;
+    eisel_lemire_<T>(d.exponent, d.mantissa, mantissa, power2);
+    if (d.truncated && power2 != format::infinite_power) {
+        // The digits are between mantissa and mantissa + 1
+        std::uint64_t mantissa_up;
+        int power2_up;
+        eisel_lemire_<T>(d.exponent, d.mantissa + 1, mantissa_up, power2_up);
+        if (mantissa != mantissa_up || power2 != power2_up) {
+            // Adjacent floats, the halfway point between them decides, a tie rounds to even
+            const std::uint64_t m = power2 == 0 ? mantissa : mantissa | (std::uint64_t(1) << format::mantissa_bits);
+            const int c = compare_halfway_(d, first, m, (power2 == 0 ? 1 : power2) + format::min_exponent - format::mantissa_bits);
+            if (c > 0 || (c == 0 && (m & 1) != 0)) {
+                mantissa = mantissa_up;
+                power2 = power2_up;
+            }
+        }
+    }
+    const auto bits = static_cast<typename format::bits_type>(
+        mantissa | (static_cast<std::uint64_t>(power2) << format::mantissa_bits) |
+        (static_cast<std::uint64_t>(d.negative ? 1 : 0) << (sizeof(T) * 8 - 1)));
+    T value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// from_chars_inf_nan_
+// inf, infinity, nan or nan(n-char-sequence) of std::from_chars, ignoring case, after an optional '-'
+template <class T>
+inline std::from_chars_result from_chars_inf_nan_(const char* first, const char* last, T& value) noexcept {
+    const bool negative = first != last && *first == '-';
+    const char* p = first + (negative ? 1 : 0);
+    // word: lowercase
+    const auto starts_with = [&p, last](const char* word) {
+        const std::size_t n = std::strlen(word);
+        if (static_cast<std::size_t>(last - p) < n) {
+            return false;
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            if ((p[i] | 0x20) != word[i]) {
+                return false;
+            }
+        }
+        return true;
+    };
+    if (starts_with("inf")) {
+        p += starts_with("infinity") ? 8 : 3;
+        value = negative ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::infinity();
+        return {p, std::errc{}};
+    }
+    if (starts_with("nan")) {
+        p += 3;
+        if (p != last && *p == '(') {
+            const char* q = p + 1;
+            while (q != last && (is_digit_(*q) || static_cast<unsigned char>((*q | 0x20) - 'a') < 26 || *q == '_')) {
+                ++q;
+            }
+            if (q != last && *q == ')') {
+                p = q + 1;
+            }
+        }
+        value = negative ? -std::numeric_limits<T>::quiet_NaN() : std::numeric_limits<T>::quiet_NaN();
+        return {p, std::errc{}};
+    }
+    return {first, std::errc::invalid_argument};
+}
+
+// from_chars_float_
+// std::from_chars of the general format: digits 8 at a time, then decimal_to_float_, exact on every input
+// Exceptions: result_out_of_range if the number overflows or underflows to zero
+template <class T>
+inline std::from_chars_result from_chars_float_(const decimal_& d, const char* first, T& value) noexcept {
+    const T x = decimal_to_float_<T>(d, first);
+    if (std::isinf(x) || (x == 0 && d.mantissa != 0)) {
+        return {d.last, std::errc::result_out_of_range};
+    }
+    value = x;
+    return {d.last, std::errc{}};
+}
+template <class T>
+inline std::from_chars_result from_chars_float_(const char* first, const char* last, T& value) noexcept {
+    const auto d = scan_decimal_<false>(first, last);
+    if (d.last == nullptr) {
+        return from_chars_inf_nan_(first, last, value);
+    }
+    return from_chars_float_(d, first, value);
+}
+
+// to_chars_float_
+// std::to_chars of T (float or double) without a format: the shortest digits that parse back to the value, in fixed
+// notation if that is not longer than the scientific one, "inf" or "nan" with a '-' if negative
+// Without ESL_USE_STD_FLOAT_TO_CHARS: the correctly rounded digits of snprintf at increasing precisions, checked with
+// decimal_to_float_, and the exact integer of "%.0f" for fixed notation without a fraction
+// return: std::errc::value_too_large if [first, last) is too small
+template <class T>
+inline std::to_chars_result to_chars_float_(char* first, char* last, T value) noexcept {
+#ifdef ESL_USE_STD_FLOAT_TO_CHARS
+    return std::to_chars(first, last, value);
+#else
+    char buf[64];
+    std::size_t n = 0;
+    if (std::signbit(value)) {
+        buf[n++] = '-';
+    }
+    const double x = std::fabs(static_cast<double>(value));
+    if (!std::isfinite(x) || x == 0) {
+        const char* const s = std::isinf(x) ? "inf" : std::isnan(x) ? "nan" : "0";
+        std::memcpy(buf + n, s, std::strlen(s));
+        n += std::strlen(s);
+    } else {
+        // d[.ddd]e(+|-)dd, only the digits are taken as the decimal point is that of the locale
+        char digits[32];
+        int count = 0;
+        int exponent = 0;
+        // Decimals of digits10 digits survive a round trip through normal numbers, so shorter ones print as such
+        const int min_precision = x < static_cast<double>(std::numeric_limits<T>::min()) ? 1 : std::numeric_limits<T>::digits10;
+        for (int precision = min_precision;; ++precision) {
+            char sci[48];
+            std::snprintf(sci, sizeof(sci), "%.*e", precision - 1, x);
+            const char* p = sci;
+            count = 0;
+            for (; *p != 'e'; ++p) {
+                if (is_digit_(*p)) {
+                    digits[count++] = *p;
+                }
+            }
+            exponent = std::atoi(p + 1);
+            decimal_ d;
+            for (int i = 0; i < count; ++i) {
+                d.mantissa = d.mantissa * 10 + static_cast<unsigned char>(digits[i] - '0');
+            }
+            d.exponent = exponent - (count - 1);
+            if (precision == std::numeric_limits<T>::max_digits10 || decimal_to_float_<T>(d, nullptr) == static_cast<T>(x)) {
+                break;
+            }
+        }
+        while (count > 1 && digits[count - 1] == '0') {
+            --count;
+        }
+        const int exponent_digits = exponent <= -100 || exponent >= 100 ? 3 : 2;
+        const int scientific_size = count + (count > 1 ? 1 : 0) + 2 + exponent_digits;
+        const int fixed_size = exponent < 0 ? count + 1 - exponent : exponent + 1 >= count ? exponent + 1 : count + 1;
+        if (fixed_size > scientific_size) {
+            buf[n++] = digits[0];
+            if (count > 1) {
+                buf[n++] = '.';
+                std::memcpy(buf + n, digits + 1, static_cast<std::size_t>(count - 1));
+                n += static_cast<std::size_t>(count - 1);
+            }
+            n += static_cast<std::size_t>(std::snprintf(buf + n, sizeof(buf) - n, "e%c%0*d", exponent < 0 ? '-' : '+', exponent_digits,
+                                                        exponent < 0 ? -exponent : exponent));
+        } else if (exponent + 1 >= count) {
+            // An integer, all its digits
+            n += static_cast<std::size_t>(std::snprintf(buf + n, sizeof(buf) - n, "%.0f", x));
+        } else if (exponent >= 0) {
+            std::memcpy(buf + n, digits, static_cast<std::size_t>(exponent + 1));
+            n += static_cast<std::size_t>(exponent + 1);
+            buf[n++] = '.';
+            std::memcpy(buf + n, digits + exponent + 1, static_cast<std::size_t>(count - exponent - 1));
+            n += static_cast<std::size_t>(count - exponent - 1);
+        } else {
+            buf[n++] = '0';
+            buf[n++] = '.';
+            std::memset(buf + n, '0', static_cast<std::size_t>(-exponent - 1));
+            n += static_cast<std::size_t>(-exponent - 1);
+            std::memcpy(buf + n, digits, static_cast<std::size_t>(count));
+            n += static_cast<std::size_t>(count);
+        }
+    }
+    if (static_cast<std::size_t>(last - first) < n) {
+        return {last, std::errc::value_too_large};
+    }
+    std::memcpy(first, buf, n);
+    return {first + n, std::errc{}};
+#endif
+}
+
+} // namespace esl
+
+#endif // ESL_CHARCONV_HPP
@@ -0,0 +1,127 @@
+#ifndef ESL_CODEC_DETAIL_HPP
+#define ESL_CODEC_DETAIL_HPP
+
+#include "json.hpp"
+#include "yaml.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <variant>
+
+// Shared by the binary codecs, cbor.hpp and msgpack.hpp
+
+namespace esl {
+
+namespace json {
+
+// value_layout_ of yaml::node, built by the decoders
+// Integers above the int64 range are floats
+template <>
+struct value_layout_<yaml::node> {
+    static constexpr std::size_t boolean = yaml::bool_index;
+    static constexpr std::size_t number = yaml::float_index;
+    static constexpr std::size_t string = yaml::str_index;
+    static constexpr std::size_t array = yaml::seq_index;
+    static constexpr std::size_t object = yaml::map_index;
+    static constexpr std::size_t integer = yaml::int_index;
+    static constexpr std::size_t unsigned_integer = std::variant_npos;
+};
+
+} // namespace json
+
+namespace details {
+
+// codec_decode_error
+// position: byte offset of the item
+class codec_decode_error : public std::runtime_error {
+private:
+    std::size_t position_;
+
+public:
+    codec_decode_error(const char* msg, std::size_t position) : runtime_error(msg), position_(position) {}
+
+    std::size_t position() const noexcept {
+        return position_;
+    }
+};
+
+// codec_size_sink
+struct codec_size_sink {
+    std::size_t size = 0;
+
+    void put(unsigned char) noexcept {
+        ++size;
+    }
+    void write(const void*, std::size_t n) noexcept {
+        size += n;
+    }
+};
+
+// codec_pointer_sink
+// Writes unchecked, the size is computed first
+struct codec_pointer_sink {
+    unsigned char* p;
+
+    void put(unsigned char c) noexcept {
+        *p++ = c;
+    }
+    void write(const void* data, std::size_t n) noexcept {
+        std::memcpy(p, data, n);
+        p += n;
+    }
+};
+
+// codec_input
+// Input of the decoders, bounds checked by need
+class codec_input {
+protected:
+    const unsigned char* first_;
+    const unsigned char* p_;
+    const unsigned char* last_;
+
+    codec_input(const unsigned char* first, const unsigned char* last) noexcept : first_(first), p_(first), last_(last) {}
+
+    [[noreturn]] void fail(const char* msg, const unsigned char* at) const {
+        throw codec_decode_error(msg, static_cast<std::size_t>(at - first_));
+    }
+
+    void need(std::uint64_t n, const unsigned char* at) const {
+        if (static_cast<std::uint64_t>(last_ - p_) < n) {
+            this->fail("unexpected end of input", at);
+        }
+    }
+
+public:
+    const unsigned char* position() const noexcept {
+        return p_;
+    }
+};
+
+// codec_decode
+// Decoder: decoder_ of a codec, a codec_input with item()
+// return: size of the item
+template <template <class> class Decoder, class Handler>
+inline std::size_t codec_decode(const void* data, std::size_t size, Handler& handler) {
+    const auto first = static_cast<const unsigned char*>(data);
+    Decoder<Handler> decoder(first, first + size, handler);
+    decoder.item();
+    return static_cast<std::size_t>(decoder.position() - first);
+}
+
+// Value built by json::value_builder_ from a whole input holding one item
+template <template <class> class Decoder, class Value>
+inline Value codec_decode(const void* data, std::size_t size) {
+    json::value_builder_<Value> builder;
+    const std::size_t n = codec_decode<Decoder>(data, size, builder);
+    if (n != size) {
+        throw codec_decode_error("trailing bytes", n);
+    }
+    return builder.take();
+}
+
+} // namespace details
+
+} // namespace esl
+
+#endif // ESL_CODEC_DETAIL_HPP
@@ -0,0 +1,85 @@
+#ifndef ESL_EXECUTOR_HPP
+#define ESL_EXECUTOR_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace esl {
+
+// Executor
+// The parallel overloads in ESL accept any executor providing:
+//   std::size_t concurrency() const                 -- number of jobs worth running at once
+//   template <class F> void bulk(std::size_t n, F f) -- invoke f(i) for i in [0, n), return when all are done
+// bulk must rethrow an exception thrown by f after all jobs are done, so a thread pool can be adapted easily
+
+// thread_executor
+// Run bulk jobs on up to `concurrency' threads, the calling thread included
+class thread_executor {
+private:
+    std::size_t concurrency_;
+
+public:
+    // concurrency: 0 for std::thread::hardware_concurrency()
+    explicit thread_executor(std::size_t concurrency = 0) noexcept : concurrency_(concurrency) {
+        if (concurrency_ == 0) {
+            concurrency_ = std::thread::hardware_concurrency();
+        }
+        if (concurrency_ == 0) {
+            concurrency_ = 1;
+        }
+    }
+
+    std::size_t concurrency() const noexcept {
+        return concurrency_;
+    }
+
+    // Exceptions: The first exception thrown by f
+    template <class F>
+    void bulk(std::size_t n, F f) const {
+        std::atomic<std::size_t> next{0};
+        std::exception_ptr eptr;
+        std::mutex mutex;
+        auto work = [&]() {
+            for (std::size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < n;) {
+                try {
+                    f(i);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (!eptr) {
+                        eptr = std::current_exception();
+                    }
+                }
+            }
+        };
+        std::vector<std::thread> threads;
+        const auto nthreads = std::min(concurrency_, n);
+        if (nthreads > 1) {
+            threads.reserve(nthreads - 1);
+            for (std::size_t i = 1; i < nthreads; ++i) {
+                try {
+                    threads.emplace_back(work);
+                } catch (const std::system_error&) {
+                    // Out of threads, the remaining jobs are picked up by the running ones
+                    break;
+                }
+            }
+        }
+        work();
+        for (auto& t : threads) {
+            t.join();
+        }
+        if (eptr) {
+            std::rethrow_exception(eptr);
+        }
+    }
+};
+
+} // namespace esl
+
+#endif //ESL_EXECUTOR_HPP
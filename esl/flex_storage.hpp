@@ -1,10 +1,36 @@
 #ifndef ESL_FLEX_STORAGE_HPP
 #define ESL_FLEX_STORAGE_HPP
 
+#include "memory.hpp"
 #include "type_traits.hpp"
 
 namespace esl {
 
+// flex_new_delete
+// Out-of-line allocation of flex_storage with new and delete
+// Allocator-extended moves keep the object only if the allocators are always equal
+struct flex_new_delete {
+    template <class T, class... Args>
+    static T* create(Args&&... args) {
+        return new T(std::forward<Args>(args)...);
+    }
+
+    template <class T, class Alloc, class... Args>
+    static T* create_using_allocator(const Alloc& alloc, Args&&... args) {
+        return new_using_allocator<T>(alloc, std::forward<Args>(args)...);
+    }
+
+    template <class T, class Alloc>
+    static bool adoptable(const T*, const Alloc&) noexcept {
+        return std::allocator_traits<Alloc>::is_always_equal::value;
+    }
+
+    template <class T>
+    static void destroy(T* p) noexcept {
+        delete p;
+    }
+};
+
 // flex_storage
 // Use for any_* contianer
 // Typically no direct use due to it does know which type inside
@@ -15,8 +41,11 @@ namespace esl {
 // * construct(move): this (unconstructed), other (constructed) -> this (constructed), other (unconstructed)
 // * destruct: this (constructed) -> this (unconstructed)
 // * swap: this (constructed), other (constructed) -> this (constructed), other (constructed)
+// * Allocator-extended construct: T is constructed with the allocator if it uses one
+// * OutOfLine: allocation of the objects not fitting in place, see flex_new_delete and flex_memory_resource (flex_variant_pmr.hpp)
+//   Out-of-line moves keep the object, allocator-extended moves reconstruct it unless OutOfLine::adoptable
 
-template <std::size_t MaxSize = 4 * sizeof(void*), std::size_t MaxAlign = alignof(void*)>
+template <std::size_t MaxSize = 4 * sizeof(void*), std::size_t MaxAlign = alignof(void*), class OutOfLine = flex_new_delete>
 class flex_storage {
 private:
     union Storage {
@@ -53,6 +82,24 @@ public:
             return val;
         }
 
+        template <class Alloc, class... Args>
+        static T& construct(Storage& s, std::allocator_arg_t, const Alloc& alloc, std::in_place_t, Args&&... args) {
+            return *uninitialized_construct_using_allocator(reinterpret_cast<T*>(&s), alloc, std::forward<Args>(args)...);
+        }
+
+        template <class Alloc>
+        static T& construct(Storage& s, std::allocator_arg_t, const Alloc& alloc, const Storage& other) {
+            return construct(s, std::allocator_arg, alloc, std::in_place, reinterpret_cast<std::add_const_t<T>&>(other));
+        }
+
+        template <class Alloc>
+        static T& construct(Storage& s, std::allocator_arg_t, const Alloc& alloc, Storage&& other) {
+            T& oval = reinterpret_cast<T&>(other);
+            auto& val = construct(s, std::allocator_arg, alloc, std::in_place, std::move(oval));
+            oval.~T();
+            return val;
+        }
+
         // destruct
         static void destruct(Storage& s) noexcept {
             reinterpret_cast<T*>(&s)->~T();
@@ -84,25 +131,45 @@ public:
         // construct
         template <class... Args>
         static T& construct(Storage& s, std::in_place_t, Args&&... args) {
-            T* val = new T(std::forward<Args>(args)...);
+            T* val = OutOfLine::template create<T>(std::forward<Args>(args)...);
             s.ptr = val;
             return *val;
         }
 
         // construct
         static T& construct(Storage& s, const Storage& other) {
-            T* val = new T(*static_cast<std::add_const_t<T>*>(other.ptr));
-            s.ptr = val;
-            return *val;
+            return construct(s, std::in_place, *static_cast<std::add_const_t<T>*>(other.ptr));
         }
         static T& construct(Storage& s, Storage&& other) noexcept {
             s.ptr = other.ptr;
             return *static_cast<T*>(s.ptr);
         }
 
+        template <class Alloc, class... Args>
+        static T& construct(Storage& s, std::allocator_arg_t, const Alloc& alloc, std::in_place_t, Args&&... args) {
+            T* val = OutOfLine::template create_using_allocator<T>(alloc, std::forward<Args>(args)...);
+            s.ptr = val;
+            return *val;
+        }
+
+        template <class Alloc>
+        static T& construct(Storage& s, std::allocator_arg_t, const Alloc& alloc, const Storage& other) {
+            return construct(s, std::allocator_arg, alloc, std::in_place, *static_cast<std::add_const_t<T>*>(other.ptr));
+        }
+
+        template <class Alloc>
+        static T& construct(Storage& s, std::allocator_arg_t, const Alloc& alloc, Storage&& other) {
+            if (OutOfLine::adoptable(static_cast<const T*>(other.ptr), alloc)) {
+                return construct(s, std::move(other));
+            }
+            auto& val = construct(s, std::allocator_arg, alloc, std::in_place, std::move(*static_cast<T*>(other.ptr)));
+            destruct(other);
+            return val;
+        }
+
         // destruct
         static void destruct(Storage& s) noexcept {
-            delete static_cast<T*>(s.ptr);
+            OutOfLine::destroy(static_cast<T*>(s.ptr));
         }
 
         // swap
@@ -161,6 +228,11 @@ public:
         this->construct<T>(std::in_place, il, std::forward<Args>(args)...);
     }
 
+    template <class Alloc, class T, class... Args>
+    explicit flex_storage(std::allocator_arg_t, const Alloc& alloc, std::in_place_type_t<T>, Args&&... args) {
+        this->construct<T>(std::allocator_arg, alloc, std::in_place, std::forward<Args>(args)...);
+    }
+
     // construct
 
     template <class T, class... Args>
@@ -183,6 +255,21 @@ public:
         return Manager<std::decay_t<T>>::construct(storage_, std::move(other.storage_));
     }
 
+    template <class T, class Alloc, class... Args>
+    std::decay_t<T>& construct(std::allocator_arg_t, const Alloc& alloc, std::in_place_t, Args&&... args) {
+        return Manager<std::decay_t<T>>::construct(storage_, std::allocator_arg, alloc, std::in_place, std::forward<Args>(args)...);
+    }
+
+    template <class T, class Alloc>
+    std::decay_t<T>& construct(std::allocator_arg_t, const Alloc& alloc, const flex_storage& other) {
+        return Manager<std::decay_t<T>>::construct(storage_, std::allocator_arg, alloc, other.storage_);
+    }
+
+    template <class T, class Alloc>
+    std::decay_t<T>& construct(std::allocator_arg_t, const Alloc& alloc, flex_storage&& other) {
+        return Manager<std::decay_t<T>>::construct(storage_, std::allocator_arg, alloc, std::move(other.storage_));
+    }
+
     // destruct
 
     template <class T>
@@ -232,6 +319,24 @@ public:
             to.template construct<T>(std::move(other));
         }
     };
+    template <class Alloc>
+    struct allocator_copy_construct {
+        template <class T>
+        struct function {
+            static void value(flex_storage& to, const Alloc& alloc, const flex_storage& other) {
+                to.template construct<T>(std::allocator_arg, alloc, other);
+            }
+        };
+    };
+    template <class Alloc>
+    struct allocator_move_construct {
+        template <class T>
+        struct function {
+            static void value(flex_storage& to, const Alloc& alloc, flex_storage&& other) {
+                to.template construct<T>(std::allocator_arg, alloc, std::move(other));
+            }
+        };
+    };
     template <class T>
     struct destruct_function {
         static void value(flex_storage& s) {
@@ -18,20 +18,25 @@
 
 namespace esl {
 
+// basic_flex_variant
+// Storage: flex_storage, the out-of-line allocation of which is chosen by its OutOfLine
+template <class Storage, class... Ts>
+class basic_flex_variant;
+
 template <class... Ts>
-class flex_variant;
+using flex_variant = basic_flex_variant<flex_storage<>, Ts...>;
 
 } // namespace esl
 
 namespace std {
 
 // std::variant_size
-template <class... Ts>
-struct variant_size<::esl::flex_variant<Ts...>> : integral_constant<size_t, sizeof...(Ts)> {};
+template <class Storage, class... Ts>
+struct variant_size<::esl::basic_flex_variant<Storage, Ts...>> : integral_constant<size_t, sizeof...(Ts)> {};
 
 // std::variant_alternative
-template <size_t I, class... Ts>
-struct variant_alternative<I, ::esl::flex_variant<Ts...>> : ::esl::nth_type<I, Ts...> {};
+template <size_t I, class Storage, class... Ts>
+struct variant_alternative<I, ::esl::basic_flex_variant<Storage, Ts...>> : ::esl::nth_type<I, Ts...> {};
 
 } // namespace std
 
@@ -48,17 +53,23 @@ template <class Storage, class... Ts>
 struct FlexVariantStorageMove {
     static constexpr auto vtable = make_tuple_vtable_v<Storage::template move_construct_function, std::tuple<Ts...>>;
 };
+template <class Storage, class Alloc, class... Ts>
+struct FlexVariantStorageAllocatorCopy {
+    static constexpr auto vtable = make_tuple_vtable_v<Storage::template allocator_copy_construct<Alloc>::template function, std::tuple<Ts...>>;
+};
+template <class Storage, class Alloc, class... Ts>
+struct FlexVariantStorageAllocatorMove {
+    static constexpr auto vtable = make_tuple_vtable_v<Storage::template allocator_move_construct<Alloc>::template function, std::tuple<Ts...>>;
+};
 } // namespace details
 
-template <class... Ts>
-class flex_variant {
+template <class Storage, class... Ts>
+class basic_flex_variant {
 private:
     friend struct details::FlexVariantStorageAccess;
 
-    using Storage = flex_storage<>;
-
-    static constexpr auto storage_destruct_vtable = make_tuple_vtable_v<Storage::destruct_function, std::tuple<Ts...>>;
-    static constexpr auto storage_swap_vtable = make_tuple_vtable_v<Storage::swap_function, std::tuple<Ts...>, std::tuple<Ts...>>;
+    static constexpr auto storage_destruct_vtable = make_tuple_vtable_v<Storage::template destruct_function, std::tuple<Ts...>>;
+    static constexpr auto storage_swap_vtable = make_tuple_vtable_v<Storage::template swap_function, std::tuple<Ts...>, std::tuple<Ts...>>;
 
     Storage storage_;
     std::size_t index_;
@@ -76,7 +87,7 @@ private:
     template <class T>
     struct SelectType<T, std::void_t<overloaded_resolution_t<T, Ts...>>> : SelectTypeEnableIf<T, overloaded_resolution_t<T, Ts...>> {};
     // workaround for clang++
-    template <class T, bool = std::is_same_v<std::decay_t<T>, flex_variant>>
+    template <class T, bool = std::is_same_v<std::decay_t<T>, basic_flex_variant>>
     struct AcceptedType {};
     template <class T>
     struct AcceptedType<T, false> : SelectType<T> {};
@@ -92,24 +103,24 @@ protected:
     template <class T, std::size_t I, class... Args>
     ESL_ATTR_FORCEINLINE T& do_emplace(Args&&... args) {
         this->reset();
-        auto& val = storage_.construct<T>(std::in_place, std::forward<Args>(args)...);
+        auto& val = storage_.template construct<T>(std::in_place, std::forward<Args>(args)...);
         index_ = I;
         return val;
     }
 
 public:
     //template <class T0 = nth_type_t<0, Ts...>, class = std::enable_if_t<std::is_default_constructible_v<T0>>>
-    constexpr flex_variant() noexcept : storage_(std::in_place_type<nth_type_t<0, Ts...>>), index_(0) {}
+    constexpr basic_flex_variant() noexcept : storage_(std::in_place_type<nth_type_t<0, Ts...>>), index_(0) {}
 
     //template <bool Dep = true, class = std::enable_if_t<Dep && template_all_of_v<std::is_copy_constructible, Ts...>>>
-    flex_variant(const flex_variant& other) : index_(other.index_) {
+    basic_flex_variant(const basic_flex_variant& other) : index_(other.index_) {
         if (index_ != std::variant_npos) {
             details::FlexVariantStorageCopy<Storage, Ts...>::vtable[index_](storage_, other.storage_);
         }
     }
 
     //template <bool Dep = true, class = std::enable_if_t<Dep && template_all_of_v<std::is_move_constructible, Ts...>>>
-    flex_variant(flex_variant&& other) noexcept : index_(other.index_) {
+    basic_flex_variant(basic_flex_variant&& other) noexcept : index_(other.index_) {
         if (index_ != std::variant_npos) {
             details::FlexVariantStorageMove<Storage, Ts...>::vtable[index_](storage_, std::move(other.storage_));
             other.index_ = std::variant_npos;
@@ -117,26 +128,60 @@ public:
     }
 
     template <class T, class AT = typename AcceptedType<T&&>::type>
-    flex_variant(T&& value) : flex_variant(std::in_place_type<AT>, std::forward<T>(value)) {}
+    basic_flex_variant(T&& value) : basic_flex_variant(std::in_place_type<AT>, std::forward<T>(value)) {}
 
     template <class T, class... Args, class I = typename ExactlyOnceIndex<T>::type>
-    explicit flex_variant(std::in_place_type_t<T>, Args&&... args) : storage_(std::in_place_type<T>, std::forward<Args>(args)...), index_(I::value) {}
+    explicit basic_flex_variant(std::in_place_type_t<T>, Args&&... args) : storage_(std::in_place_type<T>, std::forward<Args>(args)...), index_(I::value) {}
 
     template <class T, class U, class... Args, class I = typename ExactlyOnceIndex<T>::type>
-    explicit flex_variant(std::in_place_type_t<T>, std::initializer_list<U> il, Args&&... args)
+    explicit basic_flex_variant(std::in_place_type_t<T>, std::initializer_list<U> il, Args&&... args)
         : storage_(std::in_place_type<T>, il, std::forward<Args>(args)...), index_(I::value) {}
 
     template <std::size_t I, class... Args>
-    explicit flex_variant(std::in_place_index_t<I>, Args&&... args)
-        : storage_(std::in_place_type<std::variant_alternative_t<I, flex_variant>>, std::forward<Args>(args)...), index_(I) {}
+    explicit basic_flex_variant(std::in_place_index_t<I>, Args&&... args)
+        : storage_(std::in_place_type<std::variant_alternative_t<I, basic_flex_variant>>, std::forward<Args>(args)...), index_(I) {}
 
     template <std::size_t I, class U, class... Args>
-    explicit flex_variant(std::in_place_index_t<I>, std::initializer_list<U> il, Args&&... args)
-        : storage_(std::in_place_type<std::variant_alternative_t<I, flex_variant>>, il, std::forward<Args>(args)...), index_(I) {}
+    explicit basic_flex_variant(std::in_place_index_t<I>, std::initializer_list<U> il, Args&&... args)
+        : storage_(std::in_place_type<std::variant_alternative_t<I, basic_flex_variant>>, il, std::forward<Args>(args)...), index_(I) {}
+
+    // Allocator-extended constructors
+    // Alloc: passed to alternatives using an allocator, allocates the out-of-line alternatives with pmr::flex_variant
+    // (flex_variant_pmr.hpp), see flex_storage
+    // NOTE: The allocator is not kept, later assignments and emplacements construct without it
+
+    template <class Alloc>
+    basic_flex_variant(std::allocator_arg_t, const Alloc& alloc) : storage_(std::allocator_arg, alloc, std::in_place_type<nth_type_t<0, Ts...>>), index_(0) {}
+
+    template <class Alloc>
+    basic_flex_variant(std::allocator_arg_t, const Alloc& alloc, const basic_flex_variant& other) : index_(other.index_) {
+        if (index_ != std::variant_npos) {
+            details::FlexVariantStorageAllocatorCopy<Storage, Alloc, Ts...>::vtable[index_](storage_, alloc, other.storage_);
+        }
+    }
+
+    // Moves the out-of-line alternative if the storage adopts it, see flex_storage
+    template <class Alloc>
+    basic_flex_variant(std::allocator_arg_t, const Alloc& alloc, basic_flex_variant&& other) : index_(other.index_) {
+        if (index_ != std::variant_npos) {
+            details::FlexVariantStorageAllocatorMove<Storage, Alloc, Ts...>::vtable[index_](storage_, alloc, std::move(other.storage_));
+            other.index_ = std::variant_npos;
+        }
+    }
+
+    template <class Alloc, class T, class AT = typename AcceptedType<T&&>::type>
+    basic_flex_variant(std::allocator_arg_t, const Alloc& alloc, T&& value)
+        : basic_flex_variant(std::allocator_arg, alloc, std::in_place_type<AT>, std::forward<T>(value)) {}
+
+    template <class Alloc, class T, class... Args, class I = typename ExactlyOnceIndex<T>::type>
+    explicit basic_flex_variant(std::allocator_arg_t, const Alloc& alloc, std::in_place_type_t<T>, Args&&... args)
+        : storage_(std::allocator_arg, alloc, std::in_place_type<T>, std::forward<Args>(args)...), index_(I::value) {}
 
-    // TODO constructor with allocator_tag_t
+    template <class Alloc, std::size_t I, class... Args>
+    explicit basic_flex_variant(std::allocator_arg_t, const Alloc& alloc, std::in_place_index_t<I>, Args&&... args)
+        : storage_(std::allocator_arg, alloc, std::in_place_type<std::variant_alternative_t<I, basic_flex_variant>>, std::forward<Args>(args)...), index_(I) {}
 
-    flex_variant& operator=(const flex_variant& other) {
+    basic_flex_variant& operator=(const basic_flex_variant& other) {
         this->reset();
         if (other.index_ != std::variant_npos) {
             details::FlexVariantStorageCopy<Storage, Ts...>::vtable[other.index_](storage_, other.storage_);
@@ -145,7 +190,7 @@ public:
         return *this;
     }
 
-    flex_variant& operator=(flex_variant&& other) noexcept {
+    basic_flex_variant& operator=(basic_flex_variant&& other) noexcept {
         this->reset();
         if (other.index_ != std::variant_npos) {
             details::FlexVariantStorageMove<Storage, Ts...>::vtable[other.index_](storage_, std::move(other.storage_));
@@ -156,12 +201,12 @@ public:
     }
 
     template <class T, class AT = typename AcceptedType<T&&>::type>
-    flex_variant& operator=(T&& value) {
+    basic_flex_variant& operator=(T&& value) {
         this->emplace<AT>(std::forward<T>(value));
         return *this;
     }
 
-    ~flex_variant() {
+    ~basic_flex_variant() {
         if (index_ != std::variant_npos) {
             storage_destruct_vtable[index_](storage_);
         }
@@ -191,16 +236,16 @@ public:
     }
 
     template <std::size_t I, class... Args>
-    std::variant_alternative_t<I, flex_variant>& emplace(Args&&... args) {
-        return this->do_emplace<std::variant_alternative_t<I, flex_variant>, I>(std::forward<Args>(args)...);
+    std::variant_alternative_t<I, basic_flex_variant>& emplace(Args&&... args) {
+        return this->do_emplace<std::variant_alternative_t<I, basic_flex_variant>, I>(std::forward<Args>(args)...);
     }
 
     template <std::size_t I, class U, class... Args>
-    std::variant_alternative_t<I, flex_variant>& emplace(std::initializer_list<U> il, Args&&... args) {
-        return this->do_emplace<std::variant_alternative_t<I, flex_variant>, I>(il, std::forward<Args>(args)...);
+    std::variant_alternative_t<I, basic_flex_variant>& emplace(std::initializer_list<U> il, Args&&... args) {
+        return this->do_emplace<std::variant_alternative_t<I, basic_flex_variant>, I>(il, std::forward<Args>(args)...);
     }
 
-    void swap(flex_variant& other) noexcept {
+    void swap(basic_flex_variant& other) noexcept {
         if (index_ == std::variant_npos) {
             if (other.index_ != std::variant_npos) {
                 details::FlexVariantStorageMove<Storage, Ts...>::vtable[other.index_](storage_, std::move(other.storage_));
@@ -223,13 +268,13 @@ public:
 namespace details {
 
 struct FlexVariantStorageAccess {
-    template <class... Ts>
-    static typename flex_variant<Ts...>::Storage& get(flex_variant<Ts...>& v) noexcept {
+    template <class Storage, class... Ts>
+    static Storage& get(basic_flex_variant<Storage, Ts...>& v) noexcept {
         return v.storage_;
     }
 
-    template <class... Ts>
-    static const typename flex_variant<Ts...>::Storage& get(const flex_variant<Ts...>& v) noexcept {
+    template <class Storage, class... Ts>
+    static const Storage& get(const basic_flex_variant<Storage, Ts...>& v) noexcept {
         return v.storage_;
     }
 };
@@ -241,103 +286,103 @@ struct FlexVariantStorageAccess {
 namespace std {
 
 // std::holds_alternative
-template <class T, class... Ts>
-inline constexpr bool holds_alternative(const ::esl::flex_variant<Ts...>& v) noexcept {
+template <class T, class Storage, class... Ts>
+inline constexpr bool holds_alternative(const ::esl::basic_flex_variant<Storage, Ts...>& v) noexcept {
     return v.index() == ::esl::index_of_v<T, Ts...>;
 }
 
 // std::get<I>
-template <size_t I, class... Ts>
-inline constexpr variant_alternative_t<I, ::esl::flex_variant<Ts...>>& get(::esl::flex_variant<Ts...>& v) {
+template <size_t I, class Storage, class... Ts>
+inline constexpr variant_alternative_t<I, ::esl::basic_flex_variant<Storage, Ts...>>& get(::esl::basic_flex_variant<Storage, Ts...>& v) {
     if (v.index() != I) {
         throw std::bad_variant_access{};
     }
-    return ::esl::details::FlexVariantStorageAccess::get(v).template get<variant_alternative_t<I, ::esl::flex_variant<Ts...>>>();
+    return ::esl::details::FlexVariantStorageAccess::get(v).template get<variant_alternative_t<I, ::esl::basic_flex_variant<Storage, Ts...>>>();
 }
-template <size_t I, class... Ts>
-inline constexpr const variant_alternative_t<I, ::esl::flex_variant<Ts...>>& get(const ::esl::flex_variant<Ts...>& v) {
+template <size_t I, class Storage, class... Ts>
+inline constexpr const variant_alternative_t<I, ::esl::basic_flex_variant<Storage, Ts...>>& get(const ::esl::basic_flex_variant<Storage, Ts...>& v) {
     if (v.index() != I) {
         throw std::bad_variant_access{};
     }
-    return ::esl::details::FlexVariantStorageAccess::get(v).template get<variant_alternative_t<I, ::esl::flex_variant<Ts...>>>();
+    return ::esl::details::FlexVariantStorageAccess::get(v).template get<variant_alternative_t<I, ::esl::basic_flex_variant<Storage, Ts...>>>();
 }
-template <size_t I, class... Ts>
-inline constexpr variant_alternative_t<I, ::esl::flex_variant<Ts...>>&& get(::esl::flex_variant<Ts...>&& v) {
+template <size_t I, class Storage, class... Ts>
+inline constexpr variant_alternative_t<I, ::esl::basic_flex_variant<Storage, Ts...>>&& get(::esl::basic_flex_variant<Storage, Ts...>&& v) {
     return std::move(std::get<I>(v));
 }
-template <size_t I, class... Ts>
-inline constexpr variant_alternative_t<I, ::esl::flex_variant<Ts...>> const&& get(const ::esl::flex_variant<Ts...>&& v) {
+template <size_t I, class Storage, class... Ts>
+inline constexpr variant_alternative_t<I, ::esl::basic_flex_variant<Storage, Ts...>> const&& get(const ::esl::basic_flex_variant<Storage, Ts...>&& v) {
     return std::move(std::get<I>(v));
 }
 // std::get<T>
-template <class T, class... Ts>
-inline constexpr T& get(::esl::flex_variant<Ts...>& v) {
+template <class T, class Storage, class... Ts>
+inline constexpr T& get(::esl::basic_flex_variant<Storage, Ts...>& v) {
     static_assert(::esl::is_exactly_once_v<T, Ts...>, "T should occur for exactly once in alternatives");
     return get<::esl::index_of_v<T, Ts...>>(v);
 }
-template <class T, class... Ts>
-inline constexpr const T& get(const ::esl::flex_variant<Ts...>& v) {
+template <class T, class Storage, class... Ts>
+inline constexpr const T& get(const ::esl::basic_flex_variant<Storage, Ts...>& v) {
     static_assert(::esl::is_exactly_once_v<T, Ts...>, "T should occur for exactly once in alternatives");
     return get<::esl::index_of_v<T, Ts...>>(v);
 }
-template <class T, class... Ts>
-inline constexpr T&& get(::esl::flex_variant<Ts...>&& v) {
+template <class T, class Storage, class... Ts>
+inline constexpr T&& get(::esl::basic_flex_variant<Storage, Ts...>&& v) {
     return move(get<T>(v));
 }
-template <class T, class... Ts>
-inline constexpr const T&& get(const ::esl::flex_variant<Ts...>&& v) {
+template <class T, class Storage, class... Ts>
+inline constexpr const T&& get(const ::esl::basic_flex_variant<Storage, Ts...>&& v) {
     return move(get<T>(v));
 }
 
 // std::get_if
-template <size_t I, class... Ts>
-inline constexpr add_pointer_t<variant_alternative_t<I, ::esl::flex_variant<Ts...>>> get_if(::esl::flex_variant<Ts...>* vap) {
+template <size_t I, class Storage, class... Ts>
+inline constexpr add_pointer_t<variant_alternative_t<I, ::esl::basic_flex_variant<Storage, Ts...>>> get_if(::esl::basic_flex_variant<Storage, Ts...>* vap) {
     if (!vap || vap->index() != I) {
         return nullptr;
     }
-    return &::esl::details::FlexVariantStorageAccess::get(*vap).template get<variant_alternative_t<I, ::esl::flex_variant<Ts...>>>();
+    return &::esl::details::FlexVariantStorageAccess::get(*vap).template get<variant_alternative_t<I, ::esl::basic_flex_variant<Storage, Ts...>>>();
 }
-template <size_t I, class... Ts>
-inline constexpr add_pointer_t<const variant_alternative_t<I, ::esl::flex_variant<Ts...>>> get_if(const ::esl::flex_variant<Ts...>* vap) {
+template <size_t I, class Storage, class... Ts>
+inline constexpr add_pointer_t<const variant_alternative_t<I, ::esl::basic_flex_variant<Storage, Ts...>>> get_if(const ::esl::basic_flex_variant<Storage, Ts...>* vap) {
     if (!vap || vap->index() != I) {
         return nullptr;
     }
-    return &::esl::details::FlexVariantStorageAccess::get(*vap).template get<variant_alternative_t<I, ::esl::flex_variant<Ts...>>>();
+    return &::esl::details::FlexVariantStorageAccess::get(*vap).template get<variant_alternative_t<I, ::esl::basic_flex_variant<Storage, Ts...>>>();
 }
-template <class T, class... Ts>
-inline constexpr add_pointer_t<T> get_if(::esl::flex_variant<Ts...>* vap) {
+template <class T, class Storage, class... Ts>
+inline constexpr add_pointer_t<T> get_if(::esl::basic_flex_variant<Storage, Ts...>* vap) {
     static_assert(::esl::is_exactly_once_v<T, Ts...>, "T should occur for exactly once in alternatives");
     return get_if<::esl::index_of_v<T, Ts...>>(vap);
 }
-template <class T, class... Ts>
-inline constexpr add_pointer_t<const T> get_if(const ::esl::flex_variant<Ts...>* vap) {
+template <class T, class Storage, class... Ts>
+inline constexpr add_pointer_t<const T> get_if(const ::esl::basic_flex_variant<Storage, Ts...>* vap) {
     static_assert(::esl::is_exactly_once_v<T, Ts...>, "T should occur for exactly once in alternatives");
     return get_if<::esl::index_of_v<T, Ts...>>(vap);
 }
 
 // std::swap
-template <class... Ts>
-inline void swap(::esl::flex_variant<Ts...>& lhs, ::esl::flex_variant<Ts...>& rhs) noexcept(noexcept(lhs.swap(rhs))) {
+template <class Storage, class... Ts>
+inline void swap(::esl::basic_flex_variant<Storage, Ts...>& lhs, ::esl::basic_flex_variant<Storage, Ts...>& rhs) noexcept(noexcept(lhs.swap(rhs))) {
     lhs.swap(rhs);
 }
 
 // std::hash
-template <class... Ts>
-struct hash<::esl::flex_variant<Ts...>> {
+template <class Storage, class... Ts>
+struct hash<::esl::basic_flex_variant<Storage, Ts...>> {
 private:
     using hasher_type = tuple<hash<decay_t<Ts>>...>;
     hasher_type hasher_;
 
     template <size_t I>
     struct HashFunction {
-        static size_t value(const hasher_type& hasher, const ::esl::flex_variant<Ts...>& v) {
+        static size_t value(const hasher_type& hasher, const ::esl::basic_flex_variant<Storage, Ts...>& v) {
             return ::esl::hash_combine(get<I>(hasher)(std::get<I>(v)), I);
         }
     };
     static constexpr auto vtable = ::esl::make_index_sequence_vtable_v<HashFunction, sizeof...(Ts)>;
 
 public:
-    size_t operator()(const ::esl::flex_variant<Ts...>& v) const {
+    size_t operator()(const ::esl::basic_flex_variant<Storage, Ts...>& v) const {
         return vtable[v.index()](hasher_, v);
     }
 };
@@ -356,19 +401,19 @@ using std::variant_size_v;
 
 namespace details {
 
-template <template <class> class Comp, class... Ts>
+template <template <class> class Comp, class Storage, class... Ts>
 struct VariantComp {
 private:
     template <std::size_t I>
     struct CompFunction {
-        static bool value(const flex_variant<Ts...>& lhs, const flex_variant<Ts...>& rhs) {
+        static bool value(const basic_flex_variant<Storage, Ts...>& lhs, const basic_flex_variant<Storage, Ts...>& rhs) {
             return Comp<nth_type_t<I, Ts...>>{}(std::get<I>(lhs), std::get<I>(rhs));
         }
     };
     static constexpr auto vtable = make_index_sequence_vtable_v<CompFunction, sizeof...(Ts)>;
 
 public:
-    constexpr bool operator()(const flex_variant<Ts...>& lhs, const flex_variant<Ts...>& rhs) const {
+    constexpr bool operator()(const basic_flex_variant<Storage, Ts...>& lhs, const basic_flex_variant<Storage, Ts...>& rhs) const {
         return vtable[lhs.index()](lhs, rhs);
     }
 };
@@ -407,53 +452,53 @@ inline constexpr decltype(auto) visit(Visitor&& vis, Variants&&... vars) {
 }
 
 // operators
-template <class... Ts>
-inline constexpr bool operator==(const flex_variant<Ts...>& lhs, const flex_variant<Ts...>& rhs) {
-    return lhs.index() == rhs.index() && (lhs.valueless_by_exception() || details::VariantComp<std::equal_to, Ts...>{}(lhs, rhs));
+template <class Storage, class... Ts>
+inline constexpr bool operator==(const basic_flex_variant<Storage, Ts...>& lhs, const basic_flex_variant<Storage, Ts...>& rhs) {
+    return lhs.index() == rhs.index() && (lhs.valueless_by_exception() || details::VariantComp<std::equal_to, Storage, Ts...>{}(lhs, rhs));
 }
-template <class... Ts>
-inline constexpr bool operator!=(const flex_variant<Ts...>& lhs, const flex_variant<Ts...>& rhs) {
-    return lhs.index() != rhs.index() || (!lhs.valueless_by_exception() && details::VariantComp<std::not_equal_to, Ts...>{}(lhs, rhs));
+template <class Storage, class... Ts>
+inline constexpr bool operator!=(const basic_flex_variant<Storage, Ts...>& lhs, const basic_flex_variant<Storage, Ts...>& rhs) {
+    return lhs.index() != rhs.index() || (!lhs.valueless_by_exception() && details::VariantComp<std::not_equal_to, Storage, Ts...>{}(lhs, rhs));
 }
-template <class... Ts>
-inline constexpr bool operator<(const flex_variant<Ts...>& lhs, const flex_variant<Ts...>& rhs) {
+template <class Storage, class... Ts>
+inline constexpr bool operator<(const basic_flex_variant<Storage, Ts...>& lhs, const basic_flex_variant<Storage, Ts...>& rhs) {
     if (rhs.valueless_by_exception()) {
         return false;
     }
     if (lhs.valueless_by_exception()) {
         return true;
     }
-    return lhs.index() < rhs.index() || (lhs.index() == rhs.index() && details::VariantComp<std::less, Ts...>{}(lhs, rhs));
+    return lhs.index() < rhs.index() || (lhs.index() == rhs.index() && details::VariantComp<std::less, Storage, Ts...>{}(lhs, rhs));
 }
-template <class... Ts>
-inline constexpr bool operator>(const flex_variant<Ts...>& lhs, const flex_variant<Ts...>& rhs) {
+template <class Storage, class... Ts>
+inline constexpr bool operator>(const basic_flex_variant<Storage, Ts...>& lhs, const basic_flex_variant<Storage, Ts...>& rhs) {
     if (lhs.valueless_by_exception()) {
         return false;
     }
     if (rhs.valueless_by_exception()) {
         return true;
     }
-    return lhs.index() > rhs.index() || (lhs.index() == rhs.index() && details::VariantComp<std::greater, Ts...>{}(lhs, rhs));
+    return lhs.index() > rhs.index() || (lhs.index() == rhs.index() && details::VariantComp<std::greater, Storage, Ts...>{}(lhs, rhs));
 }
-template <class... Ts>
-inline constexpr bool operator<=(const flex_variant<Ts...>& lhs, const flex_variant<Ts...>& rhs) {
+template <class Storage, class... Ts>
+inline constexpr bool operator<=(const basic_flex_variant<Storage, Ts...>& lhs, const basic_flex_variant<Storage, Ts...>& rhs) {
     if (lhs.valueless_by_exception()) {
         return true;
     }
     if (rhs.valueless_by_exception()) {
         return false;
     }
-    return lhs.index() < rhs.index() || (lhs.index() == rhs.index() && details::VariantComp<std::less_equal, Ts...>{}(lhs, rhs));
+    return lhs.index() < rhs.index() || (lhs.index() == rhs.index() && details::VariantComp<std::less_equal, Storage, Ts...>{}(lhs, rhs));
 }
-template <class... Ts>
-inline constexpr bool operator>=(const flex_variant<Ts...>& lhs, const flex_variant<Ts...>& rhs) {
+template <class Storage, class... Ts>
+inline constexpr bool operator>=(const basic_flex_variant<Storage, Ts...>& lhs, const basic_flex_variant<Storage, Ts...>& rhs) {
     if (rhs.valueless_by_exception()) {
         return true;
     }
     if (lhs.valueless_by_exception()) {
         return false;
     }
-    return lhs.index() > rhs.index() || (lhs.index() == rhs.index() && details::VariantComp<std::greater_equal, Ts...>{}(lhs, rhs));
+    return lhs.index() > rhs.index() || (lhs.index() == rhs.index() && details::VariantComp<std::greater_equal, Storage, Ts...>{}(lhs, rhs));
 }
 
 } // namespace esl
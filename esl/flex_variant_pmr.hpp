@@ -0,0 +1,96 @@
+#ifndef ESL_FLEX_VARIANT_PMR_HPP
+#define ESL_FLEX_VARIANT_PMR_HPP
+
+#include "flex_variant.hpp"
+#include "memory.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <memory_resource>
+#include <type_traits>
+
+namespace esl {
+
+// flex_memory_resource
+// Out-of-line allocation of flex_storage from the memory resource of the allocator, kept before the object for destroy
+// Alloc: std::allocator (new_delete_resource) or std::pmr::polymorphic_allocator
+// Objects constructed without an allocator are allocated from new_delete_resource,
+// allocator-extended moves keep the object if the resources are equal
+struct flex_memory_resource {
+private:
+    // [resource, padding, T]
+    template <class T>
+    static constexpr std::size_t offset = (sizeof(std::pmr::memory_resource*) + alignof(T) - 1) / alignof(T) * alignof(T);
+    template <class T>
+    static constexpr std::size_t size = offset<T> + sizeof(T);
+    template <class T>
+    static constexpr std::size_t align = std::max(alignof(std::pmr::memory_resource*), alignof(T));
+
+    template <class T>
+    static std::pmr::memory_resource*& resource(const T* p) noexcept {
+        return *reinterpret_cast<std::pmr::memory_resource**>(reinterpret_cast<char*>(const_cast<T*>(p)) - offset<T>);
+    }
+
+    template <class Alloc>
+    static std::pmr::memory_resource* resource_of(const Alloc& alloc) noexcept {
+        if constexpr (std::is_same_v<Alloc, std::pmr::polymorphic_allocator<typename Alloc::value_type>>) {
+            return alloc.resource();
+        } else {
+            static_assert(std::is_same_v<Alloc, std::allocator<typename Alloc::value_type>>,
+                          "esl::flex_memory_resource: Alloc should be std::allocator or std::pmr::polymorphic_allocator");
+            return std::pmr::new_delete_resource();
+        }
+    }
+
+    // construct_at: T* (void*)
+    template <class T, class F>
+    static T* allocate(std::pmr::memory_resource* r, F&& construct_at) {
+        char* block = static_cast<char*>(r->allocate(size<T>, align<T>));
+        T* p;
+        try {
+            p = construct_at(block + offset<T>);
+        } catch (...) {
+            r->deallocate(block, size<T>, align<T>);
+            throw;
+        }
+        resource(p) = r;
+        return p;
+    }
+
+public:
+    template <class T, class... Args>
+    static T* create(Args&&... args) {
+        return allocate<T>(std::pmr::new_delete_resource(), [&](void* p) { return ::new (p) T(std::forward<Args>(args)...); });
+    }
+
+    template <class T, class Alloc, class... Args>
+    static T* create_using_allocator(const Alloc& alloc, Args&&... args) {
+        return allocate<T>(resource_of(alloc),
+                           [&](void* p) { return uninitialized_construct_using_allocator(static_cast<T*>(p), alloc, std::forward<Args>(args)...); });
+    }
+
+    template <class T, class Alloc>
+    static bool adoptable(const T* p, const Alloc& alloc) noexcept {
+        return resource(p)->is_equal(*resource_of(alloc));
+    }
+
+    template <class T>
+    static void destroy(T* p) noexcept {
+        std::pmr::memory_resource* r = resource(p);
+        p->~T();
+        r->deallocate(reinterpret_cast<char*>(p) - offset<T>, size<T>, align<T>);
+    }
+};
+
+namespace pmr {
+
+// flex_variant
+// Out-of-line alternatives allocated from the memory resource of the allocator-extended constructors
+template <class... Ts>
+using flex_variant = basic_flex_variant<flex_storage<4 * sizeof(void*), alignof(void*), flex_memory_resource>, Ts...>;
+
+} // namespace pmr
+
+} // namespace esl
+
+#endif // ESL_FLEX_VARIANT_PMR_HPP
@@ -0,0 +1,1171 @@
+#include "functional.hpp"
+#include "intrin.hpp"
+
+#include <array>
+#include <cstring>
+
+namespace esl {
+
+namespace {
+
+// Slicing by 16 bytes, see https://create.stephan-brumme.com/crc32/
+// tables[k][b]: raw crc of byte b followed by k zero bytes
+
+using crc32_slicing_tables_t_ = std::array<std::array<std::uint32_t, 256>, 16>;
+
+constexpr crc32_slicing_tables_t_ crc32_make_slicing_tables_(std::uint32_t poly) noexcept {
+	crc32_slicing_tables_t_ tables{};
+	for (std::uint32_t b = 0; b < 256; ++b) {
+		std::uint32_t crc = b;
+		for (int i = 0; i < 8; ++i) {
+			crc = (crc & 1) ? (crc >> 1) ^ poly : crc >> 1;
+		}
+		tables[0][b] = crc;
+	}
+	for (std::size_t k = 1; k < 16; ++k) {
+		for (std::size_t b = 0; b < 256; ++b) {
+			const auto prev = tables[k - 1][b];
+			tables[k][b] = (prev >> 8) ^ tables[0][prev & 0xFF];
+		}
+	}
+	return tables;
+}
+
+constexpr crc32_slicing_tables_t_ crc32_slicing_tables_ = crc32_make_slicing_tables_(crc32_poly_internal_);
+constexpr crc32_slicing_tables_t_ crc32c_slicing_tables_ = crc32_make_slicing_tables_(crc32c_poly_internal_);
+
+// crc: raw (inverted) state
+std::uint32_t crc32_slicing_(const unsigned char* p, std::size_t len, std::uint32_t crc, const crc32_slicing_tables_t_& t) noexcept {
+	for (; len >= 16; p += 16, len -= 16) {
+		const std::uint32_t a = load32le(p) ^ crc;
+		const std::uint32_t b = load32le(p + 4);
+		const std::uint32_t c = load32le(p + 8);
+		const std::uint32_t d = load32le(p + 12);
+		crc = t[15][a & 0xFF] ^ t[14][(a >> 8) & 0xFF] ^ t[13][(a >> 16) & 0xFF] ^ t[12][a >> 24] ^
+			t[11][b & 0xFF] ^ t[10][(b >> 8) & 0xFF] ^ t[9][(b >> 16) & 0xFF] ^ t[8][b >> 24] ^
+			t[7][c & 0xFF] ^ t[6][(c >> 8) & 0xFF] ^ t[5][(c >> 16) & 0xFF] ^ t[4][c >> 24] ^
+			t[3][d & 0xFF] ^ t[2][(d >> 8) & 0xFF] ^ t[1][(d >> 16) & 0xFF] ^ t[0][d >> 24];
+	}
+	for (; len != 0; --len) {
+		crc = t[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+	}
+	return crc;
+}
+
+#ifdef ESL_ARCH_X86_ANY
+
+// Folding with carry-less multiplication, see "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction" (Intel)
+// Bit-reflected constants of the paper for crc32_poly_internal_, as the Linux kernel and Chromium zlib
+ESL_ATTR_TARGET("pclmul")
+inline __m128i crc32_fold_(__m128i x, __m128i k, __m128i next) noexcept {
+	return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x00), _mm_clmulepi64_si128(x, k, 0x11)), next);
+}
+
+// len: at least 64, multiple of 16
+// crc: raw (inverted) state
+ESL_ATTR_TARGET("pclmul,sse4.1")
+std::uint32_t crc32_pclmul_(const unsigned char* p, std::size_t len, std::uint32_t crc) noexcept {
+	const __m128i k1k2 = _mm_set_epi64x(0x01c6e41596, 0x0154442bd4);
+	const __m128i k3k4 = _mm_set_epi64x(0x00ccaa009e, 0x01751997d0);
+	const __m128i k5k0 = _mm_set_epi64x(0, 0x0163cd6124);
+	const __m128i poly = _mm_set_epi64x(0x01f7011641, 0x01db710641);
+	const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+
+	__m128i x1 = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), _mm_cvtsi32_si128(static_cast<int>(crc)));
+	__m128i x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16));
+	__m128i x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 32));
+	__m128i x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 48));
+	p += 64;
+	len -= 64;
+
+	// Fold 4 x 128 bits in parallel
+	for (; len >= 64; p += 64, len -= 64) {
+		x1 = crc32_fold_(x1, k1k2, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+		x2 = crc32_fold_(x2, k1k2, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16)));
+		x3 = crc32_fold_(x3, k1k2, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 32)));
+		x4 = crc32_fold_(x4, k1k2, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 48)));
+	}
+
+	// Fold into 128 bits, then the remaining 16 bytes blocks
+	x1 = crc32_fold_(x1, k3k4, x2);
+	x1 = crc32_fold_(x1, k3k4, x3);
+	x1 = crc32_fold_(x1, k3k4, x4);
+	for (; len >= 16; p += 16, len -= 16) {
+		x1 = crc32_fold_(x1, k3k4, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+	}
+
+	// Fold 128 bits to 64 bits
+	x2 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+	x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+	x2 = _mm_srli_si128(x1, 4);
+	x1 = _mm_xor_si128(_mm_clmulepi64_si128(_mm_and_si128(x1, mask32), k5k0, 0x00), x2);
+
+	// Barrett reduction to 32 bits
+	x2 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask32), poly, 0x10);
+	x2 = _mm_clmulepi64_si128(_mm_and_si128(x2, mask32), poly, 0x00);
+	x1 = _mm_xor_si128(x1, x2);
+	return static_cast<std::uint32_t>(_mm_extract_epi32(x1, 1));
+}
+
+// The crc32 instruction has a latency of 3 cycles and a throughput of 1 per cycle, so 3 streams are interleaved,
+// see https://stackoverflow.com/a/17646775 (Mark Adler)
+
+ESL_ATTR_TARGET("sse4.2")
+inline std::uint64_t crc32c_u64_(std::uint64_t crc, const unsigned char* p) noexcept {
+#	ifdef ESL_ARCH_X64
+	return _mm_crc32_u64(crc, load64le(p));
+#	else
+	return _mm_crc32_u32(_mm_crc32_u32(static_cast<std::uint32_t>(crc), load32le(p)), load32le(p + 4));
+#	endif
+}
+
+// tables[j][b]: (b << 8j) shifted over n zero bytes
+using crc32c_shift_tables_t_ = std::array<std::array<std::uint32_t, 256>, 4>;
+
+constexpr crc32c_shift_tables_t_ crc32c_make_shift_tables_(std::size_t n) noexcept {
+	const std::uint32_t k = crc32_x8nmodp_(n, crc32c_poly_internal_);
+	crc32c_shift_tables_t_ tables{};
+	for (std::size_t j = 0; j < 4; ++j) {
+		for (std::uint32_t b = 0; b < 256; ++b) {
+			tables[j][b] = crc32_multmodp_(k, b << (8 * j), crc32c_poly_internal_);
+		}
+	}
+	return tables;
+}
+
+inline std::uint32_t crc32c_shift_(std::uint32_t crc, const crc32c_shift_tables_t_& t) noexcept {
+	return t[0][crc & 0xFF] ^ t[1][(crc >> 8) & 0xFF] ^ t[2][(crc >> 16) & 0xFF] ^ t[3][crc >> 24];
+}
+
+template <std::size_t Block>
+struct crc32c_block_shifts_ {
+	static constexpr crc32c_shift_tables_t_ once = crc32c_make_shift_tables_(Block);
+	static constexpr crc32c_shift_tables_t_ twice = crc32c_make_shift_tables_(Block * 2);
+};
+
+template <std::size_t Block>
+ESL_ATTR_TARGET("sse4.2")
+inline std::uint32_t crc32c_sse42_3way_(const unsigned char*& p, std::size_t& len, std::uint32_t crc) noexcept {
+	for (; len >= Block * 3; p += Block * 3, len -= Block * 3) {
+		// 64-bit states keep zero extensions out of the dependency chains
+		std::uint64_t c0 = crc;
+		std::uint64_t c1 = 0;
+		std::uint64_t c2 = 0;
+		for (std::size_t i = 0; i < Block; i += 8) {
+			c0 = crc32c_u64_(c0, p + i);
+			c1 = crc32c_u64_(c1, p + Block + i);
+			c2 = crc32c_u64_(c2, p + Block * 2 + i);
+		}
+		crc = crc32c_shift_(static_cast<std::uint32_t>(c0), crc32c_block_shifts_<Block>::twice) ^
+			crc32c_shift_(static_cast<std::uint32_t>(c1), crc32c_block_shifts_<Block>::once) ^ static_cast<std::uint32_t>(c2);
+	}
+	return crc;
+}
+
+// crc: raw (inverted) state
+ESL_ATTR_TARGET("sse4.2")
+std::uint32_t crc32c_sse42_(const unsigned char* p, std::size_t len, std::uint32_t crc) noexcept {
+	crc = crc32c_sse42_3way_<2048>(p, len, crc);
+	crc = crc32c_sse42_3way_<256>(p, len, crc);
+	std::uint64_t c = crc;
+	for (; len >= 8; p += 8, len -= 8) {
+		c = crc32c_u64_(c, p);
+	}
+	crc = static_cast<std::uint32_t>(c);
+	for (; len != 0; --len) {
+		crc = _mm_crc32_u8(crc, *p++);
+	}
+	return crc;
+}
+
+#endif
+
+// Multi-buffer md5, every lane of a vector register hashes its own message and is refilled with the next message
+// as soon as it is done, see "Processing Multiple Buffers in Parallel to Increase Performance on Intel Architecture
+// Processors" (Intel). The step functions are defined for each instruction set before expanding ESL_MD5V_ROUNDS_.
+
+#define ESL_MD5V_STEP_(f, a, b, c, d, M, s, t) \
+	a = ESL_MD5V_ADD_(ESL_MD5V_ADD_(a, f(b, c, d)), ESL_MD5V_ADD_(M, ESL_MD5V_SET1_(t))); \
+	a = ESL_MD5V_ADD_(ESL_MD5V_ROTL_(a, s), b);
+#define ESL_MD5V_ROUNDS_(a, b, c, d, W) \
+	ESL_MD5V_STEP_(ESL_MD5V_F_, a, b, c, d, W[0], 7, 0xd76aa478U) \
+	ESL_MD5V_STEP_(ESL_MD5V_F_, d, a, b, c, W[1], 12, 0xe8c7b756U) \
+	ESL_MD5V_STEP_(ESL_MD5V_F_, c, d, a, b, W[2], 17, 0x242070dbU) \
+	ESL_MD5V_STEP_(ESL_MD5V_F_, b, c, d, a, W[3], 22, 0xc1bdceeeU) \
+	ESL_MD5V_STEP_(ESL_MD5V_F_, a, b, c, d, W[4], 7, 0xf57c0fafU) \
+	ESL_MD5V_STEP_(ESL_MD5V_F_, d, a, b, c, W[5], 12, 0x4787c62aU) \
+	ESL_MD5V_STEP_(ESL_MD5V_F_, c, d, a, b, W[6], 17, 0xa8304613U) \
+	ESL_MD5V_STEP_(ESL_MD5V_F_, b, c, d, a, W[7], 22, 0xfd469501U) \
+	ESL_MD5V_STEP_(ESL_MD5V_F_, a, b, c, d, W[8], 7, 0x698098d8U) \
+	ESL_MD5V_STEP_(ESL_MD5V_F_, d, a, b, c, W[9], 12, 0x8b44f7afU) \
+	ESL_MD5V_STEP_(ESL_MD5V_F_, c, d, a, b, W[10], 17, 0xffff5bb1U) \
+	ESL_MD5V_STEP_(ESL_MD5V_F_, b, c, d, a, W[11], 22, 0x895cd7beU) \
+	ESL_MD5V_STEP_(ESL_MD5V_F_, a, b, c, d, W[12], 7, 0x6b901122U) \
+	ESL_MD5V_STEP_(ESL_MD5V_F_, d, a, b, c, W[13], 12, 0xfd987193U) \
+	ESL_MD5V_STEP_(ESL_MD5V_F_, c, d, a, b, W[14], 17, 0xa679438eU) \
+	ESL_MD5V_STEP_(ESL_MD5V_F_, b, c, d, a, W[15], 22, 0x49b40821U) \
+	ESL_MD5V_STEP_(ESL_MD5V_G_, a, b, c, d, W[1], 5, 0xf61e2562U) \
+	ESL_MD5V_STEP_(ESL_MD5V_G_, d, a, b, c, W[6], 9, 0xc040b340U) \
+	ESL_MD5V_STEP_(ESL_MD5V_G_, c, d, a, b, W[11], 14, 0x265e5a51U) \
+	ESL_MD5V_STEP_(ESL_MD5V_G_, b, c, d, a, W[0], 20, 0xe9b6c7aaU) \
+	ESL_MD5V_STEP_(ESL_MD5V_G_, a, b, c, d, W[5], 5, 0xd62f105dU) \
+	ESL_MD5V_STEP_(ESL_MD5V_G_, d, a, b, c, W[10], 9, 0x02441453U) \
+	ESL_MD5V_STEP_(ESL_MD5V_G_, c, d, a, b, W[15], 14, 0xd8a1e681U) \
+	ESL_MD5V_STEP_(ESL_MD5V_G_, b, c, d, a, W[4], 20, 0xe7d3fbc8U) \
+	ESL_MD5V_STEP_(ESL_MD5V_G_, a, b, c, d, W[9], 5, 0x21e1cde6U) \
+	ESL_MD5V_STEP_(ESL_MD5V_G_, d, a, b, c, W[14], 9, 0xc33707d6U) \
+	ESL_MD5V_STEP_(ESL_MD5V_G_, c, d, a, b, W[3], 14, 0xf4d50d87U) \
+	ESL_MD5V_STEP_(ESL_MD5V_G_, b, c, d, a, W[8], 20, 0x455a14edU) \
+	ESL_MD5V_STEP_(ESL_MD5V_G_, a, b, c, d, W[13], 5, 0xa9e3e905U) \
+	ESL_MD5V_STEP_(ESL_MD5V_G_, d, a, b, c, W[2], 9, 0xfcefa3f8U) \
+	ESL_MD5V_STEP_(ESL_MD5V_G_, c, d, a, b, W[7], 14, 0x676f02d9U) \
+	ESL_MD5V_STEP_(ESL_MD5V_G_, b, c, d, a, W[12], 20, 0x8d2a4c8aU) \
+	ESL_MD5V_STEP_(ESL_MD5V_H_, a, b, c, d, W[5], 4, 0xfffa3942U) \
+	ESL_MD5V_STEP_(ESL_MD5V_H_, d, a, b, c, W[8], 11, 0x8771f681U) \
+	ESL_MD5V_STEP_(ESL_MD5V_H_, c, d, a, b, W[11], 16, 0x6d9d6122U) \
+	ESL_MD5V_STEP_(ESL_MD5V_H_, b, c, d, a, W[14], 23, 0xfde5380cU) \
+	ESL_MD5V_STEP_(ESL_MD5V_H_, a, b, c, d, W[1], 4, 0xa4beea44U) \
+	ESL_MD5V_STEP_(ESL_MD5V_H_, d, a, b, c, W[4], 11, 0x4bdecfa9U) \
+	ESL_MD5V_STEP_(ESL_MD5V_H_, c, d, a, b, W[7], 16, 0xf6bb4b60U) \
+	ESL_MD5V_STEP_(ESL_MD5V_H_, b, c, d, a, W[10], 23, 0xbebfbc70U) \
+	ESL_MD5V_STEP_(ESL_MD5V_H_, a, b, c, d, W[13], 4, 0x289b7ec6U) \
+	ESL_MD5V_STEP_(ESL_MD5V_H_, d, a, b, c, W[0], 11, 0xeaa127faU) \
+	ESL_MD5V_STEP_(ESL_MD5V_H_, c, d, a, b, W[3], 16, 0xd4ef3085U) \
+	ESL_MD5V_STEP_(ESL_MD5V_H_, b, c, d, a, W[6], 23, 0x04881d05U) \
+	ESL_MD5V_STEP_(ESL_MD5V_H_, a, b, c, d, W[9], 4, 0xd9d4d039U) \
+	ESL_MD5V_STEP_(ESL_MD5V_H_, d, a, b, c, W[12], 11, 0xe6db99e5U) \
+	ESL_MD5V_STEP_(ESL_MD5V_H_, c, d, a, b, W[15], 16, 0x1fa27cf8U) \
+	ESL_MD5V_STEP_(ESL_MD5V_H_, b, c, d, a, W[2], 23, 0xc4ac5665U) \
+	ESL_MD5V_STEP_(ESL_MD5V_I_, a, b, c, d, W[0], 6, 0xf4292244U) \
+	ESL_MD5V_STEP_(ESL_MD5V_I_, d, a, b, c, W[7], 10, 0x432aff97U) \
+	ESL_MD5V_STEP_(ESL_MD5V_I_, c, d, a, b, W[14], 15, 0xab9423a7U) \
+	ESL_MD5V_STEP_(ESL_MD5V_I_, b, c, d, a, W[5], 21, 0xfc93a039U) \
+	ESL_MD5V_STEP_(ESL_MD5V_I_, a, b, c, d, W[12], 6, 0x655b59c3U) \
+	ESL_MD5V_STEP_(ESL_MD5V_I_, d, a, b, c, W[3], 10, 0x8f0ccc92U) \
+	ESL_MD5V_STEP_(ESL_MD5V_I_, c, d, a, b, W[10], 15, 0xffeff47dU) \
+	ESL_MD5V_STEP_(ESL_MD5V_I_, b, c, d, a, W[1], 21, 0x85845dd1U) \
+	ESL_MD5V_STEP_(ESL_MD5V_I_, a, b, c, d, W[8], 6, 0x6fa87e4fU) \
+	ESL_MD5V_STEP_(ESL_MD5V_I_, d, a, b, c, W[15], 10, 0xfe2ce6e0U) \
+	ESL_MD5V_STEP_(ESL_MD5V_I_, c, d, a, b, W[6], 15, 0xa3014314U) \
+	ESL_MD5V_STEP_(ESL_MD5V_I_, b, c, d, a, W[13], 21, 0x4e0811a1U) \
+	ESL_MD5V_STEP_(ESL_MD5V_I_, a, b, c, d, W[4], 6, 0xf7537e82U) \
+	ESL_MD5V_STEP_(ESL_MD5V_I_, d, a, b, c, W[11], 10, 0xbd3af235U) \
+	ESL_MD5V_STEP_(ESL_MD5V_I_, c, d, a, b, W[2], 15, 0x2ad7d2bbU) \
+	ESL_MD5V_STEP_(ESL_MD5V_I_, b, c, d, a, W[9], 21, 0xeb86d391U)
+
+// A message assigned to a lane
+struct digest_lane_ {
+	const unsigned char* data;
+	std::size_t len;
+	std::size_t block;  // next block
+	std::size_t blocks; // padding included
+	std::size_t index;
+	unsigned char tail[128]; // the last 1 or 2 blocks, padded
+
+	// big_endian: the bit length is stored big endian (SHA) or little endian (MD5)
+	void assign(const span<const unsigned char>& message, std::size_t i, bool big_endian) noexcept {
+		data = message.data();
+		len = message.size();
+		block = 0;
+		blocks = (len + 8) / 64 + 1;
+		index = i;
+		const std::size_t full = len / 64 * 64;
+		const std::size_t rest = len - full;
+		const std::size_t tail_size = blocks * 64 - full;
+		if (rest != 0) {
+			std::memcpy(tail, data + full, rest);
+		}
+		tail[rest] = 0x80;
+		std::memset(tail + rest + 1, 0, tail_size - rest - 1 - 8);
+		if (big_endian) {
+			store64be(static_cast<std::uint64_t>(len) * 8, tail + tail_size - 8);
+		} else {
+			store64le(static_cast<std::uint64_t>(len) * 8, tail + tail_size - 8);
+		}
+	}
+
+	const unsigned char* next() const noexcept {
+		const std::size_t offset = block * 64;
+		return offset + 64 <= len ? data + offset : tail + (offset - len / 64 * 64);
+	}
+};
+
+// Digest traits: value type, state words, initial state, single block compression and byte order
+struct md5_traits_ {
+	using value_type = md5val;
+	static constexpr std::size_t words = 4;
+	static constexpr bool big_endian = false;
+	static constexpr std::uint32_t init[words] = {0x67452301U, 0xefcdab89U, 0x98badcfeU, 0x10325476U};
+
+	static void compress(std::uint32_t (&state)[words], const unsigned char* block) noexcept {
+		md5_compress_internal_(state, block);
+	}
+};
+
+struct sha1_traits_ {
+	using value_type = sha1val;
+	static constexpr std::size_t words = 5;
+	static constexpr bool big_endian = true;
+	static constexpr const std::uint32_t (&init)[words] = sha1_init_internal_;
+
+	static void compress(std::uint32_t (&state)[words], const unsigned char* block) noexcept {
+		sha1_compress_(state, block, 1);
+	}
+};
+
+struct sha256_traits_ {
+	using value_type = sha256val;
+	static constexpr std::size_t words = 8;
+	static constexpr bool big_endian = true;
+	static constexpr const std::uint32_t (&init)[words] = sha256_init_internal_;
+
+	static void compress(std::uint32_t (&state)[words], const unsigned char* block) noexcept {
+		sha256_compress_(state, block, 1);
+	}
+};
+
+template <class Traits, std::size_t L>
+using digest_compress_lanes_t_ = void (*)(std::uint32_t (&state)[Traits::words][L], const unsigned char* const (&blocks)[L]) noexcept;
+
+template <class Traits, std::size_t L>
+void digest_many_lanes_(const span<const unsigned char>* messages, std::size_t n, typename Traits::value_type* out,
+		digest_compress_lanes_t_<Traits, L> compress) noexcept {
+	constexpr std::size_t W = Traits::words;
+	static constexpr unsigned char idle_block[64]{};
+	digest_lane_ lanes[L];
+	bool active[L];
+	std::uint32_t state[W][L];
+	std::size_t next = 0;
+	std::size_t nactive = 0;
+	const auto start = [&](std::size_t k) {
+		active[k] = next < n;
+		if (active[k]) {
+			lanes[k].assign(messages[next], next, Traits::big_endian);
+			++next;
+			for (std::size_t i = 0; i < W; ++i) {
+				state[i][k] = Traits::init[i];
+			}
+		}
+	};
+	const auto finish = [&](std::size_t k, const std::uint32_t (&s)[W]) {
+		for (std::size_t i = 0; i < W; ++i) {
+			if constexpr (Traits::big_endian) {
+				store32be(s[i], out[lanes[k].index].data() + (i * 4));
+			} else {
+				store32le(s[i], out[lanes[k].index].data() + (i * 4));
+			}
+		}
+	};
+	const auto lane_state = [&](std::size_t k, std::uint32_t (&s)[W]) {
+		for (std::size_t i = 0; i < W; ++i) {
+			s[i] = state[i][k];
+		}
+	};
+	for (std::size_t k = 0; k < L; ++k) {
+		start(k);
+		nactive += active[k];
+	}
+	const unsigned char* blocks[L];
+	std::uint32_t s[W];
+	while (nactive > 1) {
+		for (std::size_t k = 0; k < L; ++k) {
+			blocks[k] = active[k] ? lanes[k].next() : idle_block;
+		}
+		compress(state, blocks);
+		for (std::size_t k = 0; k < L; ++k) {
+			if (active[k] && ++lanes[k].block == lanes[k].blocks) {
+				lane_state(k, s);
+				finish(k, s);
+				start(k);
+				nactive -= !active[k];
+			}
+		}
+	}
+	// The last message is finished alone
+	for (std::size_t k = 0; k < L; ++k) {
+		if (active[k]) {
+			lane_state(k, s);
+			for (; lanes[k].block != lanes[k].blocks; ++lanes[k].block) {
+				Traits::compress(s, lanes[k].next());
+			}
+			finish(k, s);
+		}
+	}
+}
+
+#ifdef ESL_ARCH_X86_ANY
+
+// W[i]: word i of the 8 blocks
+ESL_ATTR_TARGET("avx2")
+inline void load_transposed_avx2_(const unsigned char* const (&blocks)[8], __m256i (&W)[16]) noexcept {
+	for (int half = 0; half < 2; ++half) {
+		__m256i r[8];
+		for (int k = 0; k < 8; ++k) {
+			r[k] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(blocks[k] + half * 32));
+		}
+		// 8x8 transpose of 32-bit words: 4x4 in each 128-bit lane, then the lanes
+		__m256i t[8];
+		for (int i = 0; i < 4; ++i) {
+			t[i * 2] = _mm256_unpacklo_epi32(r[i * 2], r[i * 2 + 1]);
+			t[i * 2 + 1] = _mm256_unpackhi_epi32(r[i * 2], r[i * 2 + 1]);
+		}
+		__m256i u[8];
+		for (int g = 0; g < 2; ++g) {
+			u[g * 4 + 0] = _mm256_unpacklo_epi64(t[g * 4], t[g * 4 + 2]);
+			u[g * 4 + 1] = _mm256_unpackhi_epi64(t[g * 4], t[g * 4 + 2]);
+			u[g * 4 + 2] = _mm256_unpacklo_epi64(t[g * 4 + 1], t[g * 4 + 3]);
+			u[g * 4 + 3] = _mm256_unpackhi_epi64(t[g * 4 + 1], t[g * 4 + 3]);
+		}
+		for (int m = 0; m < 4; ++m) {
+			W[half * 8 + m] = _mm256_permute2x128_si256(u[m], u[4 + m], 0x20);
+			W[half * 8 + 4 + m] = _mm256_permute2x128_si256(u[m], u[4 + m], 0x31);
+		}
+	}
+}
+
+// W[i]: word i of the 16 blocks
+ESL_ATTR_TARGET("avx512f")
+inline void load_transposed_avx512_(const unsigned char* const (&blocks)[16], __m512i (&W)[16]) noexcept {
+	__m512i r[16];
+	for (int k = 0; k < 16; ++k) {
+		r[k] = _mm512_loadu_si512(blocks[k]);
+	}
+	// 16x16 transpose of 32-bit words: 4x4 in each 128-bit lane, then 4x4 of the lanes
+	__m512i t[16];
+	for (int i = 0; i < 8; ++i) {
+		t[i * 2] = _mm512_unpacklo_epi32(r[i * 2], r[i * 2 + 1]);
+		t[i * 2 + 1] = _mm512_unpackhi_epi32(r[i * 2], r[i * 2 + 1]);
+	}
+	__m512i u[16];
+	for (int g = 0; g < 4; ++g) {
+		u[g * 4 + 0] = _mm512_unpacklo_epi64(t[g * 4], t[g * 4 + 2]);
+		u[g * 4 + 1] = _mm512_unpackhi_epi64(t[g * 4], t[g * 4 + 2]);
+		u[g * 4 + 2] = _mm512_unpacklo_epi64(t[g * 4 + 1], t[g * 4 + 3]);
+		u[g * 4 + 3] = _mm512_unpackhi_epi64(t[g * 4 + 1], t[g * 4 + 3]);
+	}
+	for (int m = 0; m < 4; ++m) {
+		const __m512i x = _mm512_shuffle_i32x4(u[m], u[4 + m], _MM_SHUFFLE(2, 0, 2, 0));
+		const __m512i y = _mm512_shuffle_i32x4(u[m], u[4 + m], _MM_SHUFFLE(3, 1, 3, 1));
+		const __m512i z = _mm512_shuffle_i32x4(u[8 + m], u[12 + m], _MM_SHUFFLE(2, 0, 2, 0));
+		const __m512i w = _mm512_shuffle_i32x4(u[8 + m], u[12 + m], _MM_SHUFFLE(3, 1, 3, 1));
+		W[m] = _mm512_shuffle_i32x4(x, z, _MM_SHUFFLE(2, 0, 2, 0));
+		W[4 + m] = _mm512_shuffle_i32x4(y, w, _MM_SHUFFLE(2, 0, 2, 0));
+		W[8 + m] = _mm512_shuffle_i32x4(x, z, _MM_SHUFFLE(3, 1, 3, 1));
+		W[12 + m] = _mm512_shuffle_i32x4(y, w, _MM_SHUFFLE(3, 1, 3, 1));
+	}
+}
+
+#	define ESL_MD5V_ADD_(x, y) _mm_add_epi32(x, y)
+#	define ESL_MD5V_SET1_(t) _mm_set1_epi32(static_cast<int>(t))
+#	define ESL_MD5V_ROTL_(x, s) _mm_or_si128(_mm_slli_epi32(x, s), _mm_srli_epi32(x, 32 - (s)))
+#	define ESL_MD5V_F_(b, c, d) _mm_xor_si128(d, _mm_and_si128(b, _mm_xor_si128(c, d)))
+#	define ESL_MD5V_G_(b, c, d) _mm_xor_si128(c, _mm_and_si128(d, _mm_xor_si128(c, b)))
+#	define ESL_MD5V_H_(b, c, d) _mm_xor_si128(_mm_xor_si128(b, c), d)
+#	define ESL_MD5V_I_(b, c, d) _mm_xor_si128(c, _mm_or_si128(b, _mm_xor_si128(d, _mm_set1_epi32(-1))))
+
+ESL_ATTR_TARGET("sse2")
+void md5_compress_sse2_(std::uint32_t (&state)[4][4], const unsigned char* const (&blocks)[4]) noexcept {
+	__m128i W[16];
+	for (int q = 0; q < 4; ++q) {
+		__m128i r[4];
+		for (int k = 0; k < 4; ++k) {
+			r[k] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks[k] + q * 16));
+		}
+		// 4x4 transpose of 32-bit words
+		const __m128i t0 = _mm_unpacklo_epi32(r[0], r[1]);
+		const __m128i t1 = _mm_unpackhi_epi32(r[0], r[1]);
+		const __m128i t2 = _mm_unpacklo_epi32(r[2], r[3]);
+		const __m128i t3 = _mm_unpackhi_epi32(r[2], r[3]);
+		W[q * 4 + 0] = _mm_unpacklo_epi64(t0, t2);
+		W[q * 4 + 1] = _mm_unpackhi_epi64(t0, t2);
+		W[q * 4 + 2] = _mm_unpacklo_epi64(t1, t3);
+		W[q * 4 + 3] = _mm_unpackhi_epi64(t1, t3);
+	}
+	const __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state[0]));
+	const __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state[1]));
+	const __m128i c0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state[2]));
+	const __m128i d0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state[3]));
+	__m128i a = a0, b = b0, c = c0, d = d0;
+	ESL_MD5V_ROUNDS_(a, b, c, d, W)
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(state[0]), _mm_add_epi32(a, a0));
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(state[1]), _mm_add_epi32(b, b0));
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(state[2]), _mm_add_epi32(c, c0));
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(state[3]), _mm_add_epi32(d, d0));
+}
+
+#	undef ESL_MD5V_ADD_
+#	undef ESL_MD5V_SET1_
+#	undef ESL_MD5V_ROTL_
+#	undef ESL_MD5V_F_
+#	undef ESL_MD5V_G_
+#	undef ESL_MD5V_H_
+#	undef ESL_MD5V_I_
+
+#	define ESL_MD5V_ADD_(x, y) _mm256_add_epi32(x, y)
+#	define ESL_MD5V_SET1_(t) _mm256_set1_epi32(static_cast<int>(t))
+#	define ESL_MD5V_ROTL_(x, s) _mm256_or_si256(_mm256_slli_epi32(x, s), _mm256_srli_epi32(x, 32 - (s)))
+#	define ESL_MD5V_F_(b, c, d) _mm256_xor_si256(d, _mm256_and_si256(b, _mm256_xor_si256(c, d)))
+#	define ESL_MD5V_G_(b, c, d) _mm256_xor_si256(c, _mm256_and_si256(d, _mm256_xor_si256(c, b)))
+#	define ESL_MD5V_H_(b, c, d) _mm256_xor_si256(_mm256_xor_si256(b, c), d)
+#	define ESL_MD5V_I_(b, c, d) _mm256_xor_si256(c, _mm256_or_si256(b, _mm256_xor_si256(d, _mm256_set1_epi32(-1))))
+
+ESL_ATTR_TARGET("avx2")
+void md5_compress_avx2_(std::uint32_t (&state)[4][8], const unsigned char* const (&blocks)[8]) noexcept {
+	__m256i W[16];
+	load_transposed_avx2_(blocks, W);
+	const __m256i a0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[0]));
+	const __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[1]));
+	const __m256i c0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[2]));
+	const __m256i d0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[3]));
+	__m256i a = a0, b = b0, c = c0, d = d0;
+	ESL_MD5V_ROUNDS_(a, b, c, d, W)
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(state[0]), _mm256_add_epi32(a, a0));
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(state[1]), _mm256_add_epi32(b, b0));
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(state[2]), _mm256_add_epi32(c, c0));
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(state[3]), _mm256_add_epi32(d, d0));
+}
+
+#	undef ESL_MD5V_ADD_
+#	undef ESL_MD5V_SET1_
+#	undef ESL_MD5V_ROTL_
+#	undef ESL_MD5V_F_
+#	undef ESL_MD5V_G_
+#	undef ESL_MD5V_H_
+#	undef ESL_MD5V_I_
+
+// The step functions are single ternary logic instructions, the immediates are their truth tables
+#	define ESL_MD5V_ADD_(x, y) _mm512_add_epi32(x, y)
+#	define ESL_MD5V_SET1_(t) _mm512_set1_epi32(static_cast<int>(t))
+#	define ESL_MD5V_ROTL_(x, s) _mm512_rol_epi32(x, s)
+#	define ESL_MD5V_F_(b, c, d) _mm512_ternarylogic_epi32(b, c, d, 0xCA)
+#	define ESL_MD5V_G_(b, c, d) _mm512_ternarylogic_epi32(b, c, d, 0xE4)
+#	define ESL_MD5V_H_(b, c, d) _mm512_ternarylogic_epi32(b, c, d, 0x96)
+#	define ESL_MD5V_I_(b, c, d) _mm512_ternarylogic_epi32(b, c, d, 0x39)
+
+ESL_ATTR_TARGET("avx512f")
+void md5_compress_avx512_(std::uint32_t (&state)[4][16], const unsigned char* const (&blocks)[16]) noexcept {
+	__m512i W[16];
+	load_transposed_avx512_(blocks, W);
+	const __m512i a0 = _mm512_loadu_si512(state[0]);
+	const __m512i b0 = _mm512_loadu_si512(state[1]);
+	const __m512i c0 = _mm512_loadu_si512(state[2]);
+	const __m512i d0 = _mm512_loadu_si512(state[3]);
+	__m512i a = a0, b = b0, c = c0, d = d0;
+	ESL_MD5V_ROUNDS_(a, b, c, d, W)
+	_mm512_storeu_si512(state[0], _mm512_add_epi32(a, a0));
+	_mm512_storeu_si512(state[1], _mm512_add_epi32(b, b0));
+	_mm512_storeu_si512(state[2], _mm512_add_epi32(c, c0));
+	_mm512_storeu_si512(state[3], _mm512_add_epi32(d, d0));
+}
+
+#	undef ESL_MD5V_ADD_
+#	undef ESL_MD5V_SET1_
+#	undef ESL_MD5V_ROTL_
+#	undef ESL_MD5V_F_
+#	undef ESL_MD5V_G_
+#	undef ESL_MD5V_H_
+#	undef ESL_MD5V_I_
+
+#endif
+
+#undef ESL_MD5V_STEP_
+#undef ESL_MD5V_ROUNDS_
+
+// sha1/sha256 compression, one block after another
+
+constexpr std::uint32_t sha256_k_[64] = {
+	0x428a2f98U, 0x71374491U, 0xb5c0fbcfU, 0xe9b5dba5U, 0x3956c25bU, 0x59f111f1U, 0x923f82a4U, 0xab1c5ed5U,
+	0xd807aa98U, 0x12835b01U, 0x243185beU, 0x550c7dc3U, 0x72be5d74U, 0x80deb1feU, 0x9bdc06a7U, 0xc19bf174U,
+	0xe49b69c1U, 0xefbe4786U, 0x0fc19dc6U, 0x240ca1ccU, 0x2de92c6fU, 0x4a7484aaU, 0x5cb0a9dcU, 0x76f988daU,
+	0x983e5152U, 0xa831c66dU, 0xb00327c8U, 0xbf597fc7U, 0xc6e00bf3U, 0xd5a79147U, 0x06ca6351U, 0x14292967U,
+	0x27b70a85U, 0x2e1b2138U, 0x4d2c6dfcU, 0x53380d13U, 0x650a7354U, 0x766a0abbU, 0x81c2c92eU, 0x92722c85U,
+	0xa2bfe8a1U, 0xa81a664bU, 0xc24b8b70U, 0xc76c51a3U, 0xd192e819U, 0xd6990624U, 0xf40e3585U, 0x106aa070U,
+	0x19a4c116U, 0x1e376c08U, 0x2748774cU, 0x34b0bcb5U, 0x391c0cb3U, 0x4ed8aa4aU, 0x5b9cca4fU, 0x682e6ff3U,
+	0x748f82eeU, 0x78a5636fU, 0x84c87814U, 0x8cc70208U, 0x90befffaU, 0xa4506cebU, 0xbef9a3f7U, 0xc67178f2U,
+};
+
+constexpr std::uint32_t sha1_k_[4] = {0x5a827999U, 0x6ed9eba1U, 0x8f1bbcdcU, 0xca62c1d6U};
+
+void sha1_compress_portable_(std::uint32_t (&state)[5], const unsigned char* p, std::size_t n) noexcept {
+	for (; n != 0; --n, p += 64) {
+		std::uint32_t W[16];
+		for (int i = 0; i < 16; ++i) {
+			W[i] = load32be(p + i * 4);
+		}
+		std::uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+		for (int t = 0; t < 80; ++t) {
+			if (t >= 16) {
+				W[t & 15] = rotl(W[(t - 3) & 15] ^ W[(t - 8) & 15] ^ W[(t - 14) & 15] ^ W[t & 15], 1);
+			}
+			std::uint32_t f;
+			if (t < 20) {
+				f = d ^ (b & (c ^ d));
+			} else if (t < 40 || t >= 60) {
+				f = b ^ c ^ d;
+			} else {
+				f = (b & c) | (d & (b | c));
+			}
+			const std::uint32_t tmp = rotl(a, 5) + f + e + sha1_k_[t / 20] + W[t & 15];
+			e = d;
+			d = c;
+			c = rotl(b, 30);
+			b = a;
+			a = tmp;
+		}
+		state[0] += a;
+		state[1] += b;
+		state[2] += c;
+		state[3] += d;
+		state[4] += e;
+	}
+}
+
+void sha256_compress_portable_(std::uint32_t (&state)[8], const unsigned char* p, std::size_t n) noexcept {
+	for (; n != 0; --n, p += 64) {
+		std::uint32_t W[16];
+		for (int i = 0; i < 16; ++i) {
+			W[i] = load32be(p + i * 4);
+		}
+		std::uint32_t s[8];
+		std::memcpy(s, state, sizeof(s));
+		for (int t = 0; t < 64; ++t) {
+			if (t >= 16) {
+				const std::uint32_t w15 = W[(t - 15) & 15];
+				const std::uint32_t w2 = W[(t - 2) & 15];
+				W[t & 15] += (rotr(w15, 7) ^ rotr(w15, 18) ^ (w15 >> 3)) + W[(t - 7) & 15] + (rotr(w2, 17) ^ rotr(w2, 19) ^ (w2 >> 10));
+			}
+			const std::uint32_t e = s[4];
+			const std::uint32_t a = s[0];
+			const std::uint32_t t1 = s[7] + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + (s[6] ^ (e & (s[5] ^ s[6]))) + sha256_k_[t] + W[t & 15];
+			const std::uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & s[1]) | (s[2] & (a | s[1])));
+			s[7] = s[6];
+			s[6] = s[5];
+			s[5] = e;
+			s[4] = s[3] + t1;
+			s[3] = s[2];
+			s[2] = s[1];
+			s[1] = a;
+			s[0] = t1 + t2;
+		}
+		for (int i = 0; i < 8; ++i) {
+			state[i] += s[i];
+		}
+	}
+}
+
+#ifdef ESL_ARCH_X86_ANY
+
+// SHA extensions, see "Intel SHA Extensions" (Intel) and its reference code
+// Every step does 4 rounds, the message schedule of the next steps is interleaved with them
+
+#	define ESL_SHA1NI_STEP_(f, w, x, y, z) \
+	w = _mm_sha1msg2_epu32(_mm_xor_si128(_mm_sha1msg1_epu32(w, x), y), z); \
+	e = _mm_sha1nexte_epu32(prev, w); \
+	prev = abcd; \
+	abcd = _mm_sha1rnds4_epu32(abcd, e, f);
+
+ESL_ATTR_TARGET("sha,sse4.1")
+void sha1_compress_shani_(std::uint32_t (&state)[5], const unsigned char* p, std::size_t n) noexcept {
+	// Message words in reverse order, W[0] in the highest lane
+	const __m128i mask = _mm_set_epi64x(0x0001020304050607LL, 0x08090a0b0c0d0e0fLL);
+	__m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0x1B);
+	__m128i e0 = _mm_set_epi32(static_cast<int>(state[4]), 0, 0, 0);
+	for (; n != 0; --n, p += 64) {
+		const __m128i abcd_save = abcd;
+		__m128i m0 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), mask);
+		__m128i m1 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16)), mask);
+		__m128i m2 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 32)), mask);
+		__m128i m3 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 48)), mask);
+		__m128i e = _mm_add_epi32(e0, m0);
+		__m128i prev = abcd;
+		abcd = _mm_sha1rnds4_epu32(abcd, e, 0);
+		e = _mm_sha1nexte_epu32(prev, m1);
+		prev = abcd;
+		abcd = _mm_sha1rnds4_epu32(abcd, e, 0);
+		e = _mm_sha1nexte_epu32(prev, m2);
+		prev = abcd;
+		abcd = _mm_sha1rnds4_epu32(abcd, e, 0);
+		e = _mm_sha1nexte_epu32(prev, m3);
+		prev = abcd;
+		abcd = _mm_sha1rnds4_epu32(abcd, e, 0);
+		ESL_SHA1NI_STEP_(0, m0, m1, m2, m3)
+		ESL_SHA1NI_STEP_(1, m1, m2, m3, m0)
+		ESL_SHA1NI_STEP_(1, m2, m3, m0, m1)
+		ESL_SHA1NI_STEP_(1, m3, m0, m1, m2)
+		ESL_SHA1NI_STEP_(1, m0, m1, m2, m3)
+		ESL_SHA1NI_STEP_(1, m1, m2, m3, m0)
+		ESL_SHA1NI_STEP_(2, m2, m3, m0, m1)
+		ESL_SHA1NI_STEP_(2, m3, m0, m1, m2)
+		ESL_SHA1NI_STEP_(2, m0, m1, m2, m3)
+		ESL_SHA1NI_STEP_(2, m1, m2, m3, m0)
+		ESL_SHA1NI_STEP_(2, m2, m3, m0, m1)
+		ESL_SHA1NI_STEP_(3, m3, m0, m1, m2)
+		ESL_SHA1NI_STEP_(3, m0, m1, m2, m3)
+		ESL_SHA1NI_STEP_(3, m1, m2, m3, m0)
+		ESL_SHA1NI_STEP_(3, m2, m3, m0, m1)
+		ESL_SHA1NI_STEP_(3, m3, m0, m1, m2)
+		e0 = _mm_sha1nexte_epu32(prev, e0);
+		abcd = _mm_add_epi32(abcd, abcd_save);
+	}
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_shuffle_epi32(abcd, 0x1B));
+	state[4] = static_cast<std::uint32_t>(_mm_extract_epi32(e0, 3));
+}
+
+#	undef ESL_SHA1NI_STEP_
+
+#	define ESL_SHA256NI_ROUNDS_(j, w) \
+	k = _mm_add_epi32(w, _mm_loadu_si128(reinterpret_cast<const __m128i*>(sha256_k_ + (j) * 4))); \
+	state1 = _mm_sha256rnds2_epu32(state1, state0, k); \
+	state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(k, 0x0E));
+#	define ESL_SHA256NI_STEP_(j, w, x, y, z) \
+	w = _mm_sha256msg2_epu32(_mm_add_epi32(_mm_sha256msg1_epu32(w, x), _mm_alignr_epi8(z, y, 4)), z); \
+	ESL_SHA256NI_ROUNDS_(j, w)
+
+ESL_ATTR_TARGET("sha,sse4.1")
+void sha256_compress_shani_(std::uint32_t (&state)[8], const unsigned char* p, std::size_t n) noexcept {
+	const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bLL, 0x0405060700010203LL);
+	// The rounds take the state as ABEF and CDGH
+	const __m128i dcba = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state));
+	const __m128i hgfe = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state + 4));
+	const __m128i cdab = _mm_shuffle_epi32(dcba, 0xB1);
+	const __m128i efgh = _mm_shuffle_epi32(hgfe, 0x1B);
+	__m128i state0 = _mm_alignr_epi8(cdab, efgh, 8);
+	__m128i state1 = _mm_blend_epi16(efgh, cdab, 0xF0);
+	for (; n != 0; --n, p += 64) {
+		const __m128i abef_save = state0;
+		const __m128i cdgh_save = state1;
+		__m128i k;
+		__m128i m0 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), mask);
+		ESL_SHA256NI_ROUNDS_(0, m0)
+		__m128i m1 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16)), mask);
+		ESL_SHA256NI_ROUNDS_(1, m1)
+		__m128i m2 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 32)), mask);
+		ESL_SHA256NI_ROUNDS_(2, m2)
+		__m128i m3 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 48)), mask);
+		ESL_SHA256NI_ROUNDS_(3, m3)
+		ESL_SHA256NI_STEP_(4, m0, m1, m2, m3)
+		ESL_SHA256NI_STEP_(5, m1, m2, m3, m0)
+		ESL_SHA256NI_STEP_(6, m2, m3, m0, m1)
+		ESL_SHA256NI_STEP_(7, m3, m0, m1, m2)
+		ESL_SHA256NI_STEP_(8, m0, m1, m2, m3)
+		ESL_SHA256NI_STEP_(9, m1, m2, m3, m0)
+		ESL_SHA256NI_STEP_(10, m2, m3, m0, m1)
+		ESL_SHA256NI_STEP_(11, m3, m0, m1, m2)
+		ESL_SHA256NI_STEP_(12, m0, m1, m2, m3)
+		ESL_SHA256NI_STEP_(13, m1, m2, m3, m0)
+		ESL_SHA256NI_STEP_(14, m2, m3, m0, m1)
+		ESL_SHA256NI_STEP_(15, m3, m0, m1, m2)
+		state0 = _mm_add_epi32(state0, abef_save);
+		state1 = _mm_add_epi32(state1, cdgh_save);
+	}
+	const __m128i feba = _mm_shuffle_epi32(state0, 0x1B);
+	const __m128i dchg = _mm_shuffle_epi32(state1, 0xB1);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_blend_epi16(feba, dchg, 0xF0));
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(state + 4), _mm_alignr_epi8(dchg, feba, 8));
+}
+
+#	undef ESL_SHA256NI_ROUNDS_
+#	undef ESL_SHA256NI_STEP_
+
+#endif
+
+// Multi-buffer sha1/sha256 as md5 above, the message words are byte swapped after the transpose
+// V is the vector type, the operations are defined for each instruction set before expanding the rounds
+
+#define ESL_SHA1V_ROUNDS_(V, s, W) \
+	{ \
+		V a = s[0], b = s[1], c = s[2], d = s[3], e = s[4]; \
+		for (int t = 0; t < 80; ++t) { \
+			if (t >= 16) { \
+				W[t & 15] = ESL_SHAV_ROTL_(ESL_SHAV_XOR4_(W[(t - 3) & 15], W[(t - 8) & 15], W[(t - 14) & 15], W[t & 15]), 1); \
+			} \
+			const V f = t < 20 ? ESL_SHAV_CH_(b, c, d) : (t < 40 || t >= 60) ? ESL_SHAV_PARITY_(b, c, d) : ESL_SHAV_MAJ_(b, c, d); \
+			const V tmp = ESL_SHAV_ADD_(ESL_SHAV_ADD_(ESL_SHAV_ROTL_(a, 5), f), \
+				ESL_SHAV_ADD_(ESL_SHAV_ADD_(e, ESL_SHAV_SET1_(sha1_k_[t / 20])), W[t & 15])); \
+			e = d; \
+			d = c; \
+			c = ESL_SHAV_ROTL_(b, 30); \
+			b = a; \
+			a = tmp; \
+		} \
+		s[0] = ESL_SHAV_ADD_(s[0], a); \
+		s[1] = ESL_SHAV_ADD_(s[1], b); \
+		s[2] = ESL_SHAV_ADD_(s[2], c); \
+		s[3] = ESL_SHAV_ADD_(s[3], d); \
+		s[4] = ESL_SHAV_ADD_(s[4], e); \
+	}
+
+#define ESL_SHA256V_ROUNDS_(V, s, W) \
+	{ \
+		V a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7]; \
+		for (int t = 0; t < 64; ++t) { \
+			if (t >= 16) { \
+				const V w15 = W[(t - 15) & 15]; \
+				const V w2 = W[(t - 2) & 15]; \
+				W[t & 15] = ESL_SHAV_ADD_( \
+					ESL_SHAV_ADD_(W[t & 15], ESL_SHAV_PARITY_(ESL_SHAV_ROTR_(w15, 7), ESL_SHAV_ROTR_(w15, 18), ESL_SHAV_SHR_(w15, 3))), \
+					ESL_SHAV_ADD_(W[(t - 7) & 15], ESL_SHAV_PARITY_(ESL_SHAV_ROTR_(w2, 17), ESL_SHAV_ROTR_(w2, 19), ESL_SHAV_SHR_(w2, 10)))); \
+			} \
+			const V t1 = ESL_SHAV_ADD_( \
+				ESL_SHAV_ADD_(h, ESL_SHAV_PARITY_(ESL_SHAV_ROTR_(e, 6), ESL_SHAV_ROTR_(e, 11), ESL_SHAV_ROTR_(e, 25))), \
+				ESL_SHAV_ADD_(ESL_SHAV_ADD_(ESL_SHAV_CH_(e, f, g), ESL_SHAV_SET1_(sha256_k_[t])), W[t & 15])); \
+			const V t2 = ESL_SHAV_ADD_(ESL_SHAV_PARITY_(ESL_SHAV_ROTR_(a, 2), ESL_SHAV_ROTR_(a, 13), ESL_SHAV_ROTR_(a, 22)), ESL_SHAV_MAJ_(a, b, c)); \
+			h = g; \
+			g = f; \
+			f = e; \
+			e = ESL_SHAV_ADD_(d, t1); \
+			d = c; \
+			c = b; \
+			b = a; \
+			a = ESL_SHAV_ADD_(t1, t2); \
+		} \
+		s[0] = ESL_SHAV_ADD_(s[0], a); \
+		s[1] = ESL_SHAV_ADD_(s[1], b); \
+		s[2] = ESL_SHAV_ADD_(s[2], c); \
+		s[3] = ESL_SHAV_ADD_(s[3], d); \
+		s[4] = ESL_SHAV_ADD_(s[4], e); \
+		s[5] = ESL_SHAV_ADD_(s[5], f); \
+		s[6] = ESL_SHAV_ADD_(s[6], g); \
+		s[7] = ESL_SHAV_ADD_(s[7], h); \
+	}
+
+#ifdef ESL_ARCH_X86_ANY
+
+#	define ESL_SHAV_ADD_(x, y) _mm256_add_epi32(x, y)
+#	define ESL_SHAV_SET1_(t) _mm256_set1_epi32(static_cast<int>(t))
+#	define ESL_SHAV_SHR_(x, s) _mm256_srli_epi32(x, s)
+#	define ESL_SHAV_ROTR_(x, s) _mm256_or_si256(_mm256_srli_epi32(x, s), _mm256_slli_epi32(x, 32 - (s)))
+#	define ESL_SHAV_ROTL_(x, s) _mm256_or_si256(_mm256_slli_epi32(x, s), _mm256_srli_epi32(x, 32 - (s)))
+#	define ESL_SHAV_PARITY_(x, y, z) _mm256_xor_si256(_mm256_xor_si256(x, y), z)
+#	define ESL_SHAV_XOR4_(w, x, y, z) _mm256_xor_si256(_mm256_xor_si256(w, x), _mm256_xor_si256(y, z))
+#	define ESL_SHAV_CH_(x, y, z) _mm256_xor_si256(z, _mm256_and_si256(x, _mm256_xor_si256(y, z)))
+#	define ESL_SHAV_MAJ_(x, y, z) _mm256_or_si256(_mm256_and_si256(x, y), _mm256_and_si256(z, _mm256_or_si256(x, y)))
+
+ESL_ATTR_TARGET("avx2")
+inline void load_transposed_be_avx2_(const unsigned char* const (&blocks)[8], __m256i (&W)[16]) noexcept {
+	load_transposed_avx2_(blocks, W);
+	const __m256i mask = _mm256_set_epi64x(0x0c0d0e0f08090a0bLL, 0x0405060700010203LL, 0x0c0d0e0f08090a0bLL, 0x0405060700010203LL);
+	for (int i = 0; i < 16; ++i) {
+		W[i] = _mm256_shuffle_epi8(W[i], mask);
+	}
+}
+
+ESL_ATTR_TARGET("avx2")
+void sha1_compress_avx2_(std::uint32_t (&state)[5][8], const unsigned char* const (&blocks)[8]) noexcept {
+	__m256i W[16];
+	load_transposed_be_avx2_(blocks, W);
+	__m256i s[5];
+	for (int i = 0; i < 5; ++i) {
+		s[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[i]));
+	}
+	ESL_SHA1V_ROUNDS_(__m256i, s, W)
+	for (int i = 0; i < 5; ++i) {
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(state[i]), s[i]);
+	}
+}
+
+ESL_ATTR_TARGET("avx2")
+void sha256_compress_avx2_(std::uint32_t (&state)[8][8], const unsigned char* const (&blocks)[8]) noexcept {
+	__m256i W[16];
+	load_transposed_be_avx2_(blocks, W);
+	__m256i s[8];
+	for (int i = 0; i < 8; ++i) {
+		s[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[i]));
+	}
+	ESL_SHA256V_ROUNDS_(__m256i, s, W)
+	for (int i = 0; i < 8; ++i) {
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(state[i]), s[i]);
+	}
+}
+
+#	undef ESL_SHAV_ADD_
+#	undef ESL_SHAV_SET1_
+#	undef ESL_SHAV_SHR_
+#	undef ESL_SHAV_ROTR_
+#	undef ESL_SHAV_ROTL_
+#	undef ESL_SHAV_PARITY_
+#	undef ESL_SHAV_XOR4_
+#	undef ESL_SHAV_CH_
+#	undef ESL_SHAV_MAJ_
+
+#	define ESL_SHAV_ADD_(x, y) _mm512_add_epi32(x, y)
+#	define ESL_SHAV_SET1_(t) _mm512_set1_epi32(static_cast<int>(t))
+#	define ESL_SHAV_SHR_(x, s) _mm512_srli_epi32(x, s)
+#	define ESL_SHAV_ROTR_(x, s) _mm512_ror_epi32(x, s)
+#	define ESL_SHAV_ROTL_(x, s) _mm512_rol_epi32(x, s)
+#	define ESL_SHAV_PARITY_(x, y, z) _mm512_ternarylogic_epi32(x, y, z, 0x96)
+#	define ESL_SHAV_XOR4_(w, x, y, z) _mm512_ternarylogic_epi32(w, x, _mm512_xor_si512(y, z), 0x96)
+#	define ESL_SHAV_CH_(x, y, z) _mm512_ternarylogic_epi32(x, y, z, 0xCA)
+#	define ESL_SHAV_MAJ_(x, y, z) _mm512_ternarylogic_epi32(x, y, z, 0xE8)
+
+ESL_ATTR_TARGET("avx512f")
+inline void load_transposed_be_avx512_(const unsigned char* const (&blocks)[16], __m512i (&W)[16]) noexcept {
+	load_transposed_avx512_(blocks, W);
+	// Byte swap without avx512bw: bytes 0 and 2 from rotl 8, bytes 1 and 3 from rotr 8
+	const __m512i mask = _mm512_set1_epi32(0x00FF00FF);
+	for (int i = 0; i < 16; ++i) {
+		W[i] = _mm512_ternarylogic_epi32(mask, _mm512_rol_epi32(W[i], 8), _mm512_ror_epi32(W[i], 8), 0xCA);
+	}
+}
+
+ESL_ATTR_TARGET("avx512f")
+void sha1_compress_avx512_(std::uint32_t (&state)[5][16], const unsigned char* const (&blocks)[16]) noexcept {
+	__m512i W[16];
+	load_transposed_be_avx512_(blocks, W);
+	__m512i s[5];
+	for (int i = 0; i < 5; ++i) {
+		s[i] = _mm512_loadu_si512(state[i]);
+	}
+	ESL_SHA1V_ROUNDS_(__m512i, s, W)
+	for (int i = 0; i < 5; ++i) {
+		_mm512_storeu_si512(state[i], s[i]);
+	}
+}
+
+ESL_ATTR_TARGET("avx512f")
+void sha256_compress_avx512_(std::uint32_t (&state)[8][16], const unsigned char* const (&blocks)[16]) noexcept {
+	__m512i W[16];
+	load_transposed_be_avx512_(blocks, W);
+	__m512i s[8];
+	for (int i = 0; i < 8; ++i) {
+		s[i] = _mm512_loadu_si512(state[i]);
+	}
+	ESL_SHA256V_ROUNDS_(__m512i, s, W)
+	for (int i = 0; i < 8; ++i) {
+		_mm512_storeu_si512(state[i], s[i]);
+	}
+}
+
+#	undef ESL_SHAV_ADD_
+#	undef ESL_SHAV_SET1_
+#	undef ESL_SHAV_SHR_
+#	undef ESL_SHAV_ROTR_
+#	undef ESL_SHAV_ROTL_
+#	undef ESL_SHAV_PARITY_
+#	undef ESL_SHAV_XOR4_
+#	undef ESL_SHAV_CH_
+#	undef ESL_SHAV_MAJ_
+
+#endif
+
+#undef ESL_SHA1V_ROUNDS_
+#undef ESL_SHA256V_ROUNDS_
+
+// fast_hash stripes, accumulated by 64-bit lanes with 32x32->64 multiplies (pmuludq)
+// Kernels keep the accumulators in registers for the whole run and scramble them at each block end
+
+#ifdef ESL_ARCH_X86_ANY
+
+ESL_ATTR_TARGET("sse2")
+void fast_hash_accumulate_sse2_(std::uint64_t (&acc)[8], const unsigned char* p, std::size_t stripes, const unsigned char* secret,
+		std::size_t& stripe) noexcept {
+	__m128i a[4];
+	for (int i = 0; i < 4; ++i) {
+		a[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc) + i);
+	}
+	const __m128i prime = _mm_set1_epi32(static_cast<int>(fast_hash_prime32_1_));
+	for (; stripes != 0; --stripes, p += 64) {
+		const unsigned char* key = secret + stripe * 8;
+		for (int i = 0; i < 4; ++i) {
+			const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p) + i);
+			const __m128i k = _mm_xor_si128(data, _mm_loadu_si128(reinterpret_cast<const __m128i*>(key) + i));
+			const __m128i product = _mm_mul_epu32(k, _mm_shuffle_epi32(k, _MM_SHUFFLE(0, 3, 0, 1)));
+			a[i] = _mm_add_epi64(a[i], _mm_add_epi64(product, _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2))));
+		}
+		if (++stripe == 16) {
+			stripe = 0;
+			const unsigned char* scramble_key = secret + 128;
+			for (int i = 0; i < 4; ++i) {
+				__m128i x = _mm_xor_si128(a[i], _mm_srli_epi64(a[i], 47));
+				x = _mm_xor_si128(x, _mm_loadu_si128(reinterpret_cast<const __m128i*>(scramble_key) + i));
+				const __m128i lo = _mm_mul_epu32(x, prime);
+				const __m128i hi = _mm_mul_epu32(_mm_shuffle_epi32(x, _MM_SHUFFLE(0, 3, 0, 1)), prime);
+				a[i] = _mm_add_epi64(lo, _mm_slli_epi64(hi, 32));
+			}
+		}
+	}
+	for (int i = 0; i < 4; ++i) {
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(acc) + i, a[i]);
+	}
+}
+
+ESL_ATTR_TARGET("avx2")
+void fast_hash_accumulate_avx2_(std::uint64_t (&acc)[8], const unsigned char* p, std::size_t stripes, const unsigned char* secret,
+		std::size_t& stripe) noexcept {
+	__m256i a[2];
+	for (int i = 0; i < 2; ++i) {
+		a[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc) + i);
+	}
+	const __m256i prime = _mm256_set1_epi32(static_cast<int>(fast_hash_prime32_1_));
+	for (; stripes != 0; --stripes, p += 64) {
+		const unsigned char* key = secret + stripe * 8;
+		for (int i = 0; i < 2; ++i) {
+			const __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p) + i);
+			const __m256i k = _mm256_xor_si256(data, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(key) + i));
+			const __m256i product = _mm256_mul_epu32(k, _mm256_shuffle_epi32(k, _MM_SHUFFLE(0, 3, 0, 1)));
+			a[i] = _mm256_add_epi64(a[i], _mm256_add_epi64(product, _mm256_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2))));
+		}
+		if (++stripe == 16) {
+			stripe = 0;
+			const unsigned char* scramble_key = secret + 128;
+			for (int i = 0; i < 2; ++i) {
+				__m256i x = _mm256_xor_si256(a[i], _mm256_srli_epi64(a[i], 47));
+				x = _mm256_xor_si256(x, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(scramble_key) + i));
+				const __m256i lo = _mm256_mul_epu32(x, prime);
+				const __m256i hi = _mm256_mul_epu32(_mm256_shuffle_epi32(x, _MM_SHUFFLE(0, 3, 0, 1)), prime);
+				a[i] = _mm256_add_epi64(lo, _mm256_slli_epi64(hi, 32));
+			}
+		}
+	}
+	for (int i = 0; i < 2; ++i) {
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(acc) + i, a[i]);
+	}
+}
+
+ESL_ATTR_TARGET("avx512f")
+void fast_hash_accumulate_avx512_(std::uint64_t (&acc)[8], const unsigned char* p, std::size_t stripes, const unsigned char* secret,
+		std::size_t& stripe) noexcept {
+	__m512i a = _mm512_loadu_si512(acc);
+	const __m512i prime = _mm512_set1_epi32(static_cast<int>(fast_hash_prime32_1_));
+	for (; stripes != 0; --stripes, p += 64) {
+		const __m512i data = _mm512_loadu_si512(p);
+		const __m512i k = _mm512_xor_si512(data, _mm512_loadu_si512(secret + stripe * 8));
+		const __m512i product = _mm512_mul_epu32(k, _mm512_shuffle_epi32(k, static_cast<_MM_PERM_ENUM>(_MM_SHUFFLE(0, 3, 0, 1))));
+		a = _mm512_add_epi64(a, _mm512_add_epi64(product, _mm512_shuffle_epi32(data, static_cast<_MM_PERM_ENUM>(_MM_SHUFFLE(1, 0, 3, 2)))));
+		if (++stripe == 16) {
+			stripe = 0;
+			// a ^ (a >> 47) ^ key
+			const __m512i x = _mm512_ternarylogic_epi64(a, _mm512_srli_epi64(a, 47), _mm512_loadu_si512(secret + 128), 0x96);
+			const __m512i lo = _mm512_mul_epu32(x, prime);
+			const __m512i hi = _mm512_mul_epu32(_mm512_shuffle_epi32(x, static_cast<_MM_PERM_ENUM>(_MM_SHUFFLE(0, 3, 0, 1))), prime);
+			a = _mm512_add_epi64(lo, _mm512_slli_epi64(hi, 32));
+		}
+	}
+	_mm512_storeu_si512(acc, a);
+}
+
+#endif
+
+} // namespace
+
+void fast_hash_accumulate_(std::uint64_t (&acc)[8], const unsigned char* p, std::size_t stripes, const unsigned char* secret, std::size_t& stripe) noexcept {
+#ifdef ESL_ARCH_X86_ANY
+	const auto& features = current_cpu_features();
+	if (features.avx512f) {
+		return fast_hash_accumulate_avx512_(acc, p, stripes, secret, stripe);
+	}
+	if (features.avx2) {
+		return fast_hash_accumulate_avx2_(acc, p, stripes, secret, stripe);
+	}
+	if (features.sse2) {
+		return fast_hash_accumulate_sse2_(acc, p, stripes, secret, stripe);
+	}
+#endif
+	for (; stripes != 0; --stripes, p += 64) {
+		fast_hash_accumulate_512_(acc, p, secret + stripe * 8);
+		if (++stripe == 16) {
+			stripe = 0;
+			for (std::size_t i = 0; i < 8; ++i) {
+				const std::uint64_t x = acc[i] ^ (acc[i] >> 47) ^ load64le(secret + 128 + i * 8);
+				acc[i] = x * fast_hash_prime32_1_;
+			}
+		}
+	}
+}
+
+std::uint32_t crc32(const void* buf, std::size_t len, std::uint32_t crc) noexcept {
+	const unsigned char* p = static_cast<const unsigned char*>(buf);
+	crc = ~crc;
+#ifdef ESL_ARCH_X86_ANY
+	const auto& features = current_cpu_features();
+	if (len >= 64 && features.pclmul && features.sse41) {
+		const std::size_t n = len & ~static_cast<std::size_t>(15);
+		crc = crc32_pclmul_(p, n, crc);
+		p += n;
+		len -= n;
+	}
+#endif
+	return ~crc32_slicing_(p, len, crc, crc32_slicing_tables_);
+}
+
+std::uint32_t crc32c(const void* buf, std::size_t len, std::uint32_t crc) noexcept {
+	const unsigned char* p = static_cast<const unsigned char*>(buf);
+	crc = ~crc;
+#ifdef ESL_ARCH_X86_ANY
+	if (current_cpu_features().sse42) {
+		return ~crc32c_sse42_(p, len, crc);
+	}
+#endif
+	return ~crc32_slicing_(p, len, crc, crc32c_slicing_tables_);
+}
+
+void md5_many(const span<const unsigned char>* messages, std::size_t n, md5val* out) noexcept {
+#ifdef ESL_ARCH_X86_ANY
+	const auto& features = current_cpu_features();
+	if (features.avx512f) {
+		return digest_many_lanes_<md5_traits_, 16>(messages, n, out, md5_compress_avx512_);
+	}
+	if (features.avx2) {
+		return digest_many_lanes_<md5_traits_, 8>(messages, n, out, md5_compress_avx2_);
+	}
+	if (features.sse2) {
+		return digest_many_lanes_<md5_traits_, 4>(messages, n, out, md5_compress_sse2_);
+	}
+#endif
+	for (std::size_t i = 0; i < n; ++i) {
+		out[i] = md5val(md5(messages[i].data(), messages[i].size()));
+	}
+}
+
+void sha1_compress_(std::uint32_t (&state)[5], const unsigned char* blocks, std::size_t n) noexcept {
+#ifdef ESL_ARCH_X86_ANY
+	const auto& features = current_cpu_features();
+	if (features.sha && features.sse41) {
+		return sha1_compress_shani_(state, blocks, n);
+	}
+#endif
+	sha1_compress_portable_(state, blocks, n);
+}
+
+void sha256_compress_(std::uint32_t (&state)[8], const unsigned char* blocks, std::size_t n) noexcept {
+#ifdef ESL_ARCH_X86_ANY
+	const auto& features = current_cpu_features();
+	if (features.sha && features.sse41) {
+		return sha256_compress_shani_(state, blocks, n);
+	}
+#endif
+	sha256_compress_portable_(state, blocks, n);
+}
+
+// 16 AVX-512 lanes are faster than the SHA extensions, which are faster than 8 AVX2 lanes
+void sha1_many(const span<const unsigned char>* messages, std::size_t n, sha1val* out) noexcept {
+#ifdef ESL_ARCH_X86_ANY
+	const auto& features = current_cpu_features();
+	if (features.avx512f) {
+		return digest_many_lanes_<sha1_traits_, 16>(messages, n, out, sha1_compress_avx512_);
+	}
+	if (features.avx2 && !(features.sha && features.sse41)) {
+		return digest_many_lanes_<sha1_traits_, 8>(messages, n, out, sha1_compress_avx2_);
+	}
+#endif
+	for (std::size_t i = 0; i < n; ++i) {
+		out[i] = sha1val(sha1(messages[i].data(), messages[i].size()));
+	}
+}
+
+void sha256_many(const span<const unsigned char>* messages, std::size_t n, sha256val* out) noexcept {
+#ifdef ESL_ARCH_X86_ANY
+	const auto& features = current_cpu_features();
+	if (features.avx512f) {
+		return digest_many_lanes_<sha256_traits_, 16>(messages, n, out, sha256_compress_avx512_);
+	}
+	if (features.avx2 && !(features.sha && features.sse41)) {
+		return digest_many_lanes_<sha256_traits_, 8>(messages, n, out, sha256_compress_avx2_);
+	}
+#endif
+	for (std::size_t i = 0; i < n; ++i) {
+		out[i] = sha256val(sha256(messages[i].data(), messages[i].size()));
+	}
+}
+
+} // namespace esl
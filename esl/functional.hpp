@@ -1,15 +1,20 @@
 #ifndef ESL_FUNCTIONAL_HPP
 #define ESL_FUNCTIONAL_HPP
 
+#include "executor.hpp"
 #include "intrin.hpp"
 #include "limits.hpp"
+#include "span.hpp"
 #include "utility.hpp"
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
 #include <cstring>
 #include <functional>
 #include <string_view>
 #include <tuple>
+#include <type_traits>
 #include <utility>
 
 #include <unordered_map>
@@ -17,6 +22,392 @@
 
 namespace esl {
 
+// fast_hash
+// XXH3 of xxHash 0.8 (64-bit and 128-bit), see https://github.com/Cyan4973/xxHash/blob/dev/doc/xxhash_spec.md
+// xxHash: Copyright (C) 2012-2021 Yann Collet, BSD 2-Clause License, see NOTICE
+
+inline constexpr std::uint64_t fast_hash_prime32_1_ = 0x9E3779B1U;
+inline constexpr std::uint64_t fast_hash_prime32_2_ = 0x85EBCA77U;
+inline constexpr std::uint64_t fast_hash_prime32_3_ = 0xC2B2AE3DU;
+inline constexpr std::uint64_t fast_hash_prime64_1_ = 0x9E3779B185EBCA87U;
+inline constexpr std::uint64_t fast_hash_prime64_2_ = 0xC2B2AE3D27D4EB4FU;
+inline constexpr std::uint64_t fast_hash_prime64_3_ = 0x165667B19E3779F9U;
+inline constexpr std::uint64_t fast_hash_prime64_4_ = 0x85EBCA77C2B2AE63U;
+inline constexpr std::uint64_t fast_hash_prime64_5_ = 0x27D4EB2F165667C5U;
+
+// Default secret, seeded hashes of more than 240 bytes use a secret derived from it
+inline constexpr std::size_t fast_hash_secret_size_ = 192;
+inline constexpr unsigned char fast_hash_secret_internal_[fast_hash_secret_size_] = {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+    0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+    0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+    0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+    0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+    0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+    0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+    0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+    0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+// return: Low 64 bits of a * b, `hi': high 64 bits
+inline constexpr std::uint64_t fast_hash_mul128_(std::uint64_t a, std::uint64_t b, std::uint64_t& hi) noexcept {
+#ifdef __SIZEOF_INT128__
+    __extension__ using uint128 = unsigned __int128;
+    const uint128 p = static_cast<uint128>(a) * b;
+    hi = static_cast<std::uint64_t>(p >> 64);
+    return static_cast<std::uint64_t>(p);
+#else
+    const std::uint64_t lo_lo = (a & 0xFFFFFFFFU) * (b & 0xFFFFFFFFU);
+    const std::uint64_t hi_lo = (a >> 32) * (b & 0xFFFFFFFFU);
+    const std::uint64_t lo_hi = (a & 0xFFFFFFFFU) * (b >> 32);
+    const std::uint64_t hi_hi = (a >> 32) * (b >> 32);
+    const std::uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFFU) + lo_hi;
+    hi = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+    return (cross << 32) | (lo_lo & 0xFFFFFFFFU);
+#endif
+}
+
+inline constexpr std::uint64_t fast_hash_mul128_fold64_(std::uint64_t a, std::uint64_t b) noexcept {
+    std::uint64_t hi = 0;
+    const std::uint64_t lo = fast_hash_mul128_(a, b, hi);
+    return lo ^ hi;
+}
+
+inline constexpr std::uint64_t fast_hash_swap64_(std::uint64_t x) noexcept {
+    x = ((x & 0x00FF00FF00FF00FFU) << 8) | ((x >> 8) & 0x00FF00FF00FF00FFU);
+    x = ((x & 0x0000FFFF0000FFFFU) << 16) | ((x >> 16) & 0x0000FFFF0000FFFFU);
+    return (x << 32) | (x >> 32);
+}
+
+inline constexpr std::uint32_t fast_hash_swap32_(std::uint32_t x) noexcept {
+    return static_cast<std::uint32_t>(fast_hash_swap64_(x) >> 32);
+}
+
+inline constexpr std::uint64_t fast_hash_xxh64_avalanche_(std::uint64_t h) noexcept {
+    h ^= h >> 33;
+    h *= fast_hash_prime64_2_;
+    h ^= h >> 29;
+    h *= fast_hash_prime64_3_;
+    return h ^ (h >> 32);
+}
+
+inline constexpr std::uint64_t fast_hash_avalanche_(std::uint64_t h) noexcept {
+    h ^= h >> 37;
+    h *= 0x165667919E3779F9U;
+    return h ^ (h >> 32);
+}
+
+inline constexpr std::uint64_t fast_hash_rrmxmx_(std::uint64_t h, std::uint64_t len) noexcept {
+    h ^= rotl(h, 49) ^ rotl(h, 24);
+    h *= 0x9FB21C651E98DF25U;
+    h ^= (h >> 35) + len;
+    h *= 0x9FB21C651E98DF25U;
+    return h ^ (h >> 28);
+}
+
+inline std::uint64_t fast_hash_mix16_(const unsigned char* p, const unsigned char* secret, std::uint64_t seed) noexcept {
+    return fast_hash_mul128_fold64_(load64le(p) ^ (load64le(secret) + seed), load64le(p + 8) ^ (load64le(secret + 8) - seed));
+}
+
+// 128-bit accumulator of the 128-bit variant
+inline void fast_hash_mix32_(std::uint64_t (&acc)[2], const unsigned char* p1, const unsigned char* p2, const unsigned char* secret,
+                             std::uint64_t seed) noexcept {
+    acc[0] += fast_hash_mix16_(p1, secret, seed);
+    acc[0] ^= load64le(p2) + load64le(p2 + 8);
+    acc[1] += fast_hash_mix16_(p2, secret + 16, seed);
+    acc[1] ^= load64le(p1) + load64le(p1 + 8);
+}
+
+// fast_hash_accumulate_
+// Accumulate 64-byte stripes into the 8 lanes, scrambling them after every 16 stripes (`stripe' is the position in the block)
+// Vectorized with SSE2/AVX2/AVX-512, defined in functional.cpp
+void fast_hash_accumulate_(std::uint64_t (&acc)[8], const unsigned char* p, std::size_t stripes, const unsigned char* secret, std::size_t& stripe) noexcept;
+
+inline void fast_hash_accumulate_512_(std::uint64_t (&acc)[8], const unsigned char* p, const unsigned char* secret) noexcept {
+    for (std::size_t i = 0; i < 8; ++i) {
+        const std::uint64_t data = load64le(p + i * 8);
+        const std::uint64_t key = data ^ load64le(secret + i * 8);
+        acc[i ^ 1] += data;
+        acc[i] += (key & 0xFFFFFFFFU) * (key >> 32);
+    }
+}
+
+inline constexpr std::uint64_t fast_hash_acc_init_[8] = {fast_hash_prime32_3_, fast_hash_prime64_1_, fast_hash_prime64_2_, fast_hash_prime64_3_,
+                                                         fast_hash_prime64_4_, fast_hash_prime32_2_, fast_hash_prime64_5_, fast_hash_prime32_1_};
+
+inline std::uint64_t fast_hash_merge_accs_(const std::uint64_t (&acc)[8], const unsigned char* secret, std::uint64_t h) noexcept {
+    for (std::size_t i = 0; i < 4; ++i) {
+        h += fast_hash_mul128_fold64_(acc[i * 2] ^ load64le(secret + i * 16), acc[i * 2 + 1] ^ load64le(secret + i * 16 + 8));
+    }
+    return fast_hash_avalanche_(h);
+}
+
+// Secret of seeded hashes of more than 240 bytes
+inline void fast_hash_derive_secret_(std::uint64_t seed, unsigned char (&secret)[fast_hash_secret_size_]) noexcept {
+    for (std::size_t i = 0; i < fast_hash_secret_size_; i += 16) {
+        store64le(load64le(fast_hash_secret_internal_ + i) + seed, secret + i);
+        store64le(load64le(fast_hash_secret_internal_ + i + 8) - seed, secret + i + 8);
+    }
+}
+
+// fast_hash128val
+struct fast_hash128val {
+    std::uint64_t low;
+    std::uint64_t high;
+
+    friend constexpr bool operator==(const fast_hash128val& lhs, const fast_hash128val& rhs) noexcept {
+        return lhs.low == rhs.low && lhs.high == rhs.high;
+    }
+    friend constexpr bool operator!=(const fast_hash128val& lhs, const fast_hash128val& rhs) noexcept {
+        return !(lhs == rhs);
+    }
+};
+
+// Hashes of at most 240 bytes, long ones are hashed with the accumulators
+inline std::uint64_t fast_hash_short_(const unsigned char* p, std::size_t len, std::uint64_t seed) noexcept {
+    const unsigned char* const s = fast_hash_secret_internal_;
+    if (len <= 16) {
+        if (len > 8) {
+            const std::uint64_t lo = load64le(p) ^ ((load64le(s + 24) ^ load64le(s + 32)) + seed);
+            const std::uint64_t hi = load64le(p + len - 8) ^ ((load64le(s + 40) ^ load64le(s + 48)) - seed);
+            return fast_hash_avalanche_(len + fast_hash_swap64_(lo) + hi + fast_hash_mul128_fold64_(lo, hi));
+        }
+        if (len >= 4) {
+            seed ^= static_cast<std::uint64_t>(fast_hash_swap32_(static_cast<std::uint32_t>(seed))) << 32;
+            const std::uint64_t in = load32le(p + len - 4) + (static_cast<std::uint64_t>(load32le(p)) << 32);
+            return fast_hash_rrmxmx_(in ^ ((load64le(s + 8) ^ load64le(s + 16)) - seed), len);
+        }
+        if (len > 0) {
+            const std::uint32_t combined = (static_cast<std::uint32_t>(p[0]) << 16) | (static_cast<std::uint32_t>(p[len >> 1]) << 24) | p[len - 1] |
+                                           static_cast<std::uint32_t>(len << 8);
+            return fast_hash_xxh64_avalanche_(combined ^ ((load32le(s) ^ load32le(s + 4)) + seed));
+        }
+        return fast_hash_xxh64_avalanche_(seed ^ load64le(s + 56) ^ load64le(s + 64));
+    }
+    std::uint64_t acc = len * fast_hash_prime64_1_;
+    if (len <= 128) {
+        if (len > 32) {
+            if (len > 64) {
+                if (len > 96) {
+                    acc += fast_hash_mix16_(p + 48, s + 96, seed);
+                    acc += fast_hash_mix16_(p + len - 64, s + 112, seed);
+                }
+                acc += fast_hash_mix16_(p + 32, s + 64, seed);
+                acc += fast_hash_mix16_(p + len - 48, s + 80, seed);
+            }
+            acc += fast_hash_mix16_(p + 16, s + 32, seed);
+            acc += fast_hash_mix16_(p + len - 32, s + 48, seed);
+        }
+        acc += fast_hash_mix16_(p, s, seed);
+        acc += fast_hash_mix16_(p + len - 16, s + 16, seed);
+        return fast_hash_avalanche_(acc);
+    }
+    for (std::size_t i = 0; i < 8; ++i) {
+        acc += fast_hash_mix16_(p + i * 16, s + i * 16, seed);
+    }
+    acc = fast_hash_avalanche_(acc);
+    for (std::size_t i = 8; i < len / 16; ++i) {
+        acc += fast_hash_mix16_(p + i * 16, s + (i - 8) * 16 + 3, seed);
+    }
+    acc += fast_hash_mix16_(p + len - 16, s + 136 - 17, seed);
+    return fast_hash_avalanche_(acc);
+}
+
+inline fast_hash128val fast_hash128_short_(const unsigned char* p, std::size_t len, std::uint64_t seed) noexcept {
+    const unsigned char* const s = fast_hash_secret_internal_;
+    if (len <= 16) {
+        if (len > 8) {
+            const std::uint64_t in_lo = load64le(p);
+            std::uint64_t in_hi = load64le(p + len - 8);
+            std::uint64_t m_hi = 0;
+            std::uint64_t m_lo = fast_hash_mul128_(in_lo ^ in_hi ^ ((load64le(s + 32) ^ load64le(s + 40)) - seed), fast_hash_prime64_1_, m_hi);
+            m_lo += static_cast<std::uint64_t>(len - 1) << 54;
+            in_hi ^= (load64le(s + 48) ^ load64le(s + 56)) + seed;
+            m_hi += in_hi + (in_hi & 0xFFFFFFFFU) * (fast_hash_prime32_2_ - 1);
+            m_lo ^= fast_hash_swap64_(m_hi);
+            std::uint64_t r_hi = 0;
+            const std::uint64_t r_lo = fast_hash_mul128_(m_lo, fast_hash_prime64_2_, r_hi);
+            r_hi += m_hi * fast_hash_prime64_2_;
+            return {fast_hash_avalanche_(r_lo), fast_hash_avalanche_(r_hi)};
+        }
+        if (len >= 4) {
+            seed ^= static_cast<std::uint64_t>(fast_hash_swap32_(static_cast<std::uint32_t>(seed))) << 32;
+            const std::uint64_t in = load32le(p) + (static_cast<std::uint64_t>(load32le(p + len - 4)) << 32);
+            std::uint64_t hi = 0;
+            std::uint64_t lo = fast_hash_mul128_(in ^ ((load64le(s + 16) ^ load64le(s + 24)) + seed), fast_hash_prime64_1_ + (len << 2), hi);
+            hi += lo << 1;
+            lo ^= hi >> 3;
+            lo ^= lo >> 35;
+            lo *= 0x9FB21C651E98DF25U;
+            lo ^= lo >> 28;
+            return {lo, fast_hash_avalanche_(hi)};
+        }
+        if (len > 0) {
+            const std::uint32_t lo = (static_cast<std::uint32_t>(p[0]) << 16) | (static_cast<std::uint32_t>(p[len >> 1]) << 24) | p[len - 1] |
+                                     static_cast<std::uint32_t>(len << 8);
+            const std::uint32_t hi = rotl(fast_hash_swap32_(lo), 13);
+            return {fast_hash_xxh64_avalanche_(lo ^ ((load32le(s) ^ load32le(s + 4)) + seed)),
+                    fast_hash_xxh64_avalanche_(hi ^ ((load32le(s + 8) ^ load32le(s + 12)) - seed))};
+        }
+        return {fast_hash_xxh64_avalanche_(seed ^ load64le(s + 64) ^ load64le(s + 72)), fast_hash_xxh64_avalanche_(seed ^ load64le(s + 80) ^ load64le(s + 88))};
+    }
+    std::uint64_t acc[2] = {len * fast_hash_prime64_1_, 0};
+    if (len <= 128) {
+        if (len > 32) {
+            if (len > 64) {
+                if (len > 96) {
+                    fast_hash_mix32_(acc, p + 48, p + len - 64, s + 96, seed);
+                }
+                fast_hash_mix32_(acc, p + 32, p + len - 48, s + 64, seed);
+            }
+            fast_hash_mix32_(acc, p + 16, p + len - 32, s + 32, seed);
+        }
+        fast_hash_mix32_(acc, p, p + len - 16, s, seed);
+    } else {
+        for (std::size_t i = 0; i < 4; ++i) {
+            fast_hash_mix32_(acc, p + i * 32, p + i * 32 + 16, s + i * 32, seed);
+        }
+        acc[0] = fast_hash_avalanche_(acc[0]);
+        acc[1] = fast_hash_avalanche_(acc[1]);
+        for (std::size_t i = 4; i < len / 32; ++i) {
+            fast_hash_mix32_(acc, p + i * 32, p + i * 32 + 16, s + 3 + (i - 4) * 32, seed);
+        }
+        fast_hash_mix32_(acc, p + len - 16, p + len - 32, s + 136 - 17 - 16, 0 - seed);
+    }
+    const std::uint64_t lo = acc[0] + acc[1];
+    const std::uint64_t hi = acc[0] * fast_hash_prime64_1_ + acc[1] * fast_hash_prime64_4_ + (len - seed) * fast_hash_prime64_2_;
+    return {fast_hash_avalanche_(lo), 0 - fast_hash_avalanche_(hi)};
+}
+
+// fast_hash_state
+// Streaming fast_hash, the same values as fast_hash/fast_hash128 of the concatenated input
+class fast_hash_state {
+private:
+    std::uint64_t acc_[8];
+    std::uint64_t seed_;
+    std::uint64_t length_;
+    std::size_t stripe_;
+    std::size_t size_;
+    unsigned char buf_[256];
+    unsigned char last_[64]; // last stripe accumulated, completes the final stripe if `buf_' has fewer bytes
+    unsigned char secret_[fast_hash_secret_size_];
+
+    void accumulate(const unsigned char* p, std::size_t stripes) noexcept {
+        fast_hash_accumulate_(acc_, p, stripes, secret_, stripe_);
+        std::memcpy(last_, p + (stripes - 1) * 64, 64);
+    }
+
+    // Accumulators with the final stripe, `length_' > 240
+    void finish_accs(std::uint64_t (&acc)[8]) const noexcept {
+        std::memcpy(acc, acc_, sizeof(acc_));
+        std::size_t stripe = stripe_;
+        const std::size_t stripes = (size_ - 1) / 64;
+        if (stripes != 0) {
+            fast_hash_accumulate_(acc, buf_, stripes, secret_, stripe);
+        }
+        unsigned char last[64];
+        const unsigned char* p = buf_ + size_ - 64;
+        if (size_ < 64) {
+            std::memcpy(last, last_ + size_, 64 - size_);
+            std::memcpy(last + 64 - size_, buf_, size_);
+            p = last;
+        }
+        fast_hash_accumulate_512_(acc, p, secret_ + fast_hash_secret_size_ - 64 - 7);
+    }
+
+public:
+    explicit fast_hash_state(std::uint64_t seed = 0) noexcept : seed_(seed) {
+        if (seed == 0) {
+            std::memcpy(secret_, fast_hash_secret_internal_, fast_hash_secret_size_);
+        } else {
+            fast_hash_derive_secret_(seed, secret_);
+        }
+        this->reset();
+    }
+
+    fast_hash_state(const void* buf, std::size_t len, std::uint64_t seed = 0) noexcept : fast_hash_state(seed) {
+        this->update(buf, len);
+    }
+
+    void reset() noexcept {
+        std::memcpy(acc_, fast_hash_acc_init_, sizeof(acc_));
+        length_ = 0;
+        stripe_ = 0;
+        size_ = 0;
+    }
+
+    void update(const void* buf, std::size_t len) noexcept {
+        const unsigned char* in = static_cast<const unsigned char*>(buf);
+        length_ += len;
+        if (size_ + len <= sizeof(buf_)) {
+            if (len != 0) {
+                std::memcpy(buf_ + size_, in, len);
+            }
+            size_ += len;
+            return;
+        }
+        // More input follows each accumulated stripe, the last one is left for finish
+        if (size_ != 0) {
+            const std::size_t n = sizeof(buf_) - size_;
+            std::memcpy(buf_ + size_, in, n);
+            in += n;
+            len -= n;
+            this->accumulate(buf_, sizeof(buf_) / 64);
+            size_ = 0;
+        }
+        const std::size_t stripes = (len - 1) / 64;
+        if (stripes != 0) {
+            this->accumulate(in, stripes);
+            in += stripes * 64;
+            len -= stripes * 64;
+        }
+        std::memcpy(buf_, in, len);
+        size_ = len;
+    }
+
+    std::uint64_t finish() const noexcept {
+        if (length_ <= 240) {
+            return fast_hash_short_(buf_, size_, seed_);
+        }
+        std::uint64_t acc[8];
+        this->finish_accs(acc);
+        return fast_hash_merge_accs_(acc, secret_ + 11, length_ * fast_hash_prime64_1_);
+    }
+
+    fast_hash128val finish128() const noexcept {
+        if (length_ <= 240) {
+            return fast_hash128_short_(buf_, size_, seed_);
+        }
+        std::uint64_t acc[8];
+        this->finish_accs(acc);
+        return {fast_hash_merge_accs_(acc, secret_ + 11, length_ * fast_hash_prime64_1_),
+                fast_hash_merge_accs_(acc, secret_ + fast_hash_secret_size_ - 64 - 11, ~(length_ * fast_hash_prime64_2_))};
+    }
+};
+
+// fast_hash
+// return: 64-bit XXH3
+inline std::uint64_t fast_hash(const void* buf, std::size_t len, std::uint64_t seed = 0) noexcept {
+    const unsigned char* p = static_cast<const unsigned char*>(buf);
+    if (len <= 240) {
+        return fast_hash_short_(p, len, seed);
+    }
+    return fast_hash_state(buf, len, seed).finish();
+}
+
+// fast_hash128
+// return: 128-bit XXH3
+inline fast_hash128val fast_hash128(const void* buf, std::size_t len, std::uint64_t seed = 0) noexcept {
+    const unsigned char* p = static_cast<const unsigned char*>(buf);
+    if (len <= 240) {
+        return fast_hash128_short_(p, len, seed);
+    }
+    return fast_hash_state(buf, len, seed).finish128();
+}
+
 // Modified from boost/container_hash/hash.hpp
 /*
  * Boost Software License - Version 1.0,
@@ -45,7 +436,18 @@ namespace esl {
  * DEALINGS IN THE SOFTWARE.
  */
 
-#if (ESL_SIZE_WIDTH == 64)
+// ESL_USE_FAST_HASH
+// Define to hash with fast_hash in stdhash and combine with a fast_hash multiply-fold on 64-bit targets.
+// Only byte hashes are then the same on every standard library: stdhash, and the containers of bulk hashable
+// scalars below (hashed with fast_hash either way); other values still come from std::hash<T> through hash_value
+
+#if (ESL_SIZE_WIDTH == 64) && defined(ESL_USE_FAST_HASH)
+
+inline constexpr void hash_combine_(std::size_t& h, std::size_t k) noexcept {
+    h = fast_hash_mul128_fold64_(h ^ fast_hash_prime64_1_, k ^ fast_hash_prime64_2_);
+}
+
+#elif (ESL_SIZE_WIDTH == 64)
 
 inline constexpr void hash_combine_(std::size_t& h, std::size_t k) noexcept {
     const std::size_t m = 0xc6a4a7935bd1e995U;
@@ -97,12 +499,39 @@ inline std::size_t hash_value(const T& value, std::size_t h) noexcept(noexcept(s
 }
 // stdhash
 inline std::size_t stdhash(const void* buf, std::size_t size) noexcept {
+#ifdef ESL_USE_FAST_HASH
+    return static_cast<std::size_t>(fast_hash(buf, size));
+#else
     return std::hash<std::string_view>{}(std::string_view(static_cast<const char*>(buf), size));
+#endif
 }
 inline std::size_t stdhash(const void* buf, std::size_t size, std::size_t h) noexcept {
     return hash_combine(h, stdhash(buf, size));
 }
 
+// is_bulk_hashable_
+// Equal values have equal bytes: scalars without padding bits, and std::array of them
+// Class types are excluded, their operator== may compare less than their bytes
+template <class T>
+struct is_bulk_hashable_ : std::bool_constant<std::is_scalar_v<T> && std::has_unique_object_representations_v<T>> {};
+template <class T, std::size_t N>
+struct is_bulk_hashable_<std::array<T, N>> : is_bulk_hashable_<T> {};
+
+// hash_contiguous
+// Hash `n' objects, the raw memory with fast_hash in one pass if possible, otherwise element by element
+template <class T>
+inline std::size_t hash_contiguous(const T* data, std::size_t n) {
+    if constexpr (is_bulk_hashable_<std::remove_cv_t<T>>::value) {
+        return static_cast<std::size_t>(fast_hash(data, n * sizeof(T)));
+    } else {
+        std::size_t h = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            h = ::esl::hash_value(data[i], h);
+        }
+        return h;
+    }
+}
+
 } // namespace esl
 
 namespace std {
@@ -135,13 +564,27 @@ private:
 template <class T, class Alloc>
 struct hash<std::vector<T, Alloc>> {
     std::size_t operator()(const std::vector<T, Alloc>& vec) const {
-        std::size_t h = 0;
-        for (auto& v : vec) {
-            h = ::esl::hash_value(v, h);
-        }
-        return h;
+        return ::esl::hash_contiguous(vec.data(), vec.size());
+    }
+};
+
+// hash<std::array>
+template <class T, std::size_t N>
+struct hash<std::array<T, N>> {
+    std::size_t operator()(const std::array<T, N>& arr) const {
+        return ::esl::hash_contiguous(arr.data(), N);
     }
 };
+
+// hash<esl::span>
+// Hash the elements viewed, as operator==
+template <class T, std::size_t N>
+struct hash<::esl::span<T, N>> {
+    std::size_t operator()(const ::esl::span<T, N>& s) const {
+        return ::esl::hash_contiguous(s.data(), s.size());
+    }
+};
+
 template <class Key, class T, class Hash, class KeyEqual, class Alloc>
 struct hash<std::unordered_map<Key, T, Hash, KeyEqual, Alloc>> {
     std::size_t operator()(const std::unordered_map<Key, T, Hash, KeyEqual, Alloc>& m) const {
@@ -159,27 +602,7 @@ struct hash<std::unordered_map<Key, T, Hash, KeyEqual, Alloc>> {
 
 namespace esl {
 
-/* zlib License
- * http://zlib.net/zlib_license.html
- * ----------------------------------------------------------------------------
- * Copyright (C) 1995-2017 Jean-loup Gailly and Mark Adler
- *
- * This software is provided 'as-is', without any express or implied
- * warranty.  In no event will the authors be held liable for any damages
- * arising from the use of this software.
- *
- * Permission is granted to anyone to use this software for any purpose,
- * including commercial applications, and to alter it and redistribute it
- * freely, subject to the following restrictions:
- *
- * 1. The origin of this software must not be misrepresented; you must not
- *    claim that you wrote the original software. If you use this software
- *    in a product, an acknowledgment in the product documentation would be
- *    appreciated but is not required.
- * 2. Altered source versions must be plainly marked as such, and must not be
- *    misrepresented as being the original software.
- * 3. This notice may not be removed or altered from any source distribution.
- */
+// CRC-32 from zlib: Copyright (C) 1995-2017 Jean-loup Gailly and Mark Adler, zlib License, see NOTICE
 
 inline constexpr std::uint32_t crc32_table_internal_[256] = {
     0x00000000U, 0x77073096U, 0xee0e612cU, 0x990951baU, 0x076dc419U, 0x706af48fU, 0xe963a535U, 0x9e6495a3U, 0x0edb8832U, 0x79dcb8a4U, 0xe0d5e91eU, 0x97d2d988U,
@@ -206,17 +629,114 @@ inline constexpr std::uint32_t crc32_table_internal_[256] = {
     0xb40bbe37U, 0xc30c8ea1U, 0x5a05df1bU, 0x2d02ef8dU,
 };
 
-// crc32
-inline constexpr std::uint32_t crc32(const void* buf, std::size_t len, std::uint32_t crc = 0) noexcept {
-    const unsigned char* buf_b = static_cast<const unsigned char*>(buf);
-    const unsigned char* const buf_end = buf_b + len;
+// crc32_bytewise
+// Byte at a time with crc32_table_internal_, usable at compile time
+inline constexpr std::uint32_t crc32_bytewise(const char* buf, std::size_t len, std::uint32_t crc = 0) noexcept {
     crc = ~crc;
-    while (buf_b != buf_end) {
-        crc = crc32_table_internal_[(crc ^ (*buf_b++)) & 0xFF] ^ (crc >> 8);
+    for (std::size_t i = 0; i < len; ++i) {
+        crc = crc32_table_internal_[(crc ^ static_cast<unsigned char>(buf[i])) & 0xFF] ^ (crc >> 8);
     }
     return crc ^ 0xFFFFFFFF;
 }
 
+// Reflected polynomials
+inline constexpr std::uint32_t crc32_poly_internal_ = 0xEDB88320U;
+inline constexpr std::uint32_t crc32c_poly_internal_ = 0x82F63B78U;
+
+// crc32_multmodp_
+// return: a * b modulo poly, where x^0 is the highest bit (reflected)
+inline constexpr std::uint32_t crc32_multmodp_(std::uint32_t a, std::uint32_t b, std::uint32_t poly) noexcept {
+    std::uint32_t p = 0;
+    for (std::uint32_t m = 1U << 31; m != 0; m >>= 1) {
+        if (a & m) {
+            p ^= b;
+        }
+        b = (b & 1) ? (b >> 1) ^ poly : b >> 1;
+    }
+    return p;
+}
+
+// crc32_x8nmodp_
+// return: x^(8 * n) modulo poly, multiplying a raw crc by it appends n zero bytes
+inline constexpr std::uint32_t crc32_x8nmodp_(std::uint64_t n, std::uint32_t poly) noexcept {
+    std::uint32_t p = 1U << 31;        // x^0
+    std::uint32_t sq = 1U << (31 - 8); // x^8
+    for (; n != 0; n >>= 1) {
+        if (n & 1) {
+            p = crc32_multmodp_(sq, p, poly);
+        }
+        sq = crc32_multmodp_(sq, sq, poly);
+    }
+    return p;
+}
+
+// crc32
+// CRC-32 as zlib, folded with PCLMULQDQ if available, otherwise sliced by 16 bytes
+std::uint32_t crc32(const void* buf, std::size_t len, std::uint32_t crc = 0) noexcept;
+
+// crc32c
+// CRC-32C (Castagnoli) as iSCSI and ext4, with the SSE4.2 crc32 instruction if available, otherwise sliced by 16 bytes
+std::uint32_t crc32c(const void* buf, std::size_t len, std::uint32_t crc = 0) noexcept;
+
+// crc32_combine
+// return: crc32 of a followed by b, given crc32 of a, crc32 of b and the length of b, in O(log(len_b))
+inline constexpr std::uint32_t crc32_combine(std::uint32_t crc_a, std::uint32_t crc_b, std::uint64_t len_b) noexcept {
+    return crc32_multmodp_(crc32_x8nmodp_(len_b, crc32_poly_internal_), crc_a, crc32_poly_internal_) ^ crc_b;
+}
+
+// crc32c_combine
+// return: crc32c of a followed by b, given crc32c of a, crc32c of b and the length of b, in O(log(len_b))
+inline constexpr std::uint32_t crc32c_combine(std::uint32_t crc_a, std::uint32_t crc_b, std::uint64_t len_b) noexcept {
+    return crc32_multmodp_(crc32_x8nmodp_(len_b, crc32c_poly_internal_), crc_a, crc32c_poly_internal_) ^ crc_b;
+}
+
+// Smallest segment worth a job of its own in crc32(c)_parallel
+inline constexpr std::size_t crc32_parallel_min_segment = 1024 * 1024;
+
+template <class Executor, class Crc, class Combine>
+inline std::uint32_t crc32_parallel_(const void* buf, std::size_t len, Executor& executor, std::uint32_t crc, Crc crc_f, Combine combine) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(buf);
+    const std::size_t n = std::max<std::size_t>(1, std::min<std::size_t>(executor.concurrency(), len / crc32_parallel_min_segment));
+    if (n == 1) {
+        return crc_f(buf, len, crc);
+    }
+    const std::size_t segment = (len + n - 1) / n;
+    std::vector<std::uint32_t> crcs(n);
+    executor.bulk(n, [=, &crcs](std::size_t i) {
+        const auto begin = i * segment;
+        crcs[i] = crc_f(bytes + begin, std::min(segment, len - begin), i == 0 ? crc : 0);
+    });
+    crc = crcs[0];
+    for (std::size_t i = 1; i < n; ++i) {
+        crc = combine(crc, crcs[i], std::min(segment, len - i * segment));
+    }
+    return crc;
+}
+
+// crc32_parallel
+// Segments are checksummed as executor jobs, then combined
+// Exceptions: Whatever the executor throws
+template <class Executor>
+inline std::uint32_t crc32_parallel(const void* buf, std::size_t len, Executor&& executor, std::uint32_t crc = 0) {
+    return crc32_parallel_(buf, len, executor, crc, [](const void* b, std::size_t l, std::uint32_t c) { return crc32(b, l, c); }, crc32_combine);
+}
+template <class T, std::size_t N, class Executor>
+inline std::uint32_t crc32_parallel(span<T, N> s, Executor&& executor, std::uint32_t crc = 0) {
+    return crc32_parallel(s.data(), s.size() * sizeof(T), executor, crc);
+}
+
+// crc32c_parallel
+// Segments are checksummed as executor jobs, then combined
+// Exceptions: Whatever the executor throws
+template <class Executor>
+inline std::uint32_t crc32c_parallel(const void* buf, std::size_t len, Executor&& executor, std::uint32_t crc = 0) {
+    return crc32_parallel_(buf, len, executor, crc, [](const void* b, std::size_t l, std::uint32_t c) { return crc32c(b, l, c); }, crc32c_combine);
+}
+template <class T, std::size_t N, class Executor>
+inline std::uint32_t crc32c_parallel(span<T, N> s, Executor&& executor, std::uint32_t crc = 0) {
+    return crc32c_parallel(s.data(), s.size() * sizeof(T), executor, crc);
+}
+
 // md5
 // See https://en.wikipedia.org/wiki/MD5
 // Modified from public domain code from https://github.com/libtom/libtomcrypt
@@ -426,6 +946,224 @@ inline md5_state md5(const void* buf, std::size_t len) noexcept {
     return md5(buf, len, state);
 }
 
+// md5_many
+// Hash independent messages together, 16/8/4 at a time across AVX-512/AVX2/SSE2 lanes
+// out: `n' values, the same as md5val(md5(messages[i].data(), messages[i].size()))
+void md5_many(const span<const unsigned char>* messages, std::size_t n, md5val* out) noexcept;
+inline std::vector<md5val> md5_many(span<const span<const unsigned char>> messages) {
+    std::vector<md5val> vals(messages.size());
+    md5_many(messages.data(), messages.size(), vals.data());
+    return vals;
+}
+
+// sha1, sha256
+// See https://en.wikipedia.org/wiki/SHA-1, https://en.wikipedia.org/wiki/SHA-2 (FIPS 180-4)
+
+// sha1_compress_, sha256_compress_
+// Compress `n' 64-byte blocks, with the SHA extensions when available, defined in functional.cpp
+void sha1_compress_(std::uint32_t (&state)[5], const unsigned char* blocks, std::size_t n) noexcept;
+void sha256_compress_(std::uint32_t (&state)[8], const unsigned char* blocks, std::size_t n) noexcept;
+
+// sha_state_
+// Block buffering and padding shared by sha1_state and sha256_state, `N' state words
+template <std::size_t N>
+class sha_state_ {
+protected:
+    std::uint32_t state_[N];
+    std::uint64_t length_;
+    std::size_t curlen_;
+    unsigned char buf_[64];
+
+    static void compress(std::uint32_t (&state)[N], const unsigned char* blocks, std::size_t n) noexcept {
+        if constexpr (N == 5) {
+            sha1_compress_(state, blocks, n);
+        } else {
+            sha256_compress_(state, blocks, n);
+        }
+    }
+
+    explicit sha_state_(const std::uint32_t (&init)[N]) noexcept : length_(0), curlen_(0) {
+        std::memcpy(state_, init, sizeof(state_));
+    }
+
+    void finish_(unsigned char* out) noexcept {
+        length_ += curlen_;
+        buf_[curlen_++] = 0x80;
+        if (curlen_ > 56) {
+            std::memset(buf_ + curlen_, 0, 64 - curlen_);
+            compress(state_, buf_, 1);
+            curlen_ = 0;
+        }
+        std::memset(buf_ + curlen_, 0, 56 - curlen_);
+        store64be(length_ * 8, buf_ + 56);
+        compress(state_, buf_, 1);
+        for (std::size_t i = 0; i < N; ++i) {
+            store32be(state_[i], out + (i * 4));
+        }
+    }
+
+public:
+    void update(const void* buf, std::size_t len) noexcept {
+        const unsigned char* in = static_cast<const unsigned char*>(buf);
+        if (curlen_ != 0) {
+            const std::size_t n = std::min(len, 64 - curlen_);
+            std::memcpy(buf_ + curlen_, in, n);
+            curlen_ += n;
+            in += n;
+            len -= n;
+            if (curlen_ != 64) {
+                return;
+            }
+            compress(state_, buf_, 1);
+            length_ += 64;
+            curlen_ = 0;
+        }
+        if (len >= 64) {
+            compress(state_, in, len / 64);
+            length_ += len / 64 * 64;
+            in += len / 64 * 64;
+            len %= 64;
+        }
+        if (len != 0) {
+            std::memcpy(buf_, in, len);
+            curlen_ = len;
+        }
+    }
+};
+
+inline constexpr std::uint32_t sha1_init_internal_[5] = {0x67452301U, 0xefcdab89U, 0x98badcfeU, 0x10325476U, 0xc3d2e1f0U};
+inline constexpr std::uint32_t sha256_init_internal_[8] = {0x6a09e667U, 0xbb67ae85U, 0x3c6ef372U, 0xa54ff53aU,
+                                                           0x510e527fU, 0x9b05688cU, 0x1f83d9abU, 0x5be0cd19U};
+
+class sha1val;
+class sha1_state;
+sha1_state& sha1(const void* buf, std::size_t len, sha1_state& state) noexcept;
+
+class sha1_state : public sha_state_<5> {
+    friend class sha1val;
+    friend sha1_state& sha1(const void* buf, std::size_t len, sha1_state& state) noexcept;
+
+public:
+    sha1_state() noexcept : sha_state_(sha1_init_internal_) {}
+
+    sha1_state(const void* buf, std::size_t len) noexcept : sha1_state() {
+        this->update(buf, len);
+    }
+
+    sha1_state(const sha1_state&) = default;
+
+    sha1_state& operator=(const sha1_state&) = default;
+
+protected:
+    sha1val finish() && noexcept;
+};
+
+class sha1val : public std::array<unsigned char, 20> {
+public:
+    sha1val() noexcept = default;
+
+    sha1val(const sha1_state& state) noexcept : sha1val(sha1_state(state).finish()) {}
+
+    sha1val(sha1_state&& state) noexcept : sha1val(std::move(state).finish()) {}
+
+    std::string to_string() const {
+        return {reinterpret_cast<const char*>(this->data()), this->size()};
+    }
+
+    std::string to_hex_string(const hex_option& option = hex_lowercase) const {
+        return hex_encode(this->data(), this->size(), option);
+    }
+};
+
+inline sha1val sha1_state::finish() && noexcept {
+    sha1val val;
+    this->finish_(val.data());
+    return val;
+}
+
+// sha1
+inline sha1_state& sha1(const void* buf, std::size_t len, sha1_state& state) noexcept {
+    state.update(buf, len);
+    return state;
+}
+inline sha1_state sha1(const void* buf, std::size_t len) noexcept {
+    sha1_state state;
+    return sha1(buf, len, state);
+}
+
+class sha256val;
+class sha256_state;
+sha256_state& sha256(const void* buf, std::size_t len, sha256_state& state) noexcept;
+
+class sha256_state : public sha_state_<8> {
+    friend class sha256val;
+    friend sha256_state& sha256(const void* buf, std::size_t len, sha256_state& state) noexcept;
+
+public:
+    sha256_state() noexcept : sha_state_(sha256_init_internal_) {}
+
+    sha256_state(const void* buf, std::size_t len) noexcept : sha256_state() {
+        this->update(buf, len);
+    }
+
+    sha256_state(const sha256_state&) = default;
+
+    sha256_state& operator=(const sha256_state&) = default;
+
+protected:
+    sha256val finish() && noexcept;
+};
+
+class sha256val : public std::array<unsigned char, 32> {
+public:
+    sha256val() noexcept = default;
+
+    sha256val(const sha256_state& state) noexcept : sha256val(sha256_state(state).finish()) {}
+
+    sha256val(sha256_state&& state) noexcept : sha256val(std::move(state).finish()) {}
+
+    std::string to_string() const {
+        return {reinterpret_cast<const char*>(this->data()), this->size()};
+    }
+
+    std::string to_hex_string(const hex_option& option = hex_lowercase) const {
+        return hex_encode(this->data(), this->size(), option);
+    }
+};
+
+inline sha256val sha256_state::finish() && noexcept {
+    sha256val val;
+    this->finish_(val.data());
+    return val;
+}
+
+// sha256
+inline sha256_state& sha256(const void* buf, std::size_t len, sha256_state& state) noexcept {
+    state.update(buf, len);
+    return state;
+}
+inline sha256_state sha256(const void* buf, std::size_t len) noexcept {
+    sha256_state state;
+    return sha256(buf, len, state);
+}
+
+// sha1_many, sha256_many
+// Hash independent messages together, 16 at a time across AVX-512 lanes, otherwise one after another with the SHA extensions
+// or 8 at a time across AVX2 lanes
+// out: `n' values, the same as sha1val(sha1(messages[i].data(), messages[i].size())) and so on
+void sha1_many(const span<const unsigned char>* messages, std::size_t n, sha1val* out) noexcept;
+inline std::vector<sha1val> sha1_many(span<const span<const unsigned char>> messages) {
+    std::vector<sha1val> vals(messages.size());
+    sha1_many(messages.data(), messages.size(), vals.data());
+    return vals;
+}
+void sha256_many(const span<const unsigned char>* messages, std::size_t n, sha256val* out) noexcept;
+inline std::vector<sha256val> sha256_many(span<const span<const unsigned char>> messages) {
+    std::vector<sha256val> vals(messages.size());
+    sha256_many(messages.data(), messages.size(), vals.data());
+    return vals;
+}
+
 } // namespace esl
 
 #endif // ESL_FUNCTIONAL_HPP
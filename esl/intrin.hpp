@@ -4,8 +4,18 @@
 #include "limits.hpp"
 #include "macros.hpp"
 
+#include <cstdint>
 #include <type_traits>
 
+#ifdef ESL_ARCH_X86_ANY
+#    ifdef ESL_COMPILER_MSVC
+#        include <intrin.h>
+#    else
+#        include <cpuid.h>
+#    endif
+#    include <immintrin.h>
+#endif
+
 namespace esl {
 
 // load16le
@@ -49,6 +59,41 @@ ESL_ATTR_FORCEINLINE constexpr void store64le(std::uint64_t u64, unsigned char*
     store32le(static_cast<std::uint32_t>(u64 >> 32), bs + 4);
 }
 
+// load16be
+ESL_ATTR_FORCEINLINE constexpr std::uint16_t load16be(const unsigned char* bs) noexcept {
+    return load16le(bs[1], bs[0]);
+}
+
+// store16be
+ESL_ATTR_FORCEINLINE constexpr void store16be(std::uint16_t u16, unsigned char* bs) noexcept {
+    bs[0] = static_cast<unsigned char>((u16 >> 8) & 0xFF);
+    bs[1] = static_cast<unsigned char>(u16 & 0xFF);
+}
+
+// load32be
+ESL_ATTR_FORCEINLINE constexpr std::uint32_t load32be(const unsigned char* bs) noexcept {
+    return load32le(bs[3], bs[2], bs[1], bs[0]);
+}
+
+// store32be
+ESL_ATTR_FORCEINLINE constexpr void store32be(std::uint32_t u32, unsigned char* bs) noexcept {
+    bs[0] = static_cast<unsigned char>((u32 >> 24) & 0xFF);
+    bs[1] = static_cast<unsigned char>((u32 >> 16) & 0xFF);
+    bs[2] = static_cast<unsigned char>((u32 >> 8) & 0xFF);
+    bs[3] = static_cast<unsigned char>(u32 & 0xFF);
+}
+
+// load64be
+ESL_ATTR_FORCEINLINE constexpr std::uint64_t load64be(const unsigned char* bs) noexcept {
+    return (static_cast<std::uint64_t>(load32be(bs)) << 32) | static_cast<std::uint64_t>(load32be(bs + 4));
+}
+
+// store64be
+ESL_ATTR_FORCEINLINE constexpr void store64be(std::uint64_t u64, unsigned char* bs) noexcept {
+    store32be(static_cast<std::uint32_t>(u64 >> 32), bs);
+    store32be(static_cast<std::uint32_t>(u64 & 0xFFFFFFFF), bs + 4);
+}
+
 // rotl
 template <class T>
 ESL_ATTR_FORCEINLINE constexpr T rotl(T x, unsigned char s) noexcept {
@@ -78,6 +123,161 @@ ESL_ATTR_FORCEINLINE unsigned char clz(T x) noexcept {
     }
 }
 
+// ctz
+// x: non-zero
+template <class T, class = std::enable_if_t<std::is_unsigned_v<T>>>
+ESL_ATTR_FORCEINLINE unsigned char ctz(T x) noexcept {
+    if constexpr (sizeof(T) == 4) {
+#ifdef ESL_COMPILER_MSVC
+        return static_cast<unsigned char>(_tzcnt_u32(x));
+#else
+        return static_cast<unsigned char>(__builtin_ctz(x));
+#endif
+    } else if constexpr (sizeof(T) == 8) {
+#ifdef ESL_COMPILER_MSVC
+        return static_cast<unsigned char>(_tzcnt_u64(x));
+#else
+        return static_cast<unsigned char>(__builtin_ctzll(x));
+#endif
+    }
+}
+
+// mul128
+// Full product of 64-bit integers
+// return: the high half, the low half in `lo'
+ESL_ATTR_FORCEINLINE std::uint64_t mul128(std::uint64_t a, std::uint64_t b, std::uint64_t& lo) noexcept {
+#if defined(ESL_COMPILER_MSVC) && defined(ESL_ARCH_X64)
+    std::uint64_t hi;
+    lo = _umul128(a, b, &hi);
+    return hi;
+#elif defined(__SIZEOF_INT128__)
+    __extension__ typedef unsigned __int128 uint128;
+    const uint128 r = static_cast<uint128>(a) * b;
+    lo = static_cast<std::uint64_t>(r);
+    return static_cast<std::uint64_t>(r >> 64);
+#else
+    const std::uint64_t a_lo = a & 0xFFFFFFFF, a_hi = a >> 32;
+    const std::uint64_t b_lo = b & 0xFFFFFFFF, b_hi = b >> 32;
+    const std::uint64_t ll = a_lo * b_lo, lh = a_lo * b_hi, hl = a_hi * b_lo, hh = a_hi * b_hi;
+    const std::uint64_t mid = (ll >> 32) + (lh & 0xFFFFFFFF) + (hl & 0xFFFFFFFF);
+    lo = (mid << 32) | (ll & 0xFFFFFFFF);
+    return hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+#endif
+}
+
+// popcount
+template <class T, class = std::enable_if_t<std::is_unsigned_v<T>>>
+ESL_ATTR_FORCEINLINE unsigned char popcount(T x) noexcept {
+    if constexpr (sizeof(T) == 4) {
+#ifdef ESL_COMPILER_MSVC
+        return static_cast<unsigned char>(__popcnt(x));
+#else
+        return static_cast<unsigned char>(__builtin_popcount(x));
+#endif
+    } else if constexpr (sizeof(T) == 8) {
+#ifdef ESL_COMPILER_MSVC
+        return static_cast<unsigned char>(__popcnt64(x));
+#else
+        return static_cast<unsigned char>(__builtin_popcountll(x));
+#endif
+    }
+}
+
+// cpu_features
+// Instruction set extensions usable at runtime (supported by both the cpu and the os)
+// All false on non-x86 architectures
+struct cpu_features {
+    bool sse2 = false;
+    bool ssse3 = false;
+    bool sse41 = false;
+    bool sse42 = false;
+    bool pclmul = false;
+    bool avx2 = false;
+    bool bmi2 = false;
+    bool avx512f = false;
+    bool avx512bw = false;
+    bool avx512vl = false;
+    bool avx512vbmi = false;
+    bool sha = false;
+};
+
+namespace details {
+
+#ifdef ESL_ARCH_X86_ANY
+
+inline void cpuid_(unsigned int leaf, unsigned int subleaf, unsigned int (&regs)[4]) noexcept {
+#    ifdef ESL_COMPILER_MSVC
+    int r[4];
+    __cpuidex(r, static_cast<int>(leaf), static_cast<int>(subleaf));
+    for (int i = 0; i < 4; ++i) {
+        regs[i] = static_cast<unsigned int>(r[i]);
+    }
+#    else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#    endif
+}
+
+inline std::uint64_t xgetbv_() noexcept {
+#    ifdef ESL_COMPILER_MSVC
+    return _xgetbv(0);
+#    else
+    unsigned int eax, edx;
+    __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return static_cast<std::uint64_t>(eax) | (static_cast<std::uint64_t>(edx) << 32);
+#    endif
+}
+
+inline cpu_features detect_cpu_features_() noexcept {
+    cpu_features f;
+    unsigned int regs[4]; // eax, ebx, ecx, edx
+    cpuid_(0, 0, regs);
+    const unsigned int max_leaf = regs[0];
+    if (max_leaf < 1) {
+        return f;
+    }
+    cpuid_(1, 0, regs);
+    f.sse2 = regs[3] & (1U << 26);
+    f.ssse3 = regs[2] & (1U << 9);
+    f.sse41 = regs[2] & (1U << 19);
+    f.sse42 = regs[2] & (1U << 20);
+    f.pclmul = regs[2] & (1U << 1);
+    // xmm/ymm, opmask/zmm state saved by the os
+    const bool osxsave = regs[2] & (1U << 27);
+    const std::uint64_t xcr0 = osxsave ? xgetbv_() : 0;
+    const bool os_avx = (xcr0 & 0x6) == 0x6;
+    const bool os_avx512 = (xcr0 & 0xE6) == 0xE6;
+    if (max_leaf < 7) {
+        return f;
+    }
+    cpuid_(7, 0, regs);
+    f.avx2 = os_avx && (regs[1] & (1U << 5));
+    f.bmi2 = regs[1] & (1U << 8);
+    f.avx512f = os_avx512 && (regs[1] & (1U << 16));
+    f.avx512bw = f.avx512f && (regs[1] & (1U << 30));
+    f.avx512vl = f.avx512f && (regs[1] & (1U << 31));
+    f.avx512vbmi = f.avx512f && (regs[2] & (1U << 1));
+    f.sha = regs[1] & (1U << 29);
+    return f;
+}
+
+#else
+
+inline cpu_features detect_cpu_features_() noexcept {
+    return {};
+}
+
+#endif
+
+} // namespace details
+
+// current_cpu_features
+// Detected once, kernels dispatch on it for every call
+// NOTE: Features may be turned off (never on) to force a fallback path, do it before any concurrent use
+inline cpu_features& current_cpu_features() noexcept {
+    static cpu_features features = details::detect_cpu_features_();
+    return features;
+}
+
 } // namespace esl
 
 #endif // ESL_INTRIN_HPP
@@ -0,0 +1,362 @@
+#include "json.hpp"
+#include "intrin.hpp"
+
+#include <array>
+
+namespace esl {
+
+namespace json {
+
+namespace {
+
+// Stage 1 follows simdjson (Langdale, Lemire: Parsing Gigabytes of JSON per Second):
+// classify 64 bytes into bitmasks, resolve the escapes and the strings with carries between blocks,
+// then flatten the structural bits to positions
+
+struct block_masks_ {
+	std::uint64_t op;
+	std::uint64_t ws;
+	std::uint64_t quote;
+	std::uint64_t backslash;
+};
+
+constexpr unsigned char class_op_ = 1;
+constexpr unsigned char class_ws_ = 2;
+constexpr unsigned char class_quote_ = 4;
+constexpr unsigned char class_backslash_ = 8;
+
+constexpr std::array<unsigned char, 256> make_class_table_() noexcept {
+	std::array<unsigned char, 256> table{};
+	for (unsigned char c : {',', ':', '[', ']', '{', '}'}) {
+		table[c] = class_op_;
+	}
+	for (unsigned char c : {' ', '\t', '\n', '\r'}) {
+		table[c] = class_ws_;
+	}
+	table['"'] = class_quote_;
+	table['\\'] = class_backslash_;
+	return table;
+}
+
+constexpr auto class_table_ = make_class_table_();
+
+block_masks_ classify_scalar_(const char* p) noexcept {
+	block_masks_ m{};
+	for (unsigned i = 0; i < 64; ++i) {
+		const unsigned c = class_table_[static_cast<unsigned char>(p[i])];
+		m.op |= static_cast<std::uint64_t>(c & 1) << i;
+		m.ws |= static_cast<std::uint64_t>((c >> 1) & 1) << i;
+		m.quote |= static_cast<std::uint64_t>((c >> 2) & 1) << i;
+		m.backslash |= static_cast<std::uint64_t>((c >> 3) & 1) << i;
+	}
+	return m;
+}
+
+// Bits of the bytes escaped by a backslash: the ones after an odd-length run of backslashes
+ESL_ATTR_FORCEINLINE std::uint64_t escaped_(std::uint64_t backslash, std::uint64_t& prev_escaped) noexcept {
+	constexpr std::uint64_t even_bits = 0x5555555555555555U;
+	backslash &= ~prev_escaped;
+	const std::uint64_t follows_escape = (backslash << 1) | prev_escaped;
+	const std::uint64_t odd_sequence_starts = backslash & ~even_bits & ~follows_escape;
+	const std::uint64_t sequences_starting_on_even_bits = odd_sequence_starts + backslash;
+	prev_escaped = sequences_starting_on_even_bits < backslash ? 1 : 0;
+	const std::uint64_t invert_mask = sequences_starting_on_even_bits << 1;
+	return (even_bits ^ invert_mask) & follows_escape;
+}
+
+ESL_ATTR_FORCEINLINE std::uint64_t prefix_xor_(std::uint64_t x) noexcept {
+	x ^= x << 1;
+	x ^= x << 2;
+	x ^= x << 4;
+	x ^= x << 8;
+	x ^= x << 16;
+	x ^= x << 32;
+	return x;
+}
+
+// in_string: prefix xor of the unescaped quotes, the opening quotes included and the closing ones excluded
+ESL_ATTR_FORCEINLINE std::uint64_t structurals_(const block_masks_& m, std::uint64_t quote, std::uint64_t in_string, structural_state_& state) noexcept {
+	in_string ^= state.in_string;
+	state.in_string = static_cast<std::uint64_t>(static_cast<std::int64_t>(in_string) >> 63);
+	const std::uint64_t scalar = ~(m.op | m.ws | quote | in_string);
+	const std::uint64_t scalar_starts = scalar & ~((scalar << 1) | state.scalar);
+	state.scalar = scalar >> 63;
+	return (m.op & ~in_string) | (quote & in_string) | scalar_starts;
+}
+
+// Unrolled against branch mispredictions, up to 16 positions past the count are garbage
+ESL_ATTR_FORCEINLINE std::size_t flatten_(std::uint64_t bits, std::uint32_t base, std::uint32_t* out) noexcept {
+	// Keeps ctz defined once the bits run out
+	constexpr std::uint64_t guard = std::uint64_t(1) << 63;
+	const std::size_t count = popcount(bits);
+	for (std::size_t i = 0; i < 8; ++i, bits &= bits - 1) {
+		out[i] = base + ctz(bits | guard);
+	}
+	if (count > 8) {
+		for (std::size_t i = 8; i < 16; ++i, bits &= bits - 1) {
+			out[i] = base + ctz(bits | guard);
+		}
+	}
+	for (std::size_t i = 16; i < count; ++i, bits &= bits - 1) {
+		out[i] = base + ctz(bits);
+	}
+	return count;
+}
+
+std::size_t structural_blocks_scalar_(const char* p, std::size_t blocks, std::uint32_t base, std::uint32_t* out, structural_state_& state) noexcept {
+	std::size_t n = 0;
+	for (std::size_t b = 0; b < blocks; ++b, p += 64, base += 64) {
+		const block_masks_ m = classify_scalar_(p);
+		const std::uint64_t quote = m.quote & ~escaped_(m.backslash, state.escaped);
+		n += flatten_(structurals_(m, quote, prefix_xor_(quote), state), base, out + n);
+	}
+	return n;
+}
+
+void newline_masks_scalar_(const char* p, std::size_t blocks, std::uint64_t* out) noexcept {
+	for (std::size_t b = 0; b < blocks; ++b, p += 64) {
+		std::uint64_t m = 0;
+		for (unsigned i = 0; i < 64; ++i) {
+			m |= static_cast<std::uint64_t>(p[i] == '\n') << i;
+		}
+		out[b] = m;
+	}
+}
+
+#ifdef ESL_ARCH_X86_ANY
+
+// Operators and whitespaces are looked up by the low nibble with pshufb:
+//   ws: table[c & 0xF] == c
+//   op: table[c & 0xF] == (c | 0x20), '[' ']' fold to '{' '}', the control characters 0x0C and 0x1A pass too,
+//       but they are invalid outside strings either way
+// Bytes with the high bit set look up zero
+
+ESL_ATTR_TARGET("pclmul")
+ESL_ATTR_FORCEINLINE std::uint64_t prefix_xor_clmul_(std::uint64_t x) noexcept {
+#	ifdef ESL_ARCH_X64
+	return static_cast<std::uint64_t>(_mm_cvtsi128_si64(_mm_clmulepi64_si128(_mm_set_epi64x(0, static_cast<long long>(x)), _mm_set1_epi8(-1), 0)));
+#	else
+	return prefix_xor_(x);
+#	endif
+}
+
+ESL_ATTR_TARGET("ssse3")
+ESL_ATTR_FORCEINLINE block_masks_ classify_ssse3_(const char* p) noexcept {
+	const __m128i ws_table = _mm_setr_epi8(' ', 0, 0, 0, 0, 0, 0, 0, 0, '\t', '\n', 0, 0, '\r', 0, 0);
+	const __m128i op_table = _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, ':', '{', ',', '}', 0, 0);
+	block_masks_ m{};
+	for (unsigned i = 0; i < 64; i += 16) {
+		const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+		const __m128i op = _mm_cmpeq_epi8(_mm_shuffle_epi8(op_table, v), _mm_or_si128(v, _mm_set1_epi8(0x20)));
+		const __m128i ws = _mm_cmpeq_epi8(_mm_shuffle_epi8(ws_table, v), v);
+		m.op |= static_cast<std::uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(op))) << i;
+		m.ws |= static_cast<std::uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(ws))) << i;
+		m.quote |= static_cast<std::uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('"'))))) << i;
+		m.backslash |= static_cast<std::uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))))) << i;
+	}
+	return m;
+}
+
+ESL_ATTR_TARGET("ssse3,pclmul")
+std::size_t structural_blocks_ssse3_(const char* p, std::size_t blocks, std::uint32_t base, std::uint32_t* out, structural_state_& state) noexcept {
+	std::size_t n = 0;
+	for (std::size_t b = 0; b < blocks; ++b, p += 64, base += 64) {
+		const block_masks_ m = classify_ssse3_(p);
+		const std::uint64_t quote = m.quote & ~escaped_(m.backslash, state.escaped);
+		n += flatten_(structurals_(m, quote, prefix_xor_clmul_(quote), state), base, out + n);
+	}
+	return n;
+}
+
+ESL_ATTR_TARGET("avx2")
+ESL_ATTR_FORCEINLINE block_masks_ classify_avx2_(const char* p) noexcept {
+	const __m256i ws_table = _mm256_setr_epi8(' ', 0, 0, 0, 0, 0, 0, 0, 0, '\t', '\n', 0, 0, '\r', 0, 0, ' ', 0, 0, 0, 0, 0, 0, 0, 0, '\t', '\n', 0, 0, '\r', 0, 0);
+	const __m256i op_table = _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, ':', '{', ',', '}', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, ':', '{', ',', '}', 0, 0);
+	block_masks_ m{};
+	for (unsigned i = 0; i < 64; i += 32) {
+		const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+		const __m256i op = _mm256_cmpeq_epi8(_mm256_shuffle_epi8(op_table, v), _mm256_or_si256(v, _mm256_set1_epi8(0x20)));
+		const __m256i ws = _mm256_cmpeq_epi8(_mm256_shuffle_epi8(ws_table, v), v);
+		m.op |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(op))) << i;
+		m.ws |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(ws))) << i;
+		m.quote |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"'))))) << i;
+		m.backslash |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))))) << i;
+	}
+	return m;
+}
+
+ESL_ATTR_TARGET("avx2,pclmul,popcnt")
+std::size_t structural_blocks_avx2_(const char* p, std::size_t blocks, std::uint32_t base, std::uint32_t* out, structural_state_& state) noexcept {
+	std::size_t n = 0;
+	for (std::size_t b = 0; b < blocks; ++b, p += 64, base += 64) {
+		const block_masks_ m = classify_avx2_(p);
+		const std::uint64_t quote = m.quote & ~escaped_(m.backslash, state.escaped);
+		n += flatten_(structurals_(m, quote, prefix_xor_clmul_(quote), state), base, out + n);
+	}
+	return n;
+}
+
+ESL_ATTR_TARGET("avx512f,avx512bw")
+ESL_ATTR_FORCEINLINE block_masks_ classify_avx512_(const char* p) noexcept {
+	const __m512i ws_table = _mm512_broadcast_i32x4(_mm_setr_epi8(' ', 0, 0, 0, 0, 0, 0, 0, 0, '\t', '\n', 0, 0, '\r', 0, 0));
+	const __m512i op_table = _mm512_broadcast_i32x4(_mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, ':', '{', ',', '}', 0, 0));
+	const __m512i v = _mm512_loadu_si512(p);
+	block_masks_ m;
+	m.op = _mm512_cmpeq_epi8_mask(_mm512_shuffle_epi8(op_table, v), _mm512_or_si512(v, _mm512_set1_epi8(0x20)));
+	m.ws = _mm512_cmpeq_epi8_mask(_mm512_shuffle_epi8(ws_table, v), v);
+	m.quote = _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('"'));
+	m.backslash = _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\\'));
+	return m;
+}
+
+ESL_ATTR_TARGET("avx512f,avx512bw,pclmul,popcnt")
+std::size_t structural_blocks_avx512_(const char* p, std::size_t blocks, std::uint32_t base, std::uint32_t* out, structural_state_& state) noexcept {
+	std::size_t n = 0;
+	for (std::size_t b = 0; b < blocks; ++b, p += 64, base += 64) {
+		const block_masks_ m = classify_avx512_(p);
+		const std::uint64_t quote = m.quote & ~escaped_(m.backslash, state.escaped);
+		n += flatten_(structurals_(m, quote, prefix_xor_clmul_(quote), state), base, out + n);
+	}
+	return n;
+}
+
+// String spans stop at '"', '\\' and bytes <= 0x1F (min_epu8(c, 0x1F) == c)
+
+ESL_ATTR_TARGET("sse2")
+std::size_t string_span_sse2_(const char* p, std::size_t n) noexcept {
+	std::size_t i = 0;
+	for (; i + 16 <= n; i += 16) {
+		const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+		const __m128i stop = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))),
+		                                  _mm_cmpeq_epi8(_mm_min_epu8(v, _mm_set1_epi8(0x1F)), v));
+		const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(stop));
+		if (mask != 0) {
+			return i + ctz(mask);
+		}
+	}
+	return i;
+}
+
+ESL_ATTR_TARGET("avx2")
+std::size_t string_span_avx2_(const char* p, std::size_t n) noexcept {
+	std::size_t i = 0;
+	for (; i + 32 <= n; i += 32) {
+		const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+		const __m256i stop = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))),
+		                                     _mm256_cmpeq_epi8(_mm256_min_epu8(v, _mm256_set1_epi8(0x1F)), v));
+		const auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(stop));
+		if (mask != 0) {
+			return i + ctz(mask);
+		}
+	}
+	return i;
+}
+
+// The tail is loaded with a mask, so the whole input is scanned
+ESL_ATTR_TARGET("avx512f,avx512bw")
+std::size_t string_span_avx512_(const char* p, std::size_t n) noexcept {
+	for (std::size_t i = 0; i < n; i += 64) {
+		const __mmask64 valid = n - i >= 64 ? ~__mmask64(0) : (std::uint64_t(1) << (n - i)) - 1;
+		const __m512i v = _mm512_maskz_loadu_epi8(valid, p + i);
+		const std::uint64_t stop = (_mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('"')) | _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\\')) |
+		                            _mm512_cmple_epu8_mask(v, _mm512_set1_epi8(0x1F))) &
+		                           valid;
+		if (stop != 0) {
+			return i + ctz(stop);
+		}
+	}
+	return n;
+}
+
+ESL_ATTR_TARGET("sse2")
+void newline_masks_sse2_(const char* p, std::size_t blocks, std::uint64_t* out) noexcept {
+	const __m128i newline = _mm_set1_epi8('\n');
+	for (std::size_t b = 0; b < blocks; ++b, p += 64) {
+		std::uint64_t m = 0;
+		for (unsigned i = 0; i < 64; i += 16) {
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+			m |= static_cast<std::uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, newline)))) << i;
+		}
+		out[b] = m;
+	}
+}
+
+ESL_ATTR_TARGET("avx2")
+void newline_masks_avx2_(const char* p, std::size_t blocks, std::uint64_t* out) noexcept {
+	const __m256i newline = _mm256_set1_epi8('\n');
+	for (std::size_t b = 0; b < blocks; ++b, p += 64) {
+		const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+		const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+		out[b] = static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, newline)))) |
+		         (static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, newline)))) << 32);
+	}
+}
+
+ESL_ATTR_TARGET("avx512f,avx512bw")
+void newline_masks_avx512_(const char* p, std::size_t blocks, std::uint64_t* out) noexcept {
+	const __m512i newline = _mm512_set1_epi8('\n');
+	for (std::size_t b = 0; b < blocks; ++b, p += 64) {
+		out[b] = _mm512_cmpeq_epi8_mask(_mm512_loadu_si512(p), newline);
+	}
+}
+
+#endif
+
+} // namespace
+
+std::size_t structural_blocks_(const char* p, std::size_t blocks, std::uint32_t base, std::uint32_t* out, structural_state_& state) noexcept {
+#ifdef ESL_ARCH_X86_ANY
+	const auto& features = current_cpu_features();
+	if (features.pclmul) {
+		if (features.avx512f && features.avx512bw) {
+			return structural_blocks_avx512_(p, blocks, base, out, state);
+		}
+		if (features.avx2) {
+			return structural_blocks_avx2_(p, blocks, base, out, state);
+		}
+		if (features.ssse3) {
+			return structural_blocks_ssse3_(p, blocks, base, out, state);
+		}
+	}
+#endif
+	return structural_blocks_scalar_(p, blocks, base, out, state);
+}
+
+std::size_t string_span_simd_(const char* p, std::size_t n) noexcept {
+#ifdef ESL_ARCH_X86_ANY
+	const auto& features = current_cpu_features();
+	if (features.avx512f && features.avx512bw) {
+		return string_span_avx512_(p, n);
+	}
+	if (features.avx2) {
+		return string_span_avx2_(p, n);
+	}
+	if (features.sse2) {
+		return string_span_sse2_(p, n);
+	}
+#else
+	(void)p;
+	(void)n;
+#endif
+	return 0;
+}
+
+void newline_masks_(const char* p, std::size_t blocks, std::uint64_t* out) noexcept {
+#ifdef ESL_ARCH_X86_ANY
+	const auto& features = current_cpu_features();
+	if (features.avx512f && features.avx512bw) {
+		return newline_masks_avx512_(p, blocks, out);
+	}
+	if (features.avx2) {
+		return newline_masks_avx2_(p, blocks, out);
+	}
+	if (features.sse2) {
+		return newline_masks_sse2_(p, blocks, out);
+	}
+#endif
+	newline_masks_scalar_(p, blocks, out);
+}
+
+} // namespace json
+
+} // namespace esl
@@ -1,10 +1,37 @@
 #ifndef ESL_JSON_HPP
 #define ESL_JSON_HPP
 
+#include "charconv.hpp"
+#include "exception.hpp"
+#include "executor.hpp"
 #include "flex_variant.hpp"
+#include "intrin.hpp"
+#include "span.hpp"
+#include "unicode.hpp"
+#include "utility.hpp"
+#include "vector_map.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace esl {
@@ -13,10 +40,24 @@ namespace json {
 
 class value;
 
+// string_hash
+// Transparent, objects are looked up by std::string_view without a copy
+struct string_hash {
+    using is_transparent = void;
+
+    std::size_t operator()(std::string_view s) const noexcept {
+        return std::hash<std::string_view>{}(s);
+    }
+};
+
 // types
+// object: unordered, see ordered::value for members in insertion order
+// integer, unsigned_integer: integral numbers, unsigned_integer only for those above the int64 range
 using null_t = std::monostate;
 using boolean = bool;
 using number = double;
+using integer = std::int64_t;
+using unsigned_integer = std::uint64_t;
 using string = std::string;
 using array = std::vector<value>;
 using object = std::unordered_map<std::string, value>;
@@ -32,15 +73,69 @@ enum index {
     string_index,
     array_index,
     object_index,
+    integer_index,
+    unsigned_integer_index,
 };
 
-using value_base = flex_variant<null_t, boolean, number, string, array, object>;
+using value_base = flex_variant<null_t, boolean, number, string, array, object, integer, unsigned_integer>;
 
 class value : public value_base {
 public:
+    using allocator_type = std::allocator<char>;
+
     using value_base::value_base;
 };
 
+// ordered
+// Values keeping object members in insertion order, see vector_map
+namespace ordered {
+
+class value;
+
+using string = std::string;
+using array = std::vector<value>;
+using object = vector_map<std::string, value, string_hash, std::equal_to<>>;
+
+using value_base = flex_variant<null_t, boolean, number, string, array, object, integer, unsigned_integer>;
+
+class value : public value_base {
+public:
+    using allocator_type = std::allocator<char>;
+
+    using value_base::value_base;
+};
+
+} // namespace ordered
+
+class value_view;
+
+// view types
+// Strings and keys are views of the parsed text, see parse_view
+using array_view = std::vector<value_view>;
+using object_view = vector_map<std::string_view, value_view, string_hash, std::equal_to<>>;
+
+using value_view_base = flex_variant<null_t, boolean, number, std::string_view, array_view, object_view, integer, unsigned_integer>;
+
+// value_view
+// Alternatives at the same indexes as value's, read by the same std::get, esl::visit and lookups by key
+class value_view : public value_view_base {
+public:
+    using allocator_type = std::allocator<char>;
+
+    using value_view_base::value_view_base;
+};
+
+// is_value_
+// Value types, and pmr::value in json_pmr.hpp
+template <class T>
+inline constexpr bool is_value_ = false;
+template <>
+inline constexpr bool is_value_<value> = true;
+template <>
+inline constexpr bool is_value_<ordered::value> = true;
+template <>
+inline constexpr bool is_value_<value_view> = true;
+
 } // namespace json
 
 } // namespace esl
@@ -63,6 +158,2216 @@ struct hash<::esl::json::value> {
     }
 };
 
+template <>
+struct variant_size<::esl::json::ordered::value> : variant_size<::esl::json::ordered::value_base> {};
+
+template <std::size_t I>
+struct variant_alternative<I, ::esl::json::ordered::value> : variant_alternative<I, ::esl::json::ordered::value_base> {};
+
+template <>
+struct hash<::esl::json::ordered::value> {
+    size_t operator()(const ::esl::json::ordered::value& n) const {
+        return hash<::esl::json::ordered::value_base>{}(n);
+    }
+};
+
+template <>
+struct variant_size<::esl::json::value_view> : variant_size<::esl::json::value_view_base> {};
+
+template <std::size_t I>
+struct variant_alternative<I, ::esl::json::value_view> : variant_alternative<I, ::esl::json::value_view_base> {};
+
+template <>
+struct hash<::esl::json::value_view> {
+    size_t operator()(const ::esl::json::value_view& n) const {
+        return hash<::esl::json::value_view_base>{}(n);
+    }
+};
+
 } // namespace std
 
+namespace esl {
+
+namespace json {
+
+// parse_error
+// position: byte offset, line and column: 1-based, column counted in bytes
+class parse_error : public std::runtime_error {
+private:
+    std::size_t position_;
+    std::size_t line_;
+    std::size_t column_;
+
+public:
+    parse_error(const char* msg, std::size_t position, std::size_t line, std::size_t column)
+        : runtime_error(msg), position_(position), line_(line), column_(column) {}
+
+    // Locate position in the input
+    parse_error(const char* msg, std::string_view input, std::size_t position) : runtime_error(msg), position_(position), line_(1), column_(1) {
+        const auto n = std::min(position, input.size());
+        for (std::size_t i = 0; i < n; ++i) {
+            if (input[i] == '\n') {
+                ++line_;
+                column_ = 1;
+            } else {
+                ++column_;
+            }
+        }
+    }
+
+    std::size_t position() const noexcept {
+        return position_;
+    }
+
+    std::size_t line() const noexcept {
+        return line_;
+    }
+
+    std::size_t column() const noexcept {
+        return column_;
+    }
+};
+
+// max_depth
+// Nesting limit of the parsers, so that destroying a parsed value can not overflow the stack
+inline constexpr std::size_t max_depth = 1024;
+
+// structural_state_
+// Carried over the 64-byte blocks of structural_blocks_
+struct structural_state_ {
+    std::uint64_t escaped = 0;   // 1 if the first byte of the next block is escaped
+    std::uint64_t in_string = 0; // all ones if the next block starts inside a string
+    std::uint64_t scalar = 0;    // 1 if the last byte of the block is part of a scalar
+};
+
+// structural_blocks_
+// Stage 1 as in simdjson (https://arxiv.org/abs/1902.08318): positions of the operators outside strings,
+// the opening quotes and the first bytes of the other scalars (numbers, true, false, null)
+// out: room for 64 * blocks + 16 positions, offset by `base'
+// return: number of positions
+// Vectorized with SSSE3/AVX2/AVX-512, defined in json.cpp
+std::size_t structural_blocks_(const char* p, std::size_t blocks, std::uint32_t base, std::uint32_t* out, structural_state_& state) noexcept;
+
+// string_span_simd_
+// Vectorized prefix of string_span_, with SSE2/AVX2/AVX-512, defined in json.cpp
+// return: length of a span, which may end before the last vector
+std::size_t string_span_simd_(const char* p, std::size_t n) noexcept;
+
+// newline_masks_
+// Bit i of out[b] is set if p[64 * b + i] is '\n'
+// Vectorized with SSE2/AVX2/AVX-512, defined in json.cpp
+void newline_masks_(const char* p, std::size_t blocks, std::uint64_t* out) noexcept;
+
+// string_span_
+// Length of the prefix free of '"', '\\' and control characters
+// Short strings are scanned 8 bytes at a time in a register (SWAR), long ones by string_span_simd_
+inline std::size_t string_span_(const char* p, std::size_t n) noexcept {
+    constexpr std::uint64_t ones = 0x0101010101010101U;
+    constexpr std::uint64_t highs = 0x8080808080808080U;
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        if (i == 32) {
+            i += string_span_simd_(p + i, n - i);
+            break;
+        }
+        std::uint64_t x;
+        std::memcpy(&x, p + i, 8);
+        x = load64le(reinterpret_cast<const unsigned char*>(&x));
+        // The lowest flagged byte is exact, borrows only flag the bytes above it
+        const std::uint64_t quote = x ^ (ones * '"');
+        const std::uint64_t backslash = x ^ (ones * '\\');
+        const std::uint64_t stop = ((quote - ones) & ~quote) | ((backslash - ones) & ~backslash) | ((x - ones * 0x20) & ~x);
+        if ((stop & highs) != 0) {
+            return i + ctz(stop & highs) / 8;
+        }
+    }
+    for (; i < n; ++i) {
+        const auto c = static_cast<unsigned char>(p[i]);
+        if (c == '"' || c == '\\' || c < 0x20) {
+            break;
+        }
+    }
+    return i;
+}
+
+// structural_index_
+// Stage 1 over a whole document, terminated by the position of the end
+class structural_index_ {
+private:
+    std::unique_ptr<std::uint32_t[]> positions_;
+    std::size_t capacity_ = 0;
+    std::size_t size_ = 0;
+
+public:
+    structural_index_() noexcept = default;
+
+    // Exceptions: esl::json::parse_error
+    explicit structural_index_(std::string_view s) {
+        this->assign(s);
+    }
+
+    // Index another document, reusing the positions buffer
+    // Exceptions: esl::json::parse_error
+    void assign(std::string_view s) {
+        if (s.size() >= std::numeric_limits<std::uint32_t>::max()) {
+            throw parse_error("document too large", s, 0);
+        }
+        const std::size_t blocks = s.size() / 64;
+        const std::size_t rest = s.size() % 64;
+        const std::size_t capacity = blocks * 64 + (rest != 0 ? 64 : 0) + 16;
+        if (capacity > capacity_) {
+            positions_.reset(new std::uint32_t[capacity]);
+            capacity_ = capacity;
+        }
+        structural_state_ state;
+        size_ = structural_blocks_(s.data(), blocks, 0, positions_.get(), state);
+        if (rest != 0) {
+            char last[64];
+            std::memset(last, ' ', sizeof(last));
+            std::memcpy(last, s.data() + blocks * 64, rest);
+            size_ += structural_blocks_(last, 1, static_cast<std::uint32_t>(blocks * 64), positions_.get() + size_, state);
+        }
+        if (state.in_string != 0) {
+            std::size_t i = size_;
+            while (s[positions_[--i]] != '"') {
+            }
+            throw parse_error("unterminated string", s, positions_[i]);
+        }
+        positions_[size_++] = static_cast<std::uint32_t>(s.size());
+    }
+
+    const std::uint32_t* data() const noexcept {
+        return positions_.get();
+    }
+
+    // Including the end
+    std::size_t size() const noexcept {
+        return size_;
+    }
+};
+
+// unexpected_
+[[noreturn]] inline void unexpected_(std::string_view s, std::size_t pos) {
+    throw parse_error(pos == s.size() ? "unexpected end of input" : "unexpected character", s, pos);
+}
+
+// is_delimiter_
+// Bytes which may follow a number or a literal
+inline constexpr bool is_delimiter_(char c) noexcept {
+    return c == ',' || c == ']' || c == '}' || c == ':' || c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// hex_digit_value_
+// return: -1 if not a hex digit
+inline constexpr int hex_digit_value_(char c) noexcept {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+// parse_hex4_
+// return: the code unit of `\uXXXX', -1 if invalid
+inline long parse_hex4_(const char* p, const char* last) noexcept {
+    if (last - p < 4) {
+        return -1;
+    }
+    long u = 0;
+    for (int i = 0; i < 4; ++i) {
+        const int d = hex_digit_value_(p[i]);
+        if (d < 0) {
+            return -1;
+        }
+        u = (u << 4) | d;
+    }
+    return u;
+}
+
+// parse_string_
+// s[pos] is the opening quote, unescaped into `scratch' only if needed
+// out: end: the position after the closing quote
+// return: the string, valid until the next call with `scratch'
+// Exceptions: esl::json::parse_error
+inline std::string_view parse_string_(std::string_view s, std::size_t pos, std::string& scratch, std::size_t& end) {
+    const char* const data = s.data();
+    const char* const first = data + pos + 1;
+    const char* const last = data + s.size();
+    const char* p = first + string_span_(first, static_cast<std::size_t>(last - first));
+    if (p != last && *p == '"') {
+        end = static_cast<std::size_t>(p + 1 - data);
+        return std::string_view(first, static_cast<std::size_t>(p - first));
+    }
+    scratch.assign(first, p);
+    for (;;) {
+        if (p == last) {
+            throw parse_error("unterminated string", s, pos);
+        }
+        const char c = *p;
+        if (c == '"') {
+            break;
+        }
+        if (c != '\\') {
+            throw parse_error("control character in string", s, static_cast<std::size_t>(p - data));
+        }
+        const char* const escape = p++;
+        switch (p != last ? *p++ : '\0') {
+        case '"':
+            scratch.push_back('"');
+            break;
+        case '\\':
+            scratch.push_back('\\');
+            break;
+        case '/':
+            scratch.push_back('/');
+            break;
+        case 'b':
+            scratch.push_back('\b');
+            break;
+        case 'f':
+            scratch.push_back('\f');
+            break;
+        case 'n':
+            scratch.push_back('\n');
+            break;
+        case 'r':
+            scratch.push_back('\r');
+            break;
+        case 't':
+            scratch.push_back('\t');
+            break;
+        case 'u': {
+            long u = parse_hex4_(p, last);
+            p += 4;
+            if (u >= 0xD800 && u <= 0xDBFF) {
+                // Surrogate pair
+                const long low = (last - p >= 2 && p[0] == '\\' && p[1] == 'u') ? parse_hex4_(p + 2, last) : -1;
+                u = (low >= 0xDC00 && low <= 0xDFFF) ? 0x10000 + ((u - 0xD800) << 10) + (low - 0xDC00) : -1;
+                p += 6;
+            } else if (u >= 0xDC00 && u <= 0xDFFF) {
+                u = -1;
+            }
+            if (u < 0) {
+                throw parse_error("invalid unicode escape", s, static_cast<std::size_t>(escape - data));
+            }
+            char u8[4];
+            scratch.append(u8, utf8_encode(static_cast<code_point>(u), u8));
+            break;
+        }
+        default:
+            throw parse_error("invalid escape", s, static_cast<std::size_t>(escape - data));
+        }
+        const auto n = string_span_(p, static_cast<std::size_t>(last - p));
+        scratch.append(p, n);
+        p += n;
+    }
+    end = static_cast<std::size_t>(p + 1 - data);
+    return scratch;
+}
+
+// scan_number_
+// JSON number grammar, digits 8 at a time
+// Exceptions: esl::json::parse_error if the number is not followed by a delimiter or the end
+inline decimal_ scan_number_(std::string_view s, std::size_t pos) {
+    const char* const last = s.data() + s.size();
+    const auto d = scan_decimal_<true>(s.data() + pos, last);
+    if (d.last == nullptr || (d.last != last && !is_delimiter_(*d.last))) {
+        throw parse_error("invalid number", s, pos);
+    }
+    return d;
+}
+
+// parse_float_
+// Correctly rounded T, see from_chars_float_
+// Exceptions: esl::json::parse_error
+template <class T>
+inline T parse_float_(const decimal_& d, std::string_view s, std::size_t pos) {
+    T x;
+    if (from_chars_float_(d, s.data() + pos, x).ec != std::errc{}) {
+        throw parse_error("number out of range", s, pos);
+    }
+    return x;
+}
+template <class T>
+inline T parse_float_(std::string_view s, std::size_t pos) {
+    return parse_float_<T>(scan_number_(s, pos), s, pos);
+}
+
+// number_
+// A parsed number: type is number_index, integer_index or unsigned_integer_index
+struct number_ {
+    index type;
+    union {
+        double d;
+        std::int64_t i;
+        std::uint64_t u;
+    };
+
+    number_(double x) noexcept : type(number_index), d(x) {}
+    number_(std::int64_t x) noexcept : type(integer_index), i(x) {}
+    number_(std::uint64_t x) noexcept : type(unsigned_integer_index), u(x) {}
+
+    double to_double() const noexcept {
+        return type == number_index ? d : type == integer_index ? static_cast<double>(i) : static_cast<double>(u);
+    }
+};
+
+// parse_number_
+// Numbers without a fraction or an exponent are integers if they fit int64, unsigned integers if they fit uint64,
+// others doubles, so that every number dumps back to the same value
+// NOTE: -0 is a double
+// Exceptions: esl::json::parse_error
+inline number_ parse_number_(std::string_view s, std::size_t pos) {
+    const auto d = scan_number_(s, pos);
+    if (d.integral) {
+        constexpr auto int_max = static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max());
+        if (d.truncated) {
+            // At least 20 digits, no leading zeros
+            std::uint64_t u;
+            if (!d.negative && std::from_chars(s.data() + pos, d.last, u).ec == std::errc{}) {
+                return number_(u);
+            }
+        } else if (!d.negative) {
+            return d.mantissa <= int_max ? number_(static_cast<std::int64_t>(d.mantissa)) : number_(d.mantissa);
+        } else if (d.mantissa != 0 && d.mantissa - 1 <= int_max) {
+            return number_(-static_cast<std::int64_t>(d.mantissa - 1) - 1);
+        }
+    }
+    return number_(parse_float_<double>(d, s, pos));
+}
+
+// has_integer_event_, has_unsigned_integer_event_
+template <class Handler, class = void>
+inline constexpr bool has_integer_event_ = false;
+template <class Handler>
+inline constexpr bool has_integer_event_<Handler, std::void_t<decltype(std::declval<Handler&>().integer(std::int64_t()))>> = true;
+template <class Handler, class = void>
+inline constexpr bool has_unsigned_integer_event_ = false;
+template <class Handler>
+inline constexpr bool has_unsigned_integer_event_<Handler, std::void_t<decltype(std::declval<Handler&>().unsigned_integer(std::uint64_t()))>> =
+    true;
+
+// integer_event_, unsigned_integer_event_, number_event_
+// Handlers without integer events get the numbers as doubles
+template <class Handler>
+inline void integer_event_(Handler& handler, std::int64_t i) {
+    if constexpr (has_integer_event_<Handler>) {
+        handler.integer(i);
+    } else {
+        handler.number(static_cast<double>(i));
+    }
+}
+template <class Handler>
+inline void unsigned_integer_event_(Handler& handler, std::uint64_t u) {
+    if constexpr (has_unsigned_integer_event_<Handler>) {
+        handler.unsigned_integer(u);
+    } else {
+        handler.number(static_cast<double>(u));
+    }
+}
+template <class Handler>
+inline void number_event_(Handler& handler, const number_& n) {
+    switch (n.type) {
+    case integer_index:
+        integer_event_(handler, n.i);
+        break;
+    case unsigned_integer_index:
+        unsigned_integer_event_(handler, n.u);
+        break;
+    default:
+        handler.number(n.d);
+    }
+}
+
+// parse_literal_
+// Exceptions: esl::json::parse_error
+inline void parse_literal_(std::string_view s, std::size_t pos, std::string_view literal) {
+    if (s.compare(pos, literal.size(), literal) != 0 || (pos + literal.size() != s.size() && !is_delimiter_(s[pos + literal.size()]))) {
+        throw parse_error("invalid literal", s, pos);
+    }
+}
+
+// structural_parser_
+// Stage 2: walk the structural index with an explicit stack, calling
+//   null(), boolean(bool), number(double), string(std::string_view), key(std::string_view),
+//   begin_object(), end_object(std::size_t members), begin_array(), end_array(std::size_t elements)
+// and optionally integer(std::int64_t), unsigned_integer(std::uint64_t), see parse_number_
+// Strings are views of `s' or of the scratch, valid only during the call
+// Resumable: a bounded run stops when less than two positions are left before `last', so a token is only read once the
+// next structural character is indexed, and continues from the same state with the rest of the index
+class structural_parser_ {
+private:
+    struct scope {
+        bool object;
+        std::size_t count;
+    };
+    enum state_type { value_state, key_state, next_state, done_state };
+
+    std::vector<scope> scopes_;
+    state_type state_ = value_state;
+    std::string scratch_;
+    char* in_place_ = nullptr;
+
+    std::string_view string(std::string_view s, std::size_t pos, std::size_t& end) {
+        const auto sv = parse_string_(s, pos, scratch_, end);
+        if (in_place_ == nullptr || sv.data() != scratch_.data()) {
+            return sv;
+        }
+        // Never longer than the escaped text, so the closing quote and the structurals after it are kept
+        char* const p = in_place_ + pos + 1;
+        std::memcpy(p, sv.data(), sv.size());
+        return std::string_view(p, sv.size());
+    }
+
+public:
+    // unescape_in_place
+    // data: the mutable text of `s', escaped strings are unescaped over their source and every string is a view of `s'
+    void unescape_in_place(char* data) noexcept {
+        in_place_ = data;
+    }
+
+    // done
+    // The value is complete
+    bool done() const noexcept {
+        return state_ == done_state;
+    }
+
+    // run
+    // Bounded: stop before `last', otherwise the index must end with the end of `s'
+    // return: the index past the value if done, otherwise the first position not consumed
+    // Exceptions: esl::json::parse_error, and exceptions thrown by the handler
+    template <bool Bounded, class Handler>
+    const std::uint32_t* run(std::string_view s, const std::uint32_t* index, const std::uint32_t* last, Handler& handler) {
+        const auto at = [&s](std::size_t pos) { return pos < s.size() ? s[pos] : '\0'; };
+        const auto nest = [&]() {
+            if (scopes_.size() == max_depth) {
+                throw parse_error("too deeply nested", s, index[-1]);
+            }
+        };
+        auto state = state_;
+        std::size_t pos;
+        std::size_t end;
+        for (;;) {
+            if constexpr (Bounded) {
+                if (last - index < 2 && !(state == next_state && scopes_.empty())) {
+                    state_ = state;
+                    return index;
+                }
+            }
+            switch (state) {
+            case value_state:
+                pos = *index++;
+                switch (at(pos)) {
+                case '{':
+                    nest();
+                    handler.begin_object();
+                    if (at(*index) == '}') {
+                        ++index;
+                        handler.end_object(0);
+                        state = next_state;
+                    } else {
+                        scopes_.push_back(scope{true, 0});
+                        state = key_state;
+                    }
+                    break;
+                case '[':
+                    nest();
+                    handler.begin_array();
+                    if (at(*index) == ']') {
+                        ++index;
+                        handler.end_array(0);
+                        state = next_state;
+                    } else {
+                        scopes_.push_back(scope{false, 0});
+                    }
+                    break;
+                case '"':
+                    handler.string(this->string(s, pos, end));
+                    state = next_state;
+                    break;
+                case 't':
+                    parse_literal_(s, pos, "true");
+                    handler.boolean(true);
+                    state = next_state;
+                    break;
+                case 'f':
+                    parse_literal_(s, pos, "false");
+                    handler.boolean(false);
+                    state = next_state;
+                    break;
+                case 'n':
+                    parse_literal_(s, pos, "null");
+                    handler.null();
+                    state = next_state;
+                    break;
+                case '-':
+                case '0':
+                case '1':
+                case '2':
+                case '3':
+                case '4':
+                case '5':
+                case '6':
+                case '7':
+                case '8':
+                case '9':
+                    number_event_(handler, parse_number_(s, pos));
+                    state = next_state;
+                    break;
+                default:
+                    unexpected_(s, pos);
+                }
+                break;
+            case key_state:
+                pos = *index++;
+                if (at(pos) != '"') {
+                    throw parse_error(pos == s.size() ? "unexpected end of input" : "expected string key", s, pos);
+                }
+                handler.key(this->string(s, pos, end));
+                pos = *index++;
+                if (at(pos) != ':') {
+                    throw parse_error(pos == s.size() ? "unexpected end of input" : "expected ':'", s, pos);
+                }
+                state = value_state;
+                break;
+            case next_state: {
+                if (scopes_.empty()) {
+                    state_ = done_state;
+                    return index;
+                }
+                auto& top = scopes_.back();
+                ++top.count;
+                pos = *index++;
+                const char c = at(pos);
+                if (c == ',') {
+                    state = top.object ? key_state : value_state;
+                } else if (c == (top.object ? '}' : ']')) {
+                    const auto count = top.count;
+                    const bool object = top.object;
+                    scopes_.pop_back();
+                    if (object) {
+                        handler.end_object(count);
+                    } else {
+                        handler.end_array(count);
+                    }
+                } else if (pos == s.size()) {
+                    unexpected_(s, pos);
+                } else {
+                    throw parse_error(top.object ? "expected ',' or '}'" : "expected ',' or ']'", s, pos);
+                }
+                break;
+            }
+            case done_state:
+                return index;
+            }
+        }
+    }
+};
+
+// parse_structurals_
+// Parse the value at `index' of the whole index of `s'
+// return: the index past the value
+template <class Handler>
+const std::uint32_t* parse_structurals_(std::string_view s, const std::uint32_t* index, Handler& handler) {
+    structural_parser_ parser;
+    return parser.run<false>(s, index, nullptr, handler);
+}
+
+// value_layout_
+// Alternative indexes of a value built by value_builder_, see codec_detail.hpp for yaml::node
+// unsigned_integer: std::variant_npos if integers above the int64 range are numbers
+template <class Value>
+struct value_layout_ {
+    static constexpr std::size_t boolean = boolean_index;
+    static constexpr std::size_t number = number_index;
+    static constexpr std::size_t string = string_index;
+    static constexpr std::size_t array = array_index;
+    static constexpr std::size_t object = object_index;
+    static constexpr std::size_t integer = integer_index;
+    static constexpr std::size_t unsigned_integer = unsigned_integer_index;
+};
+
+// value_builder_
+// Stage 2 handler building a value: children are kept on one stack and moved into containers of the exact size
+// Value: value, ordered::value, pmr::value (json_pmr.hpp), value_view or yaml::node, every node is constructed with the allocator
+template <class Value>
+class value_builder_ {
+private:
+    using layout = value_layout_<Value>;
+    using allocator_type = typename Value::allocator_type;
+    using string_type = std::variant_alternative_t<layout::string, Value>;
+    using array_type = std::variant_alternative_t<layout::array, Value>;
+    using object_type = std::variant_alternative_t<layout::object, Value>;
+
+    allocator_type alloc_;
+    std::vector<Value> values_;
+    std::vector<string_type> keys_;
+
+public:
+    explicit value_builder_(const allocator_type& alloc = allocator_type()) : alloc_(alloc) {}
+
+    void null() {
+        values_.emplace_back(std::allocator_arg, alloc_);
+    }
+    void boolean(bool b) {
+        values_.emplace_back(std::allocator_arg, alloc_, std::in_place_index<layout::boolean>, b);
+    }
+    void number(double d) {
+        values_.emplace_back(std::allocator_arg, alloc_, std::in_place_index<layout::number>, d);
+    }
+    void integer(std::int64_t i) {
+        values_.emplace_back(std::allocator_arg, alloc_, std::in_place_index<layout::integer>, i);
+    }
+    void unsigned_integer(std::uint64_t u) {
+        if constexpr (layout::unsigned_integer != std::variant_npos) {
+            values_.emplace_back(std::allocator_arg, alloc_, std::in_place_index<layout::unsigned_integer>, u);
+        } else {
+            this->number(static_cast<double>(u));
+        }
+    }
+    void string(std::string_view sv) {
+        values_.emplace_back(std::allocator_arg, alloc_, std::in_place_index<layout::string>, sv);
+    }
+    void key(std::string_view sv) {
+        if constexpr (std::uses_allocator_v<string_type, allocator_type>) {
+            keys_.emplace_back(sv, alloc_);
+        } else {
+            keys_.emplace_back(sv);
+        }
+    }
+    void begin_object() {}
+    void end_object(std::size_t n) {
+        object_type o(alloc_);
+        o.reserve(n);
+        const auto first = values_.end() - static_cast<std::ptrdiff_t>(n);
+        auto k = keys_.end() - static_cast<std::ptrdiff_t>(n);
+        for (auto v = first; v != values_.end(); ++v, ++k) {
+            o.insert_or_assign(std::move(*k), std::move(*v));
+        }
+        keys_.erase(keys_.end() - static_cast<std::ptrdiff_t>(n), keys_.end());
+        values_.erase(first, values_.end());
+        values_.emplace_back(std::allocator_arg, alloc_, std::in_place_index<layout::object>, std::move(o));
+    }
+    void begin_array() {}
+    void end_array(std::size_t n) {
+        const auto first = values_.end() - static_cast<std::ptrdiff_t>(n);
+        array_type a(std::make_move_iterator(first), std::make_move_iterator(values_.end()), alloc_);
+        values_.erase(first, values_.end());
+        values_.emplace_back(std::allocator_arg, alloc_, std::in_place_index<layout::array>, std::move(a));
+    }
+
+    // The built value, the builder is ready for another one
+    Value take() {
+        Value v = std::move(values_.back());
+        values_.pop_back();
+        return v;
+    }
+};
+
+// parse_
+// index and builder may be reused across documents
+template <class Value>
+inline Value parse_(std::string_view s, structural_index_& index, value_builder_<Value>& builder) {
+    index.assign(s);
+    const auto end = parse_structurals_(s, index.data(), builder);
+    if (*end != s.size()) {
+        throw parse_error("trailing characters", s, *end);
+    }
+    return builder.take();
+}
+template <class Value>
+inline Value parse_(std::string_view s, const typename Value::allocator_type& alloc) {
+    structural_index_ index;
+    value_builder_<Value> builder(alloc);
+    return parse_(s, index, builder);
+}
+
+// parse
+// Two stages as in simdjson: a vectorized index of the structural characters, then a tree build driven by the index
+// Strings are not validated as UTF-8
+// Exceptions: esl::json::parse_error
+inline value parse(std::string_view s) {
+    return parse_<value>(s, {});
+}
+
+namespace ordered {
+
+// parse
+// Exceptions: esl::json::parse_error
+inline value parse(std::string_view s) {
+    return parse_<value>(s, {});
+}
+
+} // namespace ordered
+
+// parse_view_
+template <class Builder>
+inline value_view parse_view_(std::string_view s, char* in_place, Builder& builder) {
+    structural_index_ index;
+    index.assign(s);
+    structural_parser_ parser;
+    parser.unescape_in_place(in_place);
+    const auto end = parser.run<false>(s, index.data(), nullptr, builder);
+    if (*end != s.size()) {
+        throw parse_error("trailing characters", s, *end);
+    }
+    return builder.take();
+}
+
+// parse_view
+// Strings and keys are views of `text', which must outlive the value, as a memory-mapped file;
+// escaped strings are unescaped in place, overwriting `text' within the string literals
+// See json_pmr.hpp for read-only text, with escaped strings unescaped into an arena
+// NOTE: Only arrays and objects are allocated
+// Exceptions: esl::json::parse_error
+inline value_view parse_view(span<char> text) {
+    value_builder_<value_view> builder;
+    return parse_view_(std::string_view(text.data(), text.size()), text.data(), builder);
+}
+
+// reader
+// Streaming parser of one value: the input is pulled in chunks, indexed and parsed as it comes, calling the handler of
+// structural_parser_, so memory is bounded by the nesting depth and the longest token rather than the input size
+// Strings are views of the buffer if not escaped, valid only during the call
+// Errors are located in the whole input
+class reader {
+public:
+    // source_type
+    // Read at most `size' bytes to `buf', 0 at the end of input
+    using source_type = std::function<std::size_t(char* buf, std::size_t size)>;
+
+    static constexpr std::size_t default_chunk_size = 64 * 1024;
+
+private:
+    source_type source_;
+    std::size_t chunk_size_;
+    std::unique_ptr<char[]> buffer_;
+    std::size_t capacity_ = 0;
+    std::size_t size_ = 0;
+    std::size_t indexed_ = 0; // bytes of the buffer indexed
+    std::unique_ptr<std::uint32_t[]> positions_;
+    std::size_t positions_capacity_ = 0;
+    std::size_t count_ = 0; // positions not consumed, the end of input twice at the end
+    structural_state_ state_;
+    bool eof_ = false;
+    // Location of the buffer in the input
+    std::size_t offset_ = 0;
+    std::size_t line_ = 1;
+    std::size_t column_ = 1;
+
+    std::string_view view() const noexcept {
+        return std::string_view(buffer_.get(), size_);
+    }
+
+    // Drop the buffer before the first position not consumed, or the bytes indexed if none
+    void compact(const std::uint32_t* first) {
+        const auto consumed = static_cast<std::size_t>(first - positions_.get());
+        const std::size_t keep = consumed != count_ ? positions_[consumed] : indexed_;
+        if (keep != 0) {
+            const char* p = buffer_.get();
+            const char* const last = p + keep;
+            while (const void* nl = std::memchr(p, '\n', static_cast<std::size_t>(last - p))) {
+                p = static_cast<const char*>(nl) + 1;
+                ++line_;
+                column_ = 1;
+            }
+            column_ += static_cast<std::size_t>(last - p);
+            offset_ += keep;
+            std::memmove(buffer_.get(), buffer_.get() + keep, size_ - keep);
+            size_ -= keep;
+            indexed_ -= keep;
+        }
+        for (std::size_t i = consumed; i < count_; ++i) {
+            positions_[i - consumed] = positions_[i] - static_cast<std::uint32_t>(keep);
+        }
+        count_ -= consumed;
+    }
+
+    // Read a chunk and index the complete blocks, or all at the end of input
+    void fill() {
+        if (size_ + chunk_size_ >= std::numeric_limits<std::uint32_t>::max()) {
+            throw parse_error("token too large", this->view(), 0);
+        }
+        if (capacity_ - size_ < chunk_size_) {
+            const auto capacity = std::max(capacity_ * 2, size_ + chunk_size_);
+            std::unique_ptr<char[]> buffer(new char[capacity]);
+            std::copy(buffer_.get(), buffer_.get() + size_, buffer.get());
+            buffer_ = std::move(buffer);
+            capacity_ = capacity;
+        }
+        const auto n = source_(buffer_.get() + size_, chunk_size_);
+        size_ += n;
+        eof_ = n == 0;
+
+        const std::size_t blocks = (size_ - indexed_) / 64;
+        const std::size_t needed = count_ + (blocks + 1) * 64 + 16;
+        if (positions_capacity_ < needed) {
+            const auto capacity = std::max(positions_capacity_ * 2, needed);
+            std::unique_ptr<std::uint32_t[]> positions(new std::uint32_t[capacity]);
+            std::copy(positions_.get(), positions_.get() + count_, positions.get());
+            positions_ = std::move(positions);
+            positions_capacity_ = capacity;
+        }
+        count_ += structural_blocks_(buffer_.get() + indexed_, blocks, static_cast<std::uint32_t>(indexed_), positions_.get() + count_, state_);
+        indexed_ += blocks * 64;
+        if (eof_) {
+            if (indexed_ != size_) {
+                char last[64];
+                std::memset(last, ' ', sizeof(last));
+                std::memcpy(last, buffer_.get() + indexed_, size_ - indexed_);
+                count_ += structural_blocks_(last, 1, static_cast<std::uint32_t>(indexed_), positions_.get() + count_, state_);
+                indexed_ = size_;
+            }
+            if (state_.in_string != 0) {
+                std::size_t i = count_;
+                while (buffer_[positions_[--i]] != '"') {
+                }
+                throw parse_error("unterminated string", this->view(), positions_[i]);
+            }
+            positions_[count_++] = static_cast<std::uint32_t>(size_);
+            positions_[count_++] = static_cast<std::uint32_t>(size_);
+        }
+    }
+
+    // Locate an error of the buffer in the input
+    parse_error locate(const parse_error& e) const {
+        return parse_error(e.what(), offset_ + e.position(), line_ + e.line() - 1, e.line() == 1 ? column_ + e.column() - 1 : e.column());
+    }
+
+public:
+    // chunk_size: bytes read at once, at least 64
+    explicit reader(source_type source, std::size_t chunk_size = default_chunk_size)
+        : source_(std::move(source)), chunk_size_(std::max<std::size_t>(chunk_size, 64)) {}
+
+    // Exceptions (read): std::system_error if reading the file fails
+    explicit reader(std::FILE* file, std::size_t chunk_size = default_chunk_size)
+        : reader(
+              [file](char* buf, std::size_t size) {
+                  const auto n = std::fread(buf, 1, size, file);
+                  if (n == 0 && std::ferror(file)) {
+                      throw std::system_error(errno, std::generic_category(), "esl::json::reader");
+                  }
+                  return n;
+              },
+              chunk_size) {}
+
+    // NOTE: Views the text, which must outlive the reader
+    explicit reader(std::string_view text, std::size_t chunk_size = default_chunk_size)
+        : reader(
+              [text](char* buf, std::size_t size) mutable {
+                  const auto n = std::min(size, text.size());
+                  std::memcpy(buf, text.data(), n);
+                  text.remove_prefix(n);
+                  return n;
+              },
+              chunk_size) {}
+
+    // read
+    // Read the value, and then the rest of input which must be whitespace
+    // Handler: see structural_parser_
+    // Exceptions: esl::json::parse_error, and exceptions thrown by the source or the handler
+    template <class Handler>
+    void read(Handler& handler) {
+        structural_parser_ parser;
+        try {
+            const std::uint32_t* first = positions_.get();
+            while (!parser.done()) {
+                first = parser.run<true>(this->view(), first, positions_.get() + count_, handler);
+                if (!parser.done()) {
+                    this->compact(first);
+                    this->fill();
+                    first = positions_.get();
+                }
+            }
+            for (;;) {
+                if (first != positions_.get() + count_ && *first != size_) {
+                    throw parse_error("trailing characters", this->view(), *first);
+                }
+                if (eof_) {
+                    break;
+                }
+                this->compact(positions_.get() + count_);
+                this->fill();
+                first = positions_.get();
+            }
+        } catch (const parse_error& e) {
+            throw this->locate(e);
+        }
+    }
+};
+
+// parse
+// Build a value from a reader
+// Exceptions: esl::json::parse_error, and exceptions thrown by the source
+inline value parse(reader& r) {
+    value_builder_<value> builder;
+    r.read(builder);
+    return builder.take();
+}
+
+// scan_newlines_
+// f(std::size_t base, std::uint64_t mask) for each 64 bytes of s, bit i of mask set if s[base + i] is '\n'
+// f returns false to stop the scan
+template <class F>
+inline void scan_newlines_(std::string_view s, F f) {
+    constexpr std::size_t window = 64;
+    std::uint64_t masks[window];
+    const std::size_t blocks = s.size() / 64;
+    for (std::size_t b = 0; b < blocks; b += window) {
+        const std::size_t n = std::min(window, blocks - b);
+        newline_masks_(s.data() + b * 64, n, masks);
+        for (std::size_t i = 0; i < n; ++i) {
+            if (!f((b + i) * 64, masks[i])) {
+                return;
+            }
+        }
+    }
+    std::uint64_t mask = 0;
+    for (std::size_t i = blocks * 64; i < s.size(); ++i) {
+        mask |= static_cast<std::uint64_t>(s[i] == '\n') << (i - blocks * 64);
+    }
+    f(blocks * 64, mask);
+}
+
+// count_newlines_
+inline std::size_t count_newlines_(std::string_view s) {
+    std::size_t n = 0;
+    scan_newlines_(s, [&n](std::size_t, std::uint64_t mask) {
+        n += popcount(mask);
+        return true;
+    });
+    return n;
+}
+
+// parse_lines_chunk_
+// Parse the lines of s, blank lines are skipped
+// on_value(std::size_t line, value&& v), on_error(std::size_t line, std::size_t line_start, const parse_error& e),
+// with line counted from 0 and e located in the line
+// return: number of '\n' in s
+template <class OnValue, class OnError>
+inline std::size_t parse_lines_chunk_(std::string_view s, const std::atomic<bool>& stop, OnValue&& on_value, OnError&& on_error) {
+    structural_index_ index;
+    value_builder_<value> builder;
+    std::size_t line = 0;
+    std::size_t start = 0;
+    const auto parse_line = [&](std::size_t end) {
+        const auto text = s.substr(start, end - start);
+        if (text.find_first_not_of(" \t\r") == std::string_view::npos) {
+            return;
+        }
+        value v;
+        try {
+            v = parse_(text, index, builder);
+        } catch (const parse_error& e) {
+            builder = value_builder_<value>();
+            on_error(line, start, e);
+            return;
+        }
+        on_value(line, std::move(v));
+    };
+    scan_newlines_(s, [&](std::size_t base, std::uint64_t mask) {
+        for (; mask != 0; mask &= mask - 1) {
+            const std::size_t end = base + ctz(mask);
+            parse_line(end);
+            ++line;
+            start = end + 1;
+        }
+        return !stop.load(std::memory_order_relaxed);
+    });
+    if (start < s.size() && !stop.load(std::memory_order_relaxed)) {
+        parse_line(s.size());
+    }
+    return line;
+}
+
+// line_order
+// Delivery of the parse_lines results
+enum class line_order {
+    ordered,   // in line order, one callback at a time
+    unordered, // as soon as parsed, callbacks may run concurrently from the executor jobs
+};
+
+// parse_lines_min_chunk
+// Smallest input worth a job of parse_lines
+inline constexpr std::size_t parse_lines_min_chunk = 256 * 1024;
+
+// parse_lines
+// Parse newline-delimited JSON (JSON Lines, NDJSON): the text is split into chunks at line starts, a few per executor thread,
+// and each chunk is scanned for '\n' and parsed line by line as an executor job
+// callback: void(std::size_t line, value&& v), line counted from 1, blank lines are skipped
+// on_error: void(const parse_error& e) for a malformed line, located in the whole text
+// NOTE: Ordered results of a chunk are held until the chunks before it are delivered
+// NOTE: Once a callback throws, the jobs not started yet and the rest of the running ones are skipped
+// Exceptions: The first exception thrown by the callbacks, whatever the executor throws
+template <class Executor, class Callback, class ErrorCallback>
+inline void parse_lines(span<const char> text, Executor&& executor, Callback callback, ErrorCallback on_error, line_order order = line_order::ordered) {
+    const std::string_view s(text.data(), text.size());
+    const std::size_t n = std::max<std::size_t>(1, std::min<std::size_t>(executor.concurrency() * 4, s.size() / parse_lines_min_chunk));
+    // Chunk i is [bounds[i], bounds[i + 1])
+    std::vector<std::size_t> bounds(n + 1, s.size());
+    bounds[0] = 0;
+    for (std::size_t i = 1; i < n; ++i) {
+        const std::size_t target = std::max(bounds[i - 1], s.size() / n * i);
+        const auto newline = static_cast<const char*>(std::memchr(s.data() + target, '\n', s.size() - target));
+        bounds[i] = newline != nullptr ? static_cast<std::size_t>(newline - s.data()) + 1 : s.size();
+    }
+    const auto chunk = [&](std::size_t i) { return s.substr(bounds[i], bounds[i + 1] - bounds[i]); };
+    const auto locate = [&](const parse_error& e, std::size_t line, std::size_t line_start) {
+        return parse_error(e.what(), line_start + e.position(), line + 1, e.column());
+    };
+    std::atomic<bool> stop{false};
+    if (order == line_order::unordered) {
+        // First lines of the chunks, counted from 0
+        std::vector<std::size_t> lines(n + 1, 0);
+        executor.bulk(n - 1, [&](std::size_t i) { lines[i + 1] = count_newlines_(chunk(i)); });
+        for (std::size_t i = 1; i < n; ++i) {
+            lines[i] += lines[i - 1];
+        }
+        executor.bulk(n, [&](std::size_t i) {
+            if (stop.load(std::memory_order_relaxed)) {
+                return;
+            }
+            try {
+                parse_lines_chunk_(
+                    chunk(i), stop, [&](std::size_t line, value&& v) { callback(lines[i] + line + 1, std::move(v)); },
+                    [&](std::size_t line, std::size_t line_start, const parse_error& e) { on_error(locate(e, lines[i] + line, bounds[i] + line_start)); });
+            } catch (...) {
+                stop = true;
+                throw;
+            }
+        });
+        return;
+    }
+    struct chunk_result {
+        std::vector<std::pair<std::size_t, value>> values;
+        std::vector<std::pair<std::size_t, parse_error>> errors; // before values[first], located in the chunk
+        std::size_t newlines = 0;
+        bool done = false;
+    };
+    std::vector<chunk_result> results(n);
+    std::mutex mutex;
+    std::size_t next = 0;
+    std::size_t line_base = 0;
+    const auto deliver = [&](chunk_result& r, std::size_t offset) {
+        auto e = r.errors.begin();
+        for (std::size_t k = 0; k <= r.values.size(); ++k) {
+            for (; e != r.errors.end() && e->first == k; ++e) {
+                on_error(parse_error(e->second.what(), offset + e->second.position(), line_base + e->second.line(), e->second.column()));
+            }
+            if (k != r.values.size()) {
+                callback(line_base + r.values[k].first + 1, std::move(r.values[k].second));
+            }
+        }
+        line_base += r.newlines;
+        r = chunk_result();
+    };
+    executor.bulk(n, [&](std::size_t i) {
+        if (stop.load(std::memory_order_relaxed)) {
+            return;
+        }
+        chunk_result r;
+        r.newlines = parse_lines_chunk_(
+            chunk(i), stop, [&](std::size_t line, value&& v) { r.values.emplace_back(line, std::move(v)); },
+            [&](std::size_t line, std::size_t line_start, const parse_error& e) {
+                r.errors.emplace_back(r.values.size(), parse_error(e.what(), line_start + e.position(), line + 1, e.column()));
+            });
+        std::lock_guard<std::mutex> lock(mutex);
+        results[i] = std::move(r);
+        results[i].done = true;
+        try {
+            for (; next < n && results[next].done && !stop.load(std::memory_order_relaxed); ++next) {
+                deliver(results[next], bounds[next]);
+            }
+        } catch (...) {
+            stop = true;
+            throw;
+        }
+    });
+}
+
+// parse_lines
+// Exceptions: esl::json::parse_error of a malformed line (the first one if ordered), the first exception thrown by callback,
+// whatever the executor throws
+template <class Executor, class Callback>
+inline void parse_lines(span<const char> text, Executor&& executor, Callback callback, line_order order = line_order::ordered) {
+    parse_lines(text, executor, std::move(callback), [](const parse_error& e) { throw e; }, order);
+}
+
+// lazy_skip_
+// Skip the value at `index' by matching brackets, its content is not validated
+// return: the index past the value
+// depth: 1 to skip the rest of the container holding `index'
+// Exceptions: esl::json::parse_error
+inline const std::uint32_t* lazy_skip_(std::string_view s, const std::uint32_t* index, std::size_t depth = 0) {
+    do {
+        const std::size_t pos = *index++;
+        if (pos == s.size()) {
+            unexpected_(s, pos);
+        }
+        switch (s[pos]) {
+        case '{':
+        case '[':
+            ++depth;
+            break;
+        case '}':
+        case ']':
+            --depth;
+            break;
+        default:
+            break;
+        }
+    } while (depth != 0);
+    return index;
+}
+
+// lazy_member_
+// Check the key and the colon of the member at `index'
+// Exceptions: esl::json::parse_error
+inline void lazy_member_(std::string_view s, const std::uint32_t* index) {
+    if (index[0] == s.size() || s[index[0]] != '"') {
+        throw parse_error(index[0] == s.size() ? "unexpected end of input" : "expected string key", s, index[0]);
+    }
+    if (index[1] == s.size() || s[index[1]] != ':') {
+        throw parse_error(index[1] == s.size() ? "unexpected end of input" : "expected ':'", s, index[1]);
+    }
+}
+
+// lazy_value
+// A value of a document, read only when accessed. Subtrees not accessed are skipped by bracket matching over the
+// structural index, so they are not validated.
+// NOTE: Views the text and the index of the document, which must outlive it
+// Exceptions (all accesses): esl::json::parse_error if the accessed part is invalid
+class lazy_value {
+private:
+    std::string_view text_;
+    const std::uint32_t* index_; // of the value
+
+    char first() const noexcept {
+        return *index_ < text_.size() ? text_[*index_] : '\0';
+    }
+
+public:
+    class iterator;
+
+    lazy_value(std::string_view text, const std::uint32_t* index) noexcept : text_(text), index_(index) {}
+
+    // type
+    json::index type() const {
+        switch (this->first()) {
+        case '{':
+            return object_index;
+        case '[':
+            return array_index;
+        case '"':
+            return string_index;
+        case 't':
+        case 'f':
+            return boolean_index;
+        case 'n':
+            return null_index;
+        case '-':
+        case '0':
+        case '1':
+        case '2':
+        case '3':
+        case '4':
+        case '5':
+        case '6':
+        case '7':
+        case '8':
+        case '9':
+            return parse_number_(text_, *index_).type;
+        default:
+            unexpected_(text_, *index_);
+        }
+    }
+
+    // get
+    // T: null_t, boolean, number, string, integer, unsigned_integer or value
+    // Exceptions: std::bad_variant_access if the value is not a T
+    template <class T>
+    T get() const {
+        if constexpr (std::is_same_v<T, value>) {
+            return this->to_value();
+        } else if constexpr (std::is_same_v<T, json::number> || std::is_same_v<T, integer> || std::is_same_v<T, unsigned_integer>) {
+            if (this->first() != '-' && !is_digit_(this->first())) {
+                this->type();
+                throw std::bad_variant_access{};
+            }
+            const auto n = parse_number_(text_, *index_);
+            constexpr auto t = std::is_same_v<T, json::number> ? number_index : std::is_same_v<T, integer> ? integer_index : unsigned_integer_index;
+            if (n.type != t) {
+                throw std::bad_variant_access{};
+            }
+            if constexpr (std::is_same_v<T, json::number>) {
+                return n.d;
+            } else if constexpr (std::is_same_v<T, integer>) {
+                return n.i;
+            } else {
+                return n.u;
+            }
+        } else {
+            if (this->type() != index_of_v<T, null_t, boolean, json::number, json::string, array, object>) {
+                throw std::bad_variant_access{};
+            }
+            if constexpr (std::is_same_v<T, null_t>) {
+                parse_literal_(text_, *index_, "null");
+                return null;
+            } else if constexpr (std::is_same_v<T, boolean>) {
+                const bool b = this->first() == 't';
+                parse_literal_(text_, *index_, b ? "true" : "false");
+                return b;
+            } else {
+                static_assert(std::is_same_v<T, json::string>,
+                              "esl::json::lazy_value::get: T should be null_t, boolean, number, string, integer, unsigned_integer or value");
+                std::string scratch;
+                std::size_t end;
+                const auto sv = parse_string_(text_, *index_, scratch, end);
+                return sv.data() == scratch.data() ? std::move(scratch) : json::string(sv);
+            }
+        }
+    }
+
+    // to_value
+    // Materialize the subtree
+    value to_value() const {
+        value_builder_<value> builder;
+        parse_structurals_(text_, index_, builder);
+        return builder.take();
+    }
+
+    // raw
+    // Text of the value, whitespace excluded
+    std::string_view raw() const {
+        const auto last = lazy_skip_(text_, index_) - 1;
+        std::size_t end = *last + 1;
+        if (this->first() == '"') {
+            std::string scratch;
+            parse_string_(text_, *index_, scratch, end);
+        } else if (this->first() != '{' && this->first() != '[') {
+            while (end != text_.size() && !is_delimiter_(text_[end])) {
+                ++end;
+            }
+        }
+        return text_.substr(*index_, end - *index_);
+    }
+
+    // Elements of an array, or values of the members of an object
+    // Exceptions: std::bad_variant_access if the value is neither an array nor an object
+    iterator begin() const;
+    iterator end() const;
+
+    // size
+    // Elements of an array or members of an object, counted by skipping them
+    std::size_t size() const;
+
+    // find
+    // Exceptions: std::bad_variant_access if the value is not an object
+    iterator find(std::string_view key) const;
+
+    bool contains(std::string_view key) const;
+
+    // Exceptions: esl::key_not_found, std::bad_variant_access if the value is not an object
+    lazy_value operator[](std::string_view key) const;
+
+    // Exceptions: std::out_of_range, std::bad_variant_access if the value is not an array
+    lazy_value operator[](std::size_t i) const;
+};
+
+// lazy_value::iterator
+class lazy_value::iterator {
+private:
+    std::string_view text_;
+    const std::uint32_t* index_ = nullptr; // of the element or the key, nullptr at the end
+    bool object_ = false;
+    mutable std::string scratch_;
+
+    void check() const {
+        if (object_) {
+            lazy_member_(text_, index_);
+        }
+    }
+
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = lazy_value;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = lazy_value;
+
+    iterator() noexcept = default;
+
+    // index: of the opening bracket
+    iterator(std::string_view text, const std::uint32_t* index) : text_(text), object_(text[*index] == '{') {
+        const auto first = index + 1;
+        if (*first != text_.size() && text_[*first] == (object_ ? '}' : ']')) {
+            return;
+        }
+        index_ = first;
+        this->check();
+    }
+
+    lazy_value operator*() const noexcept {
+        return lazy_value(text_, object_ ? index_ + 2 : index_);
+    }
+
+    // key
+    // Key of the object member, valid until the iterator changes
+    std::string_view key() const {
+        std::size_t end;
+        return parse_string_(text_, *index_, scratch_, end);
+    }
+
+    iterator& operator++() {
+        const auto next = lazy_skip_(text_, object_ ? index_ + 2 : index_);
+        const std::size_t pos = *next;
+        const char c = pos < text_.size() ? text_[pos] : '\0';
+        if (c == ',') {
+            index_ = next + 1;
+            this->check();
+        } else if (c == (object_ ? '}' : ']')) {
+            index_ = nullptr;
+        } else if (pos == text_.size()) {
+            unexpected_(text_, pos);
+        } else {
+            throw parse_error(object_ ? "expected ',' or '}'" : "expected ',' or ']'", text_, pos);
+        }
+        return *this;
+    }
+    iterator operator++(int) {
+        auto it = *this;
+        ++*this;
+        return it;
+    }
+
+    friend bool operator==(const iterator& lhs, const iterator& rhs) noexcept {
+        return lhs.index_ == rhs.index_;
+    }
+    friend bool operator!=(const iterator& lhs, const iterator& rhs) noexcept {
+        return lhs.index_ != rhs.index_;
+    }
+};
+
+inline lazy_value::iterator lazy_value::begin() const {
+    const auto t = this->type();
+    if (t != array_index && t != object_index) {
+        throw std::bad_variant_access{};
+    }
+    return iterator(text_, index_);
+}
+
+inline lazy_value::iterator lazy_value::end() const {
+    return iterator();
+}
+
+inline std::size_t lazy_value::size() const {
+    std::size_t n = 0;
+    for (auto it = this->begin(); it != this->end(); ++it) {
+        ++n;
+    }
+    return n;
+}
+
+inline lazy_value::iterator lazy_value::find(std::string_view key) const {
+    if (this->type() != object_index) {
+        throw std::bad_variant_access{};
+    }
+    auto it = this->begin();
+    for (; it != this->end() && it.key() != key; ++it) {
+    }
+    return it;
+}
+
+inline bool lazy_value::contains(std::string_view key) const {
+    return this->find(key) != this->end();
+}
+
+inline lazy_value lazy_value::operator[](std::string_view key) const {
+    const auto it = this->find(key);
+    if (it == this->end()) {
+        throw key_not_found("esl::json::lazy_value::operator[]");
+    }
+    return *it;
+}
+
+inline lazy_value lazy_value::operator[](std::size_t i) const {
+    if (this->type() != array_index) {
+        throw std::bad_variant_access{};
+    }
+    auto it = this->begin();
+    for (; it != this->end() && i != 0; ++it, --i) {
+    }
+    if (it == this->end()) {
+        throw std::out_of_range("esl::json::lazy_value::operator[]");
+    }
+    return *it;
+}
+
+// document
+// Text indexed by stage 1 only, values are read through lazy_value on access
+// NOTE: Views the text, which must outlive the document and its values
+class document {
+private:
+    std::string_view text_;
+    structural_index_ index_;
+
+public:
+    // Exceptions: esl::json::parse_error for unterminated strings
+    explicit document(std::string_view text) : text_(text), index_(text) {}
+
+    std::string_view text() const noexcept {
+        return text_;
+    }
+
+    // index
+    // Positions of the structural characters, terminated by the position of the end
+    const std::uint32_t* index() const noexcept {
+        return index_.data();
+    }
+
+    // root
+    lazy_value root() const noexcept {
+        return lazy_value(text_, index_.data());
+    }
+
+    // Shortcuts of root()
+
+    json::index type() const {
+        return this->root().type();
+    }
+    lazy_value operator[](std::string_view key) const {
+        return this->root()[key];
+    }
+    lazy_value operator[](std::size_t i) const {
+        return this->root()[i];
+    }
+    lazy_value::iterator begin() const {
+        return this->root().begin();
+    }
+    lazy_value::iterator end() const {
+        return this->root().end();
+    }
+
+    // to_value
+    // Same as parse
+    value to_value() const {
+        value_builder_<value> builder;
+        const auto end = parse_structurals_(text_, index_.data(), builder);
+        if (*end != text_.size()) {
+            throw parse_error("trailing characters", text_, *end);
+        }
+        return builder.take();
+    }
+};
+
+// path
+// A query compiled once, from a JSON Pointer (RFC 6901) or a JSONPath subset:
+//   JSON Pointer: "" (the root), "/user/id", "/items/0"; a numeric token matches an array index or a member
+//   JSONPath: "$" followed by .name, ['name'] or ["name"] for members, [n] for indexes, .* or [*] for every member or element
+// Exceptions: std::invalid_argument if the expression is invalid
+class path {
+public:
+    enum class step_kind {
+        member,            // key
+        element,           // index
+        member_or_element, // key, or index for arrays
+        wildcard,
+    };
+
+    struct step {
+        step_kind kind;
+        std::string key;
+        std::size_t index = 0;
+
+        // name: member key, or array index as text
+        bool match(bool object, std::string_view name, std::size_t i) const noexcept {
+            switch (kind) {
+            case step_kind::member:
+                return object && name == key;
+            case step_kind::element:
+                return !object && i == index;
+            case step_kind::member_or_element:
+                return object ? name == key : i == index;
+            default:
+                return true;
+            }
+        }
+    };
+
+private:
+    std::vector<step> steps_;
+    bool definite_ = true;
+
+    [[noreturn]] static void invalid(std::string_view expr) {
+        throw std::invalid_argument("esl::json::path: invalid expression: " + std::string(expr));
+    }
+
+    // return: npos if s is not a canonical decimal
+    static std::size_t parse_index(std::string_view s) noexcept {
+        if (s.empty() || s.size() > 9 || (s[0] == '0' && s.size() != 1)) {
+            return std::string_view::npos;
+        }
+        std::size_t i = 0;
+        for (const char c : s) {
+            if (c < '0' || c > '9') {
+                return std::string_view::npos;
+            }
+            i = i * 10 + static_cast<std::size_t>(c - '0');
+        }
+        return i;
+    }
+
+    void push(step_kind kind, std::string key = {}, std::size_t index = 0) {
+        definite_ = definite_ && kind != step_kind::wildcard;
+        steps_.push_back(step{kind, std::move(key), index});
+    }
+
+    void compile_pointer(std::string_view expr) {
+        for (std::size_t pos = 0; pos != expr.size();) {
+            if (expr[pos] != '/') {
+                invalid(expr);
+            }
+            const std::size_t end = std::min(expr.find('/', pos + 1), expr.size());
+            std::string token;
+            for (std::size_t i = pos + 1; i < end; ++i) {
+                if (expr[i] != '~') {
+                    token += expr[i];
+                } else if (i + 1 < end && (expr[i + 1] == '0' || expr[i + 1] == '1')) {
+                    token += expr[++i] == '0' ? '~' : '/';
+                } else {
+                    invalid(expr);
+                }
+            }
+            const std::size_t index = parse_index(token);
+            if (index != std::string_view::npos) {
+                this->push(step_kind::member_or_element, std::move(token), index);
+            } else {
+                this->push(step_kind::member, std::move(token));
+            }
+            pos = end;
+        }
+    }
+
+    void compile_jsonpath(std::string_view expr) {
+        for (std::size_t pos = 1; pos != expr.size();) {
+            if (expr[pos] == '.') {
+                const std::size_t end = std::min(expr.find_first_of(".[", pos + 1), expr.size());
+                const auto name = expr.substr(pos + 1, end - pos - 1);
+                if (name.empty()) {
+                    invalid(expr);
+                }
+                if (name == "*") {
+                    this->push(step_kind::wildcard);
+                } else {
+                    this->push(step_kind::member, std::string(name));
+                }
+                pos = end;
+            } else if (expr[pos] == '[' && pos + 1 < expr.size()) {
+                const char quote = expr[pos + 1];
+                if (quote == '\'' || quote == '"') {
+                    std::string key;
+                    std::size_t i = pos + 2;
+                    for (; i < expr.size() && expr[i] != quote; ++i) {
+                        if (expr[i] == '\\' && i + 1 < expr.size()) {
+                            ++i;
+                        }
+                        key += expr[i];
+                    }
+                    if (i + 1 >= expr.size() || expr[i + 1] != ']') {
+                        invalid(expr);
+                    }
+                    this->push(step_kind::member, std::move(key));
+                    pos = i + 2;
+                } else {
+                    const std::size_t end = expr.find(']', pos);
+                    if (end == std::string_view::npos) {
+                        invalid(expr);
+                    }
+                    const auto token = expr.substr(pos + 1, end - pos - 1);
+                    const std::size_t index = parse_index(token);
+                    if (token == "*") {
+                        this->push(step_kind::wildcard);
+                    } else if (index != std::string_view::npos) {
+                        this->push(step_kind::element, {}, index);
+                    } else {
+                        invalid(expr);
+                    }
+                    pos = end + 1;
+                }
+            } else {
+                invalid(expr);
+            }
+        }
+    }
+
+public:
+    path() noexcept = default;
+
+    // expr: a JSONPath if it starts with '$', a JSON Pointer otherwise
+    explicit path(std::string_view expr) {
+        if (!expr.empty() && expr[0] == '$') {
+            this->compile_jsonpath(expr);
+        } else {
+            this->compile_pointer(expr);
+        }
+    }
+
+    const std::vector<step>& steps() const noexcept {
+        return steps_;
+    }
+
+    // definite
+    // Without wildcards, so matching at most one value
+    bool definite() const noexcept {
+        return definite_;
+    }
+};
+
+// path_walker_
+// Walk the structural index of a document, descending only into the children some path can still match
+template <class F>
+class path_walker_ {
+private:
+    std::string_view text_;
+    span<const path> paths_;
+    F& callback_;
+    std::vector<std::size_t> active_; // stack of the paths matching each level of the walk
+    std::size_t unresolved_ = 0;      // definite paths not resolved yet
+    bool wildcards_ = false;
+    std::string scratch_;
+
+public:
+    path_walker_(std::string_view text, span<const path> paths, F& callback) : text_(text), paths_(paths), callback_(callback) {
+        for (const auto& p : paths) {
+            if (p.definite()) {
+                ++unresolved_;
+            } else {
+                wildcards_ = true;
+            }
+        }
+    }
+
+    void run(const std::uint32_t* index) {
+        for (std::size_t p = 0; p != paths_.size(); ++p) {
+            active_.push_back(p);
+        }
+        this->walk(index, 0, 0, active_.size());
+    }
+
+    // Walk the value at `index', matched by active_[first, last) up to `depth'
+    // return: the index past the value, nullptr once the walk is finished
+    // Exceptions: esl::json::parse_error, and exceptions thrown by the callback
+    const std::uint32_t* walk(const std::uint32_t* index, std::size_t depth, std::size_t first, std::size_t last) {
+        bool descend = false;
+        for (std::size_t k = first; k != last; ++k) {
+            const std::size_t p = active_[k];
+            if (paths_[p].steps().size() == depth) {
+                callback_(p, lazy_value(text_, index));
+            } else {
+                descend = true;
+            }
+        }
+        const char c = *index < text_.size() ? text_[*index] : '\0';
+        if (!descend || (c != '{' && c != '[')) {
+            return this->leave(first, last, lazy_skip_(text_, index));
+        }
+        const bool object = c == '{';
+        const char close = object ? '}' : ']';
+        auto it = index + 1;
+        if (*it != text_.size() && text_[*it] == close) {
+            return this->leave(first, last, it + 1);
+        }
+        for (std::size_t i = 0;; ++i) {
+            std::string_view key;
+            if (object) {
+                lazy_member_(text_, it);
+                std::size_t end;
+                key = parse_string_(text_, *it, scratch_, end);
+                it += 2;
+            }
+            // Paths matching the child move to it, but the ones with wildcards stay for the siblings
+            const std::size_t child_first = active_.size();
+            std::size_t kept = first;
+            bool siblings = false;
+            for (std::size_t k = first; k != last; ++k) {
+                const std::size_t p = active_[k];
+                const auto& steps = paths_[p].steps();
+                bool keep = true;
+                if (steps.size() != depth && steps[depth].match(object, key, i)) {
+                    active_.push_back(p);
+                    keep = !paths_[p].definite();
+                }
+                if (keep) {
+                    active_[kept++] = p;
+                    siblings = siblings || steps.size() != depth;
+                }
+            }
+            last = kept;
+            if (active_.size() == child_first) {
+                it = lazy_skip_(text_, it);
+            } else {
+                it = this->walk(it, depth + 1, child_first, active_.size());
+                active_.resize(child_first);
+                if (it == nullptr) {
+                    return nullptr;
+                }
+            }
+            if (!siblings) {
+                return this->leave(first, last, lazy_skip_(text_, it, 1));
+            }
+            const std::size_t pos = *it;
+            if (pos != text_.size() && text_[pos] == ',') {
+                ++it;
+            } else if (pos != text_.size() && text_[pos] == close) {
+                return this->leave(first, last, it + 1);
+            } else if (pos == text_.size()) {
+                unexpected_(text_, pos);
+            } else {
+                throw parse_error(object ? "expected ',' or '}'" : "expected ',' or ']'", text_, pos);
+            }
+        }
+    }
+
+    // The definite paths left on a walked value are resolved: matched, or missing
+    // return: next, nullptr once the walk is finished
+    const std::uint32_t* leave(std::size_t first, std::size_t last, const std::uint32_t* next) noexcept {
+        for (std::size_t k = first; k != last; ++k) {
+            if (paths_[active_[k]].definite()) {
+                --unresolved_;
+            }
+        }
+        return unresolved_ == 0 && !wildcards_ ? nullptr : next;
+    }
+};
+
+// query
+// Evaluate paths in one pass over the structural index of a document, calling callback(i, match) for the matches of
+// paths[i], as lazy values in document order
+// Subtrees no path can reach are skipped by bracket matching, siblings too once the paths matching them are resolved,
+// and the walk stops once every path is resolved, unless one has a wildcard
+// NOTE: A definite path matches the first member with its key, as lazy_value::operator[]
+// Exceptions: esl::json::parse_error if the walked structure is invalid, and exceptions thrown by callback
+template <class F>
+inline void query(const document& doc, span<const path> paths, F callback) {
+    path_walker_<F>(doc.text(), paths, callback).run(doc.index());
+}
+template <class F>
+inline void query(const document& doc, const path& p, F callback) {
+    query(doc, span<const path>(&p, 1), std::move(callback));
+}
+
+// query
+// Index the text, the matches are valid during the callback only
+// Exceptions: esl::json::parse_error, and exceptions thrown by callback
+template <class F>
+inline void query(std::string_view text, span<const path> paths, F callback) {
+    const document doc(text);
+    query(doc, paths, std::move(callback));
+}
+template <class F>
+inline void query(std::string_view text, const path& p, F callback) {
+    query(text, span<const path>(&p, 1), std::move(callback));
+}
+
+// dump_option
+// indent: spaces per nesting level, 0 for the compact form
+struct dump_option {
+    std::size_t indent = 0;
+};
+
+inline constexpr dump_option dump_compact{};
+inline constexpr dump_option dump_pretty{2};
+
+// number_max_size_
+// Longest dumped number: the shortest round-trip form of a double, e.g. "-2.2250738585072014e-308", or an integral
+// double of fixed form with ".0", or a 64-bit integer
+inline constexpr std::size_t number_max_size_ = 26;
+
+// escape_
+// '"', '\\' and control characters
+// out: at least 6 bytes
+// return: escape size
+inline std::size_t escape_(unsigned char c, char* out) noexcept {
+    out[0] = '\\';
+    switch (c) {
+    case '"':
+        out[1] = '"';
+        return 2;
+    case '\\':
+        out[1] = '\\';
+        return 2;
+    case '\b':
+        out[1] = 'b';
+        return 2;
+    case '\f':
+        out[1] = 'f';
+        return 2;
+    case '\n':
+        out[1] = 'n';
+        return 2;
+    case '\r':
+        out[1] = 'r';
+        return 2;
+    case '\t':
+        out[1] = 't';
+        return 2;
+    default:
+        out[1] = 'u';
+        out[2] = '0';
+        out[3] = '0';
+        out[4] = hex_alphabet_lowercase[c >> 4];
+        out[5] = hex_alphabet_lowercase[c & 0xF];
+        return 6;
+    }
+}
+
+// escaped_size_
+// return: size of the quoted and escaped string
+inline std::size_t escaped_size_(std::string_view s) noexcept {
+    std::size_t size = s.size() + 2;
+    const char* p = s.data();
+    const char* const last = p + s.size();
+    for (;;) {
+        p += string_span_(p, static_cast<std::size_t>(last - p));
+        if (p == last) {
+            return size;
+        }
+        char escape[6];
+        size += escape_(static_cast<unsigned char>(*p++), escape) - 1;
+    }
+}
+
+// dump_max_size_
+template <class Value>
+inline std::size_t dump_max_size_(const Value& v, const dump_option& option, std::size_t depth) {
+    // newline and indent before each element and the closing bracket
+    const auto element_space = [&option](std::size_t depth) { return option.indent != 0 ? 1 + option.indent * depth : 0; };
+    switch (v.index()) {
+    case null_index:
+        return 4;
+    case boolean_index:
+        return std::get<boolean_index>(v) ? 4 : 5;
+    case number_index:
+    case integer_index:
+    case unsigned_integer_index:
+        return number_max_size_;
+    case string_index:
+        return escaped_size_(std::get<string_index>(v));
+    case array_index: {
+        const auto& a = std::get<array_index>(v);
+        if (a.empty()) {
+            return 2;
+        }
+        std::size_t size = 2 + (a.size() - 1) + a.size() * element_space(depth + 1) + element_space(depth);
+        for (const auto& e : a) {
+            size += dump_max_size_(e, option, depth + 1);
+        }
+        return size;
+    }
+    case object_index: {
+        const auto& o = std::get<object_index>(v);
+        if (o.empty()) {
+            return 2;
+        }
+        // ':' or ": "
+        std::size_t size = 2 + (o.size() - 1) + o.size() * (element_space(depth + 1) + (option.indent != 0 ? 2 : 1)) + element_space(depth);
+        for (const auto& kv : o) {
+            size += escaped_size_(kv.first) + dump_max_size_(kv.second, option, depth + 1);
+        }
+        return size;
+    }
+    default:
+        throw std::bad_variant_access{};
+    }
+}
+
+// dump_max_size
+// return: Exact dump size, except that every number counts as its longest form
+inline std::size_t dump_max_size(const value& v, const dump_option& option = dump_compact) {
+    return dump_max_size_(v, option, 0);
+}
+inline std::size_t dump_max_size(const ordered::value& v, const dump_option& option = dump_compact) {
+    return dump_max_size_(v, option, 0);
+}
+inline std::size_t dump_max_size(const value_view& v, const dump_option& option = dump_compact) {
+    return dump_max_size_(v, option, 0);
+}
+
+// dump_pointer_sink_
+struct dump_pointer_sink_ {
+    char* p;
+
+    void write(const char* s, std::size_t n) noexcept {
+        std::memcpy(p, s, n);
+        p += n;
+    }
+    void put(char c) noexcept {
+        *p++ = c;
+    }
+};
+
+// dump_string_sink_
+struct dump_string_sink_ {
+    std::string& s;
+
+    void write(const char* p, std::size_t n) {
+        s.append(p, n);
+    }
+    void put(char c) {
+        s.push_back(c);
+    }
+};
+
+// dump_iterator_sink_
+template <class OutputIt>
+struct dump_iterator_sink_ {
+    OutputIt out;
+
+    void write(const char* s, std::size_t n) {
+        out = std::copy(s, s + n, out);
+    }
+    void put(char c) {
+        *out = c;
+        ++out;
+    }
+};
+
+// dump_ostream_sink_
+template <class CharT, class Traits>
+struct dump_ostream_sink_ {
+    std::basic_ostream<CharT, Traits>& os;
+
+    void write(const char* s, std::size_t n) {
+        os.write(s, static_cast<std::streamsize>(n));
+    }
+    void put(char c) {
+        os.put(c);
+    }
+};
+
+// dumper_
+// Runs of string bytes needing no escape are found by string_span_ and written at once
+template <class Sink>
+class dumper_ {
+private:
+    Sink& sink_;
+    const dump_option& option_;
+
+    void newline(std::size_t depth) {
+        if (option_.indent != 0) {
+            char spaces[64];
+            std::memset(spaces, ' ', sizeof(spaces));
+            sink_.put('\n');
+            for (std::size_t n = option_.indent * depth; n != 0;) {
+                const auto m = std::min(n, sizeof(spaces));
+                sink_.write(spaces, m);
+                n -= m;
+            }
+        }
+    }
+
+public:
+    dumper_(Sink& sink, const dump_option& option) noexcept : sink_(sink), option_(option) {}
+
+    void string(std::string_view s) {
+        const char* p = s.data();
+        const char* const last = p + s.size();
+        sink_.put('"');
+        for (;;) {
+            const auto n = string_span_(p, static_cast<std::size_t>(last - p));
+            sink_.write(p, n);
+            p += n;
+            if (p == last) {
+                break;
+            }
+            char escape[6];
+            sink_.write(escape, escape_(static_cast<unsigned char>(*p++), escape));
+        }
+        sink_.put('"');
+    }
+
+    // Shortest round-trip form of T (double or float), null for non-finite numbers which JSON can not represent
+    // NOTE: Integral numbers get ".0", so they parse back as doubles
+    template <class T>
+    void number(T d) {
+        char buf[number_max_size_];
+        const auto r = to_chars_float_(buf, buf + sizeof(buf) - 2, d);
+        if (r.ec != std::errc{} || !std::isfinite(d)) {
+            sink_.write("null", 4);
+            return;
+        }
+        auto n = static_cast<std::size_t>(r.ptr - buf);
+        if (std::find_if(buf, r.ptr, [](char c) { return c == '.' || c == 'e'; }) == r.ptr) {
+            buf[n++] = '.';
+            buf[n++] = '0';
+        }
+        sink_.write(buf, n);
+    }
+
+    // integer
+    // T: integer or unsigned_integer
+    template <class T>
+    void integer(T i) {
+        char buf[number_max_size_];
+        sink_.write(buf, static_cast<std::size_t>(std::to_chars(buf, buf + sizeof(buf), i).ptr - buf));
+    }
+
+    template <class Value>
+    void value(const Value& v, std::size_t depth = 0) {
+        switch (v.index()) {
+        case null_index:
+            sink_.write("null", 4);
+            break;
+        case boolean_index:
+            if (std::get<boolean_index>(v)) {
+                sink_.write("true", 4);
+            } else {
+                sink_.write("false", 5);
+            }
+            break;
+        case number_index:
+            this->number(std::get<number_index>(v));
+            break;
+        case integer_index:
+            this->integer(std::get<integer_index>(v));
+            break;
+        case unsigned_integer_index:
+            this->integer(std::get<unsigned_integer_index>(v));
+            break;
+        case string_index:
+            this->string(std::get<string_index>(v));
+            break;
+        case array_index: {
+            const auto& a = std::get<array_index>(v);
+            sink_.put('[');
+            if (!a.empty()) {
+                for (auto it = a.begin(); it != a.end(); ++it) {
+                    if (it != a.begin()) {
+                        sink_.put(',');
+                    }
+                    this->newline(depth + 1);
+                    this->value(*it, depth + 1);
+                }
+                this->newline(depth);
+            }
+            sink_.put(']');
+            break;
+        }
+        case object_index: {
+            const auto& o = std::get<object_index>(v);
+            sink_.put('{');
+            if (!o.empty()) {
+                for (auto it = o.begin(); it != o.end(); ++it) {
+                    if (it != o.begin()) {
+                        sink_.put(',');
+                    }
+                    this->newline(depth + 1);
+                    this->string(it->first);
+                    if (option_.indent != 0) {
+                        sink_.write(": ", 2);
+                    } else {
+                        sink_.put(':');
+                    }
+                    this->value(it->second, depth + 1);
+                }
+                this->newline(depth);
+            }
+            sink_.put('}');
+            break;
+        }
+        default:
+            throw std::bad_variant_access{};
+        }
+    }
+};
+
+// dump_
+template <class Value>
+inline std::size_t dump_(const Value& v, char* out, const dump_option& option) {
+    dump_pointer_sink_ sink{out};
+    dumper_<dump_pointer_sink_>(sink, option).value(v);
+    return static_cast<std::size_t>(sink.p - out);
+}
+template <class Value>
+inline std::string dump_(const Value& v, const dump_option& option) {
+    std::string s;
+    dump_string_sink_ sink{s};
+    dumper_<dump_string_sink_>(sink, option).value(v);
+    return s;
+}
+template <class Value, class OutputIt>
+inline OutputIt dump_to_(const Value& v, OutputIt out, const dump_option& option) {
+    dump_iterator_sink_<OutputIt> sink{out};
+    dumper_<dump_iterator_sink_<OutputIt>>(sink, option).value(v);
+    return sink.out;
+}
+template <class Value, class CharT, class Traits>
+inline std::basic_ostream<CharT, Traits>& dump_to_(const Value& v, std::basic_ostream<CharT, Traits>& os, const dump_option& option) {
+    dump_ostream_sink_<CharT, Traits> sink{os};
+    dumper_<dump_ostream_sink_<CharT, Traits>>(sink, option).value(v);
+    return os;
+}
+
+// dump
+// out: at least `dump_max_size' size
+// return: dump size
+inline std::size_t dump(const value& v, char* out, const dump_option& option = dump_compact) {
+    return dump_(v, out, option);
+}
+inline std::size_t dump(const ordered::value& v, char* out, const dump_option& option = dump_compact) {
+    return dump_(v, out, option);
+}
+inline std::size_t dump(const value_view& v, char* out, const dump_option& option = dump_compact) {
+    return dump_(v, out, option);
+}
+
+// return string
+// NOTE: Grows the string rather than allocating `dump_max_size' up front, which costs one more walk of the tree
+inline std::string dump(const value& v, const dump_option& option = dump_compact) {
+    return dump_(v, option);
+}
+inline std::string dump(const ordered::value& v, const dump_option& option = dump_compact) {
+    return dump_(v, option);
+}
+inline std::string dump(const value_view& v, const dump_option& option = dump_compact) {
+    return dump_(v, option);
+}
+
+// dump_to
+template <class OutputIt, class = std::enable_if_t<!std::is_base_of_v<std::ios_base, OutputIt>>>
+inline OutputIt dump_to(const value& v, OutputIt out, const dump_option& option = dump_compact) {
+    return dump_to_(v, out, option);
+}
+template <class OutputIt, class = std::enable_if_t<!std::is_base_of_v<std::ios_base, OutputIt>>>
+inline OutputIt dump_to(const ordered::value& v, OutputIt out, const dump_option& option = dump_compact) {
+    return dump_to_(v, out, option);
+}
+template <class OutputIt, class = std::enable_if_t<!std::is_base_of_v<std::ios_base, OutputIt>>>
+inline OutputIt dump_to(const value_view& v, OutputIt out, const dump_option& option = dump_compact) {
+    return dump_to_(v, out, option);
+}
+
+// ostream
+template <class CharT, class Traits>
+inline std::basic_ostream<CharT, Traits>& dump_to(const value& v, std::basic_ostream<CharT, Traits>& os, const dump_option& option = dump_compact) {
+    return dump_to_(v, os, option);
+}
+template <class CharT, class Traits>
+inline std::basic_ostream<CharT, Traits>& dump_to(const ordered::value& v, std::basic_ostream<CharT, Traits>& os, const dump_option& option = dump_compact) {
+    return dump_to_(v, os, option);
+}
+template <class CharT, class Traits>
+inline std::basic_ostream<CharT, Traits>& dump_to(const value_view& v, std::basic_ostream<CharT, Traits>& os, const dump_option& option = dump_compact) {
+    return dump_to_(v, os, option);
+}
+
+} // namespace json
+
+} // namespace esl
+
 #endif // ESL_JSON_HPP
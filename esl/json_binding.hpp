@@ -0,0 +1,385 @@
+#ifndef ESL_JSON_BINDING_HPP
+#define ESL_JSON_BINDING_HPP
+
+#include "json.hpp"
+#include "static_map.hpp"
+
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace esl {
+
+namespace json {
+
+// field_
+template <class T, class M>
+struct field_ {
+    std::string_view name;
+    M T::*member;
+};
+
+// field
+// A data member of T bound to the key `name'
+template <class T, class M>
+inline constexpr field_<T, M> field(std::string_view name, M T::*member) noexcept {
+    return field_<T, M>{name, member};
+}
+
+// binding
+// Specialize for a default constructible struct with a constexpr tuple of its fields:
+//   template <>
+//   struct esl::json::binding<point> {
+//       static constexpr auto fields = std::make_tuple(ESL_JSON_FIELD(point, x), ESL_JSON_FIELD(point, y));
+//   };
+// Fields may be bool, arithmetic, std::string, std::vector, std::optional, json::value or bound types
+template <class T>
+struct binding;
+
+// ESL_JSON_FIELD
+// The member bound to the key of its name
+#define ESL_JSON_FIELD(type, member) ::esl::json::field(#member, &type::member)
+
+// is_bound_
+template <class T, class = void>
+inline constexpr bool is_bound_ = false;
+template <class T>
+inline constexpr bool is_bound_<T, std::void_t<decltype(binding<T>::fields)>> = true;
+
+// is_vector_, is_optional_
+template <class T>
+inline constexpr bool is_vector_ = false;
+template <class T, class Alloc>
+inline constexpr bool is_vector_<std::vector<T, Alloc>> = true;
+template <class T>
+inline constexpr bool is_optional_ = false;
+template <class T>
+inline constexpr bool is_optional_<std::optional<T>> = true;
+
+// field_count_
+template <class T>
+inline constexpr std::size_t field_count_ = std::tuple_size_v<std::remove_const_t<decltype(binding<T>::fields)>>;
+
+// binding_keys_
+// Minimal perfect hash of the keys of T to the field indexes, built at compile time
+template <class T, std::size_t... Is>
+inline constexpr auto binding_keys_(std::index_sequence<Is...>) {
+    return static_map<std::string_view, std::size_t, sizeof...(Is)>(
+        std::array<std::pair<std::string_view, std::size_t>, sizeof...(Is)>{{{std::get<Is>(binding<T>::fields).name, Is}...}});
+}
+template <class T>
+inline constexpr auto binding_keys_v_ = binding_keys_<T>(std::make_index_sequence<field_count_<T>>{});
+
+// skip_handler_
+// Validate a value without building it
+struct skip_handler_ {
+    void null() noexcept {}
+    void boolean(bool) noexcept {}
+    void number(double) noexcept {}
+    void string(std::string_view) noexcept {}
+    void key(std::string_view) noexcept {}
+    void begin_object() noexcept {}
+    void end_object(std::size_t) noexcept {}
+    void begin_array() noexcept {}
+    void end_array(std::size_t) noexcept {}
+};
+
+// binding_reader_
+// Typed stage 2: walk the structural index straight into the object, keys are dispatched by binding_keys_v_
+// and members of other keys are validated and skipped
+// NOTE: Fields missing in the text keep their default values
+class binding_reader_ {
+private:
+    std::string_view s_;
+    const std::uint32_t* index_;
+    std::string scratch_;
+    std::size_t depth_ = 0;
+
+    std::size_t peek() const noexcept {
+        return *index_;
+    }
+
+    // Position of the next structural, the end is unexpected
+    std::size_t take() {
+        const std::size_t pos = *index_;
+        if (pos == s_.size()) {
+            unexpected_(s_, pos);
+        }
+        ++index_;
+        return pos;
+    }
+
+    std::size_t take(char c, const char* msg) {
+        const std::size_t pos = this->take();
+        if (s_[pos] != c) {
+            throw parse_error(msg, s_, pos);
+        }
+        return pos;
+    }
+
+    bool peek(char c) const noexcept {
+        return *index_ != s_.size() && s_[*index_] == c;
+    }
+
+    void enter() {
+        if (++depth_ > max_depth) {
+            throw parse_error("too deeply nested", s_, index_[-1]);
+        }
+    }
+
+    // Optional sign, then digits without a leading zero
+    template <class T>
+    void integer(T& x) {
+        const std::size_t pos = this->take();
+        const char* const first = s_.data() + pos;
+        const char* const last = s_.data() + s_.size();
+        const char* digits = first + (*first == '-' ? 1 : 0);
+        if (digits == last || static_cast<unsigned>(*digits - '0') > 9 || (*digits == '0' && last - digits > 1 && static_cast<unsigned>(digits[1] - '0') <= 9)) {
+            throw parse_error("expected integer", s_, pos);
+        }
+        const auto r = std::from_chars(first, last, x);
+        if (r.ptr != last && !is_delimiter_(*r.ptr)) {
+            // A number, but no integer
+            parse_number_(s_, pos);
+            throw parse_error("expected integer", s_, pos);
+        }
+        if (r.ec != std::errc{}) {
+            throw parse_error("number out of range", s_, pos);
+        }
+    }
+
+    template <class T, std::size_t I>
+    static void field(binding_reader_& r, T& x) {
+        r.read(x.*std::get<I>(binding<T>::fields).member);
+    }
+
+    template <class T, std::size_t... Is>
+    void fields(T& x, std::size_t i, std::index_sequence<Is...>) {
+        using reader = void (*)(binding_reader_&, T&);
+        static constexpr reader readers[] = {&binding_reader_::field<T, Is>...};
+        readers[i](*this, x);
+    }
+
+public:
+    binding_reader_(std::string_view s, const std::uint32_t* index) noexcept : s_(s), index_(index) {}
+
+    const std::uint32_t* index() const noexcept {
+        return index_;
+    }
+
+    // Exceptions: esl::json::parse_error
+    template <class T>
+    void read(T& x) {
+        if constexpr (std::is_same_v<T, bool>) {
+            const std::size_t pos = this->take();
+            if (s_[pos] == 't') {
+                parse_literal_(s_, pos, "true");
+                x = true;
+            } else if (s_[pos] == 'f') {
+                parse_literal_(s_, pos, "false");
+                x = false;
+            } else {
+                throw parse_error("expected boolean", s_, pos);
+            }
+        } else if constexpr (std::is_integral_v<T>) {
+            this->integer(x);
+        } else if constexpr (std::is_floating_point_v<T>) {
+            const std::size_t pos = this->take();
+            if (s_[pos] != '-' && static_cast<unsigned>(s_[pos] - '0') > 9) {
+                throw parse_error("expected number", s_, pos);
+            }
+            if constexpr (std::is_same_v<T, float>) {
+                x = parse_float_<float>(s_, pos);
+            } else {
+                x = static_cast<T>(parse_float_<double>(s_, pos));
+            }
+        } else if constexpr (std::is_same_v<T, std::string>) {
+            const std::size_t pos = this->take('"', "expected string");
+            std::size_t end;
+            x.assign(parse_string_(s_, pos, scratch_, end));
+        } else if constexpr (is_optional_<T>) {
+            if (this->peek('n')) {
+                parse_literal_(s_, this->take(), "null");
+                x.reset();
+            } else {
+                this->read(x.emplace());
+            }
+        } else if constexpr (is_vector_<T>) {
+            this->take('[', "expected array");
+            this->enter();
+            x.clear();
+            if (this->peek(']')) {
+                ++index_;
+            } else {
+                for (;;) {
+                    // Not into emplace_back(), which is a proxy for std::vector<bool>
+                    typename T::value_type e{};
+                    this->read(e);
+                    x.push_back(std::move(e));
+                    const std::size_t pos = this->take();
+                    if (s_[pos] == ']') {
+                        break;
+                    }
+                    if (s_[pos] != ',') {
+                        throw parse_error("expected ',' or ']'", s_, pos);
+                    }
+                }
+            }
+            --depth_;
+        } else if constexpr (std::is_same_v<T, value>) {
+            if (this->peek() == s_.size()) {
+                unexpected_(s_, this->peek());
+            }
+            value_builder_<value> builder;
+            index_ = parse_structurals_(s_, index_, builder);
+            x = builder.take();
+        } else {
+            static_assert(is_bound_<T>, "esl::json::read: no binding of the type");
+            this->take('{', "expected object");
+            this->enter();
+            if (this->peek('}')) {
+                ++index_;
+            } else {
+                for (;;) {
+                    lazy_member_(s_, index_);
+                    std::size_t end;
+                    const auto key = parse_string_(s_, index_[0], scratch_, end);
+                    index_ += 2;
+                    const auto it = binding_keys_v_<T>.find(key);
+                    if (it != binding_keys_v_<T>.end()) {
+                        this->fields(x, it->second, std::make_index_sequence<field_count_<T>>{});
+                    } else {
+                        if (this->peek() == s_.size()) {
+                            unexpected_(s_, this->peek());
+                        }
+                        skip_handler_ handler;
+                        index_ = parse_structurals_(s_, index_, handler);
+                    }
+                    const std::size_t pos = this->take();
+                    if (s_[pos] == '}') {
+                        break;
+                    }
+                    if (s_[pos] != ',') {
+                        throw parse_error("expected ',' or '}'", s_, pos);
+                    }
+                }
+            }
+            --depth_;
+        }
+    }
+};
+
+// binding_writer_
+template <class Sink>
+class binding_writer_ {
+private:
+    Sink& sink_;
+    dumper_<Sink> dump_;
+
+public:
+    explicit binding_writer_(Sink& sink) noexcept : sink_(sink), dump_(sink, dump_compact) {}
+
+    template <class T>
+    void write(const T& x) {
+        if constexpr (std::is_same_v<T, bool>) {
+            if (x) {
+                sink_.write("true", 4);
+            } else {
+                sink_.write("false", 5);
+            }
+        } else if constexpr (std::is_integral_v<T>) {
+            char buf[number_max_size_];
+            sink_.write(buf, static_cast<std::size_t>(std::to_chars(buf, buf + sizeof(buf), x).ptr - buf));
+        } else if constexpr (std::is_same_v<T, float>) {
+            // Shortest form of the float, not of the double it converts to
+            dump_.number(x);
+        } else if constexpr (std::is_floating_point_v<T>) {
+            dump_.number(static_cast<double>(x));
+        } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+            dump_.string(x);
+        } else if constexpr (is_optional_<T>) {
+            if (x) {
+                this->write(*x);
+            } else {
+                sink_.write("null", 4);
+            }
+        } else if constexpr (is_vector_<T>) {
+            sink_.put('[');
+            for (auto it = x.begin(); it != x.end(); ++it) {
+                if (it != x.begin()) {
+                    sink_.put(',');
+                }
+                this->write(*it);
+            }
+            sink_.put(']');
+        } else if constexpr (is_value_<T>) {
+            dump_.value(x);
+        } else {
+            static_assert(is_bound_<T>, "esl::json::write: no binding of the type");
+            // Empty optionals are left out
+            sink_.put('{');
+            bool first = true;
+            std::apply(
+                [&](const auto&... f) {
+                    const auto member = [&](const auto& f) {
+                        const auto& m = x.*f.member;
+                        if constexpr (is_optional_<std::decay_t<decltype(m)>>) {
+                            if (!m) {
+                                return;
+                            }
+                        }
+                        if (!first) {
+                            sink_.put(',');
+                        }
+                        first = false;
+                        dump_.string(f.name);
+                        sink_.put(':');
+                        this->write(m);
+                    };
+                    (member(f), ...);
+                },
+                binding<T>::fields);
+            sink_.put('}');
+        }
+    }
+};
+
+// read
+// Parse `text' straight into a T, without building a value
+// T: a bound type, or a type of its fields
+// Exceptions: esl::json::parse_error, also for values of other types than the fields
+template <class T>
+inline T read(std::string_view text) {
+    structural_index_ index(text);
+    binding_reader_ reader(text, index.data());
+    T x{};
+    reader.read(x);
+    if (*reader.index() != text.size()) {
+        throw parse_error("trailing characters", text, *reader.index());
+    }
+    return x;
+}
+
+// write
+// Compact JSON of a T, fields in the binding order
+template <class T>
+inline std::string write(const T& x) {
+    std::string s;
+    dump_string_sink_ sink{s};
+    binding_writer_<dump_string_sink_>(sink).write(x);
+    return s;
+}
+
+} // namespace json
+
+} // namespace esl
+
+#endif // ESL_JSON_BINDING_HPP
@@ -0,0 +1,188 @@
+#ifndef ESL_JSON_PMR_HPP
+#define ESL_JSON_PMR_HPP
+
+#include "flex_variant_pmr.hpp"
+#include "json.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <memory_resource>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace esl {
+
+namespace json {
+
+// pmr
+// Values allocating every string, container and out-of-line alternative from a memory resource,
+// constructed with an allocator through the allocator-extended constructors, see pmr::flex_variant
+namespace pmr {
+
+class value;
+
+using string = std::pmr::string;
+using array = std::pmr::vector<value>;
+using object = std::pmr::unordered_map<string, value>;
+
+using value_base = ::esl::pmr::flex_variant<null_t, boolean, number, string, array, object, integer, unsigned_integer>;
+
+class value : public value_base {
+public:
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+    using value_base::value_base;
+};
+
+} // namespace pmr
+
+template <>
+inline constexpr bool is_value_<pmr::value> = true;
+
+} // namespace json
+
+} // namespace esl
+
+namespace std {
+
+// std::variant_size
+template <>
+struct variant_size<::esl::json::pmr::value> : variant_size<::esl::json::pmr::value_base> {};
+
+// std::variant_alternative
+template <std::size_t I>
+struct variant_alternative<I, ::esl::json::pmr::value> : variant_alternative<I, ::esl::json::pmr::value_base> {};
+
+// std::hash
+template <>
+struct hash<::esl::json::pmr::value> {
+    size_t operator()(const ::esl::json::pmr::value& n) const {
+        return hash<::esl::json::pmr::value_base>{}(n);
+    }
+};
+
+} // namespace std
+
+namespace esl {
+
+namespace json {
+
+namespace pmr {
+
+// parse
+// Allocate the value from resource
+// Exceptions: esl::json::parse_error
+inline value parse(std::string_view s, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+    return parse_<value>(s, value::allocator_type(resource));
+}
+
+// arena_value
+// A value parsed into a monotonic arena owned with it, freed at once without destructing the tree
+// NOTE: Modifications must allocate from resource(), other allocations are leaked
+class arena_value {
+private:
+    std::pmr::monotonic_buffer_resource resource_;
+    union {
+        value value_;
+    };
+
+public:
+    // initial_size: of the first arena buffer, the text size by default
+    // Exceptions: esl::json::parse_error
+    explicit arena_value(std::string_view text, std::size_t initial_size = 0)
+        : resource_(std::max<std::size_t>(initial_size != 0 ? initial_size : text.size(), 64)) {
+        new (&value_) value(parse(text, &resource_));
+    }
+
+    arena_value(const arena_value&) = delete;
+    arena_value& operator=(const arena_value&) = delete;
+
+    ~arena_value() {}
+
+    value& get() noexcept {
+        return value_;
+    }
+    const value& get() const noexcept {
+        return value_;
+    }
+
+    std::pmr::memory_resource* resource() noexcept {
+        return &resource_;
+    }
+};
+
+} // namespace pmr
+
+// view_builder_
+// Keeps views of the source, copies strings unescaped in the parser scratch into the arena
+class view_builder_ : public value_builder_<value_view> {
+private:
+    std::string_view source_;
+    std::pmr::memory_resource* arena_;
+
+    std::string_view stable(std::string_view sv) {
+        const std::less<const char*> less;
+        if (!less(sv.data(), source_.data()) && !less(source_.data() + source_.size(), sv.data())) {
+            return sv;
+        }
+        const auto p = static_cast<char*>(arena_->allocate(sv.size(), 1));
+        std::memcpy(p, sv.data(), sv.size());
+        return std::string_view(p, sv.size());
+    }
+
+public:
+    view_builder_(std::string_view source, std::pmr::memory_resource* arena) noexcept : source_(source), arena_(arena) {}
+
+    void string(std::string_view sv) {
+        value_builder_::string(this->stable(sv));
+    }
+    void key(std::string_view sv) {
+        value_builder_::key(this->stable(sv));
+    }
+};
+
+// parse_view
+// Strings and keys are views of `text', which must outlive the value, as a memory-mapped file;
+// escaped strings are unescaped into `arena', which must outlive the value too
+// NOTE: Only arrays and objects are allocated
+// Exceptions: esl::json::parse_error
+inline value_view parse_view(std::string_view text, std::pmr::memory_resource* arena) {
+    view_builder_ builder(text, arena);
+    return parse_view_(text, nullptr, builder);
+}
+
+// dump_max_size, dump, dump_to
+// See json.hpp
+inline std::size_t dump_max_size(const pmr::value& v, const dump_option& option = dump_compact) {
+    return dump_max_size_(v, option, 0);
+}
+
+inline std::size_t dump(const pmr::value& v, char* out, const dump_option& option = dump_compact) {
+    return dump_(v, out, option);
+}
+
+inline std::string dump(const pmr::value& v, const dump_option& option = dump_compact) {
+    return dump_(v, option);
+}
+
+template <class OutputIt, class = std::enable_if_t<!std::is_base_of_v<std::ios_base, OutputIt>>>
+inline OutputIt dump_to(const pmr::value& v, OutputIt out, const dump_option& option = dump_compact) {
+    return dump_to_(v, out, option);
+}
+
+template <class CharT, class Traits>
+inline std::basic_ostream<CharT, Traits>& dump_to(const pmr::value& v, std::basic_ostream<CharT, Traits>& os, const dump_option& option = dump_compact) {
+    return dump_to_(v, os, option);
+}
+
+} // namespace json
+
+} // namespace esl
+
+#endif // ESL_JSON_PMR_HPP
@@ -101,22 +101,32 @@
 #    define ESL_ARCH_AVX2
 #endif
 
-// ESL_ATTR_(FORCEINLINE, NOINLINE, EXPORT, IMPORT)
+// ESL_ARCH_X86_ANY (X64 or X86)
+#if defined(ESL_ARCH_X64) || defined(ESL_ARCH_X86)
+#    define ESL_ARCH_X86_ANY
+#endif
+
+// ESL_ATTR_(FORCEINLINE, NOINLINE, EXPORT, IMPORT, TARGET)
+// ESL_ATTR_TARGET: compile a function for an instruction set (e.g. "avx2") regardless of -m flags,
+// MSVC does not need it for intrinsics
 #ifdef ESL_COMPILER_MSVC
 #    define ESL_ATTR_FORCEINLINE __forceinline
 #    define ESL_ATTR_NOINLINE __declspec(noinline)
 #    define ESL_ATTR_EXPORT __declspec(dllexport)
 #    define ESL_ATTR_IMPORT __declspec(dllimport)
+#    define ESL_ATTR_TARGET(isa)
 #elif defined ESL_COMPILER_GNU
 #    define ESL_ATTR_FORCEINLINE inline __attribute__((__always_inline__))
 #    define ESL_ATTR_NOINLINE __attribute__((__noinline__))
 #    define ESL_ATTR_EXPORT __attribute__((visibility("default")))
 #    define ESL_ATTR_IMPORT __attribute__((visibility("default")))
+#    define ESL_ATTR_TARGET(isa) __attribute__((__target__(isa)))
 #else
 #    define ESL_ATTR_FORCEINLINE inline
 #    define ESL_ATTR_NOINLINE
 #    define ESL_ATTR_EXPORT
 #    define ESL_ATTR_IMPORT
+#    define ESL_ATTR_TARGET(isa)
 #endif
 
 // ESL_COUNTER, ESL_PRETTY_FUNCTION
@@ -6,7 +6,9 @@
 
 #include <cstdlib>
 #include <memory>
+#include <new>
 #include <type_traits>
+#include <utility>
 
 #ifdef ESL_SOURCE_WIN32
 #    include <malloc.h>
@@ -79,6 +81,34 @@ public:
     }
 };
 
+// uninitialized_construct_using_allocator
+// Uses-allocator construction as in C++20: alloc is passed to T if T uses an allocator convertible from Alloc
+template <class T, class Alloc, class... Args>
+inline T* uninitialized_construct_using_allocator(T* p, const Alloc& alloc, Args&&... args) {
+    if constexpr (!std::uses_allocator_v<T, Alloc>) {
+        return ::new (static_cast<void*>(p)) T(std::forward<Args>(args)...);
+    } else if constexpr (std::is_constructible_v<T, std::allocator_arg_t, const Alloc&, Args...>) {
+        return ::new (static_cast<void*>(p)) T(std::allocator_arg, alloc, std::forward<Args>(args)...);
+    } else {
+        static_assert(std::is_constructible_v<T, Args..., const Alloc&>, "esl::uninitialized_construct_using_allocator: T is not allocator constructible");
+        return ::new (static_cast<void*>(p)) T(std::forward<Args>(args)..., alloc);
+    }
+}
+
+// new_using_allocator
+// Uses-allocator construction of a new T, see uninitialized_construct_using_allocator
+template <class T, class Alloc, class... Args>
+inline T* new_using_allocator(const Alloc& alloc, Args&&... args) {
+    if constexpr (!std::uses_allocator_v<T, Alloc>) {
+        return new T(std::forward<Args>(args)...);
+    } else if constexpr (std::is_constructible_v<T, std::allocator_arg_t, const Alloc&, Args...>) {
+        return new T(std::allocator_arg, alloc, std::forward<Args>(args)...);
+    } else {
+        static_assert(std::is_constructible_v<T, Args..., const Alloc&>, "esl::new_using_allocator: T is not allocator constructible");
+        return new T(std::forward<Args>(args)..., alloc);
+    }
+}
+
 template <class T, class DefaultDeleter = std::default_delete<T>>
 class default_deleter_shared_ptr : public std::shared_ptr<T> {
     using base_type = std::shared_ptr<T>;
@@ -0,0 +1,385 @@
+#ifndef ESL_MSGPACK_HPP
+#define ESL_MSGPACK_HPP
+
+#include "codec_detail.hpp"
+#include "intrin.hpp"
+#include "json.hpp"
+#include "type_traits.hpp"
+#include "yaml.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace esl {
+
+// See https://github.com/msgpack/msgpack/blob/master/spec.md
+namespace msgpack {
+
+// decode_error
+// position: byte offset of the object
+using decode_error = details::codec_decode_error;
+
+// encoder_
+// Smallest formats: fix forms, integers in the shortest width, float 32 when exact
+template <class Sink>
+class encoder_ {
+private:
+    Sink& sink_;
+
+    // Type byte and a big-endian argument of `size' bytes
+    void head(unsigned char type, std::uint64_t arg, std::size_t size) {
+        unsigned char buf[9];
+        buf[0] = type;
+        switch (size) {
+        case 0:
+            break;
+        case 1:
+            buf[1] = static_cast<unsigned char>(arg);
+            break;
+        case 2:
+            store16be(static_cast<std::uint16_t>(arg), buf + 1);
+            break;
+        case 4:
+            store32be(static_cast<std::uint32_t>(arg), buf + 1);
+            break;
+        default:
+            store64be(arg, buf + 1);
+            break;
+        }
+        sink_.write(buf, 1 + size);
+    }
+
+    // fix: type byte of the fix form, up to `fix_max'
+    void length(std::size_t n, unsigned char fix, std::size_t fix_max, unsigned char type8, unsigned char type16, unsigned char type32) {
+        if (n <= fix_max) {
+            this->head(static_cast<unsigned char>(fix | n), 0, 0);
+        } else if (n <= 0xFF && type8 != 0) {
+            this->head(type8, n, 1);
+        } else if (n <= 0xFFFF) {
+            this->head(type16, n, 2);
+        } else if (n <= 0xFFFFFFFF) {
+            this->head(type32, n, 4);
+        } else {
+            throw std::length_error("esl::msgpack::encode: size above 2^32-1");
+        }
+    }
+
+    void unsigned_integer(std::uint64_t u) {
+        if (u < 0x80) {
+            this->head(static_cast<unsigned char>(u), 0, 0);
+        } else if (u <= 0xFF) {
+            this->head(0xCC, u, 1);
+        } else if (u <= 0xFFFF) {
+            this->head(0xCD, u, 2);
+        } else if (u <= 0xFFFFFFFF) {
+            this->head(0xCE, u, 4);
+        } else {
+            this->head(0xCF, u, 8);
+        }
+    }
+
+    void integer(std::int64_t i) {
+        if (i >= 0) {
+            this->unsigned_integer(static_cast<std::uint64_t>(i));
+        } else {
+            const auto u = static_cast<std::uint64_t>(i);
+            if (i >= -32) {
+                this->head(static_cast<unsigned char>(u), 0, 0);
+            } else if (i >= std::numeric_limits<std::int8_t>::min()) {
+                this->head(0xD0, u, 1);
+            } else if (i >= std::numeric_limits<std::int16_t>::min()) {
+                this->head(0xD1, u, 2);
+            } else if (i >= std::numeric_limits<std::int32_t>::min()) {
+                this->head(0xD2, u, 4);
+            } else {
+                this->head(0xD3, u, 8);
+            }
+        }
+    }
+
+    void floating(double d) {
+        const float f = static_cast<float>(d);
+        if (static_cast<double>(f) == d || std::isnan(d)) {
+            std::uint32_t bits;
+            std::memcpy(&bits, &f, sizeof(bits));
+            this->head(0xCA, bits, 4);
+        } else {
+            std::uint64_t bits;
+            std::memcpy(&bits, &d, sizeof(bits));
+            this->head(0xCB, bits, 8);
+        }
+    }
+
+    void string(std::string_view s) {
+        this->length(s.size(), 0xA0, 31, 0xD9, 0xDA, 0xDB);
+        sink_.write(s.data(), s.size());
+    }
+
+public:
+    explicit encoder_(Sink& sink) noexcept : sink_(sink) {}
+
+    template <class Value>
+    void value(const Value& v) {
+        esl::visit([this](const auto& x) { this->alternative(x); }, v);
+    }
+
+    template <class T>
+    void alternative(const T& x) {
+        if constexpr (std::is_same_v<T, std::monostate>) {
+            this->head(0xC0, 0, 0);
+        } else if constexpr (std::is_same_v<T, bool>) {
+            this->head(x ? 0xC3 : 0xC2, 0, 0);
+        } else if constexpr (std::is_same_v<T, std::int64_t>) {
+            this->integer(x);
+        } else if constexpr (std::is_same_v<T, std::uint64_t>) {
+            this->unsigned_integer(x);
+        } else if constexpr (std::is_same_v<T, double>) {
+            this->floating(x);
+        } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+            this->string(x);
+        } else if constexpr (has_member_type_mapped_type_v<T>) {
+            this->length(x.size(), 0x80, 15, 0, 0xDE, 0xDF);
+            for (const auto& [k, e] : x) {
+                this->string(k);
+                this->value(e);
+            }
+        } else {
+            this->length(x.size(), 0x90, 15, 0, 0xDC, 0xDD);
+            for (const auto& e : x) {
+                this->value(e);
+            }
+        }
+    }
+};
+
+// encoded_size
+// Value: json::value, json::pmr::value, json::value_view or yaml::node
+// Exceptions: std::length_error if a string or a container has 2^32 or more elements
+template <class Value>
+inline std::size_t encoded_size(const Value& v) {
+    details::codec_size_sink sink;
+    encoder_<details::codec_size_sink>(sink).value(v);
+    return sink.size;
+}
+
+// encode
+// Integers are encoded as integers, doubles as float 32 when exact
+// out: encoded_size(v) bytes
+// return: output size
+// Exceptions: std::length_error if a string or a container has 2^32 or more elements
+template <class Value>
+inline std::size_t encode(const Value& v, void* out) {
+    details::codec_pointer_sink sink{static_cast<unsigned char*>(out)};
+    encoder_<details::codec_pointer_sink>(sink).value(v);
+    return static_cast<std::size_t>(sink.p - static_cast<unsigned char*>(out));
+}
+// return bytes
+template <class Value>
+inline std::vector<unsigned char> encode(const Value& v) {
+    std::vector<unsigned char> out(encoded_size(v));
+    encode(v, out.data());
+    return out;
+}
+
+// decoder_
+template <class Handler>
+class decoder_ : public details::codec_input {
+private:
+    Handler& handler_;
+    std::size_t depth_ = 0;
+
+    // Big-endian argument of `size' bytes
+    std::uint64_t argument(std::size_t size, const unsigned char* at) {
+        this->need(size, at);
+        const unsigned char* p = p_;
+        p_ += size;
+        switch (size) {
+        case 1:
+            return *p;
+        case 2:
+            return load16be(p);
+        case 4:
+            return load32be(p);
+        default:
+            return load64be(p);
+        }
+    }
+
+    std::string_view bytes(std::uint64_t n, const unsigned char* at) {
+        this->need(n, at);
+        const auto s = reinterpret_cast<const char*>(p_);
+        p_ += n;
+        return std::string_view(s, static_cast<std::size_t>(n));
+    }
+
+    // return: false if the type byte is not a str or a bin
+    bool string(unsigned type, const unsigned char* at, std::string_view& s) {
+        if (type >= 0xA0 && type <= 0xBF) {
+            s = this->bytes(type & 0x1F, at);
+        } else if (type == 0xC4 || type == 0xD9) {
+            s = this->bytes(this->argument(1, at), at);
+        } else if (type == 0xC5 || type == 0xDA) {
+            s = this->bytes(this->argument(2, at), at);
+        } else if (type == 0xC6 || type == 0xDB) {
+            s = this->bytes(this->argument(4, at), at);
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    void array(std::uint64_t n, const unsigned char* at) {
+        if (++depth_ > json::max_depth) {
+            this->fail("too deeply nested", at);
+        }
+        // Every element takes a byte at least
+        this->need(n, at);
+        handler_.begin_array();
+        for (std::uint64_t i = 0; i != n; ++i) {
+            this->item();
+        }
+        handler_.end_array(static_cast<std::size_t>(n));
+        --depth_;
+    }
+
+    void map(std::uint64_t n, const unsigned char* at) {
+        if (++depth_ > json::max_depth) {
+            this->fail("too deeply nested", at);
+        }
+        this->need(n, at);
+        handler_.begin_object();
+        for (std::uint64_t i = 0; i != n; ++i) {
+            const unsigned char* key = p_;
+            this->need(1, key);
+            std::string_view s;
+            if (!this->string(*p_++, key, s)) {
+                this->fail("unsupported key", key);
+            }
+            handler_.key(s);
+            this->item();
+        }
+        handler_.end_object(static_cast<std::size_t>(n));
+        --depth_;
+    }
+
+public:
+    decoder_(const unsigned char* first, const unsigned char* last, Handler& handler) noexcept
+        : codec_input(first, last), handler_(handler) {}
+
+    void item() {
+        const unsigned char* at = p_;
+        this->need(1, at);
+        const unsigned type = *p_++;
+        std::string_view s;
+        if (type < 0x80) {
+            handler_.integer(type);
+        } else if (type < 0x90) {
+            this->map(type & 0x0F, at);
+        } else if (type < 0xA0) {
+            this->array(type & 0x0F, at);
+        } else if (type >= 0xE0) {
+            handler_.integer(static_cast<std::int8_t>(type));
+        } else if (this->string(type, at, s)) {
+            handler_.string(s);
+        } else {
+            switch (type) {
+            case 0xC0:
+                handler_.null();
+                break;
+            case 0xC2:
+            case 0xC3:
+                handler_.boolean(type == 0xC3);
+                break;
+            case 0xCA: {
+                const auto bits = static_cast<std::uint32_t>(this->argument(4, at));
+                float x;
+                std::memcpy(&x, &bits, sizeof(x));
+                handler_.number(x);
+                break;
+            }
+            case 0xCB: {
+                const std::uint64_t bits = this->argument(8, at);
+                double x;
+                std::memcpy(&x, &bits, sizeof(x));
+                handler_.number(x);
+                break;
+            }
+            case 0xCC:
+            case 0xCD:
+            case 0xCE:
+                handler_.integer(static_cast<std::int64_t>(this->argument(std::size_t(1) << (type - 0xCC), at)));
+                break;
+            case 0xCF: {
+                const std::uint64_t u = this->argument(8, at);
+                if (u <= static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max())) {
+                    handler_.integer(static_cast<std::int64_t>(u));
+                } else {
+                    json::unsigned_integer_event_(handler_, u);
+                }
+                break;
+            }
+            case 0xD0:
+                handler_.integer(static_cast<std::int8_t>(this->argument(1, at)));
+                break;
+            case 0xD1:
+                handler_.integer(static_cast<std::int16_t>(this->argument(2, at)));
+                break;
+            case 0xD2:
+                handler_.integer(static_cast<std::int32_t>(this->argument(4, at)));
+                break;
+            case 0xD3:
+                handler_.integer(static_cast<std::int64_t>(this->argument(8, at)));
+                break;
+            case 0xDC:
+                this->array(this->argument(2, at), at);
+                break;
+            case 0xDD:
+                this->array(this->argument(4, at), at);
+                break;
+            case 0xDE:
+                this->map(this->argument(2, at), at);
+                break;
+            case 0xDF:
+                this->map(this->argument(4, at), at);
+                break;
+            case 0xC1:
+                this->fail("invalid type", at);
+            default:
+                this->fail("unsupported extension", at);
+            }
+        }
+    }
+};
+
+// decode
+// Events of the object at `data' for a handler of json::reader (see structural_parser_), with integer(std::int64_t) too;
+// bins are delivered as strings, unsigned integers above the int64 range as
+// unsigned_integer(std::uint64_t) if the handler has it, else numbers
+// NOTE: Strings and keys are views of the input
+// return: size of the object
+// Exceptions: esl::msgpack::decode_error, and exceptions thrown by the handler
+template <class Handler>
+inline std::size_t decode(const void* data, std::size_t size, Handler& handler) {
+    return details::codec_decode<decoder_>(data, size, handler);
+}
+
+// decode
+// Value: json::value or yaml::node, from a whole input holding one object
+// Exceptions: esl::msgpack::decode_error
+template <class Value>
+inline Value decode(const void* data, std::size_t size) {
+    return details::codec_decode<decoder_, Value>(data, size);
+}
+
+} // namespace msgpack
+
+} // namespace esl
+
+#endif // ESL_MSGPACK_HPP
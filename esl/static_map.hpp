@@ -0,0 +1,306 @@
+#ifndef ESL_STATIC_MAP_HPP
+#define ESL_STATIC_MAP_HPP
+
+#include "exception.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace esl {
+
+// static_map_mix_
+// Finalizer of MurmurHash3
+inline constexpr std::uint64_t static_map_mix_(std::uint64_t h) noexcept {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdU;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53U;
+    return h ^ (h >> 33);
+}
+
+// static_map_hash
+// Seeded constexpr hash of static_map keys, specialize it or pass a Hash with the same call for other keys
+template <class Key, class = void>
+struct static_map_hash;
+template <class Key>
+struct static_map_hash<Key, std::enable_if_t<std::is_integral_v<Key> || std::is_enum_v<Key>>> {
+    constexpr std::uint64_t operator()(const Key& key, std::uint64_t seed) const noexcept {
+        return static_map_mix_(static_cast<std::uint64_t>(key) ^ seed);
+    }
+};
+template <class CharT, class Traits>
+struct static_map_hash<std::basic_string_view<CharT, Traits>> {
+    // FNV-1a
+    constexpr std::uint64_t operator()(std::basic_string_view<CharT, Traits> key, std::uint64_t seed) const noexcept {
+        std::uint64_t h = 0xcbf29ce484222325U ^ seed;
+        for (auto c : key) {
+            h = (h ^ static_cast<std::make_unsigned_t<CharT>>(c)) * 0x100000001b3U;
+        }
+        return static_map_mix_(h);
+    }
+};
+
+// static_map_layout_
+// Hash and displace (CHD, PTHash): keys are hashed once, to a bucket by the low 32 bits and to a slot by the high 32 bits
+// xor the bucket displacement. Buckets are placed largest first, each with the first pilot moving all its keys to free slots.
+// Every slot is used, so a lookup is one hash and one compare.
+template <std::size_t N>
+struct static_map_layout_ {
+    static_assert(N != 0, "esl::static_map: no keys");
+
+    static constexpr std::size_t buckets = N / 2 + 1;
+
+    std::uint64_t seed{};
+    std::uint64_t displacements[buckets]{};
+    std::size_t order[N]{}; // order[slot]: index of the entry
+
+    static constexpr std::size_t bucket(std::uint64_t h) noexcept {
+        return static_cast<std::size_t>(((h & 0xFFFFFFFFU) * buckets) >> 32);
+    }
+
+    static constexpr std::size_t slot(std::uint64_t h, std::uint64_t displacement) noexcept {
+        return static_cast<std::size_t>((((h ^ displacement) >> 32) * N) >> 32);
+    }
+
+    // Heap sort of the entry indexes by hash
+    static constexpr void sort_by_hash(std::size_t (&indexes)[N], const std::uint64_t (&hashes)[N]) noexcept {
+        const auto sift_down = [&](std::size_t root, std::size_t n) {
+            for (std::size_t child = root * 2 + 1; child < n; root = child, child = root * 2 + 1) {
+                if (child + 1 < n && hashes[indexes[child + 1]] > hashes[indexes[child]]) {
+                    ++child;
+                }
+                if (hashes[indexes[root]] >= hashes[indexes[child]]) {
+                    break;
+                }
+                const auto t = indexes[root];
+                indexes[root] = indexes[child];
+                indexes[child] = t;
+            }
+        };
+        for (std::size_t i = N / 2; i-- != 0;) {
+            sift_down(i, N);
+        }
+        for (std::size_t n = N; n-- > 1;) {
+            const auto t = indexes[0];
+            indexes[0] = indexes[n];
+            indexes[n] = t;
+            sift_down(0, n);
+        }
+    }
+
+    // Seeds tried, a seed fails only if a bucket finds no pilot, so distinct hashes practically never exhaust them
+    static constexpr std::uint64_t max_seeds = 64;
+
+    // Exceptions: std::invalid_argument (a compile error in a constant expression) if keys are duplicated, or if no
+    // seed gives a perfect hash, when distinct keys have equal hashes for every seed
+    template <class Hash, class Entries>
+    constexpr static_map_layout_(const Hash& hash, const Entries& entries) {
+        constexpr std::size_t max_pilots = N * 64 + 1024;
+        std::uint64_t hashes[N]{};
+        std::size_t starts[buckets + 1]{}; // members of bucket b: members[starts[b], starts[b + 1])
+        std::size_t members[N]{};
+        std::size_t sorted[buckets]{};
+        bool taken[N]{};
+        // Equal keys have equal hashes for any seed: compared within runs of equal hashes, O(N log N)
+        for (std::size_t i = 0; i < N; ++i) {
+            hashes[i] = hash(entries[i].first, seed);
+            members[i] = i;
+        }
+        sort_by_hash(members, hashes);
+        for (std::size_t i = 1; i < N; ++i) {
+            for (std::size_t j = i; j-- != 0 && hashes[members[j]] == hashes[members[i]];) {
+                if (entries[members[j]].first == entries[members[i]].first) {
+                    throw std::invalid_argument("esl::static_map: duplicate key");
+                }
+            }
+        }
+        for (;; ++seed) {
+            if (seed == max_seeds) {
+                throw std::invalid_argument(
+                    "esl::static_map: no perfect hash within max_seeds, distinct keys hash equally for every seed");
+            }
+            for (std::size_t i = 0; i < N; ++i) {
+                hashes[i] = hash(entries[i].first, seed);
+            }
+            for (std::size_t b = 0; b <= buckets; ++b) {
+                starts[b] = 0;
+            }
+            for (std::size_t i = 0; i < N; ++i) {
+                ++starts[bucket(hashes[i]) + 1];
+                taken[i] = false;
+            }
+            for (std::size_t b = 0; b < buckets; ++b) {
+                starts[b + 1] += starts[b];
+            }
+            for (std::size_t i = N; i-- != 0;) {
+                members[--starts[bucket(hashes[i]) + 1]] = i;
+            }
+            // starts[b + 1] is the start of bucket b now, shift back
+            for (std::size_t b = 0; b < buckets; ++b) {
+                starts[b] = starts[b + 1];
+            }
+            starts[buckets] = N;
+            const auto size = [&](std::size_t b) { return starts[b + 1] - starts[b]; };
+            // Insertion sort, largest first
+            for (std::size_t i = 0; i < buckets; ++i) {
+                std::size_t j = i;
+                for (; j != 0 && size(sorted[j - 1]) < size(i); --j) {
+                    sorted[j] = sorted[j - 1];
+                }
+                sorted[j] = i;
+            }
+            bool placed_all = true;
+            for (std::size_t k = 0; k < buckets && placed_all && size(sorted[k]) != 0; ++k) {
+                const std::size_t b = sorted[k];
+                std::size_t pilot = 0;
+                for (; pilot != max_pilots; ++pilot) {
+                    const std::uint64_t d = static_map_mix_(pilot);
+                    std::size_t m = starts[b];
+                    for (; m != starts[b + 1] && !taken[slot(hashes[members[m]], d)]; ++m) {
+                        taken[slot(hashes[members[m]], d)] = true;
+                    }
+                    if (m == starts[b + 1]) {
+                        displacements[b] = d;
+                        for (m = starts[b]; m != starts[b + 1]; ++m) {
+                            order[slot(hashes[members[m]], d)] = members[m];
+                        }
+                        break;
+                    }
+                    while (m-- != starts[b]) {
+                        taken[slot(hashes[members[m]], d)] = false;
+                    }
+                }
+                placed_all = pilot != max_pilots;
+            }
+            if (placed_all) {
+                break;
+            }
+        }
+    }
+};
+
+// static_map
+// Immutable map of keys known at compile time, with a minimal perfect hash built in the constructor
+// Key: equality comparable, std::string_view for string literals
+// Hash: std::uint64_t operator()(const Key&, std::uint64_t seed) const, constexpr to build the map at compile time
+template <class Key, class Value, std::size_t N, class Hash = static_map_hash<Key>>
+class static_map {
+public:
+    using key_type = Key;
+    using mapped_type = Value;
+    using value_type = std::pair<const Key, Value>;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using hasher = Hash;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using pointer = value_type*;
+    using const_pointer = const value_type*;
+    using iterator = value_type*;
+    using const_iterator = const value_type*;
+
+private:
+    using layout_type = static_map_layout_<N>;
+
+    Hash hash_;
+    std::uint64_t seed_;
+    std::uint64_t displacements_[layout_type::buckets];
+    value_type entries_[N];
+
+    template <class Entries, std::size_t... Is>
+    constexpr static_map(const Entries& entries, const layout_type& layout, const Hash& hash, std::index_sequence<Is...>)
+        : hash_(hash), seed_(layout.seed), displacements_{}, entries_{entries[layout.order[Is]]...} {
+        for (std::size_t b = 0; b < layout_type::buckets; ++b) {
+            displacements_[b] = layout.displacements[b];
+        }
+    }
+
+    constexpr std::size_t slot(const Key& key) const noexcept {
+        const std::uint64_t h = hash_(key, seed_);
+        return layout_type::slot(h, displacements_[layout_type::bucket(h)]);
+    }
+
+public:
+    // Exceptions: std::invalid_argument if keys are duplicated or no perfect hash is found (see static_map_layout_)
+    constexpr explicit static_map(const std::pair<Key, Value> (&entries)[N], const Hash& hash = Hash())
+        : static_map(entries, layout_type(hash, entries), hash, std::make_index_sequence<N>{}) {}
+    constexpr explicit static_map(const std::array<std::pair<Key, Value>, N>& entries, const Hash& hash = Hash())
+        : static_map(entries, layout_type(hash, entries), hash, std::make_index_sequence<N>{}) {}
+
+    // Iterators, in slot order
+
+    constexpr iterator begin() noexcept {
+        return entries_;
+    }
+    constexpr const_iterator begin() const noexcept {
+        return entries_;
+    }
+    constexpr const_iterator cbegin() const noexcept {
+        return entries_;
+    }
+    constexpr iterator end() noexcept {
+        return entries_ + N;
+    }
+    constexpr const_iterator end() const noexcept {
+        return entries_ + N;
+    }
+    constexpr const_iterator cend() const noexcept {
+        return entries_ + N;
+    }
+
+    // Capacity
+
+    constexpr bool empty() const noexcept {
+        return false;
+    }
+    constexpr size_type size() const noexcept {
+        return N;
+    }
+    constexpr size_type max_size() const noexcept {
+        return N;
+    }
+
+    // Lookup
+
+    constexpr iterator find(const Key& key) noexcept {
+        return const_cast<iterator>(static_cast<const static_map&>(*this).find(key));
+    }
+    constexpr const_iterator find(const Key& key) const noexcept {
+        const_iterator it = entries_ + this->slot(key);
+        return it->first == key ? it : end();
+    }
+
+    constexpr bool contains(const Key& key) const noexcept {
+        return this->find(key) != end();
+    }
+    constexpr size_type count(const Key& key) const noexcept {
+        return this->contains(key) ? 1 : 0;
+    }
+
+    // Exceptions: esl::key_not_found
+    constexpr Value& at(const Key& key) {
+        return const_cast<Value&>(static_cast<const static_map&>(*this).at(key));
+    }
+    constexpr const Value& at(const Key& key) const {
+        const auto it = this->find(key);
+        if (it == end()) {
+            throw key_not_found("esl::static_map::at");
+        }
+        return it->second;
+    }
+};
+
+// make_static_map
+// Exceptions: std::invalid_argument if keys are duplicated or no perfect hash is found
+template <class Key, class Value, std::size_t N>
+inline constexpr static_map<Key, Value, N> make_static_map(const std::pair<Key, Value> (&entries)[N]) {
+    return static_map<Key, Value, N>(entries);
+}
+
+} // namespace esl
+
+#endif //ESL_STATIC_MAP_HPP
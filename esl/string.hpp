@@ -2,6 +2,7 @@
 #ifndef ESL_STRING_HPP
 #define ESL_STRING_HPP
 
+#include "charconv.hpp"
 #include "literal.hpp"
 #include "locale.hpp"
 #include "macros.hpp"
@@ -9,6 +10,7 @@
 #include "type_traits.hpp"
 
 #include <cinttypes>
+#include <limits>
 #include <locale>
 #include <regex>
 #include <sstream>
@@ -159,7 +161,6 @@ public:
 
 // from_string
 // Generic c++17 std::from_chars
-// TODO float
 enum class from_string_errc {
     success = 0,
     invalid_argument = static_cast<int>(std::errc::invalid_argument),
@@ -221,6 +222,15 @@ constexpr std::pair<from_string_errc, std::size_t> from_string(const S& s, T& va
     return {from_string_errc::success, it - first};
 }
 
+// NOTE: float and double of char strings: the general format, correctly rounded
+template <class S, class T, class STraits = string_traits<S>,
+          std::enable_if_t<is_one_of_v<T, float, double> && std::is_same_v<typename STraits::value_type, char>, int> = 0>
+std::pair<from_string_errc, std::size_t> from_string(const S& s, T& value) noexcept {
+    const typename STraits::string_view_type v(s);
+    const auto r = from_chars_float_(v.data(), v.data() + v.size(), value);
+    return {static_cast<from_string_errc>(r.ec), static_cast<std::size_t>(r.ptr - v.data())};
+}
+
 // split
 template <class T, class S, class OutputIt>
 OutputIt split_(const T& v, const S& d, std::size_t dn, OutputIt d_first) {
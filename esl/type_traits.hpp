@@ -268,6 +268,7 @@ ESL_IMPL_HAS_MEMBER_TYPE_INTERNAL_(value_type)
 ESL_IMPL_HAS_MEMBER_TYPE_INTERNAL_(size_type)
 ESL_IMPL_HAS_MEMBER_TYPE_INTERNAL_(difference_type)
 ESL_IMPL_HAS_MEMBER_TYPE_INTERNAL_(allocator_type)
+ESL_IMPL_HAS_MEMBER_TYPE_INTERNAL_(mapped_type)
 ESL_IMPL_HAS_MEMBER_TYPE_INTERNAL_(pointer)
 ESL_IMPL_HAS_MEMBER_TYPE_INTERNAL_(const_pointer)
 ESL_IMPL_HAS_MEMBER_TYPE_INTERNAL_(reference)
@@ -280,6 +281,7 @@ ESL_IMPL_HAS_MEMBER_TYPE_INTERNAL_(traits_type)
 ESL_IMPL_HAS_MEMBER_TYPE_INTERNAL_(element_type)
 ESL_IMPL_HAS_MEMBER_TYPE_INTERNAL_(deleter_type)
 ESL_IMPL_HAS_MEMBER_TYPE_INTERNAL_(is_always_equal)
+ESL_IMPL_HAS_MEMBER_TYPE_INTERNAL_(is_transparent)
 ESL_IMPL_HAS_MEMBER_TYPE_INTERNAL_(weak_type)
 ESL_IMPL_HAS_MEMBER_TYPE_INTERNAL_(native_handle_type)
 ESL_IMPL_HAS_MEMBER_TYPE_INTERNAL_(mutex_type)
@@ -0,0 +1,148 @@
+#include "utility.hpp"
+#include "intrin.hpp"
+
+namespace esl {
+
+#ifdef ESL_ARCH_X86_ANY
+
+namespace {
+
+// Encoding looks the nibbles up in the alphabet with pshufb, so any alphabet is supported
+// Kernels return the input size consumed, the remainder is left to the scalar loop
+
+ESL_ATTR_TARGET("ssse3")
+std::size_t hex_encode_ssse3_(const unsigned char* in, std::size_t size, char* out, const hex_option& option) noexcept {
+	const __m128i lut = _mm_loadu_si128(reinterpret_cast<const __m128i*>(option.alphabet()));
+	const __m128i mask = _mm_set1_epi8(0x0F);
+	std::size_t i = 0;
+	for (; i + 16 <= size; i += 16) {
+		const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+		const __m128i hi = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(v, 4), mask));
+		const __m128i lo = _mm_shuffle_epi8(lut, _mm_and_si128(v, mask));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2), _mm_unpacklo_epi8(hi, lo));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2 + 16), _mm_unpackhi_epi8(hi, lo));
+	}
+	return i;
+}
+
+ESL_ATTR_TARGET("avx2")
+std::size_t hex_encode_avx2_(const unsigned char* in, std::size_t size, char* out, const hex_option& option) noexcept {
+	const __m256i lut = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(option.alphabet())));
+	const __m256i mask = _mm256_set1_epi8(0x0F);
+	std::size_t i = 0;
+	for (; i + 32 <= size; i += 32) {
+		// Bytes [0, 8) [16, 24) | [8, 16) [24, 32), so the in-lane unpacks yield [0, 16) and [16, 32)
+		const __m256i v = _mm256_permute4x64_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i)), 0xD8);
+		const __m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(v, 4), mask));
+		const __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(v, mask));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i * 2), _mm256_unpacklo_epi8(hi, lo));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i * 2 + 32), _mm256_unpackhi_epi8(hi, lo));
+	}
+	return i;
+}
+
+// Decoding computes digits as c - '0' < 10 or c - letter_base < 6, so only the standard alphabets are supported
+// A block with an invalid character stops the kernel, the scalar loop locates the error
+
+ESL_ATTR_TARGET("ssse3")
+inline bool hex_decode_digits_ssse3_(__m128i c, __m128i letter_base, __m128i& out) noexcept {
+	const __m128i d = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+	const __m128i l = _mm_sub_epi8(c, letter_base);
+	const __m128i d_ok = _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(9)), d);
+	const __m128i l_ok = _mm_cmpeq_epi8(_mm_min_epu8(l, _mm_set1_epi8(5)), l);
+	out = _mm_or_si128(_mm_and_si128(d_ok, d), _mm_and_si128(l_ok, _mm_add_epi8(l, _mm_set1_epi8(10))));
+	return _mm_movemask_epi8(_mm_or_si128(d_ok, l_ok)) == 0xFFFF;
+}
+
+ESL_ATTR_TARGET("ssse3")
+std::size_t hex_decode_ssse3_(const char* in, std::size_t size, unsigned char* out, const hex_option& option) noexcept {
+	const __m128i letter_base = _mm_set1_epi8(option.letter_base());
+	// [0000hhhh][0000llll] -> [hhhhllll] in each 16-bit lane
+	const __m128i weights = _mm_set1_epi16(0x0110);
+	std::size_t i = 0;
+	for (; i + 32 <= size; i += 32) {
+		__m128i a, b;
+		if (!hex_decode_digits_ssse3_(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)), letter_base, a) ||
+				!hex_decode_digits_ssse3_(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 16)), letter_base, b)) {
+			break;
+		}
+		const __m128i r = _mm_packus_epi16(_mm_maddubs_epi16(a, weights), _mm_maddubs_epi16(b, weights));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i / 2), r);
+	}
+	return i;
+}
+
+ESL_ATTR_TARGET("avx2")
+inline bool hex_decode_digits_avx2_(__m256i c, __m256i letter_base, __m256i& out) noexcept {
+	const __m256i d = _mm256_sub_epi8(c, _mm256_set1_epi8('0'));
+	const __m256i l = _mm256_sub_epi8(c, letter_base);
+	const __m256i d_ok = _mm256_cmpeq_epi8(_mm256_min_epu8(d, _mm256_set1_epi8(9)), d);
+	const __m256i l_ok = _mm256_cmpeq_epi8(_mm256_min_epu8(l, _mm256_set1_epi8(5)), l);
+	out = _mm256_or_si256(_mm256_and_si256(d_ok, d), _mm256_and_si256(l_ok, _mm256_add_epi8(l, _mm256_set1_epi8(10))));
+	return _mm256_movemask_epi8(_mm256_or_si256(d_ok, l_ok)) == -1;
+}
+
+ESL_ATTR_TARGET("avx2")
+std::size_t hex_decode_avx2_(const char* in, std::size_t size, unsigned char* out, const hex_option& option) noexcept {
+	const __m256i letter_base = _mm256_set1_epi8(option.letter_base());
+	const __m256i weights = _mm256_set1_epi16(0x0110);
+	std::size_t i = 0;
+	for (; i + 64 <= size; i += 64) {
+		__m256i a, b;
+		if (!hex_decode_digits_avx2_(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i)), letter_base, a) ||
+				!hex_decode_digits_avx2_(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i + 32)), letter_base, b)) {
+			break;
+		}
+		// The in-lane pack yields a[0, 8) b[0, 8) a[8, 16) b[8, 16)
+		const __m256i r = _mm256_packus_epi16(_mm256_maddubs_epi16(a, weights), _mm256_maddubs_epi16(b, weights));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i / 2), _mm256_permute4x64_epi64(r, 0xD8));
+	}
+	return i;
+}
+
+} // namespace
+
+#endif
+
+std::size_t hex_encode_simd_(const unsigned char* in, std::size_t size, char* out, const hex_option& option) noexcept {
+	std::size_t n = 0;
+#ifdef ESL_ARCH_X86_ANY
+	const auto& features = current_cpu_features();
+	if (features.avx2) {
+		n = hex_encode_avx2_(in, size, out, option);
+	}
+	if (features.ssse3) {
+		n += hex_encode_ssse3_(in + n, size - n, out + n * 2, option);
+	}
+#else
+	(void)in;
+	(void)size;
+	(void)out;
+	(void)option;
+#endif
+	return n;
+}
+
+std::size_t hex_decode_simd_(const char* in, std::size_t size, unsigned char* out, const hex_option& option) noexcept {
+	std::size_t n = 0;
+#ifdef ESL_ARCH_X86_ANY
+	if (option.letter_base() == '\0') {
+		return 0;
+	}
+	const auto& features = current_cpu_features();
+	if (features.avx2) {
+		n = hex_decode_avx2_(in, size, out, option);
+	}
+	if (features.ssse3) {
+		n += hex_decode_ssse3_(in + n, size - n, out + n / 2, option);
+	}
+#else
+	(void)in;
+	(void)size;
+	(void)out;
+	(void)option;
+#endif
+	return n;
+}
+
+} // namespace esl
@@ -12,6 +12,7 @@
 #include <initializer_list>
 #include <limits>
 #include <ostream>
+#include <stdexcept>
 #include <string>
 #include <type_traits>
 #include <utility>
@@ -167,14 +168,35 @@ inline decltype(auto) add_emplace(C& c, Args&&... args) {
 inline constexpr const char* hex_alphabet_lowercase = "0123456789abcdef";
 inline constexpr const char* hex_alphabet_uppercase = "0123456789ABCDEF";
 
+// 'a' or 'A' if alphabet is hex_alphabet_(lowercase|uppercase), '\0' otherwise
+inline constexpr char hex_letter_base_(const char* alphabet) noexcept {
+    for (std::size_t i = 0; i < 10; ++i) {
+        if (alphabet[i] != static_cast<char>('0' + i)) {
+            return '\0';
+        }
+    }
+    for (const char base : {'a', 'A'}) {
+        std::size_t i = 0;
+        while (i < 6 && alphabet[10 + i] == static_cast<char>(base + i)) {
+            ++i;
+        }
+        if (i == 6) {
+            return base;
+        }
+    }
+    return '\0';
+}
+
 class hex_option {
 private:
     std::array<char, 16> alphabet_;
     std::array<unsigned char, 256> alphabet_invert_;
+    char letter_base_;
 
 public:
     constexpr hex_option(const char* alphabet) noexcept
-        : alphabet_(make_sized_array<16>(alphabet)), alphabet_invert_(invert_integer_array<unsigned char, 256, 16>(alphabet)) {}
+        : alphabet_(make_sized_array<16>(alphabet)), alphabet_invert_(invert_integer_array<unsigned char, 256, 16>(alphabet)),
+          letter_base_(hex_letter_base_(alphabet)) {}
 
     // b [0, 16)
     constexpr char encode(unsigned char b) const noexcept {
@@ -185,6 +207,16 @@ public:
     constexpr unsigned char decode(char c) const noexcept {
         return alphabet_invert_[static_cast<unsigned char>(c)];
     }
+
+    // 16 characters, not null-terminated
+    constexpr const char* alphabet() const noexcept {
+        return alphabet_.data();
+    }
+
+    // 'a' or 'A' for the standard alphabets, '\0' otherwise; vectorized decoding computes digits arithmetically from it
+    constexpr char letter_base() const noexcept {
+        return letter_base_;
+    }
 };
 
 inline constexpr hex_option hex_lowercase{hex_alphabet_lowercase};
@@ -195,10 +227,18 @@ inline constexpr std::size_t hex_encode_size(std::size_t size) noexcept {
     return size * 2;
 }
 
+// hex_encode_simd_
+// Vectorized prefix of hex_encode
+// return: input size encoded
+std::size_t hex_encode_simd_(const unsigned char* in, std::size_t size, char* out, const hex_option& option) noexcept;
+
 // hex_encode
-inline constexpr std::size_t hex_encode(const void* buf, std::size_t size, char* out, const hex_option& option = hex_lowercase) noexcept {
+inline std::size_t hex_encode(const void* buf, std::size_t size, char* out, const hex_option& option = hex_lowercase) noexcept {
     const unsigned char* in = static_cast<const unsigned char*>(buf);
     const unsigned char* const in_end = in + size;
+    const auto n = hex_encode_simd_(in, size, out, option);
+    in += n;
+    out += n * 2;
     while (in != in_end) {
         const auto c = *in++;
         *out++ = option.encode(c >> 4);
@@ -227,7 +267,89 @@ inline std::basic_ostream<CharT, Traits>& hex_encode(std::basic_ostream<CharT, T
     return os;
 }
 
-// TODO hex_decode
+// hex_decode_size
+// return: decode size if input is valid
+inline constexpr std::size_t hex_decode_size(std::size_t size) noexcept {
+    return size / 2;
+}
+
+// hex_decode_error
+class hex_decode_error : public std::logic_error {
+private:
+    std::size_t pos_;
+
+public:
+    hex_decode_error(std::size_t pos) : logic_error("decode error"), pos_(pos) {}
+
+    std::size_t position() const noexcept {
+        return pos_;
+    }
+};
+
+// hex_decode_simd_
+// Vectorized prefix of hex_try_decode, stops before the first block with an invalid character
+// return: input size decoded (even)
+std::size_t hex_decode_simd_(const char* in, std::size_t size, unsigned char* out, const hex_option& option) noexcept;
+
+// hex_try_decode
+// return: output size and input decoded size, which is the position of the first invalid (or the trailing unpaired) character on failure
+inline std::pair<std::size_t, std::size_t> hex_try_decode(const char* in, std::size_t size, void* out, const hex_option& option = hex_lowercase) noexcept {
+    unsigned char* out_b = static_cast<unsigned char*>(out);
+    std::size_t i = hex_decode_simd_(in, size, out_b, option);
+    for (; i + 1 < size; i += 2) {
+        const auto h = option.decode(in[i]);
+        if (h >= 16) {
+            return {i / 2, i};
+        }
+        const auto l = option.decode(in[i + 1]);
+        if (l >= 16) {
+            return {i / 2, i + 1};
+        }
+        out_b[i / 2] = static_cast<unsigned char>((h << 4) | l);
+    }
+    return {i / 2, i};
+}
+// return string
+inline std::pair<std::string, std::size_t> hex_try_decode(const char* in, std::size_t size, const hex_option& option = hex_lowercase) {
+    std::string s;
+    s.resize(hex_decode_size(size));
+    auto r = hex_try_decode(in, size, s.data(), option);
+    s.resize(r.first);
+    return {std::move(s), r.second};
+}
+
+// hex_decode
+// Exceptions: hex_decode_error
+inline std::size_t hex_decode(const char* in, std::size_t size, char* out, const hex_option& option = hex_lowercase) {
+    auto r = hex_try_decode(in, size, out, option);
+    if (r.second != size) {
+        throw hex_decode_error(r.second);
+    }
+    return r.first;
+}
+// return string
+inline std::string hex_decode(const char* in, std::size_t size, const hex_option& option = hex_lowercase) {
+    std::string s;
+    s.resize(hex_decode_size(size));
+    hex_decode(in, size, s.data(), option);
+    return s;
+}
+// ostream
+template <class CharT, class Traits>
+inline std::basic_ostream<CharT, Traits>& hex_decode(std::basic_ostream<CharT, Traits>& os, const char* in, std::size_t size,
+                                                     const hex_option& option = hex_lowercase) {
+    constexpr std::size_t chunk_size = 512;
+    char buf[chunk_size / 2];
+    for (std::size_t i = 0; i < size; i += chunk_size) {
+        const auto n = std::min(size - i, chunk_size);
+        const auto r = hex_try_decode(in + i, n, buf, option);
+        os.write(buf, r.first);
+        if (r.second != n) {
+            throw hex_decode_error(i + r.second);
+        }
+    }
+    return os;
+}
 
 template <class CharT, class Traits, std::size_t N>
 inline std::basic_ostream<CharT, Traits>& operator<<(std::basic_ostream<CharT, Traits>& os, const std::array<unsigned char, N>& byte_arr) {
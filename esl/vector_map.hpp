@@ -0,0 +1,543 @@
+#ifndef ESL_VECTOR_MAP_HPP
+#define ESL_VECTOR_MAP_HPP
+
+#include "exception.hpp"
+#include "functional.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace esl {
+
+// vector_map
+// Map of entries kept contiguous in insertion order. Small maps are searched linearly, a hash index of the entries is
+// built once the size exceeds index_threshold, so typical small maps cost one allocation and no hashing.
+// Hash, KeyEqual: default constructed for every use, lookups of other key types are enabled if both are transparent
+// NOTE:
+// * Insertions invalidate iterators and references as std::vector, erasures are O(n) and rebuild the index
+// * Keys must not be modified through iterators
+// * Comparison ignores the order of entries
+template <class Key, class T, class Hash = std::hash<Key>, class KeyEqual = std::equal_to<Key>, class Allocator = std::allocator<std::pair<Key, T>>>
+class vector_map {
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using value_type = std::pair<Key, T>;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+    using allocator_type = Allocator;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+
+private:
+    using entries_type = std::vector<value_type, Allocator>;
+    using slot_allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<std::uint64_t>;
+    using slot_traits = std::allocator_traits<slot_allocator_type>;
+
+public:
+    using pointer = typename entries_type::pointer;
+    using const_pointer = typename entries_type::const_pointer;
+    using iterator = typename entries_type::iterator;
+    using const_iterator = typename entries_type::const_iterator;
+
+    // Size above which lookups go through the hash index
+    static constexpr size_type index_threshold = 8;
+
+private:
+    static constexpr size_type npos = static_cast<size_type>(-1);
+
+    template <class K>
+    using enable_if_transparent_t = std::enable_if_t<has_member_type_is_transparent_v<Hash> && has_member_type_is_transparent_v<KeyEqual> && !std::is_convertible_v<K, const_iterator>>;
+
+    entries_type entries_;
+    // Open addressing with linear probing, slots_[0]: capacity, other slots: (hash low 32 bits << 32) | (entry + 1), 0 if empty
+    // Probing starts from the high bits of the mixed hash
+    std::uint64_t* slots_ = nullptr;
+
+    static std::uint64_t mix(std::size_t h) noexcept {
+        return static_cast<std::uint64_t>(h) * 0x9E3779B97F4A7C15U;
+    }
+
+    template <class K>
+    static std::uint64_t hash_of(const K& key) {
+        return mix(Hash{}(key));
+    }
+
+    size_type capacity() const noexcept {
+        return static_cast<size_type>(slots_[0]);
+    }
+
+    static size_type first_slot(std::uint64_t h, size_type capacity) noexcept {
+        return static_cast<size_type>((h >> 32) & (capacity - 1));
+    }
+
+    void free_index() noexcept {
+        if (slots_) {
+            slot_allocator_type alloc(entries_.get_allocator());
+            slot_traits::deallocate(alloc, slots_, this->capacity() + 1);
+            slots_ = nullptr;
+        }
+    }
+
+    void put_slot(std::uint64_t h, size_type i) noexcept {
+        const auto cap = this->capacity();
+        auto pos = first_slot(h, cap);
+        while (slots_[pos + 1] != 0) {
+            pos = (pos + 1) & (cap - 1);
+        }
+        slots_[pos + 1] = (h << 32) | static_cast<std::uint64_t>(i + 1);
+    }
+
+    // Index the entries in the current table, which must hold them with a load factor below 1/2
+    // NOTE: Without an index if hashing throws, lookups then scan the entries
+    void fill_index() {
+        std::fill(slots_ + 1, slots_ + this->capacity() + 1, 0);
+        try {
+            for (size_type i = 0; i < entries_.size(); ++i) {
+                this->put_slot(hash_of(entries_[i].first), i);
+            }
+        } catch (...) {
+            this->free_index();
+            throw;
+        }
+    }
+
+    // Index `n' entries at most with a load factor below 1/2, n >= size()
+    // NOTE: The current index is kept if the allocation throws
+    void build_index(size_type n) {
+        size_type cap = 16;
+        while (cap < n * 2) {
+            cap *= 2;
+        }
+        slot_allocator_type alloc(entries_.get_allocator());
+        std::uint64_t* slots = slot_traits::allocate(alloc, cap + 1);
+        slots[0] = cap;
+        this->free_index();
+        slots_ = slots;
+        this->fill_index();
+    }
+
+    // Index the entry just appended
+    void index_back() {
+        const auto n = entries_.size();
+        if (slots_) {
+            if (n * 2 > this->capacity()) {
+                this->build_index(n);
+            } else {
+                this->put_slot(hash_of(entries_.back().first), n - 1);
+            }
+        } else if (n > index_threshold) {
+            this->build_index(n);
+        }
+    }
+
+    // After erasures, or with no index: the current table is reused, so a failed allocation can not leave it stale
+    void reindex() {
+        if (entries_.size() > index_threshold) {
+            if (slots_) {
+                this->fill_index();
+            } else {
+                this->build_index(entries_.size());
+            }
+        } else {
+            this->free_index();
+        }
+    }
+
+    template <class K>
+    size_type find_index(const K& key) const {
+        if (!slots_) {
+            for (size_type i = 0; i < entries_.size(); ++i) {
+                if (KeyEqual{}(entries_[i].first, key)) {
+                    return i;
+                }
+            }
+            return npos;
+        }
+        const auto h = hash_of(key);
+        const auto cap = this->capacity();
+        for (auto pos = first_slot(h, cap);; pos = (pos + 1) & (cap - 1)) {
+            const auto slot = slots_[pos + 1];
+            if (slot == 0) {
+                return npos;
+            }
+            const auto i = static_cast<size_type>(slot & 0xFFFFFFFFU) - 1;
+            if ((slot >> 32) == (h & 0xFFFFFFFFU) && KeyEqual{}(entries_[i].first, key)) {
+                return i;
+            }
+        }
+    }
+
+    template <class K, class... Args>
+    std::pair<iterator, bool> try_emplace_(K&& key, Args&&... args) {
+        const auto i = this->find_index(key);
+        if (i != npos) {
+            return {entries_.begin() + static_cast<difference_type>(i), false};
+        }
+        entries_.emplace_back(std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)), std::forward_as_tuple(std::forward<Args>(args)...));
+        this->commit_back();
+        return {std::prev(entries_.end()), true};
+    }
+
+    template <class K, class M>
+    std::pair<iterator, bool> insert_or_assign_(K&& key, M&& obj) {
+        const auto i = this->find_index(key);
+        if (i != npos) {
+            entries_[i].second = std::forward<M>(obj);
+            return {entries_.begin() + static_cast<difference_type>(i), false};
+        }
+        entries_.emplace_back(std::forward<K>(key), std::forward<M>(obj));
+        this->commit_back();
+        return {std::prev(entries_.end()), true};
+    }
+
+    // Index the entry just appended, removed if the index can not grow
+    void commit_back() {
+        try {
+            this->index_back();
+        } catch (...) {
+            entries_.pop_back();
+            throw;
+        }
+    }
+
+    void copy_index(const vector_map& other) {
+        if (other.slots_) {
+            slot_allocator_type alloc(entries_.get_allocator());
+            slots_ = slot_traits::allocate(alloc, other.capacity() + 1);
+            std::copy(other.slots_, other.slots_ + other.capacity() + 1, slots_);
+        }
+    }
+
+public:
+    // Constructors
+
+    vector_map() = default;
+
+    explicit vector_map(const Allocator& alloc) : entries_(alloc) {}
+
+    template <class InputIt>
+    vector_map(InputIt first, InputIt last, const Allocator& alloc = Allocator()) : entries_(alloc) {
+        this->insert(first, last);
+    }
+
+    vector_map(std::initializer_list<value_type> il, const Allocator& alloc = Allocator()) : vector_map(il.begin(), il.end(), alloc) {}
+
+    vector_map(const vector_map& other) : entries_(other.entries_) {
+        this->copy_index(other);
+    }
+
+    vector_map(const vector_map& other, const Allocator& alloc) : entries_(other.entries_, alloc) {
+        this->copy_index(other);
+    }
+
+    vector_map(vector_map&& other) noexcept : entries_(std::move(other.entries_)), slots_(std::exchange(other.slots_, nullptr)) {}
+
+    vector_map(vector_map&& other, const Allocator& alloc) : entries_(std::move(other.entries_), alloc) {
+        if (other.entries_.get_allocator() == alloc) {
+            slots_ = std::exchange(other.slots_, nullptr);
+        } else {
+            other.clear();
+            this->reindex();
+        }
+    }
+
+    ~vector_map() {
+        this->free_index();
+    }
+
+    // Strong guarantee: the copy is built aside, then swapped in
+    vector_map& operator=(const vector_map& other) {
+        if (this != &other) {
+            vector_map copy(other, std::allocator_traits<Allocator>::propagate_on_container_copy_assignment::value ? other.get_allocator()
+                                                                                                                  : this->get_allocator());
+            this->swap(copy);
+        }
+        return *this;
+    }
+
+    vector_map& operator=(vector_map&& other) noexcept(std::is_nothrow_move_assignable_v<entries_type>) {
+        if (this != &other) {
+            this->free_index();
+            const bool steal = std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value ||
+                               entries_.get_allocator() == other.entries_.get_allocator();
+            entries_ = std::move(other.entries_);
+            if (steal) {
+                slots_ = std::exchange(other.slots_, nullptr);
+            } else {
+                other.clear();
+                this->reindex();
+            }
+        }
+        return *this;
+    }
+
+    vector_map& operator=(std::initializer_list<value_type> il) {
+        this->clear();
+        this->insert(il);
+        return *this;
+    }
+
+    allocator_type get_allocator() const noexcept {
+        return entries_.get_allocator();
+    }
+
+    // Iterators, in insertion order
+
+    iterator begin() noexcept {
+        return entries_.begin();
+    }
+    const_iterator begin() const noexcept {
+        return entries_.begin();
+    }
+    const_iterator cbegin() const noexcept {
+        return entries_.cbegin();
+    }
+    iterator end() noexcept {
+        return entries_.end();
+    }
+    const_iterator end() const noexcept {
+        return entries_.end();
+    }
+    const_iterator cend() const noexcept {
+        return entries_.cend();
+    }
+
+    // Capacity
+
+    bool empty() const noexcept {
+        return entries_.empty();
+    }
+    size_type size() const noexcept {
+        return entries_.size();
+    }
+    size_type max_size() const noexcept {
+        return std::min<size_type>(entries_.max_size(), 0xFFFFFFFEU);
+    }
+
+    // reserve
+    // Also sizes the index if `n' exceeds index_threshold
+    void reserve(size_type n) {
+        entries_.reserve(n);
+        if (n > index_threshold && (!slots_ || n * 2 > this->capacity())) {
+            this->build_index(std::max(n, entries_.size()));
+        }
+    }
+
+    // Modifiers
+
+    void clear() noexcept {
+        entries_.clear();
+        this->free_index();
+    }
+
+    std::pair<iterator, bool> insert(const value_type& value) {
+        return this->try_emplace_(value.first, value.second);
+    }
+    std::pair<iterator, bool> insert(value_type&& value) {
+        return this->try_emplace_(std::move(value.first), std::move(value.second));
+    }
+    template <class InputIt>
+    void insert(InputIt first, InputIt last) {
+        for (; first != last; ++first) {
+            this->emplace(*first);
+        }
+    }
+    void insert(std::initializer_list<value_type> il) {
+        this->insert(il.begin(), il.end());
+    }
+
+    template <class M>
+    std::pair<iterator, bool> insert_or_assign(const Key& key, M&& obj) {
+        return this->insert_or_assign_(key, std::forward<M>(obj));
+    }
+    template <class M>
+    std::pair<iterator, bool> insert_or_assign(Key&& key, M&& obj) {
+        return this->insert_or_assign_(std::move(key), std::forward<M>(obj));
+    }
+
+    // emplace
+    // The entry is constructed at the end, then removed if the key exists
+    template <class... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        entries_.emplace_back(std::forward<Args>(args)...);
+        const auto n = entries_.size() - 1;
+        const auto& key = entries_.back().first;
+        size_type i = npos;
+        try {
+            if (slots_) {
+                i = this->find_index(key);
+            } else {
+                for (size_type j = 0; j < n && i == npos; ++j) {
+                    if (KeyEqual{}(entries_[j].first, key)) {
+                        i = j;
+                    }
+                }
+            }
+        } catch (...) {
+            entries_.pop_back();
+            throw;
+        }
+        if (i != npos) {
+            entries_.pop_back();
+            return {entries_.begin() + static_cast<difference_type>(i), false};
+        }
+        this->commit_back();
+        return {std::prev(entries_.end()), true};
+    }
+
+    template <class... Args>
+    std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args) {
+        return this->try_emplace_(key, std::forward<Args>(args)...);
+    }
+    template <class... Args>
+    std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args) {
+        return this->try_emplace_(std::move(key), std::forward<Args>(args)...);
+    }
+
+    iterator erase(const_iterator pos) {
+        return this->erase(pos, std::next(pos));
+    }
+    iterator erase(const_iterator first, const_iterator last) {
+        const auto offset = first - entries_.cbegin();
+        entries_.erase(first, last);
+        this->reindex();
+        return entries_.begin() + offset;
+    }
+    size_type erase(const Key& key) {
+        const auto i = this->find_index(key);
+        if (i == npos) {
+            return 0;
+        }
+        this->erase(entries_.cbegin() + static_cast<difference_type>(i));
+        return 1;
+    }
+
+    // NOTE: Allocators must be equal unless propagated on swap
+    void swap(vector_map& other) noexcept {
+        entries_.swap(other.entries_);
+        std::swap(slots_, other.slots_);
+    }
+
+    // Lookup
+
+    iterator find(const Key& key) {
+        const auto i = this->find_index(key);
+        return i != npos ? entries_.begin() + static_cast<difference_type>(i) : entries_.end();
+    }
+    const_iterator find(const Key& key) const {
+        const auto i = this->find_index(key);
+        return i != npos ? entries_.begin() + static_cast<difference_type>(i) : entries_.end();
+    }
+    template <class K, class = enable_if_transparent_t<K>>
+    iterator find(const K& key) {
+        const auto i = this->find_index(key);
+        return i != npos ? entries_.begin() + static_cast<difference_type>(i) : entries_.end();
+    }
+    template <class K, class = enable_if_transparent_t<K>>
+    const_iterator find(const K& key) const {
+        const auto i = this->find_index(key);
+        return i != npos ? entries_.begin() + static_cast<difference_type>(i) : entries_.end();
+    }
+
+    bool contains(const Key& key) const {
+        return this->find_index(key) != npos;
+    }
+    template <class K, class = enable_if_transparent_t<K>>
+    bool contains(const K& key) const {
+        return this->find_index(key) != npos;
+    }
+
+    size_type count(const Key& key) const {
+        return this->contains(key) ? 1 : 0;
+    }
+    template <class K, class = enable_if_transparent_t<K>>
+    size_type count(const K& key) const {
+        return this->contains(key) ? 1 : 0;
+    }
+
+    // Exceptions: esl::key_not_found
+    T& at(const Key& key) {
+        return const_cast<T&>(static_cast<const vector_map&>(*this).at(key));
+    }
+    const T& at(const Key& key) const {
+        const auto i = this->find_index(key);
+        if (i == npos) {
+            throw key_not_found("esl::vector_map::at");
+        }
+        return entries_[i].second;
+    }
+    template <class K, class = enable_if_transparent_t<K>>
+    T& at(const K& key) {
+        return const_cast<T&>(static_cast<const vector_map&>(*this).at(key));
+    }
+    template <class K, class = enable_if_transparent_t<K>>
+    const T& at(const K& key) const {
+        const auto i = this->find_index(key);
+        if (i == npos) {
+            throw key_not_found("esl::vector_map::at");
+        }
+        return entries_[i].second;
+    }
+
+    T& operator[](const Key& key) {
+        return this->try_emplace_(key).first->second;
+    }
+    T& operator[](Key&& key) {
+        return this->try_emplace_(std::move(key)).first->second;
+    }
+
+    // Operators
+
+    friend bool operator==(const vector_map& lhs, const vector_map& rhs) {
+        if (lhs.size() != rhs.size()) {
+            return false;
+        }
+        for (const auto& kv : lhs) {
+            const auto i = rhs.find_index(kv.first);
+            if (i == npos || !(rhs.entries_[i].second == kv.second)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    friend bool operator!=(const vector_map& lhs, const vector_map& rhs) {
+        return !(lhs == rhs);
+    }
+};
+
+// swap
+template <class Key, class T, class Hash, class KeyEqual, class Allocator>
+inline void swap(vector_map<Key, T, Hash, KeyEqual, Allocator>& lhs, vector_map<Key, T, Hash, KeyEqual, Allocator>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+} // namespace esl
+
+namespace std {
+
+// hash<esl::vector_map>
+// Independent of the order of entries, as operator==
+template <class Key, class T, class Hash, class KeyEqual, class Allocator>
+struct hash<::esl::vector_map<Key, T, Hash, KeyEqual, Allocator>> {
+    std::size_t operator()(const ::esl::vector_map<Key, T, Hash, KeyEqual, Allocator>& m) const {
+        std::size_t h = 0;
+        for (const auto& kv : m) {
+            h += ::esl::hash_value(kv.second, Hash{}(kv.first));
+        }
+        return h;
+    }
+};
+
+} // namespace std
+
+#endif // ESL_VECTOR_MAP_HPP
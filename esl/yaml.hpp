@@ -56,6 +56,8 @@ using node_base = flex_variant<null_t, bool_t, int_t, float_t, str, seq, map>;
 
 class node : public node_base {
 public:
+    using allocator_type = std::allocator<char>;
+
     using node_base::node_base;
 
     // TODO universal type deduction guide
@@ -1,6 +1,13 @@
 
 #include <gtest/gtest.h>
 #include <esl/base64.hpp>
+#include <esl/intrin.hpp>
+#include "cpu_test_util.hpp"
+
+#include <cstring>
+#include <sstream>
+#include <utility>
+#include <vector>
 
 TEST(Base64Test, encode) {
 	// no pads
@@ -146,3 +153,339 @@ TEST(Base64Test, decode) {
 
 }
 
+
+namespace {
+
+// Runs f with vectorized kernels turned off one level at a time, the last run is scalar only
+template <class F>
+void for_each_cpu_level(F&& f) {
+	esl_tests::for_each_cpu_level({{&esl::cpu_features::avx512vbmi}, {&esl::cpu_features::avx2}, {&esl::cpu_features::sse41, &esl::cpu_features::ssse3}}, std::forward<F>(f));
+}
+
+std::string make_bytes(std::size_t n) {
+	std::string s(n, '\0');
+	std::uint32_t x = 0x12345678;
+	for (auto& c : s) {
+		x = x * 1103515245 + 12345;
+		c = static_cast<char>(x >> 24);
+	}
+	return s;
+}
+
+} // namespace
+
+TEST(Base64Test, encode_simd) {
+	const esl::base64_option custom("ZYXWVUTSRQPONMLKJIHGFEDCBAzyxwvutsrqponmlkjihgfedcba9876543210!~");
+	for (const auto* option : {&esl::base64_std, &esl::base64_std_npad, &esl::base64_urlsafe, &custom}) {
+		for (std::size_t n : {0, 1, 2, 3, 11, 12, 15, 16, 27, 28, 47, 48, 63, 64, 65, 100, 1000, 4099}) {
+			const auto bytes = make_bytes(n);
+			std::vector<std::string> encoded;
+			for_each_cpu_level([&] {
+				encoded.push_back(esl::base64_encode(bytes.data(), bytes.size(), *option));
+			});
+			for (auto& e : encoded) {
+				ASSERT_EQ(e, encoded.back());
+			}
+			ASSERT_EQ(esl::base64_decode(encoded.back().data(), encoded.back().size(), *option), bytes);
+		}
+	}
+	ASSERT_EQ(esl::base64_encode("\xfb\xff\xbf\xfb\xff\xbf\xfb\xff\xbf\xfb\xff\xbf\xfb\xff\xbf\xfb\xff\xbf", 18, esl::base64_urlsafe),
+			"-_-_-_-_-_-_-_-_-_-_-_-_");
+}
+
+TEST(Base64Test, decode_simd) {
+	for (const auto* option : {&esl::base64_std, &esl::base64_std_npad, &esl::base64_urlsafe}) {
+		for (std::size_t n : {0, 1, 2, 3, 11, 12, 17, 18, 24, 31, 32, 33, 34, 48, 100, 1000, 4099}) {
+			const auto bytes = make_bytes(n);
+			const auto encoded = esl::base64_encode(bytes.data(), bytes.size(), *option);
+			for_each_cpu_level([&] {
+				ASSERT_EQ(esl::base64_decode(encoded.data(), encoded.size(), *option), bytes);
+			});
+			// Stores stay within the exact decoded size
+			for_each_cpu_level([&] {
+				std::string out(bytes.size() + 1, '#');
+				ASSERT_EQ(esl::base64_decode(encoded.data(), encoded.size(), out.data(), *option), bytes.size());
+				ASSERT_EQ(out.back(), '#');
+			});
+			// Invalid or padding character at every position
+			for (std::size_t pos = 0; pos < std::min<std::size_t>(encoded.size(), 80); ++pos) {
+				for (char bad : {'=', '?', '\n', '\x80', '\xff'}) {
+					auto text = encoded;
+					text[pos] = bad;
+					std::vector<std::pair<std::string, std::size_t>> results;
+					for_each_cpu_level([&] {
+						results.push_back(esl::base64_try_decode(text.data(), text.size(), *option));
+					});
+					for (auto& r : results) {
+						ASSERT_EQ(r, results.back());
+					}
+				}
+			}
+		}
+	}
+	// Concatenated with padding in the middle
+	{
+		const auto a = make_bytes(100);
+		const auto b = make_bytes(200);
+		const auto text = esl::base64_encode(a.data(), a.size()) + esl::base64_encode(b.data(), b.size());
+		for_each_cpu_level([&] {
+			ASSERT_EQ(esl::base64_decode(text.data(), text.size()), a + b);
+		});
+	}
+}
+
+TEST(Base64Test, encoder_decoder) {
+	const auto bytes = make_bytes(1000);
+	const auto encoded = esl::base64_encode(bytes.data(), bytes.size());
+	for (std::size_t step : {1, 2, 3, 5, 7, 64, 333}) {
+		std::string e(esl::base64_encode_size(bytes.size(), true), '\0');
+		esl::base64_encoder encoder;
+		std::size_t en = 0;
+		for (std::size_t i = 0; i < bytes.size(); i += step) {
+			const auto n = std::min(step, bytes.size() - i);
+			ASSERT_LE(encoder.update_size(n), e.size() - en);
+			en += encoder.update(esl::make_span(bytes.data() + i, n), e.data() + en);
+		}
+		en += encoder.finish(e.data() + en);
+		ASSERT_EQ(en, e.size());
+		ASSERT_EQ(e, encoded);
+
+		std::string d(esl::base64_decode_max_size(encoded.size()), '\0');
+		esl::base64_decoder decoder;
+		std::size_t dn = 0;
+		for (std::size_t i = 0; i < encoded.size(); i += step) {
+			const auto n = std::min(step, encoded.size() - i);
+			ASSERT_LE(decoder.update_size(n), d.size() - dn);
+			dn += decoder.update(encoded.data() + i, n, d.data() + dn);
+			ASSERT_EQ(decoder.position(), i + n);
+		}
+		dn += decoder.finish(d.data() + dn);
+		d.resize(dn);
+		ASSERT_EQ(d, bytes);
+	}
+
+	// Padding in the middle, no padding at the end
+	{
+		std::string_view sv("MDEyMzQ1Njc4OQ==MDEyMzQ1Njc=MDEyMzQ1Njc4OQ");
+		char out[64];
+		esl::base64_decoder decoder;
+		std::size_t n = 0;
+		for (char c : sv) {
+			n += decoder.update(&c, 1, out + n);
+		}
+		n += decoder.finish(out + n);
+		ASSERT_EQ(std::string_view(out, n), "0123456789012345670123456789");
+	}
+
+	// Absolute error position
+	{
+		auto text = encoded;
+		text[901] = '?';
+		const auto [d, pos] = esl::base64_try_decode(text.data(), text.size());
+		ASSERT_EQ(pos, 901);
+		std::string out(bytes.size(), '\0');
+		esl::base64_decoder decoder;
+		std::size_t n = 0;
+		try {
+			for (std::size_t i = 0; i < text.size(); i += 7) {
+				n += decoder.update(text.data() + i, std::min<std::size_t>(7, text.size() - i), out.data() + n);
+			}
+			FAIL();
+		} catch (const esl::base64_decode_error& e) {
+			ASSERT_EQ(e.position(), 901);
+		}
+	}
+	{
+		std::string_view sv("MDEyMzQ1Njc4O");
+		char out[16];
+		esl::base64_decoder decoder;
+		auto n = decoder.update(sv.data(), sv.size(), out);
+		ASSERT_EQ(n, 9);
+		try {
+			decoder.finish(out + n);
+			FAIL();
+		} catch (const esl::base64_decode_error& e) {
+			ASSERT_EQ(e.position(), sv.size() + 1);
+		}
+	}
+
+	// ostream
+	{
+		std::ostringstream os;
+		esl::base64_decode(os, encoded.data(), encoded.size());
+		ASSERT_EQ(os.str(), bytes);
+	}
+}
+
+TEST(Base64Test, decode_skip_whitespace) {
+	// MIME, 76 characters per line
+	{
+		const auto bytes = make_bytes(5000);
+		const auto encoded = esl::base64_encode(bytes.data(), bytes.size());
+		std::string mime;
+		for (std::size_t i = 0; i < encoded.size(); i += 76) {
+			mime.append(encoded, i, 76).append("\r\n");
+		}
+		for_each_cpu_level([&] {
+			ASSERT_EQ(esl::base64_decode(mime.data(), mime.size(), esl::base64_mime), bytes);
+		});
+		ASSERT_THROW(esl::base64_decode(mime.data(), mime.size()), esl::base64_decode_error);
+
+		for (std::size_t step : {1, 3, 4, 77, 1000}) {
+			std::string d(esl::base64_decode_max_size(mime.size()), '\0');
+			esl::base64_decoder decoder(esl::base64_mime);
+			std::size_t n = 0;
+			for (std::size_t i = 0; i < mime.size(); i += step) {
+				n += decoder.update(mime.data() + i, std::min(step, mime.size() - i), d.data() + n);
+			}
+			n += decoder.finish(d.data() + n);
+			d.resize(n);
+			ASSERT_EQ(d, bytes);
+		}
+	}
+
+	// Same as decoding without whitespace, with positions in the original input
+	{
+		const char* const text = " MDEy\tMzQ1\nNjc4OQ==\r\n MDEyMzQ1Njc=MDEy MzQ1 Njc4 OQ \n";
+		ASSERT_EQ(esl::base64_decode(text, std::strlen(text), esl::base64_mime), "0123456789012345670123456789");
+
+		const char* const bad = "MDEy\r\nMz?1";
+		const auto [d, pos] = esl::base64_try_decode(bad, std::strlen(bad), esl::base64_mime);
+		ASSERT_EQ(d, "0123");
+		ASSERT_EQ(pos, 8);
+
+		const char* const incomplete = "MDEy\nM \n";
+		const auto [d2, pos2] = esl::base64_try_decode(incomplete, std::strlen(incomplete), esl::base64_mime);
+		ASSERT_EQ(d2, "012");
+		ASSERT_EQ(pos2, std::strlen(incomplete) + 1);
+	}
+	{
+		const auto bytes = make_bytes(3000);
+		const auto encoded = esl::base64_encode(bytes.data(), bytes.size());
+		std::string text;
+		std::vector<std::size_t> raw_pos;
+		std::uint32_t x = 1;
+		for (char c : encoded) {
+			x = x * 1103515245 + 12345;
+			if ((x >> 16) % 7 == 0) {
+				text.append((x >> 20) % 40, " \t\r\n"[(x >> 8) % 4]);
+			}
+			raw_pos.push_back(text.size());
+			text.push_back(c);
+		}
+		ASSERT_EQ(esl::base64_decode(text.data(), text.size(), esl::base64_mime), bytes);
+		for (std::size_t i : {0, 1, 2, 3, 5, 100, 1000, 1500, 3999}) {
+			auto bad = encoded;
+			bad[i] = '*';
+			auto bad_text = text;
+			bad_text[raw_pos[i]] = '*';
+			const auto expected = esl::base64_try_decode(bad.data(), bad.size());
+			for_each_cpu_level([&] {
+				const auto r = esl::base64_try_decode(bad_text.data(), bad_text.size(), esl::base64_mime);
+				ASSERT_EQ(r.first, expected.first);
+				ASSERT_EQ(r.second, raw_pos[i]);
+			});
+			esl::base64_decoder decoder(esl::base64_mime);
+			std::string out(bytes.size(), '\0');
+			std::size_t n = 0;
+			try {
+				for (std::size_t j = 0; j < bad_text.size(); j += 13) {
+					n += decoder.update(bad_text.data() + j, std::min<std::size_t>(13, bad_text.size() - j), out.data() + n);
+				}
+				decoder.finish(out.data() + n);
+				FAIL();
+			} catch (const esl::base64_decode_error& e) {
+				ASSERT_EQ(e.position(), raw_pos[i]);
+			}
+		}
+	}
+}
+
+namespace {
+
+// Runs jobs in order on the calling thread
+struct serial_executor {
+	std::size_t concurrency_;
+	std::size_t jobs = 0;
+
+	std::size_t concurrency() const noexcept {
+		return concurrency_;
+	}
+
+	template <class F>
+	void bulk(std::size_t n, F f) {
+		for (std::size_t i = 0; i < n; ++i) {
+			f(i);
+		}
+		jobs += n;
+	}
+};
+
+} // namespace
+
+TEST(Base64Test, parallel) {
+	const std::size_t size = 4 * esl::base64_parallel_min_slice + 1;
+	const auto bytes = make_bytes(size);
+	for (const auto* option : {&esl::base64_std, &esl::base64_std_npad}) {
+		const auto encoded = esl::base64_encode(bytes.data(), bytes.size(), *option);
+		{
+			std::string e(encoded.size(), '\0');
+			serial_executor executor{4};
+			ASSERT_EQ(esl::base64_encode(bytes.data(), bytes.size(), e.data(), *option, executor), e.size());
+			ASSERT_EQ(executor.jobs, 4u);
+			ASSERT_EQ(e, encoded);
+		}
+		{
+			std::string e(encoded.size(), '\0');
+			ASSERT_EQ(esl::base64_encode(bytes.data(), bytes.size(), e.data(), *option, esl::thread_executor(3)), e.size());
+			ASSERT_EQ(e, encoded);
+		}
+		{
+			std::string d(esl::base64_decode_max_size(encoded.size()), '\0');
+			d.resize(esl::base64_decode(encoded.data(), encoded.size(), d.data(), *option, esl::thread_executor(4)));
+			ASSERT_EQ(d, bytes);
+		}
+	}
+	// Errors in several slices, the lowest is reported as the sequential one
+	const auto encoded = esl::base64_encode(bytes.data(), bytes.size());
+	const std::size_t slice = (encoded.size() + 3) / 4 / 4 * 4 + 4;
+	for (std::size_t pos : {std::size_t{0}, slice - 1, slice, slice + 2, 3 * slice + 1, encoded.size() - 1}) {
+		auto text = encoded;
+		text[pos] = '?';
+		text[text.size() - 2] = '?';
+		std::string d(esl::base64_decode_max_size(text.size()), '\0');
+		serial_executor executor{4};
+		const auto r = esl::base64_try_decode(text.data(), text.size(), d.data(), esl::base64_std, executor);
+		ASSERT_EQ(executor.jobs, 4u);
+		const auto expected = esl::base64_try_decode(text.data(), text.size());
+		ASSERT_EQ(r.second, expected.second);
+		ASSERT_EQ(d.substr(0, r.first), expected.first);
+		try {
+			esl::base64_decode(text.data(), text.size(), d.data(), esl::base64_std, esl::thread_executor(4));
+			FAIL();
+		} catch (const esl::base64_decode_error& e) {
+			ASSERT_EQ(e.position(), expected.second);
+		}
+	}
+	// Concatenated with padding in the middle of slices
+	{
+		std::string text;
+		std::string expected;
+		for (std::size_t n = 1; text.size() < 4 * esl::base64_parallel_min_slice; n = n * 7 % 100003) {
+			const auto part = make_bytes(n);
+			text += esl::base64_encode(part.data(), part.size());
+			expected += part;
+		}
+		std::string d(esl::base64_decode_max_size(text.size()), '\0');
+		d.resize(esl::base64_decode(text.data(), text.size(), d.data(), esl::base64_std, esl::thread_executor(4)));
+		ASSERT_EQ(d, expected);
+	}
+	// Small input is decoded in place
+	{
+		serial_executor executor{4};
+		std::string d(3, '\0');
+		ASSERT_EQ(esl::base64_decode("MDEy", 4, d.data(), esl::base64_std, executor), 3u);
+		ASSERT_EQ(executor.jobs, 0u);
+		ASSERT_EQ(d, "012");
+	}
+}
@@ -0,0 +1,197 @@
+#include <gtest/gtest.h>
+#include <esl/cbor.hpp>
+#include "codec_test_util.hpp"
+
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace cbor = esl::cbor;
+namespace json = esl::json;
+namespace yaml = esl::yaml;
+
+namespace {
+
+struct cbor_codec {
+	using option_type = cbor::encode_option;
+	using decode_error = cbor::decode_error;
+
+	template <class Value>
+	static std::vector<unsigned char> encode(const Value& v, const option_type& option) {
+		return cbor::encode(v, option);
+	}
+	template <class Value>
+	static std::size_t encoded_size(const Value& v, const option_type& option) {
+		return cbor::encoded_size(v, option);
+	}
+	template <class Value>
+	static Value decode(const unsigned char* data, std::size_t size) {
+		return cbor::decode<Value>(data, size);
+	}
+};
+
+using codec = esl_tests::codec_test<cbor_codec>;
+using esl_tests::from_hex;
+
+} // namespace
+
+// Examples of RFC 8949 appendix A
+TEST(CborTest, encode) {
+	const std::pair<std::int64_t, const char*> integers[] = {{0, "00"}, {1, "01"}, {10, "0a"}, {23, "17"}, {24, "1818"}, {100, "1864"},
+		{1000, "1903e8"}, {1000000, "1a000f4240"}, {1000000000000, "1b000000e8d4a51000"}, {-1, "20"}, {-10, "29"}, {-100, "3863"},
+		{-1000, "3903e7"}};
+	for (const auto& [d, hex] : integers) {
+		ASSERT_EQ(codec::to_hex(json::value(d)), hex) << d;
+		ASSERT_EQ(codec::to_hex(yaml::node(d)), hex) << d;
+	}
+	ASSERT_EQ(codec::to_hex(yaml::node(std::numeric_limits<yaml::int_t>::min())), "3b7fffffffffffffff");
+	ASSERT_EQ(codec::to_hex(json::value(std::numeric_limits<json::unsigned_integer>::max())), "1bffffffffffffffff");
+
+	const std::pair<double, const char*> floats[] = {{0.0, "f90000"}, {-0.0, "f98000"}, {1.0, "f93c00"}, {1.1, "fb3ff199999999999a"},
+		{1.5, "f93e00"}, {65504.0, "f97bff"}, {100000.0, "fa47c35000"}, {3.4028234663852886e+38, "fa7f7fffff"},
+		{1.0e+300, "fb7e37e43c8800759c"}, {5.960464477539063e-8, "f90001"}, {0.00006103515625, "f90400"}, {-4.0, "f9c400"},
+		{-4.1, "fbc010666666666666"}, {std::numeric_limits<double>::infinity(), "f97c00"},
+		{std::numeric_limits<double>::quiet_NaN(), "f97e00"}, {-std::numeric_limits<double>::infinity(), "f9fc00"}};
+	for (const auto& [d, hex] : floats) {
+		ASSERT_EQ(codec::to_hex(json::value(d)), hex) << d;
+		ASSERT_EQ(codec::to_hex(yaml::node(d)), hex) << d;
+	}
+
+	ASSERT_EQ(codec::to_hex(json::value(false)), "f4");
+	ASSERT_EQ(codec::to_hex(json::value(true)), "f5");
+	ASSERT_EQ(codec::to_hex(json::value()), "f6");
+	ASSERT_EQ(codec::to_hex(json::value(json::string(""))), "60");
+	ASSERT_EQ(codec::to_hex(json::value(json::string("a"))), "6161");
+	ASSERT_EQ(codec::to_hex(json::value(json::string("IETF"))), "6449455446");
+	ASSERT_EQ(codec::to_hex(json::value(json::string("ü"))), "62c3bc");
+	ASSERT_EQ(codec::to_hex(json::parse("[]")), "80");
+	ASSERT_EQ(codec::to_hex(json::parse("[1, 2, 3]")), "83010203");
+	ASSERT_EQ(codec::to_hex(json::parse("[1, [2, 3], [4, 5]]")), "8301820203820405");
+	ASSERT_EQ(codec::to_hex(json::parse("{}")), "a0");
+	ASSERT_EQ(codec::to_hex(json::ordered::parse(R"({"a": 1, "b": [2, 3]})")), "a26161016162820203");
+	ASSERT_EQ(codec::to_hex(json::value(std::string(24, 'x'))).substr(0, 4), "7818");
+	ASSERT_EQ(codec::to_hex(json::value(std::string(256, 'x'))).substr(0, 6), "790100");
+
+	yaml::map m;
+	m["k"] = yaml::node(yaml::seq{yaml::node(std::int64_t(1)), yaml::node(yaml::str("v"))});
+	ASSERT_EQ(codec::to_hex(yaml::node(m)), "a1616b82016176");
+}
+
+TEST(CborTest, decode) {
+	ASSERT_EQ(codec::decode_hex("1b000000e8d4a51000"), json::value(json::integer(1000000000000)));
+	ASSERT_EQ(codec::decode_hex("3903e7"), json::value(json::integer(-1000)));
+	ASSERT_EQ(codec::decode_hex("1bffffffffffffffff"), json::value(std::numeric_limits<json::unsigned_integer>::max()));
+	ASSERT_EQ(codec::decode_hex("3bffffffffffffffff"), json::value(-18446744073709551616.0));
+	ASSERT_EQ(codec::decode_hex("f97bff"), json::value(65504.0));
+	ASSERT_EQ(codec::decode_hex("f90001"), json::value(5.960464477539063e-8));
+	ASSERT_EQ(codec::decode_hex("fa7f7fffff"), json::value(3.4028234663852886e+38));
+	ASSERT_EQ(codec::decode_hex("fbc010666666666666"), json::value(-4.1));
+	ASSERT_TRUE(std::isnan(std::get<json::number>(codec::decode_hex("f97e00"))));
+	ASSERT_EQ(codec::decode_hex("f7"), json::value());
+	ASSERT_EQ(codec::decode_hex("62c3bc"), json::value(json::string("ü")));
+	ASSERT_EQ(codec::decode_hex("4401020304"), json::value(json::string("\x01\x02\x03\x04")));
+	// Indefinite lengths
+	ASSERT_EQ(codec::decode_hex("5f42010243030405ff"), json::value(json::string("\x01\x02\x03\x04\x05")));
+	ASSERT_EQ(codec::decode_hex("7f657374726561646d696e67ff"), json::value(json::string("streaming")));
+	ASSERT_EQ(codec::decode_hex("9fff"), json::parse("[]"));
+	ASSERT_EQ(codec::decode_hex("9f018202039f0405ffff"), json::parse("[1, [2, 3], [4, 5]]"));
+	ASSERT_EQ(codec::decode_hex("bf61610161629f0203ffff"), json::parse(R"({"a": 1, "b": [2, 3]})"));
+	// Tags are dropped
+	ASSERT_EQ(codec::decode_hex("c074323031332d30332d32315432303a30343a30305a"), json::value(json::string("2013-03-21T20:04:00Z")));
+
+	// Integers and floats are kept apart in yaml nodes
+	const auto n = codec::decode_hex<yaml::node>("a2616101616282f93e0003");
+	ASSERT_EQ(std::get<yaml::int_t>(std::get<yaml::map>(n).at("a")), 1);
+	const auto& b = std::get<yaml::seq>(std::get<yaml::map>(n).at("b"));
+	ASSERT_EQ(std::get<yaml::float_t>(b[0]), 1.5);
+	ASSERT_EQ(std::get<yaml::int_t>(b[1]), 3);
+	// yaml nodes have no unsigned integers, those above the int64 range are floats
+	ASSERT_EQ(std::get<yaml::float_t>(codec::decode_hex<yaml::node>("1bffffffffffffffff")), 18446744073709551615.0);
+
+	// Strings and keys are views of the input
+	struct recorder {
+		const unsigned char* first;
+		const unsigned char* last;
+		std::size_t views = 0;
+		void view(std::string_view s) {
+			views += reinterpret_cast<const unsigned char*>(s.data()) >= first && reinterpret_cast<const unsigned char*>(s.data()) < last;
+		}
+		void null() {}
+		void boolean(bool) {}
+		void integer(std::int64_t) {}
+		void number(double) {}
+		void string(std::string_view s) {
+			this->view(s);
+		}
+		void key(std::string_view s) {
+			this->view(s);
+		}
+		void begin_object() {}
+		void end_object(std::size_t) {}
+		void begin_array() {}
+		void end_array(std::size_t) {}
+	};
+	const auto bytes = from_hex("a2616161786162826179417a00");
+	recorder r{bytes.data(), bytes.data() + bytes.size()};
+	ASSERT_EQ(cbor::decode(bytes.data(), bytes.size(), r), bytes.size() - 1);
+	ASSERT_EQ(r.views, 5u);
+
+	ASSERT_EQ(codec::error_position(""), 0u);
+	ASSERT_EQ(codec::error_position("1901"), 0u);
+	ASSERT_EQ(codec::error_position("8301"), 0u);
+	ASSERT_EQ(codec::error_position("1c"), 0u);
+	ASSERT_EQ(codec::error_position("ff"), 0u);
+	ASSERT_EQ(codec::error_position("f0"), 0u);
+	ASSERT_EQ(codec::error_position("820102ff"), 3u);
+	ASSERT_EQ(codec::error_position("a10102"), 1u);
+	ASSERT_EQ(codec::error_position("5f6161ff"), 1u);
+	ASSERT_EQ(codec::error_position("9f01"), 0u);
+	std::string deep;
+	for (std::size_t i = 0; i <= json::max_depth; ++i) {
+		deep += "81";
+	}
+	ASSERT_EQ(codec::error_position(deep), json::max_depth);
+}
+
+// RFC 8746 typed arrays
+TEST(CborTest, typed_array) {
+	const auto numbers = json::parse("[1.5, -2.0, 1e300]");
+	const auto hex = codec::to_hex(numbers, {true});
+	ASSERT_EQ(hex.substr(0, 6), "d85658");
+	ASSERT_EQ(hex.size(), 2 * (3 + 1 + 24));
+	ASSERT_EQ(codec::decode_hex(hex), numbers);
+	ASSERT_EQ(codec::to_hex(json::parse(R"([1, "a"])"), {true}), "82016161");
+	ASSERT_EQ(codec::to_hex(json::parse("[-1, 1099511627776]"), {true}), "d84f50ffffffffffffffff0000000000010000");
+
+	yaml::node ints(yaml::seq{yaml::node(std::int64_t(-1)), yaml::node(std::int64_t(1) << 40)});
+	ASSERT_EQ(codec::to_hex(ints, {true}), "d84f50ffffffffffffffff0000000000010000");
+	ASSERT_EQ(codec::decode_hex<yaml::node>(codec::to_hex(ints, {true})), ints);
+
+	// uint16 big-endian, sint8, float16 little-endian, float32 big-endian
+	ASSERT_EQ(codec::decode_hex("d84144000101ff"), json::parse("[1, 511]"));
+	ASSERT_EQ(codec::decode_hex("d8484201ff"), json::parse("[1, -1]"));
+	ASSERT_EQ(codec::decode_hex("d85444003cc0c4"), json::parse("[1.0, -4.75]"));
+	ASSERT_EQ(codec::decode_hex("d851443fc00000"), json::parse("[1.5]"));
+	ASSERT_EQ(codec::error_position("d8504100"), 0u);
+	ASSERT_EQ(codec::error_position("d84c40"), 0u);
+}
+
+TEST(CborTest, roundtrip) {
+	const auto v = json::parse(R"({"id": 623347347958, "name": "user_0", "active": false, "score": 76.3774618976614,
+		"tags": ["alpha", "beta"], "bio": "", "address": {"city": "City 0", "geo": [-0.8216843234506257, -18.183216676054286]},
+		"nested": [[[[]]], {}], "n": null, "big": 1e20, "small": -1e-300, "max": 18446744073709551615})");
+	for (const bool typed : {false, true}) {
+		const auto bytes = cbor::encode(v, {typed});
+		ASSERT_EQ(cbor::decode<json::value>(bytes.data(), bytes.size()), v);
+		ASSERT_LT(bytes.size(), json::dump(v).size());
+	}
+
+	yaml::map m;
+	m["i"] = yaml::node(std::int64_t(3));
+	m["f"] = yaml::node(3.0);
+	m["s"] = yaml::node(yaml::seq{yaml::node(yaml::null), yaml::node(true), yaml::node(yaml::str("x"))});
+	const yaml::node n(m);
+	const auto bytes = cbor::encode(n);
+	ASSERT_EQ(cbor::decode<yaml::node>(bytes.data(), bytes.size()), n);
+}
@@ -0,0 +1,61 @@
+#ifndef ESL_TESTS_CODEC_TEST_UTIL_HPP
+#define ESL_TESTS_CODEC_TEST_UTIL_HPP
+
+#include <gtest/gtest.h>
+#include <esl/json.hpp>
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace esl_tests {
+
+// from_hex
+inline std::vector<unsigned char> from_hex(std::string_view hex) {
+	std::vector<unsigned char> bytes;
+	for (std::size_t i = 0; i + 1 < hex.size(); i += 2) {
+		bytes.push_back(static_cast<unsigned char>(std::stoi(std::string(hex.substr(i, 2)), nullptr, 16)));
+	}
+	return bytes;
+}
+
+// codec_test
+// Hex round trips of a binary codec, Codec provides:
+//   option_type, encode(value, option), encoded_size(value, option), decode<Value>(data, size), decode_error
+template <class Codec>
+struct codec_test {
+	// Also checks that encoded_size is exact
+	template <class Value>
+	static std::string to_hex(const Value& v, const typename Codec::option_type& option = {}) {
+		const auto bytes = Codec::encode(v, option);
+		EXPECT_EQ(bytes.size(), Codec::encoded_size(v, option));
+		std::string hex;
+		for (auto b : bytes) {
+			constexpr char digits[] = "0123456789abcdef";
+			hex += digits[b >> 4];
+			hex += digits[b & 0xF];
+		}
+		return hex;
+	}
+
+	template <class Value = esl::json::value>
+	static Value decode_hex(std::string_view hex) {
+		const auto bytes = from_hex(hex);
+		return Codec::template decode<Value>(bytes.data(), bytes.size());
+	}
+
+	// return: npos if decoded
+	static std::size_t error_position(std::string_view hex) {
+		try {
+			decode_hex(hex);
+		} catch (const typename Codec::decode_error& e) {
+			return e.position();
+		}
+		return std::string_view::npos;
+	}
+};
+
+} // namespace esl_tests
+
+#endif // ESL_TESTS_CODEC_TEST_UTIL_HPP
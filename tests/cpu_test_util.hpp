@@ -0,0 +1,63 @@
+#ifndef ESL_TESTS_CPU_TEST_UTIL_HPP
+#define ESL_TESTS_CPU_TEST_UTIL_HPP
+
+#include <gtest/gtest.h>
+#include <esl/intrin.hpp>
+
+#include <initializer_list>
+#include <type_traits>
+
+namespace esl_tests {
+
+// cpu_features_guard
+// Restores esl::current_cpu_features() when leaving the scope, also on early returns of failed assertions and exceptions
+class cpu_features_guard {
+private:
+	esl::cpu_features saved_;
+
+public:
+	cpu_features_guard() : saved_(esl::current_cpu_features()) {}
+	cpu_features_guard(const cpu_features_guard&) = delete;
+	cpu_features_guard& operator=(const cpu_features_guard&) = delete;
+	~cpu_features_guard() {
+		esl::current_cpu_features() = saved_;
+	}
+};
+
+// cpu_level
+// Features turned off together
+using cpu_level = std::initializer_list<bool esl::cpu_features::*>;
+
+// for_each_cpu_level
+// Runs f with all features, then once more after turning off each level in turn, levels accumulating, so the last run
+// uses the kernels below every level. f may take the run number, 0 with all features.
+// Stops at the first fatal failure
+template <class F>
+void for_each_cpu_level(std::initializer_list<cpu_level> levels, F&& f) {
+	const cpu_features_guard guard;
+	auto& features = esl::current_cpu_features();
+	int run = 0;
+	const auto call = [&] {
+		if constexpr (std::is_invocable_v<F&, int>) {
+			f(run++);
+		} else {
+			f();
+		}
+		return !::testing::Test::HasFatalFailure();
+	};
+	if (!call()) {
+		return;
+	}
+	for (const auto& level : levels) {
+		for (const auto flag : level) {
+			features.*flag = false;
+		}
+		if (!call()) {
+			return;
+		}
+	}
+}
+
+} // namespace esl_tests
+
+#endif // ESL_TESTS_CPU_TEST_UTIL_HPP
@@ -1,6 +1,9 @@
 
 #include <gtest/gtest.h>
 #include <esl/flex_variant.hpp>
+#include <esl/flex_variant_pmr.hpp>
+#include "memory_test_util.hpp"
+#include <memory_resource>
 #include <string>
 
 TEST(FlexVariantTest, default_construct) {
@@ -135,3 +138,62 @@ TEST(FlexVariantTest, comp) {
 	ASSERT_GE(va4, va1);
 }
 
+TEST(FlexVariantTest, allocator) {
+	// std::pmr::string does not fit in place, its block is allocated with new, its buffer from the resource
+	using va_type = esl::flex_variant<int, std::pmr::string>;
+	const std::pmr::string text(100, 'x');
+	esl_tests::counting_resource r1, r2;
+	{
+		va_type v(std::allocator_arg, std::pmr::polymorphic_allocator<char>(&r1), std::in_place_type<std::pmr::string>, text);
+		ASSERT_EQ(std::get<std::pmr::string>(v), text);
+		ASSERT_EQ(std::get<std::pmr::string>(v).get_allocator().resource(), &r1);
+		ASSERT_EQ(r1.allocated, 1);
+
+		// Not adopted: polymorphic allocators are not always equal
+		va_type other(std::allocator_arg, std::pmr::polymorphic_allocator<char>(&r2), std::move(v));
+		ASSERT_TRUE(v.valueless_by_exception());
+		ASSERT_EQ(std::get<std::pmr::string>(other), text);
+		ASSERT_EQ(std::get<std::pmr::string>(other).get_allocator().resource(), &r2);
+		ASSERT_EQ(r1.outstanding, 0);
+		ASSERT_EQ(r2.allocated, 1);
+
+		va_type copy(std::allocator_arg, std::pmr::polymorphic_allocator<char>(&r1), other);
+		ASSERT_EQ(copy, other);
+		ASSERT_EQ(r1.outstanding, 1);
+	}
+	ASSERT_EQ(r1.outstanding, 0);
+	ASSERT_EQ(r2.outstanding, 0);
+}
+
+TEST(FlexVariantTest, pmr_allocator) {
+	// std::pmr::string does not fit in place, its block and buffer are both allocated from the resource
+	using va_type = esl::pmr::flex_variant<int, std::pmr::string>;
+	const std::pmr::string text(100, 'x');
+	esl_tests::counting_resource r1, r2;
+	{
+		va_type v(std::allocator_arg, std::pmr::polymorphic_allocator<char>(&r1), std::in_place_type<std::pmr::string>, text);
+		ASSERT_EQ(std::get<std::pmr::string>(v), text);
+		ASSERT_EQ(std::get<std::pmr::string>(v).get_allocator().resource(), &r1);
+		ASSERT_EQ(r1.allocated, 2);
+
+		va_type same(std::allocator_arg, std::pmr::polymorphic_allocator<char>(&r1), std::move(v));
+		ASSERT_TRUE(v.valueless_by_exception());
+		ASSERT_EQ(r1.allocated, 2);
+
+		va_type other(std::allocator_arg, std::pmr::polymorphic_allocator<char>(&r2), std::move(same));
+		ASSERT_EQ(std::get<std::pmr::string>(other), text);
+		ASSERT_EQ(r1.outstanding, 0);
+		ASSERT_EQ(r2.allocated, 2);
+
+		va_type copy(std::allocator_arg, std::pmr::polymorphic_allocator<char>(&r1), other);
+		ASSERT_EQ(copy, other);
+		ASSERT_EQ(r1.outstanding, 2);
+
+		va_type n(std::allocator_arg, std::pmr::polymorphic_allocator<char>(&r1), 1);
+		ASSERT_EQ(std::get<int>(n), 1);
+		va_type d(std::allocator_arg, std::allocator<char>(), std::in_place_index<1>, "abc");
+		ASSERT_EQ(std::get<1>(d), "abc");
+	}
+	ASSERT_EQ(r1.outstanding, 0);
+	ASSERT_EQ(r2.outstanding, 0);
+}
@@ -1,6 +1,38 @@
 
 #include <gtest/gtest.h>
 #include <esl/functional.hpp>
+#include <esl/intrin.hpp>
+#include "cpu_test_util.hpp"
+
+#include <algorithm>
+#include <array>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace {
+
+template <class F>
+void for_each_cpu_level(F&& f) {
+	esl_tests::for_each_cpu_level({{&esl::cpu_features::pclmul, &esl::cpu_features::sse42}}, std::forward<F>(f));
+}
+
+// Runs jobs in reverse order on the calling thread
+struct serial_executor {
+	std::size_t concurrency() const noexcept {
+		return 4;
+	}
+
+	template <class F>
+	void bulk(std::size_t n, F f) const {
+		for (std::size_t i = n; i-- != 0;) {
+			f(i);
+		}
+	}
+};
+
+} // namespace
 
 TEST(FuntionalTest, hash_value) {
 	{
@@ -11,6 +43,14 @@ TEST(FuntionalTest, hash_value) {
 		int a[100];
 		ASSERT_NE(esl::stdhash(a, sizeof(a)), 0);
 	}
+	{
+		const std::string_view s = "hello";
+#ifdef ESL_USE_FAST_HASH
+		ASSERT_EQ(esl::stdhash(s.data(), s.size()), static_cast<std::size_t>(esl::fast_hash(s.data(), s.size())));
+#else
+		ASSERT_EQ(esl::stdhash(s.data(), s.size()), std::hash<std::string_view>{}(s));
+#endif
+	}
 }
 
 TEST(FuntionalTest, hash_combine) {
@@ -62,12 +102,89 @@ TEST(FuntionalTest, hash_tuple) {
 	}
 }
 
+TEST(FuntionalTest, hash_contiguous) {
+	std::vector<int> vec(1000);
+	for (std::size_t i = 0; i < vec.size(); ++i) {
+		vec[i] = static_cast<int>(i * 7);
+	}
+	const auto h = esl::hash_value(vec);
+	ASSERT_EQ(h, static_cast<std::size_t>(esl::fast_hash(vec.data(), vec.size() * sizeof(int))));
+	ASSERT_EQ(h, esl::hash_value(std::vector<int>(vec)));
+	ASSERT_EQ(h, esl::hash_value(esl::span<const int>(vec.data(), vec.size())));
+	vec[500] = -1;
+	ASSERT_NE(h, esl::hash_value(vec));
+
+	std::array<std::uint8_t, 4> arr{1, 2, 3, 4};
+	ASSERT_EQ(esl::hash_value(arr), esl::hash_value(std::vector<std::uint8_t>{1, 2, 3, 4}));
+	ASSERT_EQ(esl::hash_value(arr), esl::hash_value(esl::span<std::uint8_t, 4>(arr.data())));
+	ASSERT_EQ(esl::hash_value(std::vector<std::array<std::uint8_t, 4>>{arr}), esl::hash_value(arr));
+
+	// Element by element: +0.0 == -0.0 with different bytes
+	ASSERT_EQ(esl::hash_value(std::vector<double>{0.0, 1.0}), esl::hash_value(std::vector<double>{-0.0, 1.0}));
+	ASSERT_EQ(esl::hash_value(std::vector<std::string>{"a", "b"}), esl::hash_value(std::array<std::string, 2>{"a", "b"}));
+	ASSERT_NE(esl::hash_value(std::vector<std::string>{"a", "b"}), esl::hash_value(std::vector<std::string>{"b", "a"}));
+}
+
 TEST(FuntionalTest, crc32) {
 	ASSERT_EQ(esl::crc32("", 0), 0U);
 	ASSERT_EQ(esl::crc32("0", 1), 4108050209U);
 	ASSERT_EQ(esl::crc32("0123456789", 10), 2793719750U);
 	ASSERT_EQ(esl::crc32("ABCDEFGH", 8), 1759295004U);
 	ASSERT_EQ(esl::crc32("0123456789ABCDEFGH", 18), esl::crc32("ABCDEFGH", 8, 2793719750U));
+	static_assert(esl::crc32_bytewise("0123456789", 10) == 2793719750U);
+
+	std::string data(5000, '\0');
+	for (std::size_t i = 0; i < data.size(); ++i) {
+		data[i] = static_cast<char>(i * 131 + (i >> 7));
+	}
+	for (std::size_t n : {0, 1, 15, 16, 17, 63, 64, 65, 80, 127, 128, 200, 1000, 5000}) {
+		for (std::size_t offset : {0, 3}) {
+			const auto len = std::min(n, data.size() - offset);
+			const auto expected = esl::crc32_bytewise(data.data() + offset, len, 0x12345678U);
+			for_each_cpu_level([&] {
+				ASSERT_EQ(esl::crc32(data.data() + offset, len, 0x12345678U), expected);
+			});
+		}
+	}
+}
+
+TEST(FuntionalTest, crc32c) {
+	ASSERT_EQ(esl::crc32c("", 0), 0U);
+	ASSERT_EQ(esl::crc32c("123456789", 9), 0xE3069283U);
+	ASSERT_EQ(esl::crc32c("123456789", 9), esl::crc32c("56789", 5, esl::crc32c("1234", 4)));
+
+	std::string data(20000, '\0');
+	for (std::size_t i = 0; i < data.size(); ++i) {
+		data[i] = static_cast<char>(i * 131 + (i >> 7));
+	}
+	for (std::size_t n : {0, 1, 7, 8, 9, 100, 767, 768, 769, 1000, 6143, 6144, 6145, 20000}) {
+		std::vector<std::uint32_t> results;
+		for_each_cpu_level([&] {
+			results.push_back(esl::crc32c(data.data(), n, 0x12345678U));
+		});
+		for (auto r : results) {
+			ASSERT_EQ(r, results.back());
+		}
+	}
+}
+
+TEST(FuntionalTest, crc32_combine) {
+	ASSERT_EQ(esl::crc32_combine(esl::crc32("0123", 4), esl::crc32("456789", 6), 6), esl::crc32("0123456789", 10));
+	ASSERT_EQ(esl::crc32c_combine(esl::crc32c("0123", 4), esl::crc32c("456789", 6), 6), esl::crc32c("0123456789", 10));
+	ASSERT_EQ(esl::crc32_combine(esl::crc32("0123", 4), 0, 0), esl::crc32("0123", 4));
+	static_assert(esl::crc32_combine(esl::crc32_bytewise("0", 1), esl::crc32_bytewise("123456789", 9), 9) == esl::crc32_bytewise("0123456789", 10));
+
+	std::vector<std::uint32_t> data(esl::crc32_parallel_min_segment + 5);
+	for (std::size_t i = 0; i < data.size(); ++i) {
+		data[i] = static_cast<std::uint32_t>(i * 2654435761U);
+	}
+	const auto len = data.size() * sizeof(std::uint32_t);
+	const auto s = esl::span<const std::uint32_t>(data.data(), data.size());
+	ASSERT_EQ(esl::crc32_parallel(s, serial_executor{}, 7), esl::crc32(data.data(), len, 7));
+	ASSERT_EQ(esl::crc32_parallel(s, esl::thread_executor(3)), esl::crc32(data.data(), len));
+	ASSERT_EQ(esl::crc32c_parallel(s, serial_executor{}, 7), esl::crc32c(data.data(), len, 7));
+	ASSERT_EQ(esl::crc32c_parallel(data.data(), len, esl::thread_executor(2)), esl::crc32c(data.data(), len));
+	ASSERT_EQ(esl::crc32_parallel("0123456789", 10, esl::thread_executor(4)), esl::crc32("0123456789", 10));
 }
 
 TEST(FuntionalTest, md5) {
@@ -77,3 +194,153 @@ TEST(FuntionalTest, md5) {
 	ASSERT_EQ(esl::md5val(esl::md5("456789", 6, s)).to_hex_string(), "781e5e245d69b566979b86e28d23f2c7");
 }
 
+
+TEST(FuntionalTest, md5_many) {
+	std::string data(5000, '\0');
+	for (std::size_t i = 0; i < data.size(); ++i) {
+		data[i] = static_cast<char>(i * 131 + (i >> 7));
+	}
+	const auto bytes = reinterpret_cast<const unsigned char*>(data.data());
+	std::vector<esl::span<const unsigned char>> messages;
+	for (std::size_t n = 0; n < 200; ++n) {
+		messages.emplace_back(bytes + n, n);
+	}
+	for (std::size_t n : {1000, 5000, 64, 0, 55, 56}) {
+		messages.emplace_back(bytes, n);
+	}
+	esl_tests::for_each_cpu_level({{&esl::cpu_features::avx512f}, {&esl::cpu_features::avx2}, {&esl::cpu_features::sse2}}, [&](int level) {
+		for (std::size_t count : {std::size_t{0}, std::size_t{1}, std::size_t{3}, messages.size()}) {
+			const auto vals = esl::md5_many({messages.data(), count});
+			ASSERT_EQ(vals.size(), count);
+			for (std::size_t i = 0; i < count; ++i) {
+				ASSERT_EQ(vals[i], esl::md5val(esl::md5(messages[i].data(), messages[i].size()))) << level << " " << i;
+			}
+		}
+	});
+}
+
+TEST(FuntionalTest, sha) {
+	ASSERT_EQ(esl::sha1val(esl::sha1("", 0)).to_hex_string(), "da39a3ee5e6b4b0d3255bfef95601890afd80709");
+	ASSERT_EQ(esl::sha256val(esl::sha256("", 0)).to_hex_string(), "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+	const std::string m = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+	auto s1 = esl::sha1("abc", 3);
+	ASSERT_EQ(esl::sha1val(s1).to_hex_string(), "a9993e364706816aba3e25717850c26c9cd0d89d");
+	ASSERT_EQ(esl::sha1val(esl::sha1(m.data() + 3, m.size() - 3, s1)).to_hex_string(), "84983e441c3bd26ebaae4aa1f95129e5e54670f1");
+	auto s256 = esl::sha256("abc", 3);
+	ASSERT_EQ(esl::sha256val(s256).to_hex_string(), "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+
+	struct expected {
+		std::size_t size;
+		const char* sha1;
+		const char* sha256;
+	};
+	static constexpr expected cases[] = {
+		{55, "336243d03df910f7914a14b13dd85f56c140660c", "5d05a4435b96f43e53e5a582bbb0b8d840a71c023e7468d6604d1c9ae6511c4c"},
+		{56, "f5cc93d5593579203ae8f3fc497baabf4fdfb417", "0851bc0b733318bd14db8098dec9a591c02ee1e72295d3ba54560e56342430fb"},
+		{64, "4360095a2eea45a13a83190aeb049821aee57f46", "949f78c7321c5fa8a90f3d236c471950df72d869abc1d36e985cfce9a3ac98b9"},
+		{119, "99d71c308a6c094af624067e6db56482f887356f", "f1ae96dacae36aee55d875c7d523334473a78b3e2381a3e7cc7fde2bef3f1938"},
+		{1000, "210e69a624094c14e953ce2a860c695eac7ffabd", "16808e380aa2627834b5e72f1fd536ec90dc77be33b814d8f1dae903f8ceaebd"},
+		{5000, "1c0bf5c9308c37cef5365fd26f736d20d80f8628", "b8beda883b7232b5a3806269416d45d2643d3c8477fd41535403a01bdb4ebf6c"},
+	};
+	std::string data(5000, '\0');
+	for (std::size_t i = 0; i < data.size(); ++i) {
+		data[i] = static_cast<char>(i * 131 + (i >> 7));
+	}
+	const auto bytes = reinterpret_cast<const unsigned char*>(data.data());
+	std::vector<esl::span<const unsigned char>> messages;
+	for (std::size_t n = 0; n < 200; ++n) {
+		messages.emplace_back(bytes + n, n);
+	}
+	for (const auto& c : cases) {
+		messages.emplace_back(bytes, c.size);
+	}
+	esl_tests::for_each_cpu_level({{&esl::cpu_features::avx512f}, {&esl::cpu_features::sha}, {&esl::cpu_features::avx2}}, [&](int level) {
+		for (const auto& c : cases) {
+			ASSERT_EQ(esl::sha1val(esl::sha1(data.data(), c.size)).to_hex_string(), c.sha1) << level << " " << c.size;
+			ASSERT_EQ(esl::sha256val(esl::sha256(data.data(), c.size)).to_hex_string(), c.sha256) << level << " " << c.size;
+			esl::sha1_state state1;
+			esl::sha256_state state256;
+			for (std::size_t i = 0; i < c.size; i += 100) {
+				state1.update(data.data() + i, std::min<std::size_t>(100, c.size - i));
+				state256.update(data.data() + i, std::min<std::size_t>(100, c.size - i));
+			}
+			ASSERT_EQ(esl::sha1val(state1).to_hex_string(), c.sha1) << level << " " << c.size;
+			ASSERT_EQ(esl::sha256val(state256).to_hex_string(), c.sha256) << level << " " << c.size;
+		}
+		const auto vals1 = esl::sha1_many({messages.data(), messages.size()});
+		const auto vals256 = esl::sha256_many({messages.data(), messages.size()});
+		ASSERT_EQ(vals1.size(), messages.size());
+		ASSERT_EQ(vals256.size(), messages.size());
+		for (std::size_t i = 0; i < messages.size(); ++i) {
+			ASSERT_EQ(vals1[i], esl::sha1val(esl::sha1(messages[i].data(), messages[i].size()))) << level << " " << i;
+			ASSERT_EQ(vals256[i], esl::sha256val(esl::sha256(messages[i].data(), messages[i].size()))) << level << " " << i;
+		}
+		for (std::size_t i = 0; i < std::size(cases); ++i) {
+			ASSERT_EQ(vals256[200 + i].to_hex_string(), cases[i].sha256) << level;
+		}
+	});
+}
+
+TEST(FuntionalTest, fast_hash) {
+	// Reference values of XXH3_64bits/XXH3_128bits, seeded with 0x0123456789ABCDEF
+	struct expected {
+		std::size_t size;
+		std::uint64_t h64;
+		std::uint64_t h64_seeded;
+		esl::fast_hash128val h128;
+		esl::fast_hash128val h128_seeded;
+	};
+	static constexpr expected cases[] = {
+		{0, 0x2d06800538d394c2U, 0xcc1ca35a1b089c5cU, {0x6001c324468d497fU, 0x99aa06d3014798d8U}, {0xaaa287af24a9bb3aU, 0xa4cb05dbbf09907aU}},
+		{1, 0xc44bdff4074eecdbU, 0xd5dd68911c7f195dU, {0xc44bdff4074eecdbU, 0xa6cd5e9392000f6aU}, {0xd5dd68911c7f195dU, 0xcfeda14808382ad3U}},
+		{3, 0x6811538b444fc6dcU, 0x343dbd4b9b572b8eU, {0x6811538b444fc6dcU, 0xc925ae1797c3998fU}, {0x343dbd4b9b572b8eU, 0x193503a403155d6eU}},
+		{4, 0xed503340c589a28bU, 0x27fc0e776c757324U, {0xdb9cecd5eb59a7f1U, 0x6ae518c60df23fcaU}, {0xfbe8d830506b5981U, 0x3f80888d302c1268U}},
+		{8, 0xe5b43ab074c9c13bU, 0x4f99ee67ff93e698U, {0x5b3f49d0f38f9d7dU, 0x63f350efc0ba3e2eU}, {0x7508e8ca422e05a4U, 0x78c8d91c8ee10db8U}},
+		{9, 0x089b8d25b20fb877U, 0xa703151b2543398eU, {0xd8a20b5b7aa68a37U, 0x83c871b1014e6f76U}, {0x0ec29767e91726f1U, 0x92d6740204901508U}},
+		{16, 0x0a0ec5ae8679cb7fU, 0x2eb982afb5716ba9U, {0xadebb1d9d080b69cU, 0x248181305d3c1039U}, {0x1c796abc52679c6cU, 0x580a0a9ea45c07e5U}},
+		{17, 0x57c52d21ce492c1eU, 0x0cd78a4269e05cfcU, {0xcfea252f6b7ed7e9U, 0x825a0db7d0afe2c0U}, {0x8e7e5a781b235de7U, 0x5da0d809da0bf3f8U}},
+		{33, 0xbc16fc6b42571f75U, 0x39d78e1f4d42858aU, {0x17580ff25b93b223U, 0xd1fad6434c06e9adU}, {0x884cb93cdf714f6aU, 0x9cffa662aff8e4fcU}},
+		{65, 0xdd1752f723801bbcU, 0x98feff39f93ad6e5U, {0x11609fe0d1f6230fU, 0x188e082b3b260ab5U}, {0x9f08e6e0b502fae0U, 0x64e0cc27dcfb8821U}},
+		{97, 0x0c5de55821283ddeU, 0xe4f8cb968b74091dU, {0xa408415b79ba85d8U, 0xf26536f5ef52d772U}, {0x4fe333c2cc2c1c80U, 0xa8a0f5960aab2f24U}},
+		{128, 0x696069c4f1e6a91aU, 0xb03707457c59dc50U, {0x5cfea347ea4bb687U, 0x08df79f520370b52U}, {0x183af6a355b5d876U, 0x38b126c4028fd973U}},
+		{129, 0x34dfc256c90565f6U, 0x315a24ac53d25196U, {0x75f3ef9c8cc6bf42U, 0xbff3391f3ae72593U}, {0x6612e4d3c7d19e93U, 0x9b0533abb7ddf786U}},
+		{160, 0xfc016c92e6b003e9U, 0x274320f4612fe16fU, {0x24225b6f649b237aU, 0xb945afb48590bd83U}, {0x7a69a726d932976cU, 0x904fa5cd82cb8868U}},
+		{200, 0xa326630d5b43ee51U, 0xd294aa66779d3abeU, {0x2a304d994da63783U, 0x0d31ac2f150b9bc3U}, {0x93d1bcb6f63e35e4U, 0x57996b3079cbe223U}},
+		{240, 0x64506894a1a6f809U, 0x64f0bffef0dd184eU, {0xd755c23217420e58U, 0xb6f7bd89b91e21afU}, {0x11ca5b29bdd61b9eU, 0x8442851ee586522dU}},
+		{241, 0x56a00f05e5bc379fU, 0x712e5ead03b4e16bU, {0x56a00f05e5bc379fU, 0xc6eff592faaef7bbU}, {0x712e5ead03b4e16bU, 0xeb9f7ce9902225e7U}},
+		{256, 0xb46e0a65b30ab9ecU, 0xb47d252533e790f0U, {0xb46e0a65b30ab9ecU, 0xca7c5221f2fa13b6U}, {0xb47d252533e790f0U, 0x39b8d32fc491a3b1U}},
+		{257, 0xf03bab8268616764U, 0x3ea191f50466f789U, {0xf03bab8268616764U, 0xd27e251be6e20563U}, {0x3ea191f50466f789U, 0x78bcf6a93a891c3eU}},
+		{1024, 0x4cfaafe894a89d23U, 0xa27f8c4c202f1fc4U, {0x4cfaafe894a89d23U, 0xc020fec37588bdc6U}, {0xa27f8c4c202f1fc4U, 0xfa1a552a3124149dU}},
+		{1025, 0x204d513a775020ceU, 0xb73ebb562333cf76U, {0x204d513a775020ceU, 0xfe495dd92cd6b228U}, {0xb73ebb562333cf76U, 0xdd6e14a148a2dc99U}},
+		{2047, 0x0d45a98412ec51beU, 0x5e7b9612f7186af2U, {0x0d45a98412ec51beU, 0x66e4c0754f6e8ea3U}, {0x5e7b9612f7186af2U, 0xf95e154b1fedb3e7U}},
+		{5000, 0x78b96ec17214513eU, 0xd064f207ed2e7513U, {0x78b96ec17214513eU, 0xe98df7a283d0b3cdU}, {0xd064f207ed2e7513U, 0x875bfb7b0115914cU}},
+	};
+	constexpr std::uint64_t seed = 0x0123456789ABCDEFU;
+	ASSERT_EQ(esl::fast_hash("abc", 3), 0x78af5f94892f3950U);
+
+	std::string data(5000, '\0');
+	for (std::size_t i = 0; i < data.size(); ++i) {
+		data[i] = static_cast<char>(i * 131 + (i >> 7));
+	}
+	esl_tests::for_each_cpu_level({{&esl::cpu_features::avx512f}, {&esl::cpu_features::avx2}, {&esl::cpu_features::sse2}}, [&](int level) {
+		for (const auto& c : cases) {
+			ASSERT_EQ(esl::fast_hash(data.data(), c.size), c.h64) << level << " " << c.size;
+			ASSERT_EQ(esl::fast_hash(data.data(), c.size, seed), c.h64_seeded) << level << " " << c.size;
+			ASSERT_EQ(esl::fast_hash128(data.data(), c.size), c.h128) << level << " " << c.size;
+			ASSERT_EQ(esl::fast_hash128(data.data(), c.size, seed), c.h128_seeded) << level << " " << c.size;
+			for (std::size_t chunk : {1, 7, 64, 100, 256, 1000}) {
+				esl::fast_hash_state state(seed);
+				for (std::size_t i = 0; i < c.size; i += chunk) {
+					state.update(data.data() + i, std::min(chunk, c.size - i));
+				}
+				ASSERT_EQ(state.finish(), c.h64_seeded) << level << " " << c.size << " " << chunk;
+				ASSERT_EQ(state.finish128(), c.h128_seeded) << level << " " << c.size << " " << chunk;
+			}
+		}
+	});
+
+	esl::fast_hash_state state;
+	state.update(data.data(), data.size());
+	state.reset();
+	ASSERT_EQ(state.finish(), 0x2d06800538d394c2U);
+}
@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+#include <esl/json_binding.hpp>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace json = esl::json;
+
+namespace {
+
+struct geo {
+	double lat = 0;
+	double lng = 0;
+};
+
+struct address {
+	std::string city;
+	std::optional<geo> location;
+};
+
+struct user {
+	std::int64_t id = 0;
+	std::string name;
+	bool active = false;
+	float score = 0;
+	std::vector<std::string> tags;
+	address home;
+	std::vector<address> others;
+	std::optional<std::uint8_t> level;
+	json::value extra;
+};
+
+struct node {
+	int value = 0;
+	std::vector<node> children;
+};
+
+} // namespace
+
+template <>
+struct esl::json::binding<geo> {
+	static constexpr auto fields = std::make_tuple(ESL_JSON_FIELD(geo, lat), ESL_JSON_FIELD(geo, lng));
+};
+
+template <>
+struct esl::json::binding<address> {
+	static constexpr auto fields = std::make_tuple(ESL_JSON_FIELD(address, city), json::field("geo", &address::location));
+};
+
+template <>
+struct esl::json::binding<user> {
+	static constexpr auto fields = std::make_tuple(ESL_JSON_FIELD(user, id), ESL_JSON_FIELD(user, name), ESL_JSON_FIELD(user, active),
+		ESL_JSON_FIELD(user, score), ESL_JSON_FIELD(user, tags), json::field("address", &user::home), ESL_JSON_FIELD(user, others),
+		ESL_JSON_FIELD(user, level), ESL_JSON_FIELD(user, extra));
+};
+
+template <>
+struct esl::json::binding<node> {
+	static constexpr auto fields = std::make_tuple(ESL_JSON_FIELD(node, value), ESL_JSON_FIELD(node, children));
+};
+
+TEST(JsonBindingTest, read) {
+	const auto u = json::read<user>(R"({"id": 9007199254740993, "name": "a\"b", "unknown": {"x": [1, {}]}, "active": true,
+		"score": 76.5, "tags": ["x", "y"], "address": {"city": "c", "geo": {"lat": 1.5, "lng": -2}},
+		"others": [{"city": "d", "geo": null}, {"city": "e"}], "level": 3, "extra": [null, {"k": "v"}]})");
+	ASSERT_EQ(u.id, 9007199254740993);
+	ASSERT_EQ(u.name, "a\"b");
+	ASSERT_TRUE(u.active);
+	ASSERT_EQ(u.score, 76.5f);
+	ASSERT_EQ(u.tags, (std::vector<std::string>{"x", "y"}));
+	ASSERT_EQ(u.home.city, "c");
+	ASSERT_EQ(u.home.location->lat, 1.5);
+	ASSERT_EQ(u.home.location->lng, -2);
+	ASSERT_EQ(u.others.size(), 2u);
+	ASSERT_EQ(u.others[0].city, "d");
+	ASSERT_FALSE(u.others[0].location);
+	ASSERT_FALSE(u.others[1].location);
+	ASSERT_EQ(u.level, 3);
+	ASSERT_EQ(u.extra, json::parse(R"([null, {"k": "v"}])"));
+
+	// Missing fields keep their defaults, later duplicates win
+	const auto v = json::read<user>(R"({"tags": ["x"], "tags": [], "level": null})");
+	ASSERT_EQ(v.id, 0);
+	ASSERT_TRUE(v.tags.empty());
+	ASSERT_FALSE(v.level);
+
+	ASSERT_EQ(json::read<std::vector<int>>("[1, -2, 3]"), (std::vector<int>{1, -2, 3}));
+	ASSERT_EQ(json::read<std::vector<bool>>("[true, false, true]"), (std::vector<bool>{true, false, true}));
+	ASSERT_EQ(json::read<std::optional<std::string>>("null"), std::nullopt);
+
+	const auto t = json::read<node>(R"({"value": 1, "children": [{"value": 2, "children": [{"value": 3}]}, {"value": 4}]})");
+	ASSERT_EQ(t.children.size(), 2u);
+	ASSERT_EQ(t.children[0].children[0].value, 3);
+	ASSERT_EQ(t.children[1].value, 4);
+}
+
+TEST(JsonBindingTest, read_error) {
+	const auto position = [](auto read, std::string_view text) -> std::size_t {
+		try {
+			read(text);
+		} catch (const json::parse_error& e) {
+			return e.position();
+		}
+		return std::string_view::npos;
+	};
+	const auto read_user = [](std::string_view text) { json::read<user>(text); };
+	const auto read_ints = [](std::string_view text) { json::read<std::vector<int>>(text); };
+	const auto read_bytes = [](std::string_view text) { json::read<std::vector<std::uint8_t>>(text); };
+	ASSERT_EQ(position(read_user, "[]"), 0u);
+	ASSERT_EQ(position(read_user, R"({"id": "1"})"), 7u);
+	ASSERT_EQ(position(read_user, R"({"id": 1.5})"), 7u);
+	ASSERT_EQ(position(read_user, R"({"id": 1e3})"), 7u);
+	ASSERT_EQ(position(read_user, R"({"id": 01})"), 7u);
+	ASSERT_EQ(position(read_user, R"({"id": 1.})"), 7u);
+	ASSERT_EQ(position(read_user, R"({"name": 1})"), 9u);
+	ASSERT_EQ(position(read_user, R"({"active": 1})"), 11u);
+	ASSERT_EQ(position(read_user, R"({"score": "1"})"), 10u);
+	ASSERT_EQ(position(read_user, R"({"unknown": [1,]})"), 15u);
+	ASSERT_EQ(position(read_user, R"({"id": 1 "name": ""})"), 9u);
+	ASSERT_EQ(position(read_user, R"({"id": 1,})"), 9u);
+	ASSERT_EQ(position(read_user, R"({"id": 1)"), 8u);
+	ASSERT_EQ(position(read_user, R"({"id": 1} [])"), 10u);
+	ASSERT_EQ(position(read_user, R"({"extra": )"), 10u);
+	ASSERT_EQ(position(read_ints, "[1 2]"), 3u);
+	ASSERT_EQ(position(read_ints, "[1, 99999999999]"), 4u);
+	ASSERT_EQ(position(read_bytes, "[256]"), 1u);
+	ASSERT_EQ(position(read_bytes, "[-1]"), 1u);
+
+	std::string deep;
+	for (std::size_t i = 0; i <= json::max_depth; ++i) {
+		deep += R"({"children": [)";
+	}
+	ASSERT_THROW(json::read<node>(deep), json::parse_error);
+}
+
+TEST(JsonBindingTest, write) {
+	user u;
+	u.id = -9007199254740993;
+	u.name = "a\"b\n";
+	u.score = 0.1f;
+	u.tags = {"x"};
+	u.home.city = "c";
+	u.home.location = geo{1.5, -2};
+	u.others = {address{"d", std::nullopt}};
+	u.extra = json::parse(R"({"k": [true]})");
+	const auto text = json::write(u);
+	ASSERT_EQ(text, R"({"id":-9007199254740993,"name":"a\"b\n","active":false,"score":0.1,"tags":["x"],)"
+					R"("address":{"city":"c","geo":{"lat":1.5,"lng":-2.0}},"others":[{"city":"d"}],"extra":{"k":[true]}})");
+	const auto v = json::read<user>(text);
+	ASSERT_EQ(json::write(v), text);
+	ASSERT_EQ(json::write(std::vector<std::optional<int>>{1, std::nullopt}), "[1,null]");
+	ASSERT_EQ(json::write(std::vector<bool>{true, false}), "[true,false]");
+}
@@ -1,6 +1,22 @@
 
 #include <gtest/gtest.h>
 #include <esl/json.hpp>
+#include <esl/json_pmr.hpp>
+#include "cpu_test_util.hpp"
+#include "memory_test_util.hpp"
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <memory_resource>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
 
 namespace json = esl::json;
 
@@ -46,3 +62,611 @@ TEST(JsonTest, value) {
 	ASSERT_EQ(std::get<json::string>(std::get<json::object>(std::get<json::object>(jv)["obj"])["obj_k1"]), "obj_v1");
 }
 
+
+namespace {
+
+template <class F>
+void for_each_cpu_level(F&& f) {
+	esl_tests::for_each_cpu_level({{&esl::cpu_features::avx512bw}, {&esl::cpu_features::avx2}, {&esl::cpu_features::ssse3, &esl::cpu_features::sse2}}, std::forward<F>(f));
+}
+
+} // namespace
+
+TEST(JsonTest, parse) {
+	for_each_cpu_level([] {
+		auto jv = json::parse(R"( {"k1": 123456, "k2": -123.456e-2, "k3": "v3", "k4": true, "k5": null, "k6": false,
+			"arr": [0, 1.5, "", [], {}, [[null]]], "obj": {"a": {"b": "c"}}, "k1": 1} )");
+		auto& obj = std::get<json::object>(jv);
+		ASSERT_EQ(obj.size(), 8);
+		ASSERT_EQ(std::get<json::integer>(obj["k1"]), 1);
+		ASSERT_DOUBLE_EQ(std::get<json::number>(obj["k2"]), -1.23456);
+		ASSERT_EQ(std::get<json::string>(obj["k3"]), "v3");
+		ASSERT_EQ(std::get<json::boolean>(obj["k4"]), true);
+		ASSERT_EQ(obj["k5"].index(), json::null_index);
+		ASSERT_EQ(std::get<json::boolean>(obj["k6"]), false);
+		auto& arr = std::get<json::array>(obj["arr"]);
+		ASSERT_EQ(arr.size(), 6);
+		ASSERT_EQ(std::get<json::number>(arr[1]), 1.5);
+		ASSERT_EQ(std::get<json::string>(arr[2]), "");
+		ASSERT_TRUE(std::get<json::array>(arr[3]).empty());
+		ASSERT_TRUE(std::get<json::object>(arr[4]).empty());
+		ASSERT_EQ(std::get<json::array>(std::get<json::array>(arr[5])[0])[0].index(), json::null_index);
+		ASSERT_EQ(std::get<json::string>(std::get<json::object>(std::get<json::object>(obj["obj"])["a"])["b"]), "c");
+
+		ASSERT_EQ(std::get<json::number>(json::parse("-0")), 0);
+		ASSERT_EQ(std::get<json::number>(json::parse("1E+2")), 100);
+		ASSERT_EQ(std::get<json::string>(json::parse("\"\"")), "");
+		ASSERT_EQ(json::parse("null").index(), json::null_index);
+
+		// Escapes, across block boundaries too
+		ASSERT_EQ(std::get<json::string>(json::parse(R"("\"\\\/\b\f\n\r\t\u0041\u00e9\u20AC\ud83d\ude00")")),
+		          "\"\\/\b\f\n\r\t\x41\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80");
+		for (std::size_t n = 0; n < 140; ++n) {
+			for (std::size_t slashes = 0; slashes < 4; ++slashes) {
+				std::string expected(n, 'x');
+				expected.append(slashes, '\\');
+				expected.append("\"[]{}:,");
+				std::string text = "[\"" + std::string(n, 'x') + std::string(slashes * 2, '\\') + "\\\"[]{}:,\", 1]";
+				auto v = json::parse(text);
+				ASSERT_EQ(std::get<json::string>(std::get<json::array>(v)[0]), expected);
+				ASSERT_EQ(std::get<json::integer>(std::get<json::array>(v)[1]), 1);
+			}
+		}
+
+		// Large documents
+		std::string text = "[";
+		for (int i = 0; i < 1000; ++i) {
+			text += "{\"id\": " + std::to_string(i) + ", \"name\": \"item\\t" + std::to_string(i) + "\", \"tags\": [\"a\", \"b\"]},\n";
+		}
+		text += "{}]";
+		auto v = json::parse(text);
+		auto& items = std::get<json::array>(v);
+		ASSERT_EQ(items.size(), 1001);
+		ASSERT_EQ(std::get<json::integer>(std::get<json::object>(items[999])["id"]), 999);
+		ASSERT_EQ(std::get<json::string>(std::get<json::object>(items[500])["name"]), "item\t500");
+	});
+}
+
+TEST(JsonTest, parse_error) {
+	struct error_case {
+		const char* text;
+		std::size_t position;
+		std::size_t line;
+		std::size_t column;
+	};
+	const error_case cases[] = {
+		{"", 0, 1, 1},
+		{"  ", 2, 1, 3},
+		{"[1, 2", 5, 1, 6},
+		{"[1, 2,]", 6, 1, 7},
+		{"{\"a\" 1}", 5, 1, 6},
+		{"{\"a\": 1,}", 8, 1, 9},
+		{"{1: 1}", 1, 1, 2},
+		{"[1}", 2, 1, 3},
+		{"[1]]", 3, 1, 4},
+		{"[\n  tru\n]", 4, 2, 3},
+		{"[\n  01]", 4, 2, 3},
+		{"[1.]", 1, 1, 2},
+		{"[-]", 1, 1, 2},
+		{"[1e]", 1, 1, 2},
+		{"[1x]", 1, 1, 2},
+		{"1e999", 0, 1, 1},
+		{"[\"abc", 1, 1, 2},
+		{"[\"a\\\"]", 1, 1, 2},
+		{"\"a\\x\"", 2, 1, 3},
+		{"\"\\u12\"", 1, 1, 2},
+		{"\"\\ud800\"", 1, 1, 2},
+		{"\"\\udc00\"", 1, 1, 2},
+		{"\"a\tb\"", 2, 1, 3},
+		{"[\"a\"\"b\"]", 4, 1, 5},
+		{"{\"a\":1}\n\nx", 9, 3, 1},
+	};
+	for_each_cpu_level([&] {
+		for (auto& c : cases) {
+			try {
+				json::parse(c.text);
+				FAIL() << c.text;
+			} catch (const json::parse_error& e) {
+				ASSERT_EQ(e.position(), c.position) << c.text << ": " << e.what();
+				ASSERT_EQ(e.line(), c.line) << c.text;
+				ASSERT_EQ(e.column(), c.column) << c.text;
+			}
+		}
+		ASSERT_THROW(json::parse(std::string(json::max_depth + 1, '[') + std::string(json::max_depth + 1, ']')), json::parse_error);
+		ASSERT_NO_THROW(json::parse(std::string(json::max_depth, '[') + std::string(json::max_depth, ']')));
+	});
+}
+
+TEST(JsonTest, document) {
+	for_each_cpu_level([] {
+		const std::string text = R"( {"a": {"b": [1, "x", true, null, {"c": -2.5e1}]}, "k\"ey": "vé", "skip": [[{}], {"z": [1,2]}], "e": [], "o": {}} )";
+		const json::document doc(text);
+		ASSERT_EQ(doc.type(), json::object_index);
+		const auto b = doc["a"]["b"];
+		ASSERT_EQ(b.type(), json::array_index);
+		ASSERT_EQ(b.size(), 5);
+		ASSERT_EQ(b[0].get<json::integer>(), 1);
+		ASSERT_EQ(b[1].get<json::string>(), "x");
+		ASSERT_EQ(b[2].get<json::boolean>(), true);
+		ASSERT_EQ(b[3].type(), json::null_index);
+		ASSERT_NO_THROW(b[3].get<json::null_t>());
+		ASSERT_EQ(b[4]["c"].get<json::number>(), -25);
+		ASSERT_EQ(doc["k\"ey"].get<json::string>(), "v\xC3\xA9");
+		ASSERT_EQ(doc["e"].size(), 0);
+		ASSERT_EQ(doc["o"].size(), 0);
+		ASSERT_EQ(doc["o"].begin(), doc["o"].end());
+		ASSERT_TRUE(doc.root().contains("skip"));
+		ASSERT_FALSE(doc.root().contains("nope"));
+
+		std::vector<std::string> keys;
+		for (auto it = doc.begin(); it != doc.end(); ++it) {
+			keys.emplace_back(it.key());
+		}
+		ASSERT_EQ(keys, (std::vector<std::string>{"a", "k\"ey", "skip", "e", "o"}));
+
+		ASSERT_EQ(doc["skip"].raw(), R"([[{}], {"z": [1,2]}])");
+		ASSERT_EQ(doc["k\"ey"].raw(), R"("vé")");
+		ASSERT_EQ(b[4]["c"].raw(), "-2.5e1");
+		ASSERT_EQ(b[2].raw(), "true");
+		ASSERT_EQ(doc["skip"].to_value(), json::parse(R"([[{}], {"z": [1,2]}])"));
+		ASSERT_EQ(doc.to_value(), json::parse(text));
+		ASSERT_EQ(b[4].get<json::value>(), json::parse(R"({"c": -2.5e1})"));
+
+		ASSERT_THROW(doc["nope"], esl::key_not_found);
+		ASSERT_THROW(b[5], std::out_of_range);
+		ASSERT_THROW(b[1].get<json::number>(), std::bad_variant_access);
+		ASSERT_THROW(b[0]["c"], std::bad_variant_access);
+		ASSERT_THROW(doc[std::size_t(0)], std::bad_variant_access);
+
+		// Malformed subtrees are only rejected when accessed
+		const json::document bad(R"({"bad": [1 2, tru], "ok": 1})");
+		ASSERT_EQ(bad["ok"].get<json::integer>(), 1);
+		ASSERT_THROW(bad["bad"].size(), json::parse_error);
+		ASSERT_EQ(bad["bad"][0].get<json::integer>(), 1);
+		ASSERT_THROW(bad["bad"][1], json::parse_error);
+		ASSERT_THROW(bad.to_value(), json::parse_error);
+		ASSERT_THROW(json::document(R"({"a": [1, 2})")["b"], json::parse_error);
+		ASSERT_THROW(json::document(R"({"a" 1})")["a"], json::parse_error);
+		ASSERT_THROW(json::document(R"(["abc])"), json::parse_error);
+	});
+}
+
+TEST(JsonTest, pmr) {
+	const std::string text = R"({"key with a long name":["a string longer than the small buffer",1.5,true,null,{"nested":{}}],"e":[]})";
+	esl_tests::counting_resource resource;
+	{
+		// Any allocation from the default resource fails
+		auto* const prev = std::pmr::set_default_resource(std::pmr::null_memory_resource());
+		const auto v = json::pmr::parse(text, &resource);
+		std::pmr::set_default_resource(prev);
+		ASSERT_NE(resource.outstanding, 0);
+		ASSERT_EQ(v.index(), json::object_index);
+		const auto& o = std::get<json::pmr::object>(v);
+		ASSERT_EQ(o.get_allocator().resource(), &resource);
+		const auto& a = std::get<json::pmr::array>(o.at("key with a long name"));
+		ASSERT_EQ(a.get_allocator().resource(), &resource);
+		ASSERT_EQ(std::get<json::pmr::string>(a[0]).get_allocator().resource(), &resource);
+		ASSERT_EQ(json::dump(v), json::dump(json::parse(text)));
+		ASSERT_EQ(json::dump_max_size(v), json::dump_max_size(json::parse(text)));
+	}
+	ASSERT_EQ(resource.outstanding, 0);
+
+	const json::pmr::arena_value arena(text);
+	ASSERT_EQ(json::dump(arena.get(), json::dump_pretty), json::dump(json::parse(text), json::dump_pretty));
+	ASSERT_THROW(json::pmr::arena_value("[1,]"), json::parse_error);
+}
+
+TEST(JsonTest, value_view) {
+	const std::string text = R"({"plain":"abc","esc":"a\"b\\cé😀","k\n":[1.5,"x",null,true],"e":{}})";
+	const auto within = [](std::string_view sv, std::string_view s) {
+		return std::less_equal<>{}(s.data(), sv.data()) && std::less_equal<>{}(sv.data() + sv.size(), s.data() + s.size());
+	};
+	// Written once for value and value_view
+	const auto check = [](const auto& v) {
+		const auto& o = std::get<json::object_index>(v);
+		ASSERT_EQ(o.size(), 4u);
+		ASSERT_EQ(std::get<json::string_index>(o.at("plain")), "abc");
+		ASSERT_EQ(std::get<json::string_index>(o.at("esc")), "a\"b\\cé\U0001F600");
+		const auto& a = std::get<json::array_index>(o.at("k\n"));
+		ASSERT_EQ(std::get<json::number>(a[0]), 1.5);
+		ASSERT_TRUE(std::holds_alternative<json::null_t>(a[2]));
+		ASSERT_TRUE(std::get<json::boolean>(a[3]));
+		ASSERT_TRUE(std::get<json::object_index>(o.at("e")).empty());
+	};
+	check(json::parse(text));
+	for_each_cpu_level([&] {
+		std::pmr::monotonic_buffer_resource arena;
+		const auto v = json::parse_view(text, &arena);
+		check(v);
+		const auto& o = std::get<json::object_view>(v);
+		ASSERT_TRUE(within(std::get<std::string_view>(o.at("plain")), text));
+		ASSERT_FALSE(within(std::get<std::string_view>(o.at("esc")), text));
+		ASSERT_FALSE(within(o.begin()[2].first, text));
+		ASSERT_EQ(json::dump(v), json::dump(json::ordered::parse(text)));
+		ASSERT_EQ(json::dump_max_size(v), json::dump_max_size(json::parse(text)));
+
+		// In place, every string is a view of the text
+		std::string buffer = text;
+		const auto w = json::parse_view(esl::span<char>(buffer.data(), buffer.size()));
+		check(w);
+		ASSERT_EQ(w, v);
+		for (const auto& [key, e] : std::get<json::object_view>(w)) {
+			ASSERT_TRUE(within(key, buffer));
+			if (e.index() == json::string_index) {
+				ASSERT_TRUE(within(std::get<std::string_view>(e), buffer));
+			}
+		}
+		ASSERT_EQ(json::dump(w), json::dump(json::ordered::parse(text)));
+
+		ASSERT_THROW(json::parse_view("[1,]", &arena), json::parse_error);
+		std::string bad = R"(["\u12"])";
+		ASSERT_THROW(json::parse_view(esl::span<char>(bad.data(), bad.size())), json::parse_error);
+	});
+}
+
+namespace {
+
+// Events as text
+struct event_recorder {
+	std::string events;
+
+	void null() { events += "n "; }
+	void boolean(bool b) { events += b ? "t " : "f "; }
+	void number(double d) { events += std::to_string(d) + ' '; }
+	void string(std::string_view sv) { events += "s:" + std::string(sv) + ' '; }
+	void key(std::string_view sv) { events += "k:" + std::string(sv) + ' '; }
+	void begin_object() { events += "{ "; }
+	void end_object(std::size_t n) { events += "}" + std::to_string(n) + ' '; }
+	void begin_array() { events += "[ "; }
+	void end_array(std::size_t n) { events += "]" + std::to_string(n) + ' '; }
+};
+
+} // namespace
+
+TEST(JsonTest, reader) {
+	std::string text = " {\"items\": [";
+	for (int i = 0; i < 500; ++i) {
+		text += "{\"id\": " + std::to_string(i) + ", \"name\": \"item\\t" + std::string(static_cast<std::size_t>(i % 200), 'x') + "\", \"ok\": true},\n";
+	}
+	text += "null], \"e\": {}, \"a\": []} \n";
+	const auto expected = json::parse(text);
+	for_each_cpu_level([&] {
+		for (std::size_t chunk : {1, 64, 100, 4096, 1 << 20}) {
+			json::reader r(text, chunk);
+			ASSERT_EQ(json::parse(r), expected);
+		}
+
+		event_recorder recorder;
+		json::reader r(std::string_view(R"([1, "a\"b", {"k": false}, [], {}])"), 64);
+		r.read(recorder);
+		ASSERT_EQ(recorder.events, "[ 1.000000 s:a\"b { k:k f }1 [ ]0 { }0 ]5 ");
+
+		// Errors are located in the whole input
+		const std::vector<std::string> invalid = {
+			text + "x",
+			text.substr(0, text.size() - 4),
+			text.substr(0, 3000) + "\n  ]" + text.substr(3000),
+			std::string(5000, ' ') + "\"abc",
+			std::string(json::max_depth + 1, '['),
+			"",
+		};
+		for (const auto& s : invalid) {
+			std::size_t position = 0, line = 0, column = 0;
+			try {
+				json::parse(s);
+			} catch (const json::parse_error& e) {
+				position = e.position();
+				line = e.line();
+				column = e.column();
+			}
+			ASSERT_NE(line, 0);
+			for (std::size_t chunk : {64, 1000}) {
+				json::reader r(s, chunk);
+				try {
+					json::parse(r);
+					FAIL();
+				} catch (const json::parse_error& e) {
+					ASSERT_EQ(e.position(), position);
+					ASSERT_EQ(e.line(), line);
+					ASSERT_EQ(e.column(), column);
+				}
+			}
+		}
+	});
+
+	// File source
+	std::unique_ptr<std::FILE, int (*)(std::FILE*)> file(std::tmpfile(), &std::fclose);
+	ASSERT_TRUE(file);
+	std::fwrite(text.data(), 1, text.size(), file.get());
+	std::rewind(file.get());
+	json::reader r(file.get(), 1000);
+	ASSERT_EQ(json::parse(r), expected);
+}
+
+TEST(JsonTest, parse_lines) {
+	// Lines of every kind, long enough for several chunks; malformed ones at known lines
+	std::string text;
+	std::vector<std::string_view> lines;
+	std::vector<std::size_t> starts;
+	{
+		std::vector<std::string> records;
+		const std::string pad(160, 'x');
+		for (std::size_t i = 0; records.size() < 6000; ++i) {
+			records.push_back(R"({"id": )" + std::to_string(i) + R"(, "tags": ["a", "b\n"], "pad": ")" + pad + R"("})");
+			if (i % 97 == 0) {
+				records.emplace_back(i % 2 == 0 ? "" : " \t\r");
+			}
+			if (i % 251 == 0) {
+				records.push_back(i % 2 == 0 ? "[1, 2" : R"({"open": "string)");
+			}
+			if (i % 5 == 0) {
+				records.back() += '\r';
+			}
+		}
+		for (const auto& r : records) {
+			starts.push_back(text.size());
+			text += r;
+			text += '\n';
+		}
+		starts.push_back(text.size());
+		text += R"("last, without a newline")";
+		for (std::size_t i = 0; i < starts.size(); ++i) {
+			const std::size_t end = i + 1 < starts.size() ? starts[i + 1] - 1 : text.size();
+			lines.push_back(std::string_view(text).substr(starts[i], end - starts[i]));
+		}
+	}
+	ASSERT_GT(text.size(), 4 * json::parse_lines_min_chunk);
+	// Expected results: "line: dump" or "line: error at position"
+	std::vector<std::string> expected;
+	for (std::size_t i = 0; i < lines.size(); ++i) {
+		if (lines[i].find_first_not_of(" \t\r") == std::string_view::npos) {
+			continue;
+		}
+		try {
+			expected.push_back(std::to_string(i + 1) + ": " + json::dump(json::parse(lines[i])));
+		} catch (const json::parse_error& e) {
+			expected.push_back(std::to_string(i + 1) + ": " + e.what() + " at " + std::to_string(starts[i] + e.position()));
+		}
+	}
+	const esl::span<const char> input(text.data(), text.size());
+
+	const auto check = [&](json::line_order order) {
+		std::mutex mutex;
+		std::vector<std::string> results;
+		json::parse_lines(
+			input, esl::thread_executor(4),
+			[&](std::size_t line, json::value&& v) {
+				const std::lock_guard<std::mutex> lock(mutex);
+				results.push_back(std::to_string(line) + ": " + json::dump(v));
+			},
+			[&](const json::parse_error& e) {
+				const std::lock_guard<std::mutex> lock(mutex);
+				ASSERT_EQ(e.column(), e.position() - starts[e.line() - 1] + 1);
+				results.push_back(std::to_string(e.line()) + ": " + e.what() + " at " + std::to_string(e.position()));
+			},
+			order);
+		if (order == json::line_order::unordered) {
+			const auto line_number = [](const std::string& r) { return std::stoul(r); };
+			std::stable_sort(results.begin(), results.end(), [&](const auto& a, const auto& b) { return line_number(a) < line_number(b); });
+		}
+		ASSERT_EQ(results, expected);
+	};
+	for_each_cpu_level([&] { check(json::line_order::ordered); });
+	check(json::line_order::unordered);
+
+	// The first malformed line is thrown, after the lines before it are delivered
+	std::size_t delivered = 0;
+	try {
+		json::parse_lines(input, esl::thread_executor(4), [&](std::size_t line, json::value&&) { delivered = line; });
+		FAIL();
+	} catch (const json::parse_error& e) {
+		ASSERT_EQ(e.line(), 3u);
+		ASSERT_EQ(e.position(), starts[2] + 6);
+		ASSERT_EQ(delivered, 1u);
+	}
+	// Serial, with a single chunk
+	std::size_t count = 0;
+	json::parse_lines(esl::span<const char>(lines[0].data(), lines[0].size()), esl::thread_executor(1), [&](std::size_t line, json::value&& v) {
+		ASSERT_EQ(line, 1u);
+		ASSERT_EQ(json::dump(v), json::dump(json::parse(lines[0])));
+		++count;
+	});
+	ASSERT_EQ(count, 1u);
+}
+
+TEST(JsonTest, path) {
+	const std::string text = R"({"user": {"id": 42, "name": "a\"b", "tags": ["x", "y"]}, "a/b": {"m~n": 1},
+		"items": [{"sku": "s1", "qty": 1}, {"qty": 2}, {"sku": "s3"}], "0": "zero", "user": {"id": 0}})";
+	const std::string invalid = text.substr(0, text.size() - 1) + R"(, "bad": [1 2]})";
+	const auto matches = [](std::string_view input, std::initializer_list<std::string_view> exprs) {
+		const json::document doc(input);
+		std::vector<json::path> paths;
+		for (auto e : exprs) {
+			paths.emplace_back(e);
+		}
+		std::vector<std::string> r;
+		json::query(doc, esl::span<const json::path>(paths.data(), paths.size()), [&](std::size_t i, json::lazy_value v) {
+			r.push_back(std::to_string(i) + ": " + std::string(v.raw()));
+		});
+		return r;
+	};
+	using strings = std::vector<std::string>;
+
+	// JSON Pointer
+	ASSERT_EQ(matches(text, {"/user/id"}), strings{"0: 42"});
+	ASSERT_EQ(matches(text, {"/user/name"}), strings{R"(0: "a\"b")"});
+	ASSERT_EQ(matches(text, {"/user/tags/1"}), strings{R"(0: "y")"});
+	ASSERT_EQ(matches(text, {"/a~1b/m~0n"}), strings{"0: 1"});
+	ASSERT_EQ(matches(text, {"/0"}), strings{R"(0: "zero")"});
+	ASSERT_EQ(matches(text, {"/items/0/sku", "/items/2/sku"}), (strings{R"(0: "s1")", R"(1: "s3")"}));
+	ASSERT_EQ(matches(text, {"/missing", "/user/id/x", "/user/tags/2", "/items/1/sku"}), strings{});
+	ASSERT_EQ(matches(text, {""}).size(), 1u);
+
+	// JSONPath, several paths in one pass, in document order
+	ASSERT_EQ(matches(text, {"$.user.id"}), strings{"0: 42"});
+	ASSERT_EQ(matches(text, {"$['user'][\"tags\"][0]"}), strings{R"(0: "x")"});
+	ASSERT_EQ(matches(text, {"$.items[*].sku", "$.items[*].qty"}), (strings{R"(0: "s1")", "1: 1", "1: 2", R"(0: "s3")"}));
+	ASSERT_EQ(matches(text, {"$.*.id"}), (strings{"0: 42", "0: 0"}));
+	ASSERT_EQ(matches(text, {"$.user.*"}), (strings{"0: 42", R"(0: "a\"b")", R"(0: ["x", "y"])", "0: 0"}));
+	ASSERT_EQ(matches(text, {"$.user", "$.user.tags[1]"}).size(), 2u);
+	// Numeric JSONPath indexes match arrays only
+	ASSERT_EQ(matches(text, {"$[0]", "$['0']"}), strings{R"(1: "zero")"});
+
+	// Definite paths stop the walk once resolved, the invalid array after them is not reached
+	ASSERT_EQ(matches(invalid, {"/user/id", "/0"}).size(), 2u);
+	ASSERT_THROW(matches(invalid, {"$.*.id"}), json::parse_error);
+	ASSERT_THROW(matches(invalid, {"/bad/1"}), json::parse_error);
+
+	// Converted values
+	json::query(text, json::path("/user/tags"), [](std::size_t, json::lazy_value v) {
+		ASSERT_EQ(json::dump(v.to_value()), R"(["x","y"])");
+		ASSERT_EQ(v[1].get<json::string>(), "y");
+	});
+	json::query(text, json::path("$.user.name"), [](std::size_t, json::lazy_value v) { ASSERT_EQ(v.get<json::string>(), "a\"b"); });
+
+	for (auto e : {"user", "/a~2", "/a~", "$.", "$..a", "$[", "$[x]", "$['a'", "$[01]", "$a"}) {
+		ASSERT_THROW(json::path{e}, std::invalid_argument) << e;
+	}
+}
+
+TEST(JsonTest, dump) {
+	for_each_cpu_level([] {
+		json::value v(std::in_place_type<json::array>, {
+				json::value(json::null),
+				json::value(true),
+				json::value(false),
+				json::value(-1.5),
+				json::value(1e300),
+				json::value(json::string("a\"b\\c/\b\f\n\r\t\x01\x1F\xC3\xA9")),
+				json::value(json::array{}),
+				json::value(json::object{}),
+				json::value(json::object{{"k", json::value(json::array{json::value(json::integer(1)), json::value(json::string("x"))})}}),
+			});
+		const std::string compact = R"([null,true,false,-1.5,1e+300,"a\"b\\c/\b\f\n\r\t\u0001\u001f)" "\xC3\xA9" R"(",[],{},{"k":[1,"x"]}])";
+		ASSERT_EQ(json::dump(v), compact);
+		ASSERT_EQ(json::dump(json::parse(compact)), compact);
+		ASSERT_EQ(json::dump(json::value(std::numeric_limits<double>::infinity())), "null");
+		// Members in document order
+		ASSERT_EQ(json::dump(json::ordered::parse(R"({"b":1,"a":2,"c":{"z":0,"y":1}})")), R"({"b":1,"a":2,"c":{"z":0,"y":1}})");
+		ASSERT_EQ(json::dump(json::parse(R"({"b":1})")), R"({"b":1})");
+
+		const std::string pretty = "[\n"
+		                           "    null,\n"
+		                           "    []\n"
+		                           "]";
+		ASSERT_EQ(json::dump(json::parse("[null,[]]"), json::dump_option{4}), pretty);
+		ASSERT_EQ(json::dump(json::parse(R"({"a":{"b":[1,2]}})"), json::dump_pretty), "{\n  \"a\": {\n    \"b\": [\n      1,\n      2\n    ]\n  }\n}");
+
+		// Exact without numbers
+		auto text = json::dump(v, json::dump_pretty);
+		ASSERT_EQ(json::parse(text), v);
+		ASSERT_GE(json::dump_max_size(v, json::dump_pretty), text.size());
+		json::value strings(json::object{{std::string(100, '"'), json::value(json::array{json::value(json::string(200, '\x02'))})}});
+		ASSERT_EQ(json::dump_max_size(strings, json::dump_pretty), json::dump(strings, json::dump_pretty).size());
+		ASSERT_EQ(json::dump_max_size(strings), json::dump(strings).size());
+
+		std::string out;
+		json::dump_to(v, std::back_inserter(out));
+		ASSERT_EQ(out, compact);
+		std::ostringstream os;
+		json::dump_to(v, os, json::dump_pretty);
+		ASSERT_EQ(os.str(), text);
+	});
+}
+
+TEST(JsonTest, dump_number) {
+	std::mt19937_64 rng(1);
+	for (int i = 0; i < 10000; ++i) {
+		double d;
+		const auto bits = rng();
+		std::memcpy(&d, &bits, sizeof(d));
+		if (!std::isfinite(d)) {
+			continue;
+		}
+		const auto text = json::dump(json::value(d));
+		ASSERT_EQ(std::get<json::number>(json::parse(text)), d) << text;
+		ASSERT_LE(text.size(), json::dump_max_size(json::value(d)));
+	}
+	ASSERT_EQ(json::dump(json::value(0.1)), "0.1");
+	ASSERT_EQ(json::dump(json::value(123456789.0)), "123456789.0");
+	ASSERT_EQ(json::dump(json::value(-0.0)), "-0.0");
+	ASSERT_EQ(json::dump(json::value(-2.2250738585072014e-308)), "-2.2250738585072014e-308");
+	ASSERT_EQ(json::dump(json::value(1e-5)), "1e-05");
+	ASSERT_EQ(json::dump(json::value(5e-324)), "5e-324");
+#ifdef __cpp_lib_to_chars
+	// As std::to_chars, also when built with ESL_NO_STD_FLOAT_TO_CHARS
+	for (int i = 0; i < 10000; ++i) {
+		const auto bits = rng();
+		double d;
+		std::memcpy(&d, &bits, sizeof(d));
+		float f;
+		const auto f_bits = static_cast<std::uint32_t>(bits);
+		std::memcpy(&f, &f_bits, sizeof(f));
+		char a[32];
+		char b[32];
+		ASSERT_EQ(std::string(a, esl::to_chars_float_(a, a + sizeof(a), d).ptr), std::string(b, std::to_chars(b, b + sizeof(b), d).ptr));
+		ASSERT_EQ(std::string(a, esl::to_chars_float_(a, a + sizeof(a), f).ptr), std::string(b, std::to_chars(b, b + sizeof(b), f).ptr));
+	}
+#endif
+}
+
+TEST(JsonTest, integer) {
+	const std::string text = "[9007199254740993,-9223372036854775808,9223372036854775807,9223372036854775808,18446744073709551615,"
+	                         "18446744073709551616,-9223372036854775809,0,-0,1.0,1e2,12345678901234567890123]";
+	const auto v = json::parse(text);
+	const auto& a = std::get<json::array>(v);
+	ASSERT_EQ(std::get<json::integer>(a[0]), 9007199254740993);
+	ASSERT_EQ(std::get<json::integer>(a[1]), std::numeric_limits<std::int64_t>::min());
+	ASSERT_EQ(std::get<json::integer>(a[2]), std::numeric_limits<std::int64_t>::max());
+	ASSERT_EQ(std::get<json::unsigned_integer>(a[3]), 9223372036854775808u);
+	ASSERT_EQ(std::get<json::unsigned_integer>(a[4]), std::numeric_limits<std::uint64_t>::max());
+	ASSERT_EQ(std::get<json::number>(a[5]), 18446744073709551616.0);
+	ASSERT_EQ(std::get<json::number>(a[6]), -9223372036854775809.0);
+	ASSERT_EQ(std::get<json::integer>(a[7]), 0);
+	ASSERT_TRUE(std::signbit(std::get<json::number>(a[8])));
+	ASSERT_EQ(std::get<json::number>(a[9]), 1);
+	ASSERT_EQ(std::get<json::number>(a[10]), 100);
+	ASSERT_EQ(std::get<json::number>(a[11]), 12345678901234567890123.0);
+
+	// Integers dump as they were, doubles keep a fraction or an exponent
+	ASSERT_EQ(json::dump(v), "[9007199254740993,-9223372036854775808,9223372036854775807,9223372036854775808,18446744073709551615,"
+	                         "18446744073709551616.0,-9223372036854775808.0,0,-0.0,1.0,100.0,1.2345678901234568e+22]");
+	ASSERT_EQ(json::parse(json::dump(v)), v);
+	ASSERT_LE(json::dump(v).size(), json::dump_max_size(v));
+	std::mt19937_64 rng(2);
+	for (int i = 0; i < 10000; ++i) {
+		const auto u = rng() >> (rng() % 64);
+		// Unsigned integers only above the int64 range
+		const auto x = u > static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max()) ? json::value(u) : json::value(-static_cast<json::integer>(u));
+		ASSERT_EQ(json::parse(json::dump(x)), x) << json::dump(x);
+	}
+
+	const auto view = json::parse_view(text, std::pmr::new_delete_resource());
+	ASSERT_EQ(std::get<json::integer>(std::get<json::array_view>(view)[0]), 9007199254740993);
+	ASSERT_EQ(std::get<json::unsigned_integer>(std::get<json::array_view>(view)[4]), std::numeric_limits<std::uint64_t>::max());
+
+	const json::document doc(text);
+	ASSERT_EQ(doc[std::size_t(0)].type(), json::integer_index);
+	ASSERT_EQ(doc[std::size_t(0)].get<json::integer>(), 9007199254740993);
+	ASSERT_EQ(doc[std::size_t(4)].type(), json::unsigned_integer_index);
+	ASSERT_EQ(doc[std::size_t(4)].get<json::unsigned_integer>(), std::numeric_limits<std::uint64_t>::max());
+	ASSERT_EQ(doc[std::size_t(5)].type(), json::number_index);
+	ASSERT_THROW(doc[std::size_t(0)].get<json::number>(), std::bad_variant_access);
+	ASSERT_THROW(doc[std::size_t(5)].get<json::integer>(), std::bad_variant_access);
+
+	// Handlers with integer events get them, others doubles
+	struct integer_recorder : event_recorder {
+		void integer(std::int64_t i) { events += "i" + std::to_string(i) + ' '; }
+		void unsigned_integer(std::uint64_t u) { events += "u" + std::to_string(u) + ' '; }
+	};
+	integer_recorder recorder;
+	json::reader r(std::string_view("[-1, 18446744073709551615, 2.5]"));
+	r.read(recorder);
+	ASSERT_EQ(recorder.events, "[ i-1 u18446744073709551615 2.500000 ]3 ");
+
+	for (const char* invalid : {"01", "-", "-01", "1.", ".5", "1e", "1e+", "+1", "1.5x", "0x10", "1-"}) {
+		ASSERT_THROW(json::parse(invalid), json::parse_error) << invalid;
+	}
+	ASSERT_THROW(json::parse("1e400"), json::parse_error);
+	ASSERT_THROW(json::parse("-1e-400"), json::parse_error);
+}
@@ -0,0 +1,33 @@
+#ifndef ESL_TESTS_MEMORY_TEST_UTIL_HPP
+#define ESL_TESTS_MEMORY_TEST_UTIL_HPP
+
+#include <cstddef>
+#include <memory_resource>
+
+namespace esl_tests {
+
+// counting_resource
+// Allocations from new_delete_resource, counted; equal only to itself
+class counting_resource : public std::pmr::memory_resource {
+public:
+	std::size_t allocated = 0;
+	std::size_t outstanding = 0;
+
+private:
+	void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+		++allocated;
+		++outstanding;
+		return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+	}
+	void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+		--outstanding;
+		std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+	}
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+		return this == &other;
+	}
+};
+
+} // namespace esl_tests
+
+#endif // ESL_TESTS_MEMORY_TEST_UTIL_HPP
@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include <esl/msgpack.hpp>
+#include "codec_test_util.hpp"
+
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace msgpack = esl::msgpack;
+namespace json = esl::json;
+namespace yaml = esl::yaml;
+
+namespace {
+
+struct msgpack_codec {
+	// No options
+	struct option_type {};
+	using decode_error = msgpack::decode_error;
+
+	template <class Value>
+	static std::vector<unsigned char> encode(const Value& v, const option_type&) {
+		return msgpack::encode(v);
+	}
+	template <class Value>
+	static std::size_t encoded_size(const Value& v, const option_type&) {
+		return msgpack::encoded_size(v);
+	}
+	template <class Value>
+	static Value decode(const unsigned char* data, std::size_t size) {
+		return msgpack::decode<Value>(data, size);
+	}
+};
+
+using codec = esl_tests::codec_test<msgpack_codec>;
+
+} // namespace
+
+TEST(MsgpackTest, encode) {
+	const std::pair<std::int64_t, const char*> integers[] = {{0, "00"}, {127, "7f"}, {128, "cc80"}, {255, "ccff"}, {256, "cd0100"},
+		{65536, "ce00010000"}, {4294967296, "cf0000000100000000"}, {-1, "ff"}, {-32, "e0"}, {-33, "d0df"}, {-128, "d080"},
+		{-129, "d1ff7f"}, {-32769, "d2ffff7fff"}, {-2147483649, "d3ffffffff7fffffff"}};
+	for (const auto& [d, hex] : integers) {
+		ASSERT_EQ(codec::to_hex(json::value(d)), hex) << d;
+		ASSERT_EQ(codec::to_hex(yaml::node(d)), hex) << d;
+	}
+	ASSERT_EQ(codec::to_hex(json::value(std::numeric_limits<json::unsigned_integer>::max())), "cfffffffffffffffff");
+	ASSERT_EQ(codec::to_hex(yaml::node(1.0)), "ca3f800000");
+	ASSERT_EQ(codec::to_hex(yaml::node(1.1)), "cb3ff199999999999a");
+	ASSERT_EQ(codec::to_hex(json::value(1.0)), "ca3f800000");
+	ASSERT_EQ(codec::to_hex(json::value(1.5)), "ca3fc00000");
+	ASSERT_EQ(codec::to_hex(json::value(-0.0)), "ca80000000");
+	ASSERT_EQ(codec::to_hex(json::value(1e300)), "cb7e37e43c8800759c");
+
+	ASSERT_EQ(codec::to_hex(json::value()), "c0");
+	ASSERT_EQ(codec::to_hex(json::value(false)), "c2");
+	ASSERT_EQ(codec::to_hex(json::value(true)), "c3");
+	ASSERT_EQ(codec::to_hex(json::value(json::string(""))), "a0");
+	ASSERT_EQ(codec::to_hex(json::value(json::string("a"))), "a161");
+	ASSERT_EQ(codec::to_hex(json::value(std::string(31, 'x'))).substr(0, 2), "bf");
+	ASSERT_EQ(codec::to_hex(json::value(std::string(32, 'x'))).substr(0, 4), "d920");
+	ASSERT_EQ(codec::to_hex(json::value(std::string(256, 'x'))).substr(0, 6), "da0100");
+	ASSERT_EQ(codec::to_hex(json::value(std::string(65536, 'x'))).substr(0, 10), "db00010000");
+	ASSERT_EQ(codec::to_hex(json::parse("[]")), "90");
+	ASSERT_EQ(codec::to_hex(json::parse("[1, 2, 3]")), "93010203");
+	ASSERT_EQ(codec::to_hex(json::parse("[0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0]")).substr(0, 6), "dc0010");
+	ASSERT_EQ(codec::to_hex(json::parse("{}")), "80");
+	ASSERT_EQ(codec::to_hex(json::ordered::parse(R"({"a": 1, "b": [2, 3]})")), "82a16101a162920203");
+}
+
+TEST(MsgpackTest, decode) {
+	ASSERT_EQ(codec::decode_hex("cfffffffffffffffff"), json::value(std::numeric_limits<json::unsigned_integer>::max()));
+	ASSERT_EQ(codec::decode_hex("d38000000000000000"), json::value(std::numeric_limits<json::integer>::min()));
+	ASSERT_EQ(codec::decode_hex("d1ff7f"), json::value(json::integer(-129)));
+	ASSERT_EQ(codec::decode_hex("ce00010000"), json::value(json::integer(65536)));
+	ASSERT_EQ(codec::decode_hex("ca3fc00000"), json::value(1.5));
+	ASSERT_EQ(codec::decode_hex("cb3ff199999999999a"), json::value(1.1));
+	ASSERT_EQ(codec::decode_hex("d90161"), json::value(json::string("a")));
+	ASSERT_EQ(codec::decode_hex("da000161"), json::value(json::string("a")));
+	ASSERT_EQ(codec::decode_hex("c403010203"), json::value(json::string("\x01\x02\x03")));
+	ASSERT_EQ(codec::decode_hex("dc00020102"), json::parse("[1, 2]"));
+	ASSERT_EQ(codec::decode_hex("dd0000000100"), json::parse("[0]"));
+	ASSERT_EQ(codec::decode_hex("de0001a16101"), json::parse(R"({"a": 1})"));
+	ASSERT_EQ(codec::decode_hex("81c40161c0"), json::parse(R"({"a": null})"));
+
+	// Integers and floats are kept apart in yaml nodes
+	const auto n = codec::decode_hex<yaml::node>("82a16101a16292ca3fc0000003");
+	ASSERT_EQ(std::get<yaml::int_t>(std::get<yaml::map>(n).at("a")), 1);
+	const auto& b = std::get<yaml::seq>(std::get<yaml::map>(n).at("b"));
+	ASSERT_EQ(std::get<yaml::float_t>(b[0]), 1.5);
+	ASSERT_EQ(std::get<yaml::int_t>(b[1]), 3);
+
+	ASSERT_EQ(codec::error_position(""), 0u);
+	ASSERT_EQ(codec::error_position("cd01"), 0u);
+	ASSERT_EQ(codec::error_position("a261"), 0u);
+	ASSERT_EQ(codec::error_position("9201"), 0u);
+	ASSERT_EQ(codec::error_position("c1"), 0u);
+	ASSERT_EQ(codec::error_position("d40100"), 0u);
+	ASSERT_EQ(codec::error_position("910190"), 2u);
+	ASSERT_EQ(codec::error_position("920190c1"), 3u);
+	ASSERT_EQ(codec::error_position("810101"), 1u);
+	ASSERT_EQ(codec::error_position("0000"), 1u);
+	std::string deep;
+	for (std::size_t i = 0; i <= json::max_depth; ++i) {
+		deep += "91";
+	}
+	ASSERT_EQ(codec::error_position(deep), json::max_depth);
+}
+
+TEST(MsgpackTest, roundtrip) {
+	const auto v = json::parse(R"({"id": 623347347958, "name": "user_0", "active": false, "score": 76.3774618976614,
+		"tags": ["alpha", "beta"], "bio": "", "address": {"city": "City 0", "geo": [-0.8216843234506257, -18.183216676054286]},
+		"nested": [[[[]]], {}], "n": null, "big": 1e20, "small": -1e-300, "neg": -5000000000, "max": 18446744073709551615})");
+	const auto bytes = msgpack::encode(v);
+	ASSERT_EQ(msgpack::decode<json::value>(bytes.data(), bytes.size()), v);
+	ASSERT_LT(bytes.size(), json::dump(v).size());
+
+	yaml::map m;
+	m["i"] = yaml::node(std::int64_t(3));
+	m["f"] = yaml::node(3.0);
+	m["s"] = yaml::node(yaml::seq{yaml::node(yaml::null), yaml::node(true), yaml::node(yaml::str("x"))});
+	const yaml::node y(m);
+	const auto ybytes = msgpack::encode(y);
+	ASSERT_EQ(msgpack::decode<yaml::node>(ybytes.data(), ybytes.size()), y);
+}
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include <esl/static_map.hpp>
+#include <esl/map_utils.hpp>
+
+#include <array>
+#include <cstdint>
+#include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+
+using namespace std::literals;
+
+namespace {
+
+constexpr auto verbs = esl::make_static_map<std::string_view, int>({
+	{"GET", 1}, {"HEAD", 2}, {"POST", 3}, {"PUT", 4}, {"DELETE", 5}, {"CONNECT", 6}, {"OPTIONS", 7}, {"TRACE", 8}, {"PATCH", 9},
+});
+
+template <std::size_t... Is>
+constexpr std::array<std::pair<int, int>, sizeof...(Is)> make_squares(std::index_sequence<Is...>) {
+	return {{{int(Is) * 7919, int(Is * Is)}...}};
+}
+
+} // namespace
+
+TEST(StaticMapTest, compile_time) {
+	static_assert(verbs.size() == 9);
+	static_assert(verbs.at("PATCH") == 9);
+	static_assert(verbs.contains("OPTIONS"));
+	static_assert(!verbs.contains("GETS"));
+	static_assert(verbs.find("") == verbs.end());
+
+	static constexpr esl::static_map<int, int, 1000> squares(make_squares(std::make_index_sequence<1000>{}));
+	static_assert(squares.at(999 * 7919) == 999 * 999);
+	for (int i = 0; i < 1000; ++i) {
+		ASSERT_EQ(squares.at(i * 7919), i * i);
+		ASSERT_FALSE(squares.contains(i * 7919 + 1));
+	}
+}
+
+TEST(StaticMapTest, lookup) {
+	std::set<std::string_view> keys;
+	for (auto& [key, value] : verbs) {
+		ASSERT_EQ(verbs.find(key)->second, value);
+		keys.insert(key);
+	}
+	ASSERT_EQ(keys.size(), verbs.size());
+	ASSERT_EQ(verbs.count("PUT"), 1U);
+	ASSERT_EQ(verbs.count("put"), 0U);
+	ASSERT_THROW(verbs.at("put"), esl::key_not_found);
+
+	const std::string key = "DELETE";
+	ASSERT_EQ(verbs.at(key), 5);
+}
+
+TEST(StaticMapTest, runtime) {
+	auto m = esl::make_static_map<std::string_view, std::string>({{"a", "1"}, {"b", "2"}, {"c", "3"}});
+	m.at("b") = "22";
+	ASSERT_EQ(m.at("b"), "22");
+	ASSERT_THROW((esl::make_static_map<std::string_view, int>({{"a", 1}, {"b", 2}, {"a", 3}})), std::invalid_argument);
+
+	// Distinct keys hashing equally for every seed exhaust the seeds
+	struct constant_hash {
+		constexpr std::uint64_t operator()(int, std::uint64_t) const noexcept { return 42; }
+	};
+	using colliding_map = esl::static_map<int, int, 3, constant_hash>;
+	ASSERT_THROW((colliding_map({{1, 1}, {2, 2}, {3, 3}})), std::invalid_argument);
+	ASSERT_THROW((colliding_map({{1, 1}, {2, 2}, {1, 3}})), std::invalid_argument);
+	ASSERT_EQ((esl::static_map<int, int, 1, constant_hash>({{7, 49}}).at(7)), 49);
+}
+
+TEST(StaticMapTest, map_utils) {
+	auto m = esl::make_static_map<std::string_view, int>({{"k1", 11}, {"k2", 12}});
+	ASSERT_EQ(esl::map_get(m, "k1"), 11);
+	ASSERT_EQ(esl::map_get(verbs, "GET"), 1);
+	ASSERT_THROW(esl::map_get(verbs, "k0"), esl::key_not_found);
+	int def = 5;
+	ASSERT_EQ(&esl::map_get(m, "k0", def), &def);
+	esl::map_get(m, "k2") = 22;
+	ASSERT_EQ(*esl::map_get_if(&m, "k2"), 22);
+	ASSERT_EQ(esl::map_get_if(&m, "k0"), nullptr);
+	ASSERT_TRUE(esl::map_contains(verbs, "HEAD"));
+	ASSERT_FALSE(esl::map_contains(verbs, "k0"));
+}
@@ -4,9 +4,17 @@
 #include <esl/string.hpp>
 #include <esl/iterator.hpp>
 
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
 #include <vector>
 #include <set>
 #include <iterator>
+#include <limits>
+#include <string>
+#include <utility>
 
 TEST(StringTest, constexpr_str_functions) {
 	static_assert(esl::constexpr_strlen("") == 0);
@@ -162,6 +170,112 @@ TEST(StringTest, from_string) {
 	}
 }
 
+#ifdef __cpp_lib_to_chars
+
+namespace {
+
+// Same value and consumed size as std::from_chars
+template <class T>
+void expect_from_chars(const std::string& s) {
+	T a = 0;
+	T b = 0;
+	const auto [errc, size] = esl::from_string(s, a);
+	const auto r = std::from_chars(s.data(), s.data() + s.size(), b);
+	ASSERT_EQ(static_cast<int>(errc), static_cast<int>(r.ec)) << s;
+	ASSERT_EQ(size, static_cast<std::size_t>(r.ptr - s.data())) << s;
+	if (r.ec == std::errc{}) {
+		ASSERT_EQ(std::memcmp(&a, &b, sizeof(T)), 0) << s;
+	}
+}
+
+} // namespace
+
+#endif // __cpp_lib_to_chars
+
+TEST(StringTest, from_string_float) {
+	{
+		double a = 0;
+		auto [errc, size] = esl::from_string(std::string_view("1.5e3x"), a);
+		ASSERT_EQ(errc, esl::from_string_errc::success);
+		ASSERT_EQ(a, 1500.0);
+		ASSERT_EQ(size, 5);
+	}
+	{
+		double a = 100;
+		auto [errc, size] = esl::from_string(std::string_view("e5"), a);
+		ASSERT_EQ(errc, esl::from_string_errc::invalid_argument);
+		ASSERT_EQ(a, 100);
+		ASSERT_EQ(size, 0);
+	}
+	{
+		float a = 100;
+		auto [errc, size] = esl::from_string(std::string_view("1e39"), a);
+		ASSERT_EQ(errc, esl::from_string_errc::result_out_of_range);
+		ASSERT_EQ(a, 100);
+		ASSERT_EQ(size, 4);
+	}
+	// Past 19 digits, rounded at the exact halfway point: to even on a tie, digits after the 768th only break ties
+	{
+		const std::string halfway = "1.00000000000000011102230246251565404236316680908203125"; // 1 + 2^-53
+		const double up = std::nextafter(1.0, 2.0);
+		for (const auto& [s, expected] : {std::make_pair(halfway, 1.0), std::make_pair(halfway + std::string(800, '0') + "1", up),
+					 std::make_pair(halfway.substr(0, halfway.size() - 1) + "4" + std::string(30, '9'), 1.0),
+					 std::make_pair("-" + halfway + "e0", -1.0)}) {
+			double a = 0;
+			const auto [errc, size] = esl::from_string(s, a);
+			ASSERT_EQ(errc, esl::from_string_errc::success) << s;
+			ASSERT_EQ(size, s.size()) << s;
+			ASSERT_EQ(a, expected) << s;
+		}
+		const float upf = std::nextafter(1.0f, 2.0f);
+		for (const auto& [s, expected] : {std::make_pair("1.000000059604644775390625", 1.0f),
+					 std::make_pair("1.0000000596046447753906250000000001", upf),
+					 std::make_pair("1.000000178813934326171875", std::nextafter(upf, 2.0f))}) {
+			float a = 0;
+			ASSERT_EQ(esl::from_string(std::string_view(s), a).first, esl::from_string_errc::success) << s;
+			ASSERT_EQ(a, expected) << s;
+		}
+	}
+	{
+		double a = 0;
+		ASSERT_EQ(esl::from_string(std::string_view("-Infinity"), a), std::make_pair(esl::from_string_errc::success, std::size_t{9}));
+		ASSERT_EQ(a, -std::numeric_limits<double>::infinity());
+		ASSERT_EQ(esl::from_string(std::string_view("nan(0x1)"), a), std::make_pair(esl::from_string_errc::success, std::size_t{8}));
+		ASSERT_TRUE(std::isnan(a));
+		ASSERT_EQ(esl::from_string(std::string_view("+inf"), a).first, esl::from_string_errc::invalid_argument);
+	}
+#ifdef __cpp_lib_to_chars
+	for (const char* s : {"0", "-0", "1", "-1.25", ".5", "5.", "1e", "1e+", "1.e5", "007.5", "0.1", "1e22", "1e23", "9007199254740993",
+			 "2.2250738585072011e-308", "2.2250738585072014e-308", "4.9406564584124654e-324", "2.4703282292062327e-324",
+			 "2.4703282292062328e-324", "1.7976931348623157e308", "1.7976931348623159e308", "1e-400", "1e400", "inf", "-nan",
+			 "0.000000000000000000000000000000000000000000001", "123456789012345678901234567890",
+			 "9007199254740992.000000000000000000001", "1.00000000000000011102230246251565404236316680908203125",
+			 "1.00000000000000011102230246251565404236316680908203124", "7.038531e-26", "3.4028235e38", "1.4e-45"}) {
+		expect_from_chars<double>(s);
+		expect_from_chars<float>(s);
+	}
+
+	std::mt19937_64 rng(42);
+	char buf[64];
+	for (int i = 0; i < 20000; ++i) {
+		const std::uint64_t bits = rng();
+		double d;
+		std::memcpy(&d, &bits, sizeof(d));
+		const auto shortest = std::to_chars(buf, buf + sizeof(buf), d);
+		expect_from_chars<double>(std::string(buf, shortest.ptr));
+		const auto fixed = std::to_chars(buf, buf + sizeof(buf), d, std::chars_format::scientific, 17 + static_cast<int>(i % 8));
+		expect_from_chars<double>(std::string(buf, fixed.ptr));
+		const auto f = static_cast<std::uint32_t>(bits);
+		float x;
+		std::memcpy(&x, &f, sizeof(x));
+		const auto r = std::to_chars(buf, buf + sizeof(buf), x);
+		expect_from_chars<float>(std::string(buf, r.ptr));
+		const auto n = std::to_chars(buf, buf + sizeof(buf), bits % 100000000000, 10);
+		expect_from_chars<double>(std::string(buf, n.ptr) + "e" + std::to_string(static_cast<int>(bits >> 55) - 256));
+	}
+#endif
+}
+
 TEST(StringTest, format) {
 	auto s = esl::format("{{hi{}}}", 123);
 	ASSERT_EQ(s, "{hi123}");
@@ -1,6 +1,12 @@
 
 #include <gtest/gtest.h>
 #include <esl/utility.hpp>
+#include <esl/intrin.hpp>
+#include "cpu_test_util.hpp"
+
+#include <sstream>
+#include <stdexcept>
+#include <utility>
 
 using namespace esl::casts;
 
@@ -48,4 +54,88 @@ TEST(UtilityTest, make_overloaded) {
 	ASSERT_EQ(f(0), 1);
 	ASSERT_EQ(f(true), 2);
 	ASSERT_EQ(f(std::string("hello")), 3);
-}
\ No newline at end of file
+}
+
+namespace {
+
+template <class F>
+void for_each_cpu_level(F&& f) {
+	esl_tests::for_each_cpu_level({{&esl::cpu_features::avx2}, {&esl::cpu_features::ssse3}}, std::forward<F>(f));
+}
+
+} // namespace
+
+TEST(UtilityTest, cpu_features_guard) {
+	const bool avx2 = esl::current_cpu_features().avx2;
+	int runs = 0;
+	try {
+		for_each_cpu_level([&] {
+			if (++runs == 2) {
+				ASSERT_FALSE(esl::current_cpu_features().avx2);
+				throw std::runtime_error("cpu_features_guard");
+			}
+		});
+	} catch (const std::runtime_error&) {
+	}
+	ASSERT_EQ(runs, 2);
+	ASSERT_EQ(esl::current_cpu_features().avx2, avx2);
+}
+
+TEST(UtilityTest, hex) {
+	ASSERT_EQ(esl::hex_encode("\x01\xab\xCD\xef", 4), "01abcdef");
+	ASSERT_EQ(esl::hex_encode("\x01\xab\xCD\xef", 4, esl::hex_uppercase), "01ABCDEF");
+	ASSERT_EQ(esl::hex_decode("01abcdef", 8), "\x01\xab\xCD\xef");
+	ASSERT_EQ(esl::hex_decode("01ABCDEF", 8, esl::hex_uppercase), "\x01\xab\xCD\xef");
+	ASSERT_EQ(esl::hex_try_decode("01ABCDEF", 8), std::make_pair(std::string("\x01"), std::size_t{2}));
+	ASSERT_EQ(esl::hex_try_decode("01a", 3), std::make_pair(std::string("\x01"), std::size_t{2}));
+	try {
+		esl::hex_decode("01a", 3);
+		FAIL();
+	} catch (const esl::hex_decode_error& e) {
+		ASSERT_EQ(e.position(), 2u);
+	}
+
+	const esl::hex_option custom("fedcba9876543210");
+	std::string bytes(1000, '\0');
+	for (std::size_t i = 0; i < bytes.size(); ++i) {
+		bytes[i] = static_cast<char>(i * 37 + (i >> 3));
+	}
+	for (const auto* option : {&esl::hex_lowercase, &esl::hex_uppercase, &custom}) {
+		for (std::size_t n : {0, 1, 15, 16, 17, 31, 32, 33, 63, 64, 65, 100, 1000}) {
+			const auto b = bytes.substr(0, n);
+			std::vector<std::string> encoded;
+			for_each_cpu_level([&] {
+				encoded.push_back(esl::hex_encode(b.data(), b.size(), *option));
+			});
+			for (auto& e : encoded) {
+				ASSERT_EQ(e, encoded.back());
+			}
+			for (std::size_t i = 0; i < n; ++i) {
+				ASSERT_EQ(encoded.back()[i * 2], option->encode(static_cast<unsigned char>(b[i]) >> 4));
+			}
+			const auto& text = encoded.back();
+			for_each_cpu_level([&] {
+				ASSERT_EQ(esl::hex_decode(text.data(), text.size(), *option), b);
+			});
+			// Invalid character at every position
+			for (std::size_t pos = 0; pos < std::min<std::size_t>(text.size(), 140); ++pos) {
+				for (char bad : {'g', 'G', '/', ':', '@', '`', '\0', '\xff', static_cast<char>(text[pos] ^ 0x20)}) {
+					auto t = text;
+					t[pos] = bad;
+					if (option->decode(bad) < 16) {
+						continue;
+					}
+					for_each_cpu_level([&] {
+						const auto r = esl::hex_try_decode(t.data(), t.size(), *option);
+						ASSERT_EQ(r.second, pos);
+						ASSERT_EQ(r.first, b.substr(0, pos / 2));
+					});
+				}
+			}
+		}
+	}
+
+	std::ostringstream os;
+	esl::hex_decode(os, "0102", 4);
+	ASSERT_EQ(os.str(), "\x01\x02");
+}
@@ -0,0 +1,230 @@
+
+#include <gtest/gtest.h>
+#include <esl/map_utils.hpp>
+#include <esl/vector_map.hpp>
+
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace {
+
+struct string_hash {
+	using is_transparent = void;
+
+	std::size_t operator()(std::string_view s) const noexcept {
+		return std::hash<std::string_view>{}(s);
+	}
+};
+
+using string_map = esl::vector_map<std::string, int, string_hash, std::equal_to<>>;
+
+// Fails allocations of index slots, or hashing, on demand
+bool fail_index_allocation = false;
+bool fail_hash = false;
+
+template <class T>
+struct index_failing_allocator {
+	using value_type = T;
+
+	index_failing_allocator() = default;
+	template <class U>
+	index_failing_allocator(const index_failing_allocator<U>&) noexcept {}
+
+	T* allocate(std::size_t n) {
+		if (std::is_same_v<T, std::uint64_t> && fail_index_allocation) {
+			throw std::bad_alloc();
+		}
+		return std::allocator<T>().allocate(n);
+	}
+	void deallocate(T* p, std::size_t n) noexcept {
+		std::allocator<T>().deallocate(p, n);
+	}
+
+	friend bool operator==(const index_failing_allocator&, const index_failing_allocator&) noexcept {
+		return true;
+	}
+	friend bool operator!=(const index_failing_allocator&, const index_failing_allocator&) noexcept {
+		return false;
+	}
+};
+
+struct failing_hash {
+	std::size_t operator()(int k) const {
+		if (fail_hash) {
+			throw std::runtime_error("failing_hash");
+		}
+		return std::hash<int>{}(k);
+	}
+};
+
+using failing_map = esl::vector_map<int, int, failing_hash, std::equal_to<int>, index_failing_allocator<std::pair<int, int>>>;
+
+template <class Map>
+void expect_range(const Map& m, int first, int last) {
+	ASSERT_EQ(m.size(), static_cast<std::size_t>(last - first));
+	for (int k = first - 10; k < last + 10; ++k) {
+		ASSERT_EQ(m.contains(k), k >= first && k < last) << k;
+	}
+}
+
+} // namespace
+
+TEST(VectorMapTest, basic) {
+	string_map m = {{"b", 2}, {"a", 1}, {"b", 3}};
+	ASSERT_EQ(m.size(), 2);
+	ASSERT_EQ(m.begin()->first, "b");
+	ASSERT_EQ(m.at("b"), 2);
+	ASSERT_THROW(m.at("c"), esl::key_not_found);
+
+	// Insertion order
+	m["c"] = 3;
+	ASSERT_TRUE(m.insert_or_assign("a", 10).second == false);
+	ASSERT_TRUE(m.try_emplace("d", 4).second);
+	ASSERT_FALSE(m.try_emplace("d", 5).second);
+	ASSERT_FALSE(m.emplace("c", 6).second);
+	ASSERT_TRUE(m.emplace("e", 5).second);
+	std::string keys;
+	for (const auto& [k, v] : m) {
+		keys += k;
+	}
+	ASSERT_EQ(keys, "bacde");
+	ASSERT_EQ(m.at("a"), 10);
+	ASSERT_EQ(m.at("d"), 4);
+	ASSERT_EQ(m.at("c"), 3);
+
+	// Heterogeneous lookup
+	ASSERT_TRUE(m.contains(std::string_view("e")));
+	ASSERT_EQ(m.count("x"), 0);
+	ASSERT_EQ(esl::map_get(m, "e"), 5);
+	ASSERT_EQ(esl::map_get_if(&m, "x"), nullptr);
+
+	ASSERT_EQ(m.erase("a"), 1);
+	ASSERT_EQ(m.erase("a"), 0);
+	ASSERT_EQ(m.erase(m.begin())->first, "c");
+	ASSERT_EQ(m.size(), 3);
+
+	// Order is ignored
+	string_map other = {{"e", 5}, {"d", 4}, {"c", 3}};
+	ASSERT_EQ(m, other);
+	ASSERT_EQ(std::hash<string_map>{}(m), std::hash<string_map>{}(other));
+	other["c"] = 0;
+	ASSERT_NE(m, other);
+
+	m.clear();
+	ASSERT_TRUE(m.empty());
+	ASSERT_EQ(m.find("e"), m.end());
+}
+
+TEST(VectorMapTest, index) {
+	// Checked against std::map through the growth of the index and erasures
+	std::mt19937 rng(1);
+	esl::vector_map<int, int> m;
+	std::map<int, int> ref;
+	for (int i = 0; i < 2000; ++i) {
+		const int k = static_cast<int>(rng() % 300);
+		if (rng() % 4 == 0) {
+			ASSERT_EQ(m.erase(k), ref.erase(k));
+		} else {
+			ASSERT_EQ(m.insert({k, i}).second, ref.insert({k, i}).second);
+		}
+		ASSERT_EQ(m.size(), ref.size());
+		const int q = static_cast<int>(rng() % 300);
+		ASSERT_EQ(m.contains(q), ref.count(q) != 0);
+		if (m.contains(q)) {
+			ASSERT_EQ(m.at(q), ref.at(q));
+		}
+	}
+	for (const auto& [k, v] : ref) {
+		ASSERT_EQ(m.at(k), v);
+	}
+
+	// Copies and moves keep the index
+	auto copy = m;
+	ASSERT_EQ(copy, m);
+	auto moved = std::move(copy);
+	ASSERT_EQ(moved, m);
+	copy = moved;
+	ASSERT_EQ(copy.size(), ref.size());
+	for (const auto& [k, v] : ref) {
+		ASSERT_EQ(copy.at(k), v);
+	}
+
+	esl::vector_map<int, int> reserved;
+	reserved.reserve(100);
+	for (int i = 0; i < 100; ++i) {
+		reserved.emplace(i, i);
+	}
+	ASSERT_EQ(reserved.at(99), 99);
+	ASSERT_FALSE(reserved.contains(100));
+}
+
+TEST(VectorMapTest, allocator) {
+	std::pmr::monotonic_buffer_resource r1, r2;
+	using map_type = esl::vector_map<std::pmr::string, int, std::hash<std::pmr::string>, std::equal_to<std::pmr::string>,
+	                                 std::pmr::polymorphic_allocator<std::pair<std::pmr::string, int>>>;
+	map_type m(&r1);
+	for (int i = 0; i < 20; ++i) {
+		m.emplace(std::pmr::string(std::to_string(i) + std::string(30, 'k')), i);
+	}
+	ASSERT_EQ(m.begin()->first.get_allocator().resource(), &r1);
+
+	map_type same(std::move(m), &r1);
+	ASSERT_EQ(same.size(), 20);
+	map_type other(std::move(same), &r2);
+	ASSERT_EQ(other.size(), 20);
+	ASSERT_EQ(other.begin()->first.get_allocator().resource(), &r2);
+	ASSERT_EQ(other.at(std::pmr::string("19" + std::string(30, 'k'))), 19);
+}
+
+TEST(VectorMapTest, exception_safety) {
+	failing_map m;
+	for (int i = 0; i < 40; ++i) {
+		m.emplace(i, i);
+	}
+
+	// Erasures rebuild the index in place, without allocating
+	fail_index_allocation = true;
+	m.erase(m.begin(), m.begin() + 10);
+	fail_index_allocation = false;
+	expect_range(m, 10, 40);
+
+	// Copy assignment leaves the map unchanged if the index can not be copied
+	failing_map small;
+	small.emplace(1, 1);
+	fail_index_allocation = true;
+	ASSERT_THROW(small = m, std::bad_alloc);
+	fail_index_allocation = false;
+	expect_range(small, 1, 2);
+	small = m;
+	expect_range(small, 10, 40);
+
+	// The index can not grow: the entry is not inserted
+	fail_index_allocation = true;
+	for (int i = 40; i < 100; ++i) {
+		try {
+			m.emplace(i, i);
+		} catch (const std::bad_alloc&) {
+			break;
+		}
+	}
+	fail_index_allocation = false;
+	expect_range(m, 10, static_cast<int>(m.size()) + 10);
+
+	// Hashing throws while reindexing: the map is left without an index, then indexed for all entries again
+	m.erase(m.begin() + 30, m.end());
+	fail_hash = true;
+	ASSERT_THROW(m.erase(m.begin()), std::runtime_error);
+	fail_hash = false;
+	expect_range(m, 11, 40);
+	m.reserve(esl::vector_map<int, int>::index_threshold + 1);
+	expect_range(m, 11, 40);
+	m.emplace(40, 40);
+	expect_range(m, 11, 41);
+}